@@ -0,0 +1,28 @@
+// Decoding for VertexFormat::Compact and VertexFormat::CompactQuantised, see graphics/CompactVertex.hpp. The vertex input formats already
+// turn the snorm, unorm and half components into floats.
+
+vec3 decode_octahedral_normal(vec2 encoded)
+{
+	vec3 normal = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+	if (normal.z < 0.0) {
+		normal.xy = (1.0 - abs(normal.yx)) * vec2(normal.x >= 0.0 ? 1.0 : -1.0, normal.y >= 0.0 ? 1.0 : -1.0);
+	}
+	return normalize(normal);
+}
+
+vec3 rotate_by_quaternion(vec4 quaternion, vec3 vector)
+{
+	return vector + 2.0 * cross(quaternion.xyz, cross(quaternion.xyz, vector) + quaternion.w * vector);
+}
+
+// The sign of w is the sign of the bitangent.
+void decode_tangent_frame(vec4 encoded, out vec3 tangent, out vec3 bitangent)
+{
+	const vec4 quaternion = normalize(encoded);
+	const vec3 normal = rotate_by_quaternion(quaternion, vec3(0.0, 0.0, 1.0));
+	tangent = rotate_by_quaternion(quaternion, vec3(1.0, 0.0, 0.0));
+	bitangent = cross(normal, tangent) * (encoded.w < 0.0 ? -1.0 : 1.0);
+}
+
+// The offset and scale are the PositionDequantisation of the submesh.
+vec3 dequantise_position(vec4 quantised, vec3 offset, vec3 scale) { return offset + scale * quantised.xyz; }
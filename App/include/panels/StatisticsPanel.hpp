@@ -26,6 +26,8 @@ private:
 	MovingAverage<double, double, frame_keep> frame_time_average;
 	MovingAverage<double, double, frame_keep> cpu_time_average;
 	MovingAverage<double, double, frame_keep> presentation_time_average;
+	MovingAverage<double, double, frame_keep> heap_allocations_average;
+	MovingAverage<double, double, frame_keep> frame_arena_bytes_average;
 };
 
 } // namespace Disarray::Client
@@ -88,7 +88,8 @@ void ClientLayer::setup_filewatcher_and_threadpool(Threading::ThreadPool& pool)
 	static constexpr auto tick_time = std::chrono::milliseconds(3000);
 	file_watcher = make_scope<FileWatcher>(pool, "Assets/Shaders", Collections::StringSet { ".vert", ".frag", ".glsl" }, tick_time);
 	auto& pipeline_cache = scene_renderer.get_pipeline_cache();
-	file_watcher->on_modified([&ext = extent, &pipeline_cache](const FileInformation& entry) { pipeline_cache.force_recreation(ext); });
+	// Editors often save by renaming a new file into place, which is reported as a creation.
+	file_watcher->on_created_or_modified([&pipeline_cache](const FileInformation& entry) { pipeline_cache.reload_affected_by(entry.to_path()); });
 }
 
 auto ClientLayer::toolbar() -> void
@@ -406,6 +407,7 @@ void ClientLayer::update(float time_step)
 
 void ClientLayer::render()
 {
+	scene_renderer.get_pipeline_cache().apply_reloads();
 	scene_renderer.begin_execution();
 	if (scene_state == SceneState::Play) {
 		auto primary_camera = scene->get_primary_camera();
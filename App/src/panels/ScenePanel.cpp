@@ -135,6 +135,14 @@ void ScenePanel::interface()
 	}
 	UI::end();
 
+	UI::scope("Frame Graph", [this]() {
+		const auto& [tasks, wall_time, critical_path] = scene->get_frame_statistics();
+		UI::text("Wall time: {:.3f}ms, critical path: {:.3f}ms", wall_time, critical_path);
+		for (const auto& task : tasks) {
+			UI::text("{} {}: {:.3f}ms (started at {:.3f}ms)", task.on_critical_path ? '*' : ' ', task.name, task.duration_ms, task.start_ms);
+		}
+	});
+
 	ImGui::Begin("Properties");
 	if (!selected_entity) {
 		UI::end();
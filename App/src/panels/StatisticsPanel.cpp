@@ -1,5 +1,7 @@
 #include "panels/StatisticsPanel.hpp"
 
+#include "core/Metrics.hpp"
+
 namespace Disarray::Client {
 
 StatisticsPanel::StatisticsPanel(Device&, Window&, Swapchain&, const ApplicationStatistics& stats)
@@ -7,10 +9,12 @@ StatisticsPanel::StatisticsPanel(Device&, Window&, Swapchain&, const Application
 
 void StatisticsPanel::update(float time_step)
 {
-	const auto& [cpu_time, frame_time, presentation_time] = statistics;
+	const auto& [cpu_time, frame_time, presentation_time, heap_allocations, frame_arena_bytes] = statistics;
 	cpu_time_average(cpu_time);
 	frame_time_average(frame_time);
 	presentation_time_average(presentation_time);
+	heap_allocations_average(static_cast<double>(heap_allocations));
+	frame_arena_bytes_average(static_cast<double>(frame_arena_bytes));
 }
 
 void StatisticsPanel::interface()
@@ -25,6 +29,13 @@ void StatisticsPanel::interface()
 				ImGui::TableNextColumn();
 				UI::text("{:.3f}ms", double(frame_time_average));
 			}
+			if (const auto frame_time_summary = Metrics::get_summary("Frame"); frame_time_summary.has_value()) {
+				ImGui::TableNextRow();
+				ImGui::TableNextColumn();
+				UI::text("{}", "Frametime p99 / max");
+				ImGui::TableNextColumn();
+				UI::text("{:.3f}ms / {:.3f}ms", frame_time_summary->p99, frame_time_summary->max);
+			}
 			{
 				ImGui::TableNextRow();
 				ImGui::TableNextColumn();
@@ -46,6 +57,28 @@ void StatisticsPanel::interface()
 				ImGui::TableNextColumn();
 				UI::text("{:.3f}us", double(presentation_time_average));
 			}
+			{
+				ImGui::TableNextRow();
+				ImGui::TableNextColumn();
+				UI::text("{}", "Heap allocations");
+				ImGui::TableNextColumn();
+				UI::text("{:.1f}", double(heap_allocations_average));
+			}
+			{
+				ImGui::TableNextRow();
+				ImGui::TableNextColumn();
+				UI::text("{}", "Frame arena");
+				ImGui::TableNextColumn();
+				UI::text("{:.1f}KiB", double(frame_arena_bytes_average) / 1024.0);
+			}
+			{
+				const auto draw_calls = Metrics::get_summary(Metrics::Counter::DrawCalls);
+				ImGui::TableNextRow();
+				ImGui::TableNextColumn();
+				UI::text("{}", "Draw calls p50 / max");
+				ImGui::TableNextColumn();
+				UI::text("{:.0f} / {:.0f}", draw_calls.p50, draw_calls.max);
+			}
 			ImGui::EndTable();
 		}
 	});
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "core/filesystem/FileIO.hpp"
+#include "core/filesystem/MappedFile.hpp"
+
+// Compares FS::read_from_file with FS::MappedFile. The first argument is the file size in MiB, every iteration opens the file and
+// scans all of it, like the JSON parser or the shader compiler would.
+
+namespace Disarray::Benchmarks {
+
+inline auto mapped_file_benchmark_path(std::size_t mebibytes) -> std::filesystem::path
+{
+	auto path = std::filesystem::temp_directory_path() / ("disarray-mapped-file-" + std::to_string(mebibytes) + ".txt");
+	if (std::filesystem::exists(path) && std::filesystem::file_size(path) == mebibytes * 1024 * 1024) {
+		return path;
+	}
+
+	std::string line = "vec4 position = model * vec4(in_position, 1.0); // padding padding padding\n";
+	std::ofstream stream { path, std::ios::binary };
+	for (std::size_t written = 0; written < mebibytes * 1024 * 1024;) {
+		const auto count = std::min(line.size(), mebibytes * 1024 * 1024 - written);
+		stream.write(line.data(), static_cast<std::streamsize>(count));
+		written += count;
+	}
+	return path;
+}
+
+} // namespace Disarray::Benchmarks
+
+inline void benchmark_read_from_file(benchmark::State& state)
+{
+	using namespace Disarray;
+	const auto path = Benchmarks::mapped_file_benchmark_path(static_cast<std::size_t>(state.range(0))).string();
+	for (auto value : state) {
+		std::string output;
+		if (!FS::read_from_file(path, output)) {
+			state.SkipWithError("Could not read the file");
+			break;
+		}
+		benchmark::DoNotOptimize(std::count(output.begin(), output.end(), '\n'));
+	}
+	state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations()) * state.range(0) * 1024 * 1024);
+}
+
+inline void benchmark_mapped_file(benchmark::State& state)
+{
+	using namespace Disarray;
+	const auto path = Benchmarks::mapped_file_benchmark_path(static_cast<std::size_t>(state.range(0)));
+	for (auto value : state) {
+		const FS::MappedFile file { path };
+		if (!file) {
+			state.SkipWithError("Could not map the file");
+			break;
+		}
+		const auto view = file.view();
+		benchmark::DoNotOptimize(std::count(view.begin(), view.end(), '\n'));
+	}
+	state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations()) * state.range(0) * 1024 * 1024);
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <benchmark/benchmark.h>
+
+#include <filesystem>
+
+#include "core/Log.hpp"
+#include "graphics/MeshCache.hpp"
+#include "graphics/ModelLoader.hpp"
+#include "graphics/model_loaders/AssimpModelLoader.hpp"
+
+// Compares importing a model with Assimp, as every mesh construction did before the cache, with loading the same import from its .dmesh file.
+
+namespace Disarray::Benchmarks {
+
+inline constexpr auto mesh_cache_benchmark_model = "Assets/Models/sponza/sponza.obj";
+
+inline auto import_for_mesh_cache_benchmark() -> ModelLoader
+{
+	return ModelLoader { make_scope<AssimpModelLoader>(), mesh_cache_benchmark_model, default_import_flags };
+}
+
+} // namespace Disarray::Benchmarks
+
+inline void benchmark_mesh_cache_cold_assimp(benchmark::State& state)
+{
+	using namespace Disarray;
+	Logging::Logger::initialise_logger("info");
+	for (auto value : state) {
+		try {
+			auto loader = Benchmarks::import_for_mesh_cache_benchmark();
+			benchmark::DoNotOptimize(loader.get_aabb());
+		} catch (const CouldNotLoadModelException& exc) {
+			state.SkipWithError(exc.what());
+			break;
+		}
+	}
+}
+
+inline void benchmark_mesh_cache_warm(benchmark::State& state)
+{
+	using namespace Disarray;
+	Logging::Logger::initialise_logger("info");
+	const auto rotation = glm::identity<glm::mat4>();
+	if (!MeshCache::load(Benchmarks::mesh_cache_benchmark_model, default_import_flags, rotation)) {
+		try {
+			auto loader = Benchmarks::import_for_mesh_cache_benchmark();
+			MeshCache::store(Benchmarks::mesh_cache_benchmark_model, default_import_flags, rotation, loader.get_mesh_data(), loader.get_aabb());
+		} catch (const CouldNotLoadModelException& exc) {
+			state.SkipWithError(exc.what());
+			return;
+		}
+	}
+
+	for (auto value : state) {
+		const auto cached = MeshCache::load(Benchmarks::mesh_cache_benchmark_model, default_import_flags, rotation);
+		if (!cached) {
+			state.SkipWithError("The mesh cache could not be loaded");
+			break;
+		}
+		benchmark::DoNotOptimize(cached->get_aabb());
+	}
+}
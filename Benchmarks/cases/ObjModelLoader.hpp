@@ -0,0 +1,69 @@
+#pragma once
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <thread>
+
+#include "ParallelForEach.hpp"
+#include "core/Collections.hpp"
+#include "core/Log.hpp"
+#include "graphics/ModelLoader.hpp"
+#include "graphics/model_loaders/ObjModelLoader.hpp"
+#include "graphics/model_loaders/TinyObjModelLoader.hpp"
+
+// Imports sponza.obj (model 0) and viking.obj (model 1) with tinyobjloader and with the chunked ObjModelLoader. The streaming
+// benchmark's first argument is the thread count, as in ParallelForEach.hpp, and its second the model.
+
+namespace Disarray::Benchmarks {
+
+inline constexpr std::array obj_benchmark_models { "Assets/Models/sponza/sponza.obj", "Assets/Models/viking.obj" };
+
+inline void register_obj_models(benchmark::internal::Benchmark* benchmark)
+{
+	for (std::int64_t model = 0; model < static_cast<std::int64_t>(obj_benchmark_models.size()); model++) {
+		benchmark->Args({ 0, model });
+		for (std::int64_t threads = 1; threads <= static_cast<std::int64_t>(std::thread::hardware_concurrency()); threads *= 2) {
+			benchmark->Args({ threads, model });
+		}
+	}
+	benchmark->UseRealTime()->Unit(benchmark::kMillisecond);
+}
+
+} // namespace Disarray::Benchmarks
+
+inline void benchmark_obj_loader_tinyobj(benchmark::State& state)
+{
+	using namespace Disarray;
+	Logging::Logger::initialise_logger("info");
+	const auto* model = Benchmarks::obj_benchmark_models.at(static_cast<std::size_t>(state.range(0)));
+	TinyObjModelLoader loader { glm::mat4 { 1.0F } };
+	for (auto value : state) {
+		try {
+			auto loaded = loader.import_model(model, default_import_flags);
+			benchmark::DoNotOptimize(loaded);
+		} catch (const CouldNotLoadModelException& exc) {
+			state.SkipWithError(exc.what());
+			break;
+		}
+	}
+}
+
+inline void benchmark_obj_loader_streaming(benchmark::State& state)
+{
+	using namespace Disarray;
+	Logging::Logger::initialise_logger("info");
+	Benchmarks::configure_parallel_execution(state);
+	const auto* model = Benchmarks::obj_benchmark_models.at(static_cast<std::size_t>(state.range(1)));
+	ObjModelLoader loader {};
+	for (auto value : state) {
+		try {
+			auto loaded = loader.import_model(model, default_import_flags);
+			benchmark::DoNotOptimize(loaded);
+		} catch (const CouldNotLoadModelException& exc) {
+			state.SkipWithError(exc.what());
+			break;
+		}
+	}
+	Collections::set_serial_execution(false);
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <benchmark/benchmark.h>
+
+#include <glm/ext/matrix_transform.hpp>
+
+#include <thread>
+#include <vector>
+
+#include "core/App.hpp"
+#include "core/Collections.hpp"
+#include "core/Log.hpp"
+#include "graphics/ModelLoader.hpp"
+#include "graphics/ModelVertex.hpp"
+#include "graphics/model_loaders/AssimpModelLoader.hpp"
+#include "graphics/model_loaders/TinyObjModelLoader.hpp"
+
+namespace Disarray::Benchmarks {
+
+// An argument of zero runs the serial fallback, any other argument is the size of the thread pool.
+inline void configure_parallel_execution(const benchmark::State& state)
+{
+	const auto thread_count = static_cast<Threading::concurrency_t>(state.range(0));
+	Collections::set_serial_execution(thread_count == 0);
+	App::get_thread_pool().reset(thread_count == 0 ? 1 : thread_count);
+}
+
+inline void register_thread_counts(benchmark::internal::Benchmark* benchmark)
+{
+	benchmark->Arg(0);
+	for (std::int64_t threads = 1; threads <= static_cast<std::int64_t>(std::thread::hardware_concurrency()); threads *= 2) {
+		benchmark->Arg(threads);
+	}
+	benchmark->UseRealTime()->Unit(benchmark::kMillisecond);
+}
+
+} // namespace Disarray::Benchmarks
+
+inline void benchmark_parallel_for_each_rotate(benchmark::State& state)
+{
+	using namespace Disarray;
+	Logging::Logger::initialise_logger("info");
+	Benchmarks::configure_parallel_execution(state);
+
+	static constexpr auto vertex_count = 1'000'000;
+	std::vector<ModelVertex> vertices(vertex_count, ModelVertex { .pos = { 1, 2, 3 }, .normals = { 0, 1, 0 } });
+	const auto rotation = glm::rotate(glm::mat4 { 1.0F }, glm::radians(15.0F), glm::vec3 { 0, 1, 0 });
+
+	for (auto value : state) {
+		Collections::parallel_for_each(vertices, [&rotation](ModelVertex& vertex) { vertex.rotate_by(rotation); });
+		benchmark::DoNotOptimize(vertices.data());
+	}
+	state.SetItemsProcessed(state.iterations() * vertex_count);
+	Collections::set_serial_execution(false);
+}
+
+inline void benchmark_parallel_assimp_loader(benchmark::State& state)
+{
+	using namespace Disarray;
+	Logging::Logger::initialise_logger("info");
+	Benchmarks::configure_parallel_execution(state);
+
+	const auto rotation = glm::rotate(glm::mat4 { 1.0F }, glm::radians(90.0F), glm::vec3 { 1, 0, 0 });
+	AssimpModelLoader loader { rotation };
+	for (auto value : state) {
+		auto loaded = loader.import_model("Assets/Models/sponza/sponza.obj", default_import_flags);
+		benchmark::DoNotOptimize(loaded);
+	}
+	Collections::set_serial_execution(false);
+}
+
+inline void benchmark_parallel_tiny_obj_loader(benchmark::State& state)
+{
+	using namespace Disarray;
+	Logging::Logger::initialise_logger("info");
+	Benchmarks::configure_parallel_execution(state);
+
+	const auto rotation = glm::rotate(glm::mat4 { 1.0F }, glm::radians(90.0F), glm::vec3 { 1, 0, 0 });
+	TinyObjModelLoader loader { rotation };
+	for (auto value : state) {
+		auto loaded = loader.import_model("Assets/Models/viking.obj", default_import_flags);
+		benchmark::DoNotOptimize(loaded);
+	}
+	Collections::set_serial_execution(false);
+}
@@ -2,12 +2,86 @@
 
 #include <benchmark/benchmark.h>
 
+#include <algorithm>
 #include <filesystem>
 #include <stdexcept>
+#include <vector>
 
 #include "Disarray.hpp"
+#include "ParallelForEach.hpp"
+#include "core/Collections.hpp"
 #include "core/Log.hpp"
+#include "core/filesystem/MappedFile.hpp"
 #include "graphics/Device.hpp"
+#include "graphics/IncludeCache.hpp"
+#include "graphics/Shader.hpp"
+#include "graphics/ShaderCompiler.hpp"
+#include "graphics/SpirvCache.hpp"
+
+// Compiles every shader PipelineCache would, through the SpirvCache. Cold empties the cache before every iteration so all of them go
+// through glslang and SPIRV-Cross, warm fills it once so every iteration only reads .dspv files. Creating the shader modules is left out,
+// it needs a device and costs the same either way. The parallel benchmark compiles them like the PipelineCache constructor does, with the
+// cache off, and takes the thread count as its argument as in ParallelForEach.hpp. The include expansion benchmarks only splice includes
+// into every shader, cold starting from an empty IncludeCache each iteration like a new process, and report what was read from disk.
+
+namespace Disarray::Benchmarks {
+
+inline auto pipeline_benchmark_shaders() -> std::vector<std::filesystem::path>
+{
+	std::vector<std::filesystem::path> paths {};
+	if (!std::filesystem::exists("Assets/Shaders")) {
+		return paths;
+	}
+	for (const auto& entry : std::filesystem::recursive_directory_iterator { "Assets/Shaders" }) {
+		const auto extension = entry.path().extension();
+		if (entry.is_regular_file() && (extension == ".vert" || extension == ".frag" || extension == ".glsl")) {
+			paths.push_back(std::filesystem::relative(entry.path()));
+		}
+	}
+	std::ranges::sort(paths);
+	return paths;
+}
+
+inline void configure_benchmark_spirv_cache()
+{
+	const auto directory = std::filesystem::temp_directory_path() / "disarray-spirv-cache-benchmark";
+	std::filesystem::remove_all(directory);
+	SpirvCache::configure({ .directory = directory });
+}
+
+inline void compile_shaders(Runtime::ShaderCompiler& compiler, const std::vector<std::filesystem::path>& paths, benchmark::State& state)
+{
+	for (const auto& path : paths) {
+		auto compiled = compiler.compile_cached(path, to_shader_type(path));
+		if (compiled.code.empty()) {
+			state.SkipWithError("A shader did not compile");
+			return;
+		}
+		benchmark::DoNotOptimize(compiled.code.data());
+	}
+}
+
+inline void expand_shaders(const Runtime::BasicIncluder& includer, const std::vector<std::filesystem::path>& paths)
+{
+	for (const auto& path : paths) {
+		const FS::MappedFile file { path };
+		std::vector<std::string_view> pieces {};
+		std::vector<IncludeHandle> includes {};
+		includer.expand_includes(file.view(), pieces, includes);
+		benchmark::DoNotOptimize(pieces.data());
+	}
+}
+
+inline void report_include_reads(benchmark::State& state)
+{
+	const auto statistics = IncludeCache::statistics();
+	const auto iterations = static_cast<double>(state.iterations());
+	state.counters["files_read"] = static_cast<double>(statistics.misses) / iterations;
+	state.counters["bytes_read"] = static_cast<double>(statistics.bytes_read) / iterations;
+	state.counters["hits"] = static_cast<double>(statistics.hits) / iterations;
+}
+
+} // namespace Disarray::Benchmarks
 
 inline void benchmark_pipeline_compiler(benchmark::State& state)
 {
@@ -16,3 +90,89 @@ inline void benchmark_pipeline_compiler(benchmark::State& state)
 
 	for (auto value : state) { }
 }
+
+inline void benchmark_shader_compile_cold(benchmark::State& state)
+{
+	using namespace Disarray;
+	Logging::Logger::initialise_logger("error");
+	const auto paths = Benchmarks::pipeline_benchmark_shaders();
+	Runtime::ShaderCompiler::initialize();
+	Runtime::ShaderCompiler compiler {};
+	for (auto value : state) {
+		state.PauseTiming();
+		Benchmarks::configure_benchmark_spirv_cache();
+		state.ResumeTiming();
+		Benchmarks::compile_shaders(compiler, paths, state);
+	}
+	state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(paths.size()));
+	SpirvCache::configure({});
+}
+
+inline void benchmark_shader_compile_warm(benchmark::State& state)
+{
+	using namespace Disarray;
+	Logging::Logger::initialise_logger("error");
+	const auto paths = Benchmarks::pipeline_benchmark_shaders();
+	Runtime::ShaderCompiler::initialize();
+	Runtime::ShaderCompiler compiler {};
+	Benchmarks::configure_benchmark_spirv_cache();
+	Benchmarks::compile_shaders(compiler, paths, state);
+	for (auto value : state) {
+		Benchmarks::compile_shaders(compiler, paths, state);
+	}
+	state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(paths.size()));
+	SpirvCache::configure({});
+}
+
+inline void benchmark_shader_compile_parallel(benchmark::State& state)
+{
+	using namespace Disarray;
+	Logging::Logger::initialise_logger("error");
+	Benchmarks::configure_parallel_execution(state);
+	const auto paths = Benchmarks::pipeline_benchmark_shaders();
+	Runtime::ShaderCompiler::initialize();
+	Runtime::ShaderCompiler compiler {};
+	SpirvCache::configure({ .enabled = false });
+	for (auto value : state) {
+		Collections::parallel_for_each(
+			paths,
+			[&compiler](const std::filesystem::path& path) {
+				auto compiled = compiler.compile_cached(path, to_shader_type(path));
+				benchmark::DoNotOptimize(compiled.code.data());
+			},
+			1);
+	}
+	state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(paths.size()));
+	SpirvCache::configure({});
+	Collections::set_serial_execution(false);
+}
+
+inline void benchmark_include_expansion_cold(benchmark::State& state)
+{
+	using namespace Disarray;
+	Logging::Logger::initialise_logger("error");
+	const auto paths = Benchmarks::pipeline_benchmark_shaders();
+	const Runtime::BasicIncluder includer {};
+	IncludeCache::reset_statistics();
+	for (auto value : state) {
+		state.PauseTiming();
+		IncludeCache::clear();
+		state.ResumeTiming();
+		Benchmarks::expand_shaders(includer, paths);
+	}
+	Benchmarks::report_include_reads(state);
+}
+
+inline void benchmark_include_expansion_warm(benchmark::State& state)
+{
+	using namespace Disarray;
+	Logging::Logger::initialise_logger("error");
+	const auto paths = Benchmarks::pipeline_benchmark_shaders();
+	const Runtime::BasicIncluder includer {};
+	Benchmarks::expand_shaders(includer, paths);
+	IncludeCache::reset_statistics();
+	for (auto value : state) {
+		Benchmarks::expand_shaders(includer, paths);
+	}
+	Benchmarks::report_include_reads(state);
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "core/App.hpp"
+#include "core/Collections.hpp"
+#include "graphics/Renderer.hpp"
+
+// Compares the arena-backed RenderCommandQueue against the std::function queue it replaced. The first argument is the number of commands.
+
+namespace Disarray::Benchmarks {
+
+/**
+ * @brief The previous queue: std::function slots, every slot visited on execute and then cleared.
+ * The original array only had room for a few hundred commands, so the slots are sized to the benchmark instead.
+ */
+class LegacyRenderCommandQueue {
+public:
+	explicit LegacyRenderCommandQueue(std::size_t capacity)
+		: storage_buffer(capacity)
+	{
+	}
+
+	void allocate(std::function<void()>&& func) { storage_buffer[command_count++] = std::move(func); }
+
+	void execute()
+	{
+		Collections::for_each(storage_buffer, [](auto& func) {
+			if (func) {
+				func();
+			}
+		});
+		command_count = 0;
+		std::fill(storage_buffer.begin(), storage_buffer.end(), nullptr);
+	}
+
+private:
+	std::vector<std::function<void()>> storage_buffer;
+	std::uint32_t command_count { 0 };
+};
+
+// Roughly the size of a typical command capture: a pointer to the renderer and a few handles.
+struct CommandPayload {
+	std::array<std::uint64_t, 3> handles {};
+};
+
+} // namespace Disarray::Benchmarks
+
+inline void benchmark_render_command_queue_legacy(benchmark::State& state)
+{
+	const auto commands = static_cast<std::size_t>(state.range(0));
+	Disarray::Benchmarks::LegacyRenderCommandQueue queue { commands };
+	std::uint64_t sink = 0;
+	for (auto value : state) {
+		for (std::size_t i = 0; i < commands; i++) {
+			queue.allocate([&sink, payload = Disarray::Benchmarks::CommandPayload { { i, i, i } }] { sink += payload.handles[0]; });
+		}
+		queue.execute();
+	}
+	benchmark::DoNotOptimize(sink);
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+inline void benchmark_render_command_queue_arena(benchmark::State& state)
+{
+	const auto commands = static_cast<std::size_t>(state.range(0));
+	auto& queue = Disarray::Renderer::get_render_command_queue();
+	std::uint64_t sink = 0;
+	for (auto value : state) {
+		for (std::size_t i = 0; i < commands; i++) {
+			queue.allocate([&sink, payload = Disarray::Benchmarks::CommandPayload { { i, i, i } }] { sink += payload.handles[0]; });
+		}
+		queue.execute();
+	}
+	benchmark::DoNotOptimize(sink);
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// Every pool worker and the calling thread submit a share of the commands concurrently.
+inline void benchmark_render_command_queue_arena_multi_producer(benchmark::State& state)
+{
+	const auto commands = static_cast<std::size_t>(state.range(0));
+	auto& pool = Disarray::App::get_thread_pool();
+	auto& queue = Disarray::Renderer::get_render_command_queue();
+	const auto producers = static_cast<std::size_t>(pool.get_thread_count()) + 1;
+	std::atomic<std::uint64_t> sink = 0;
+	for (auto value : state) {
+		Disarray::Threading::JobCounter counter {};
+		const auto submit_share = [&queue, &sink, share = commands / producers] {
+			for (std::size_t i = 0; i < share; i++) {
+				queue.allocate([&sink, payload = Disarray::Benchmarks::CommandPayload { { i, i, i } }] {
+					sink.fetch_add(payload.handles[0], std::memory_order_relaxed);
+				});
+			}
+		};
+		for (std::size_t i = 1; i < producers; i++) {
+			pool.schedule(submit_share, &counter);
+		}
+		submit_share();
+		pool.wait(counter);
+		queue.execute();
+	}
+	benchmark::DoNotOptimize(sink.load());
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
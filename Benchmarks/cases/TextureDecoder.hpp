@@ -0,0 +1,63 @@
+#pragma once
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "ParallelForEach.hpp"
+#include "core/Log.hpp"
+#include "graphics/TextureDecoder.hpp"
+
+// Decodes every image under a model directory with TextureDecoder::decode_all, which is what ModelLoader::construct_textures does before
+// it creates any texture. The argument is the thread count, as in ParallelForEach.hpp, so zero is the one by one baseline.
+
+namespace Disarray::Benchmarks {
+
+inline auto texture_benchmark_paths(const std::filesystem::path& directory) -> std::vector<std::filesystem::path>
+{
+	static const std::set<std::string> extensions { ".png", ".jpg", ".jpeg", ".tga", ".bmp" };
+	std::vector<std::filesystem::path> paths {};
+	if (!std::filesystem::exists(directory)) {
+		return paths;
+	}
+	for (const auto& entry : std::filesystem::recursive_directory_iterator { directory }) {
+		if (entry.is_regular_file() && extensions.contains(entry.path().extension().string())) {
+			paths.push_back(entry.path());
+		}
+	}
+	std::ranges::sort(paths);
+	return paths;
+}
+
+} // namespace Disarray::Benchmarks
+
+inline void benchmark_texture_decode(benchmark::State& state)
+{
+	using namespace Disarray;
+	Logging::Logger::initialise_logger("info");
+	Benchmarks::configure_parallel_execution(state);
+
+	const auto paths = Benchmarks::texture_benchmark_paths("Assets/Models/sponza");
+	if (paths.empty()) {
+		state.SkipWithError("No textures in Assets/Models/sponza");
+		Collections::set_serial_execution(false);
+		return;
+	}
+
+	std::int64_t bytes = 0;
+	for (auto value : state) {
+		const auto decoded = TextureDecoder::decode_all(paths);
+		for (const auto& texture : decoded) {
+			bytes += static_cast<std::int64_t>(texture.pixels.get_size());
+		}
+		benchmark::DoNotOptimize(decoded.data());
+	}
+	state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(paths.size()));
+	state.SetBytesProcessed(bytes);
+	Collections::set_serial_execution(false);
+}
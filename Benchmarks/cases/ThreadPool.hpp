@@ -0,0 +1,127 @@
+#pragma once
+
+#include <benchmark/benchmark.h>
+
+#include <BS_thread_pool.hpp>
+
+#include <atomic>
+#include <future>
+#include <vector>
+
+#include "core/App.hpp"
+#include "core/ThreadPool.hpp"
+
+// Compares the work-stealing pool against the BS::thread_pool it replaced. The first argument is the number of tasks.
+
+namespace Disarray::Benchmarks {
+
+inline auto legacy_thread_pool() -> BS::thread_pool&
+{
+	static BS::thread_pool pool { 5 };
+	return pool;
+}
+
+inline auto job_system() -> Threading::ThreadPool&
+{
+	auto& pool = App::get_thread_pool();
+	if (pool.get_thread_count() != 5) {
+		pool.reset(5);
+	}
+	return pool;
+}
+
+} // namespace Disarray::Benchmarks
+
+// Submit many empty tasks from the main thread and wait for all of them.
+inline void benchmark_thread_pool_submit_legacy(benchmark::State& state)
+{
+	auto& pool = Disarray::Benchmarks::legacy_thread_pool();
+	const auto tasks = state.range(0);
+	for (auto value : state) {
+		for (std::int64_t i = 0; i < tasks; i++) {
+			pool.push_task([] { });
+		}
+		pool.wait_for_tasks();
+	}
+	state.SetItemsProcessed(state.iterations() * tasks);
+}
+
+inline void benchmark_thread_pool_submit_job_system(benchmark::State& state)
+{
+	auto& pool = Disarray::Benchmarks::job_system();
+	const auto tasks = state.range(0);
+	for (auto value : state) {
+		Disarray::Threading::JobCounter counter {};
+		for (std::int64_t i = 0; i < tasks; i++) {
+			pool.schedule([] { }, &counter);
+		}
+		pool.wait(counter);
+	}
+	state.SetItemsProcessed(state.iterations() * tasks);
+}
+
+// One task fans out into many children. The legacy pool funnels them through its shared queue, the job
+// system pushes them onto the spawning worker's deque for the other workers to steal.
+inline void benchmark_thread_pool_steal_legacy(benchmark::State& state)
+{
+	auto& pool = Disarray::Benchmarks::legacy_thread_pool();
+	const auto tasks = state.range(0);
+	for (auto value : state) {
+		std::atomic<std::int64_t> executed { 0 };
+		pool.push_task([&pool, &executed, tasks] {
+			for (std::int64_t i = 0; i < tasks; i++) {
+				pool.push_task([&executed] { executed.fetch_add(1, std::memory_order_relaxed); });
+			}
+		});
+		pool.wait_for_tasks();
+		benchmark::DoNotOptimize(executed.load());
+	}
+	state.SetItemsProcessed(state.iterations() * tasks);
+}
+
+inline void benchmark_thread_pool_steal_job_system(benchmark::State& state)
+{
+	auto& pool = Disarray::Benchmarks::job_system();
+	const auto tasks = state.range(0);
+	for (auto value : state) {
+		std::atomic<std::int64_t> executed { 0 };
+		Disarray::Threading::JobCounter counter {};
+		pool.schedule(
+			[&pool, &executed, &counter, tasks] {
+				for (std::int64_t i = 0; i < tasks; i++) {
+					pool.schedule([&executed] { executed.fetch_add(1, std::memory_order_relaxed); }, &counter);
+				}
+			},
+			&counter);
+		pool.wait(counter);
+		benchmark::DoNotOptimize(executed.load());
+	}
+	state.SetItemsProcessed(state.iterations() * tasks);
+}
+
+// Round trip of a single task, waited on individually: a future for the legacy pool, a counter for the job system.
+inline void benchmark_thread_pool_wait_legacy(benchmark::State& state)
+{
+	auto& pool = Disarray::Benchmarks::legacy_thread_pool();
+	const auto tasks = state.range(0);
+	for (auto value : state) {
+		for (std::int64_t i = 0; i < tasks; i++) {
+			pool.submit([] { }).wait();
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * tasks);
+}
+
+inline void benchmark_thread_pool_wait_job_system(benchmark::State& state)
+{
+	auto& pool = Disarray::Benchmarks::job_system();
+	const auto tasks = state.range(0);
+	for (auto value : state) {
+		for (std::int64_t i = 0; i < tasks; i++) {
+			Disarray::Threading::JobCounter counter {};
+			pool.schedule([] { }, &counter);
+			pool.wait(counter);
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * tasks);
+}
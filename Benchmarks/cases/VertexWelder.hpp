@@ -0,0 +1,95 @@
+#pragma once
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <unordered_map>
+#include <vector>
+
+#include "core/Log.hpp"
+#include "graphics/ModelLoader.hpp"
+#include "graphics/VertexWelder.hpp"
+#include "graphics/model_loaders/AssimpModelLoader.hpp"
+#include "graphics/model_loaders/TinyObjModelLoader.hpp"
+
+// Welds the unindexed vertex streams of viking.obj (argument 0) and sponza (argument 1), once with the unordered_map the loaders used
+// before and once with VertexWelder. Each submesh is a separate stream, as it is during import.
+
+namespace Disarray::Benchmarks {
+
+inline auto unindexed_streams(const ImportedMesh& mesh) -> std::vector<std::vector<ModelVertex>>
+{
+	std::vector<std::vector<ModelVertex>> streams;
+	streams.reserve(mesh.size());
+	for (const auto& [name, submesh] : mesh) {
+		auto& stream = streams.emplace_back();
+		stream.reserve(submesh.indices.size());
+		for (const auto index : submesh.indices) {
+			stream.push_back(submesh.vertices.at(index));
+		}
+	}
+	return streams;
+}
+
+inline auto vertex_welder_streams(const benchmark::State& state) -> const std::vector<std::vector<ModelVertex>>&
+{
+	static const std::array streams {
+		unindexed_streams(TinyObjModelLoader { glm::mat4 { 1.0F } }.import_model("Assets/Models/viking.obj", default_import_flags)),
+		unindexed_streams(AssimpModelLoader { glm::mat4 { 1.0F } }.import_model("Assets/Models/sponza/sponza.obj", default_import_flags)),
+	};
+	return streams.at(static_cast<std::size_t>(state.range(0)));
+}
+
+} // namespace Disarray::Benchmarks
+
+inline void benchmark_vertex_weld_unordered_map(benchmark::State& state)
+{
+	using namespace Disarray;
+	Logging::Logger::initialise_logger("info");
+	const auto& streams = Benchmarks::vertex_welder_streams(state);
+	for (auto value : state) {
+		for (const auto& stream : streams) {
+			std::unordered_map<ModelVertex, std::uint32_t> unique_vertices {};
+			std::vector<ModelVertex> vertices;
+			std::vector<std::uint32_t> indices;
+			unique_vertices.reserve(stream.size());
+			vertices.reserve(stream.size());
+			indices.reserve(stream.size());
+			for (const auto& vertex : stream) {
+				if (!unique_vertices.contains(vertex)) {
+					unique_vertices.try_emplace(vertex, static_cast<std::uint32_t>(vertices.size()));
+					vertices.push_back(vertex);
+				}
+				indices.push_back(unique_vertices[vertex]);
+			}
+			benchmark::DoNotOptimize(vertices.data());
+			benchmark::DoNotOptimize(indices.data());
+		}
+	}
+}
+
+inline void benchmark_vertex_weld_open_addressing(benchmark::State& state)
+{
+	using namespace Disarray;
+	Logging::Logger::initialise_logger("info");
+	const auto& streams = Benchmarks::vertex_welder_streams(state);
+	for (auto value : state) {
+		for (const auto& stream : streams) {
+			auto welded = VertexWelder::weld(stream);
+			benchmark::DoNotOptimize(welded.vertices.data());
+		}
+	}
+}
+
+inline void benchmark_vertex_weld_quantised(benchmark::State& state)
+{
+	using namespace Disarray;
+	Logging::Logger::initialise_logger("info");
+	const auto& streams = Benchmarks::vertex_welder_streams(state);
+	for (auto value : state) {
+		for (const auto& stream : streams) {
+			auto welded = VertexWelder::weld(stream, { .epsilon = 1e-5F });
+			benchmark::DoNotOptimize(welded.vertices.data());
+		}
+	}
+}
@@ -1,8 +1,43 @@
 #include <benchmark/benchmark.h>
 
+#include "cases/MappedFile.hpp"
+#include "cases/MeshCache.hpp"
 #include "cases/ModelLoader.hpp"
+#include "cases/ObjModelLoader.hpp"
+#include "cases/ParallelForEach.hpp"
 #include "cases/PipelineCompiler.hpp"
+#include "cases/RenderCommandQueue.hpp"
+#include "cases/TextureDecoder.hpp"
+#include "cases/ThreadPool.hpp"
+#include "cases/VertexWelder.hpp"
 
 // Register the function as a benchmark
 BENCHMARK(benchmark_model_loader);
 BENCHMARK(benchmark_pipeline_compiler);
+BENCHMARK(benchmark_shader_compile_cold)->Unit(benchmark::kMillisecond);
+BENCHMARK(benchmark_shader_compile_warm)->Unit(benchmark::kMillisecond);
+BENCHMARK(benchmark_shader_compile_parallel)->Apply(Disarray::Benchmarks::register_thread_counts);
+BENCHMARK(benchmark_include_expansion_cold);
+BENCHMARK(benchmark_include_expansion_warm);
+BENCHMARK(benchmark_parallel_for_each_rotate)->Apply(Disarray::Benchmarks::register_thread_counts);
+BENCHMARK(benchmark_parallel_assimp_loader)->Apply(Disarray::Benchmarks::register_thread_counts);
+BENCHMARK(benchmark_parallel_tiny_obj_loader)->Apply(Disarray::Benchmarks::register_thread_counts);
+BENCHMARK(benchmark_thread_pool_submit_legacy)->Arg(1'000)->Arg(100'000)->UseRealTime();
+BENCHMARK(benchmark_thread_pool_submit_job_system)->Arg(1'000)->Arg(100'000)->UseRealTime();
+BENCHMARK(benchmark_thread_pool_steal_legacy)->Arg(1'000)->Arg(100'000)->UseRealTime();
+BENCHMARK(benchmark_thread_pool_steal_job_system)->Arg(1'000)->Arg(100'000)->UseRealTime();
+BENCHMARK(benchmark_thread_pool_wait_legacy)->Arg(1'000)->UseRealTime();
+BENCHMARK(benchmark_thread_pool_wait_job_system)->Arg(1'000)->UseRealTime();
+BENCHMARK(benchmark_render_command_queue_legacy)->Arg(1'000)->Arg(10'000)->Arg(100'000);
+BENCHMARK(benchmark_render_command_queue_arena)->Arg(1'000)->Arg(10'000)->Arg(100'000);
+BENCHMARK(benchmark_render_command_queue_arena_multi_producer)->Arg(1'000)->Arg(10'000)->Arg(100'000)->UseRealTime();
+BENCHMARK(benchmark_read_from_file)->Arg(4)->Arg(16)->Arg(64)->Unit(benchmark::kMillisecond);
+BENCHMARK(benchmark_mapped_file)->Arg(4)->Arg(16)->Arg(64)->Unit(benchmark::kMillisecond);
+BENCHMARK(benchmark_mesh_cache_cold_assimp)->Unit(benchmark::kMillisecond);
+BENCHMARK(benchmark_mesh_cache_warm)->Unit(benchmark::kMillisecond);
+BENCHMARK(benchmark_vertex_weld_unordered_map)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+BENCHMARK(benchmark_vertex_weld_open_addressing)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+BENCHMARK(benchmark_vertex_weld_quantised)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+BENCHMARK(benchmark_obj_loader_tinyobj)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+BENCHMARK(benchmark_obj_loader_streaming)->Apply(Disarray::Benchmarks::register_obj_models);
+BENCHMARK(benchmark_texture_decode)->Apply(Disarray::Benchmarks::register_thread_counts);
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Disarray::Allocations {
+
+/**
+ * @brief Number of calls to the global operator new so far. Only counted when built with DISARRAY_COUNT_ALLOCATIONS, zero otherwise.
+ */
+auto get_allocation_count() -> std::uint64_t;
+auto is_counting() -> bool;
+
+} // namespace Disarray::Allocations
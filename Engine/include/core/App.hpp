@@ -5,6 +5,7 @@
 #include <string>
 #include <vector>
 
+#include "core/FrameAllocator.hpp"
 #include "core/Layer.hpp"
 #include "core/ThreadPool.hpp"
 #include "core/events/Event.hpp"
@@ -25,6 +26,12 @@ struct ApplicationProperties {
 	bool is_fullscreen { false };
 	std::filesystem::path working_directory { std::filesystem::current_path() };
 	bool use_validation_layers { true };
+	/** @brief Where the trace is written when the app exits. Only used when built with DISARRAY_PROFILE */
+	std::filesystem::path trace_output { "disarray-trace.json" };
+	/** @brief Where frame metrics are dumped, as JSON for a .json extension and CSV otherwise. Nothing is written when empty */
+	std::filesystem::path metrics_output {};
+	/** @brief (s) Time between metric dumps. Zero only dumps at shutdown */
+	std::uint32_t metrics_interval { 0 };
 };
 
 /**
@@ -39,6 +46,12 @@ struct ApplicationStatistics {
 
 	/** @brief (ns) Time for presentation */
 	double presentation_time { 0 };
+
+	/** @brief Calls to the global operator new during the last frame. Always zero unless built with DISARRAY_COUNT_ALLOCATIONS */
+	std::uint64_t heap_allocations { 0 };
+
+	/** @brief (bytes) Transient memory handed out by the frame allocator during the last frame */
+	std::size_t frame_arena_bytes { 0 };
 };
 
 class App {
@@ -90,6 +103,7 @@ public:
 	[[nodiscard]] auto get_swapchain() const -> const auto& { return *swapchain; }
 
 	[[nodiscard]] static auto get_thread_pool() -> auto& { return thread_pool; }
+	[[nodiscard]] static auto get_frame_allocator() -> auto& { return frame_allocator; }
 
 private:
 	auto could_prepare_frame() -> bool;
@@ -99,8 +113,10 @@ private:
 	Scope<Swapchain> swapchain { nullptr };
 	std::vector<std::shared_ptr<Layer>> layers {};
 	ApplicationStatistics statistics;
+	std::filesystem::path trace_output {};
 
 	static inline Threading::ThreadPool thread_pool { {}, 5 };
+	static inline FrameAllocator frame_allocator { {} };
 };
 
 struct AppDeleter {
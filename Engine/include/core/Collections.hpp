@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <array>
+#include <cstddef>
 #include <functional>
 #include <iterator>
 #include <span>
@@ -15,10 +16,6 @@
 #include "core/Hashes.hpp"
 #include "core/PointerDefinition.hpp"
 
-#ifdef DISARRAY_WINDOWS
-#include <execution>
-#endif
-
 namespace Disarray::Collections {
 
 template <class T> class DefaultAllocator : public std::allocator<T> {
@@ -139,13 +136,53 @@ constexpr inline auto map(Iterable auto& collection, auto&& func)
 	return output;
 }
 
-#ifdef DISARRAY_WINDOWS
-constexpr inline void parallel_for_each(Iterable auto& collection, auto&& func)
+namespace Detail {
+	using ChunkFunction = std::function<void(std::size_t, std::size_t)>;
+
+	/**
+	 * @brief Splits [0, count) into chunks of grain_size and runs them on the application thread pool.
+	 * The calling thread claims chunks as well, so nested calls from pool threads cannot deadlock.
+	 * The first exception thrown by a chunk cancels the remaining chunks and is rethrown on the calling thread.
+	 */
+	void parallel_for_chunks(std::size_t count, std::size_t grain_size, const ChunkFunction& chunk_function);
+} // namespace Detail
+
+/**
+ * @brief Forces parallel_for_each to run on the calling thread. Useful when debugging or profiling.
+ */
+void set_serial_execution(bool serial);
+auto is_serial_execution() -> bool;
+
+/**
+ * @brief Calls func for every element of the collection, concurrently. func must be safe to call from several threads at once.
+ *
+ * @param grain_size Number of elements handed to a worker at a time. Zero picks a size based on the thread count.
+ */
+inline void parallel_for_each(Iterable auto& collection, auto&& func, std::size_t grain_size = 0)
 {
-	std::for_each(std::execution::par, std::begin(collection), std::end(collection), func);
+	using Iterator = decltype(std::begin(collection));
+
+	auto first = std::begin(collection);
+	const auto last = std::end(collection);
+	if constexpr (std::random_access_iterator<Iterator>) {
+		const auto count = static_cast<std::size_t>(std::distance(first, last));
+		Detail::parallel_for_chunks(count, grain_size, [&first, &func](std::size_t begin, std::size_t end) {
+			using Difference = std::iter_difference_t<Iterator>;
+			for (auto index = begin; index < end; index++) {
+				func(*(first + static_cast<Difference>(index)));
+			}
+		});
+	} else {
+		std::vector<Iterator> iterators;
+		for (; first != last; ++first) {
+			iterators.push_back(first);
+		}
+		Detail::parallel_for_chunks(iterators.size(), grain_size, [&iterators, &func](std::size_t begin, std::size_t end) {
+			for (auto index = begin; index < end; index++) {
+				func(*iterators[index]);
+			}
+		});
+	}
 }
-#else
-constexpr inline void parallel_for_each(Iterable auto& collection, auto&& func) { std::for_each(std::begin(collection), std::end(collection), func); }
-#endif
 
 } // namespace Disarray::Collections
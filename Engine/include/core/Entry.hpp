@@ -22,8 +22,14 @@ int main(int argc, char** argv)
 	program.add_argument<std::string>("--wd").help("Working directory").default_value(current_path.string());
 	program.add_argument<std::string>("--name").help("Window name").default_value(std::string { "Disarray" });
 	program.add_argument<std::string>("--level").help("Log level").default_value(std::string { "debug" });
+	program.add_argument("--async_logging").help("Write log messages from a background thread").default_value(false).implicit_value(true);
+	program.add_argument<std::string>("--log_overflow")
+		.help("What asynchronous logging does when its queue is full: block, drop or count")
+		.default_value(std::string { "block" });
 	program.add_argument("--fullscreen").help("Start in fullscreen").default_value(false).implicit_value(true);
 	program.add_argument("--disable_validation").help("Disable validation layers").default_value(false).implicit_value(true);
+	program.add_argument<std::string>("--metrics").help("Dump frame metrics to this file (.json or .csv)").default_value(std::string {});
+	program.add_argument("--metrics_interval").scan<'d', std::uint32_t>().default_value(0U).help("Seconds between metric dumps, 0 dumps at exit");
 
 	try {
 		program.parse_args(argc, argv);
@@ -38,8 +44,12 @@ int main(int argc, char** argv)
 	auto name = program.get<std::string>("name");
 	auto working_directory = program.get<std::string>("wd");
 	auto log_level = program.get<std::string>("level");
+	auto async_logging = program["--async_logging"] == true;
+	auto log_overflow = program.get<std::string>("log_overflow");
 	auto is_fullscreen = program["--fullscreen"] == true;
 	auto disable_validation_layers = program["--disable_validation"] == true;
+	auto metrics_output = program.get<std::string>("metrics");
+	auto metrics_interval = program.get<std::uint32_t>("metrics_interval");
 	const Disarray::ApplicationProperties properties {
 		.width = static_cast<std::uint32_t>(width),
 		.height = static_cast<std::uint32_t>(height),
@@ -47,9 +57,18 @@ int main(int argc, char** argv)
 		.is_fullscreen = is_fullscreen,
 		.working_directory = std::filesystem::path { working_directory },
 		.use_validation_layers = !disable_validation_layers,
+		.metrics_output = std::filesystem::path { metrics_output },
+		.metrics_interval = metrics_interval,
 	};
 
 	Disarray::Logging::Logger::initialise_logger(log_level);
+	auto overflow_policy = Disarray::Logging::OverflowPolicy::Block;
+	if (log_overflow == "drop") {
+		overflow_policy = Disarray::Logging::OverflowPolicy::Drop;
+	} else if (log_overflow == "count") {
+		overflow_policy = Disarray::Logging::OverflowPolicy::Count;
+	}
+	Disarray::Logging::Logger::the().configure({ .asynchronous = async_logging, .overflow = overflow_policy });
 
 	auto app = Disarray::create_application(properties);
 	app->run();
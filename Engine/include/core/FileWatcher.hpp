@@ -5,6 +5,8 @@
 #include <filesystem>
 #include <functional>
 #include <future>
+#include <mutex>
+#include <optional>
 #include <thread>
 #include <unordered_map>
 #include <unordered_set>
@@ -13,6 +15,7 @@
 #include "core/Collections.hpp"
 #include "core/Hashes.hpp"
 #include "core/ThreadPool.hpp"
+#include "core/Types.hpp"
 
 namespace Disarray {
 
@@ -45,19 +48,75 @@ struct FileInformation {
 	std::string path;
 	std::filesystem::file_time_type last_modified;
 	FileStatus status = FileStatus::Created;
+	/** @brief Set on a created file that was renamed from this path within the watched tree */
+	std::string previous_path {};
 
 	[[nodiscard]] auto to_path() const { return std::filesystem::path { path }; }
 	[[nodiscard]] auto is_valid() const { return std::filesystem::is_regular_file(to_path()); }
 	[[nodiscard]] auto has_extension(std::string_view ext) const { return to_path().extension().string() == ext; }
 };
 
+enum class FileWatcherBackend : std::uint8_t {
+	/** @brief The native backend where there is one, polling otherwise */
+	Automatic,
+	/** @brief inotify on Linux. Logs an error and falls back to polling where it is unavailable */
+	Native,
+	/** @brief Walks the tree every delay */
+	Polling,
+};
+
+struct FileWatcherSettings {
+	FileWatcherBackend backend { FileWatcherBackend::Automatic };
+	/** @brief A path is reported once it has been quiet for this long, so that e.g. an editor saving a file is reported once */
+	std::chrono::milliseconds debounce { 100 };
+};
+
+namespace Detail {
+	enum class WatchEventType : std::uint8_t {
+		Created,
+		Deleted,
+		Modified,
+		Renamed,
+		/** @brief Events may have been missed, the tree has to be compared with what is known about it */
+		Rescan,
+	};
+
+	struct WatchEvent {
+		WatchEventType type { WatchEventType::Modified };
+		std::string path {};
+		std::string previous_path {};
+	};
+
+	/**
+	 * @brief Reports raw changes under a root. The file watcher coalesces them, and works out what actually changed.
+	 */
+	class WatchBackend {
+	public:
+		virtual ~WatchBackend() = default;
+
+		/**
+		 * @brief Blocks until something happens, the timeout passes or wake is called, and appends what happened to events.
+		 */
+		virtual void wait(std::vector<WatchEvent>& events, std::optional<std::chrono::milliseconds> timeout) = 0;
+		virtual void wake() = 0;
+	};
+
+	/**
+	 * @brief The platform backend, or nullptr if there is none or it could not be set up.
+	 */
+	auto create_native_watch_backend(const std::filesystem::path& root) -> Scope<WatchBackend>;
+} // namespace Detail
+
 class FileWatcher {
 public:
-	FileWatcher(Threading::ThreadPool&, const std::filesystem::path&, std::chrono::duration<int, std::milli> = std::chrono::milliseconds(2000));
+	FileWatcher(Threading::ThreadPool&, const std::filesystem::path&, std::chrono::duration<int, std::milli> = std::chrono::milliseconds(2000),
+		const FileWatcherSettings& = {});
 	FileWatcher(Threading::ThreadPool&, const std::filesystem::path&, const Collections::StringSet& extensions,
-		std::chrono::duration<int, std::milli> = std::chrono::milliseconds(2000));
+		std::chrono::duration<int, std::milli> = std::chrono::milliseconds(2000), const FileWatcherSettings& = {});
 	~FileWatcher();
 
+	[[nodiscard]] auto get_backend() const -> FileWatcherBackend { return backend_type; }
+
 	void on_created(const std::function<void(const FileInformation&)>& activation_function);
 	void on_created_or_modified(const std::function<void(const FileInformation&)>& activation_function);
 	void on_modified(const std::function<void(const FileInformation&)>& activation_function);
@@ -71,28 +130,43 @@ private:
 		Collections::for_each(funcs, [&info = file_information](auto& func) { func(info); });
 	}
 
+	struct PendingChange {
+		bool existed { false };
+		std::string previous_path {};
+		std::chrono::steady_clock::time_point deadline {};
+	};
+
 	void start(const std::function<void(const FileInformation&)>& activation_function);
 	void stop();
 	void loop_until();
-	void update();
+	void handle(const Detail::WatchEvent& event, std::chrono::steady_clock::time_point now);
+	void queue(const std::string& path, const std::string& previous_path, std::chrono::steady_clock::time_point now);
+	void rescan(std::chrono::steady_clock::time_point now);
+	void dispatch_due(std::chrono::steady_clock::time_point now);
+	[[nodiscard]] auto next_deadline() const -> std::optional<std::chrono::milliseconds>;
 
-	auto in_extensions(const auto& entry)
+	auto in_extensions(const std::filesystem::path& path) const
 	{
 		if (extensions.contains("*")) {
 			return true;
 		}
 
-		if (extensions.contains(entry.path().extension().string())) {
+		if (extensions.contains(path.extension().string())) {
 			return true;
 		}
 		return false;
 	}
 
+	std::mutex activation_mutex;
 	std::vector<std::function<void(const FileInformation&)>> activations;
 	std::filesystem::path root;
 	Collections::StringSet extensions {};
 	std::chrono::duration<int, std::milli> delay;
+	FileWatcherSettings settings {};
+	FileWatcherBackend backend_type { FileWatcherBackend::Polling };
+	Scope<Detail::WatchBackend> backend {};
 	Collections::StringMap<FileInformation> paths {};
+	Collections::StringMap<PendingChange> pending {};
 	std::atomic_bool running { true };
 	std::future<void> finaliser;
 };
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "Forward.hpp"
+#include "core/UsageBadge.hpp"
+
+namespace Disarray {
+
+/**
+ * @brief Bump allocator over a list of blocks. Deallocation is a no-op, everything is released at once by reset.
+ * Blocks are kept across resets, so once the arena has grown to the size of a frame it stops touching the heap.
+ */
+class LinearArena {
+public:
+	static constexpr std::size_t default_block_size = 1024ULL * 1024ULL;
+
+	LinearArena()
+		: LinearArena(default_block_size)
+	{
+	}
+	explicit LinearArena(std::size_t block_size);
+
+	auto allocate(std::size_t bytes, std::size_t alignment) -> void*;
+	void reset();
+
+	[[nodiscard]] auto get_bytes_used() const -> std::size_t { return bytes_used; }
+	[[nodiscard]] auto get_capacity() const -> std::size_t;
+
+private:
+	struct Block {
+		std::unique_ptr<std::byte[]> memory {};
+		std::size_t size { 0 };
+	};
+
+	std::size_t block_size;
+	std::vector<Block> blocks {};
+	std::size_t current_block { 0 };
+	std::size_t offset { 0 };
+	std::size_t bytes_used { 0 };
+};
+
+class LinearArenaResource final : public std::pmr::memory_resource {
+public:
+	explicit LinearArenaResource(LinearArena& arena)
+		: arena(arena)
+	{
+	}
+
+private:
+	auto do_allocate(std::size_t bytes, std::size_t alignment) -> void* override { return arena.allocate(bytes, alignment); }
+	void do_deallocate(void*, std::size_t, std::size_t) override { }
+	[[nodiscard]] auto do_is_equal(const std::pmr::memory_resource& other) const noexcept -> bool override { return this == &other; }
+
+	LinearArena& arena;
+};
+
+/**
+ * @brief Transient allocations for the current frame. There is one arena per frame in flight, and the arena for a frame is
+ * reset when that frame starts again, so memory handed out during a frame stays valid while the next frame is recorded.
+ *
+ * Only the thread that owns the allocator (the one running App::run) uses the arenas. Other threads get the default resource.
+ */
+class FrameAllocator {
+public:
+	static constexpr std::size_t frames_in_flight = 2;
+
+	explicit FrameAllocator(UsageBadge<App>);
+
+	void begin_frame(UsageBadge<App>);
+
+	[[nodiscard]] auto get_resource() -> std::pmr::memory_resource*;
+	[[nodiscard]] auto is_owner_thread() const -> bool { return std::this_thread::get_id() == owner; }
+	[[nodiscard]] auto get_bytes_used() const -> std::size_t { return arenas.at(current_frame).get_bytes_used(); }
+	[[nodiscard]] auto get_capacity() const -> std::size_t;
+
+private:
+	std::array<LinearArena, frames_in_flight> arenas {};
+	std::array<LinearArenaResource, frames_in_flight> resources;
+	std::size_t current_frame { 0 };
+	std::thread::id owner { std::this_thread::get_id() };
+};
+
+/**
+ * @brief The current frame's arena, as a std::pmr resource.
+ */
+auto frame_resource() -> std::pmr::memory_resource*;
+auto is_frame_thread() -> bool;
+
+/**
+ * @brief Formats into memory owned by the current frame. The view is valid until the frame is reused.
+ * Off the frame thread, the view is only valid until the next call on the same thread.
+ */
+template <typename... Args> auto frame_format(fmt::format_string<Args...> fmt_string, Args&&... args) -> std::string_view
+{
+	fmt::memory_buffer buffer;
+	fmt::format_to(std::back_inserter(buffer), fmt_string, std::forward<Args>(args)...);
+
+	if (!is_frame_thread()) {
+		thread_local std::string fallback {};
+		fallback.assign(buffer.data(), buffer.size());
+		return fallback;
+	}
+
+	auto* output = static_cast<char*>(frame_resource()->allocate(buffer.size(), alignof(char)));
+	std::copy(buffer.begin(), buffer.end(), output);
+	return { output, buffer.size() };
+}
+
+} // namespace Disarray
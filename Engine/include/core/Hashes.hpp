@@ -1,8 +1,13 @@
 #pragma once
 
+#include <bit>
 #include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <filesystem>
 #include <functional>
+#include <span>
 #include <string_view>
 
 namespace Disarray {
@@ -16,6 +21,42 @@ template <typename T, typename... Rest> inline void hash_combine(std::size_t& se
 	hash_combine(seed, rest...);
 }
 
+/**
+ * @brief A fast, non-cryptographic 64-bit hash of a byte range, stable across runs and platforms of the same endianness.
+ * Meant for keying on-disk caches by content.
+ */
+inline auto hash_bytes(std::span<const std::byte> bytes, std::uint64_t seed = 0) -> std::uint64_t
+{
+	constexpr std::uint64_t first_prime = 0x9E3779B185EBCA87ULL;
+	constexpr std::uint64_t second_prime = 0xC2B2AE3D27D4EB4FULL;
+	const auto mix = [](std::uint64_t hash, std::uint64_t word) { return std::rotl(hash ^ (word * second_prime), 31) * first_prime; };
+
+	std::uint64_t hash = seed ^ (static_cast<std::uint64_t>(bytes.size()) * first_prime);
+	std::size_t offset = 0;
+	for (; offset + sizeof(std::uint64_t) <= bytes.size(); offset += sizeof(std::uint64_t)) {
+		std::uint64_t word = 0;
+		std::memcpy(&word, bytes.data() + offset, sizeof(word));
+		hash = mix(hash, word);
+	}
+	if (offset < bytes.size()) {
+		std::uint64_t word = 0;
+		std::memcpy(&word, bytes.data() + offset, bytes.size() - offset);
+		hash = mix(hash, word);
+	}
+
+	hash ^= hash >> 33U;
+	hash *= 0xFF51AFD7ED558CCDULL;
+	hash ^= hash >> 33U;
+	hash *= 0xC4CEB9FE1A85EC53ULL;
+	hash ^= hash >> 33U;
+	return hash;
+}
+
+inline auto hash_bytes(std::string_view text, std::uint64_t seed = 0) -> std::uint64_t
+{
+	return hash_bytes(std::as_bytes(std::span { text.data(), text.size() }), seed);
+}
+
 struct StringHash {
 	using is_transparent = void;
 	[[nodiscard]] auto operator()(const char* txt) const -> size_t { return std::hash<std::string_view> {}(txt); }
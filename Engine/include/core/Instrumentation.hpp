@@ -1,19 +1,187 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <string>
 #include <string_view>
+#include <vector>
 
-#define DISARRAY_PROFILE_SCOPE(scope) Disarray::Instrumentation::Profiler(scope);
+#if defined(_M_X64)
+#include <intrin.h>
+#elif defined(__x86_64__)
+#include <x86intrin.h>
+#endif
+
+#define DISARRAY_PROFILE_CONCAT_IMPL(a, b) a##b
+#define DISARRAY_PROFILE_CONCAT(a, b) DISARRAY_PROFILE_CONCAT_IMPL(a, b)
+
+#ifdef DISARRAY_PROFILE
+#define DISARRAY_PROFILE_SCOPE(scope)                                                                                                                \
+	static const auto DISARRAY_PROFILE_CONCAT(disarray_profile_location_, __LINE__)                                                                  \
+		= Disarray::Instrumentation::register_location({ .name = scope, .function = __func__, .file = __FILE__, .line = __LINE__ });                 \
+	const Disarray::Instrumentation::Zone DISARRAY_PROFILE_CONCAT(disarray_profile_zone_, __LINE__) { DISARRAY_PROFILE_CONCAT(                       \
+		disarray_profile_location_, __LINE__) };
+#define DISARRAY_PROFILE_FUNCTION() DISARRAY_PROFILE_SCOPE(__func__)
+#define DISARRAY_PROFILE_FRAME() Disarray::Instrumentation::mark_frame();
+#define DISARRAY_PROFILE_THREAD(name) Disarray::Instrumentation::set_thread_name(name);
+#else
+#define DISARRAY_PROFILE_SCOPE(scope)
+#define DISARRAY_PROFILE_FUNCTION()
+#define DISARRAY_PROFILE_FRAME()
+#define DISARRAY_PROFILE_THREAD(name)
+#endif
 
 namespace Disarray::Instrumentation {
 
-class Profiler {
+/**
+ * @brief Where a zone is declared. Registered once per call site, events only carry the index.
+ */
+struct SourceLocation {
+	const char* name { nullptr };
+	const char* function { nullptr };
+	const char* file { nullptr };
+	std::uint32_t line { 0 };
+};
+
+enum class EventType : std::uint8_t {
+	Begin,
+	End,
+	Frame,
+};
+
+struct Event {
+	/** @brief In ticks of Detail::now, converted to time on export */
+	std::uint64_t timestamp { 0 };
+	std::uint32_t location { 0 };
+	EventType type { EventType::Begin };
+};
+static_assert(sizeof(Event) == 16);
+
+namespace Detail {
+	/**
+	 * @brief Single producer, single consumer ring of events. The owning thread writes, the collector reads.
+	 * A full ring drops new events instead of blocking the thread being profiled.
+	 */
+	class EventRing {
+	public:
+		static constexpr std::size_t capacity = 1ULL << 15ULL;
+
+		auto try_push(const Event& event) -> bool
+		{
+			const auto current_head = head.load(std::memory_order_relaxed);
+			if (current_head - tail.load(std::memory_order_acquire) >= capacity) {
+				return false;
+			}
+			events[current_head & mask] = event;
+			head.store(current_head + 1, std::memory_order_release);
+			return true;
+		}
+
+		template <class Consumer> void drain(Consumer&& consumer)
+		{
+			const auto current_tail = tail.load(std::memory_order_relaxed);
+			const auto current_head = head.load(std::memory_order_acquire);
+			for (auto i = current_tail; i < current_head; i++) {
+				consumer(events[i & mask]);
+			}
+			tail.store(current_head, std::memory_order_release);
+		}
+
+	private:
+		static constexpr std::size_t mask = capacity - 1;
+
+		alignas(64) std::atomic<std::uint64_t> head { 0 };
+		alignas(64) std::atomic<std::uint64_t> tail { 0 };
+		std::array<Event, capacity> events {};
+	};
+
+	struct ThreadState {
+		EventRing ring {};
+		std::uint32_t thread_id { 0 };
+		std::atomic<std::uint64_t> dropped { 0 };
+
+		// Owned by the collector.
+		std::string name {};
+		std::vector<Event> collected {};
+	};
+
+	auto current_thread() -> ThreadState&;
+
+	inline std::atomic_bool recording { false };
+
+	/**
+	 * @brief The time stamp counter where there is one, since it is several times cheaper to read than the steady clock.
+	 * Ticks are calibrated against the steady clock over the length of a session.
+	 */
+	inline auto now() -> std::uint64_t
+	{
+#if defined(_M_X64) || defined(__x86_64__)
+		return __rdtsc();
+#else
+		return static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+	}
+
+	inline void emit(std::uint32_t location, EventType type)
+	{
+		if (!recording.load(std::memory_order_relaxed)) {
+			return;
+		}
+		auto& thread = current_thread();
+		if (!thread.ring.try_push({ .timestamp = now(), .location = location, .type = type })) {
+			thread.dropped.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+} // namespace Detail
+
+auto register_location(const SourceLocation& location) -> std::uint32_t;
+
+/**
+ * @brief Names the calling thread in exported traces.
+ */
+void set_thread_name(std::string_view name);
+
+/**
+ * @brief Marks the start of a frame on the calling thread.
+ */
+void mark_frame();
+
+/**
+ * @brief Starts recording zones on every thread, discarding anything recorded earlier.
+ */
+void begin_session();
+
+/**
+ * @brief Moves events out of the per-thread rings. Call regularly (e.g. once per frame), a ring that fills up drops events.
+ */
+void collect();
+
+/**
+ * @brief Stops recording and writes everything collected as Chrome trace JSON, which Perfetto opens as well.
+ */
+void end_session(const std::filesystem::path& output);
+
+[[nodiscard]] auto is_recording() -> bool;
+
+class Zone {
 public:
-	Profiler(std::string_view scope_name);
-	~Profiler();
+	explicit Zone(std::uint32_t location)
+		: location(location)
+	{
+		Detail::emit(location, EventType::Begin);
+	}
+	~Zone() { Detail::emit(location, EventType::End); }
+
+	Zone(const Zone&) = delete;
+	Zone(Zone&&) = delete;
+	auto operator=(const Zone&) -> Zone& = delete;
+	auto operator=(Zone&&) -> Zone& = delete;
 
 private:
-	std::string_view name;
-	double start_time;
+	std::uint32_t location;
 };
 
 } // namespace Disarray::Instrumentation
@@ -1,29 +1,144 @@
 #pragma once
 
 #include <fmt/core.h>
+#include <fmt/format.h>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <new>
 #include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 
 #include "core/Types.hpp"
 
+// Levels below this are compiled out: 0 keeps everything, 1 removes Log::to_file, 2 removes Log::debug as well and 3 only keeps errors.
+#ifndef DISARRAY_MINIMUM_LOG_LEVEL
+#ifdef IS_RELEASE
+#define DISARRAY_MINIMUM_LOG_LEVEL 2
+#else
+#define DISARRAY_MINIMUM_LOG_LEVEL 0
+#endif
+#endif
+
 namespace Disarray {
 
 namespace Logging {
 
+	enum class Level : std::uint8_t {
+		Trace,
+		Debug,
+		Info,
+		Error,
+	};
+
+	inline constexpr auto minimum_level = static_cast<Level>(DISARRAY_MINIMUM_LOG_LEVEL);
+
+	enum class OverflowPolicy : std::uint8_t {
+		/** @brief Wait for the writer to make room */
+		Block,
+		/** @brief Discard the message */
+		Drop,
+		/** @brief Discard the message, and log how many were discarded once there is room again */
+		Count,
+	};
+
+	struct LoggerConfiguration {
+		bool asynchronous { false };
+		std::size_t queue_capacity { 4096 };
+		OverflowPolicy overflow { OverflowPolicy::Block };
+	};
+
+	namespace Detail {
+		template <class T>
+		concept Deferrable = std::is_arithmetic_v<std::remove_cvref_t<T>> || std::is_enum_v<std::remove_cvref_t<T>>;
+
+		template <class... Args> struct DeferredArguments {
+			fmt::string_view format;
+			std::tuple<std::remove_cvref_t<Args>...> values;
+		};
+
+		/**
+		 * @brief A message that is formatted on the writer thread. Only arithmetic and enum arguments are captured, by value,
+		 * since anything referring to memory owned by the caller could be gone by the time the writer gets to it.
+		 */
+		struct DeferredMessage {
+			static constexpr std::size_t scope_capacity = 32;
+			static constexpr std::size_t storage_size = 96;
+			using Formatter = void (*)(const std::byte*, fmt::memory_buffer&);
+
+			Formatter formatter { nullptr };
+			std::array<char, scope_capacity> scope {};
+			std::size_t scope_length { 0 };
+			alignas(std::max_align_t) std::array<std::byte, storage_size> storage {};
+
+			template <class... Args> static auto create(std::string_view scope_name, fmt::format_string<Args...> format, Args&&... args) -> DeferredMessage
+			{
+				using Captured = DeferredArguments<Args...>;
+				DeferredMessage message {};
+				message.scope_length = std::min(scope_name.size(), scope_capacity);
+				std::copy_n(scope_name.begin(), message.scope_length, message.scope.begin());
+				::new (message.storage.data()) Captured { static_cast<fmt::string_view>(format), { std::forward<Args>(args)... } };
+				message.formatter = [](const std::byte* storage, fmt::memory_buffer& out) {
+					const auto& captured = *std::launder(reinterpret_cast<const Captured*>(storage));
+					std::apply([&](const auto&... values) { fmt::vformat_to(std::back_inserter(out), captured.format, fmt::make_format_args(values...)); },
+						captured.values);
+				};
+				return message;
+			}
+
+			void format_to(fmt::memory_buffer& out) const;
+		};
+
+		template <class... Args>
+		inline constexpr bool can_defer = (Deferrable<Args> && ...) && sizeof(DeferredArguments<Args...>) <= DeferredMessage::storage_size
+			&& alignof(DeferredArguments<Args...>) <= alignof(std::max_align_t) && std::is_trivially_destructible_v<DeferredArguments<Args...>>;
+	} // namespace Detail
+
 	class Logger {
 	private:
 		Logger();
 
 		struct LoggerDataPimpl;
 		Scope<LoggerDataPimpl, PimplDeleter<LoggerDataPimpl>> logger_data;
+		std::atomic<Level> runtime_level { Level::Debug };
+		std::atomic_bool asynchronous { false };
 
 	public:
+		[[nodiscard]] auto should_log(Level level) const -> bool { return level >= runtime_level.load(std::memory_order_relaxed); }
+		[[nodiscard]] auto is_asynchronous() const -> bool { return asynchronous.load(std::memory_order_relaxed); }
+
+		void log(Level level, std::string&& message);
+		void log(Level level, const Detail::DeferredMessage& message);
+
 		void debug(const std::string&);
 		void info(const std::string&);
 		void error(const std::string&);
 		void to_file(const std::string&);
 
+		/**
+		 * @brief Switches between writing on the calling thread and writing from a background thread.
+		 * Must be called before other threads start logging.
+		 */
+		void configure(const LoggerConfiguration& configuration);
+
+		/**
+		 * @brief Blocks until everything queued so far has been written.
+		 */
+		void flush();
+
+		/**
+		 * @brief Messages discarded because the queue was full.
+		 */
+		[[nodiscard]] auto get_dropped_count() const -> std::uint64_t;
+
 		static void initialise_logger(const std::string& log_level);
 
 		static auto the() -> Logger&
@@ -39,57 +154,59 @@ namespace Log {
 	auto current_time(bool include_ms = true) -> std::string;
 	auto format(const char* format, ...) -> std::string;
 
+	/**
+	 * @brief Checks the compile time and runtime levels before doing any formatting. In asynchronous mode, messages with only
+	 * arithmetic and enum arguments are formatted on the writer thread.
+	 */
+	template <Logging::Level Level, class... Args> inline void log(std::string_view scope, fmt::format_string<Args...> fmt, Args&&... args)
+	{
+		if constexpr (Level >= Logging::minimum_level) {
+			auto& logger = Logging::Logger::the();
+			if (!logger.should_log(Level)) {
+				return;
+			}
+
+			if constexpr (Logging::Detail::can_defer<Args...>) {
+				if (logger.is_asynchronous()) {
+					logger.log(Level, Logging::Detail::DeferredMessage::create(scope, fmt, std::forward<Args>(args)...));
+					return;
+				}
+			}
+
+			fmt::memory_buffer buffer;
+			fmt::format_to(std::back_inserter(buffer), "[{}] ", scope);
+			fmt::format_to(std::back_inserter(buffer), fmt, std::forward<Args>(args)...);
+			logger.log(Level, std::string { buffer.data(), buffer.size() });
+		}
+	}
+
 	template <class... Args> inline void to_file(std::string_view scope, fmt::format_string<Args...> fmt, Args&&... args)
 	{
-		const auto message = fmt::format(fmt, std::forward<Args>(args)...);
-		auto formatted = fmt::format("[{}] {}", scope, message);
-		Logging::Logger::the().to_file(formatted);
+		log<Logging::Level::Trace>(scope, fmt, std::forward<Args>(args)...);
 	}
 
 	template <class... Args> inline void debug(std::string_view scope, fmt::format_string<Args...> fmt, Args&&... args)
 	{
-		const auto message = fmt::format(fmt, std::forward<Args>(args)...);
-		auto formatted = fmt::format("[{}] {}", scope, message);
-		Logging::Logger::the().debug(formatted);
+		log<Logging::Level::Debug>(scope, fmt, std::forward<Args>(args)...);
 	}
 
 	template <class... Args> inline void info(std::string_view scope, fmt::format_string<Args...> fmt, Args&&... args)
 	{
-		const auto message = fmt::format(fmt, std::forward<Args>(args)...);
-		auto formatted = fmt::format("[{}] {}", scope, message);
-		Logging::Logger::the().info(formatted);
+		log<Logging::Level::Info>(scope, fmt, std::forward<Args>(args)...);
 	}
 
 	template <class... Args> inline void error(std::string_view scope, fmt::format_string<Args...> fmt, Args&&... args)
 	{
-		const auto message = fmt::format(fmt, std::forward<Args>(args)...);
-		auto formatted = fmt::format("[{}] {}", scope, message);
-		Logging::Logger::the().error(formatted);
+		log<Logging::Level::Error>(scope, fmt, std::forward<Args>(args)...);
 	}
 
-	inline void to_file(std::string_view scope, std::string_view message)
-	{
-		auto formatted = fmt::format("[{}] {}", scope, message);
-		Logging::Logger::the().to_file(formatted);
-	}
+	inline void to_file(std::string_view scope, std::string_view message) { log<Logging::Level::Trace>(scope, "{}", message); }
 
-	inline void debug(std::string_view scope, std::string_view message)
-	{
-		auto formatted = fmt::format("[{}] {}", scope, message);
-		Logging::Logger::the().debug(formatted);
-	}
+	inline void debug(std::string_view scope, std::string_view message) { log<Logging::Level::Debug>(scope, "{}", message); }
 
-	inline void info(std::string_view scope, std::string_view message)
-	{
-		auto formatted = fmt::format("[{}] {}", scope, message);
-		Logging::Logger::the().info(formatted);
-	}
+	inline void info(std::string_view scope, std::string_view message) { log<Logging::Level::Info>(scope, "{}", message); }
 
-	inline void error(std::string_view scope, std::string_view message)
-	{
-		auto formatted = fmt::format("[{}] {}", scope, message);
-		Logging::Logger::the().error(formatted);
-	}
+	inline void error(std::string_view scope, std::string_view message) { log<Logging::Level::Error>(scope, "{}", message); }
 
 } // namespace Log
 
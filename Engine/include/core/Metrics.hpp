@@ -0,0 +1,104 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace Disarray::Metrics {
+
+struct HistogramSummary {
+	std::size_t count { 0 };
+	double min { 0.0 };
+	double max { 0.0 };
+	double mean { 0.0 };
+	double p50 { 0.0 };
+	double p95 { 0.0 };
+	double p99 { 0.0 };
+	double p999 { 0.0 };
+};
+
+/**
+ * @brief Keeps the last window samples, and computes exact percentiles over them on request.
+ */
+class RollingHistogram {
+public:
+	static constexpr std::size_t default_window = 2048;
+
+	RollingHistogram()
+		: RollingHistogram(default_window)
+	{
+	}
+	explicit RollingHistogram(std::size_t window);
+
+	void record(double value);
+	void clear();
+
+	[[nodiscard]] auto summarise() const -> HistogramSummary;
+	[[nodiscard]] auto get_count() const -> std::size_t { return filled; }
+
+private:
+	std::vector<double> samples;
+	std::size_t next { 0 };
+	std::size_t filled { 0 };
+};
+
+/**
+ * @brief Per-frame counters. Any thread can add to them, end_frame records the frame's total into a histogram and resets them.
+ */
+enum class Counter : std::uint8_t {
+	DrawCalls,
+	EntitiesDrawn,
+	BytesUploaded,
+	HeapAllocations,
+};
+inline constexpr std::size_t counter_count = 4;
+
+enum class OutputFormat : std::uint8_t {
+	CSV,
+	JSON,
+};
+
+struct MetricsConfiguration {
+	/** @brief Written on every dump. The format follows the extension, .json for JSON and CSV otherwise. Nothing is written when empty */
+	std::filesystem::path output {};
+	/** @brief Time between dumps. Zero only dumps at shutdown */
+	std::chrono::seconds dump_interval { 0 };
+	std::size_t window { RollingHistogram::default_window };
+};
+
+void configure(const MetricsConfiguration& configuration);
+
+/**
+ * @brief (ms) Records a timing sample under the given name. Names are created on first use.
+ */
+void record_timing(std::string_view name, double milliseconds);
+
+void add(Counter counter, std::uint64_t value = 1);
+
+/**
+ * @brief Records the counters for the frame that just ended, and dumps to the configured output when the interval has passed.
+ */
+void end_frame();
+
+[[nodiscard]] auto get_summary(std::string_view name) -> std::optional<HistogramSummary>;
+[[nodiscard]] auto get_summary(Counter counter) -> HistogramSummary;
+
+/**
+ * @brief A snapshot of every timing and counter, timings first, each sorted by name.
+ */
+[[nodiscard]] auto get_summaries() -> std::vector<std::pair<std::string, HistogramSummary>>;
+
+void write(const std::filesystem::path& output, OutputFormat format);
+
+/**
+ * @brief Writes to the configured output, if there is one.
+ */
+void dump();
+
+} // namespace Disarray::Metrics
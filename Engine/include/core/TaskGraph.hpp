@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "core/ThreadPool.hpp"
+
+namespace Disarray::Threading {
+
+struct TaskStatistics {
+	std::string name {};
+	double start_ms { 0.0 };
+	double duration_ms { 0.0 };
+	bool on_critical_path { false };
+};
+
+struct TaskGraphStatistics {
+	std::vector<TaskStatistics> tasks {};
+	double wall_time_ms { 0.0 };
+	double critical_path_ms { 0.0 };
+};
+
+/**
+ * @brief A small per-frame task graph. Each stage names the resources it reads and writes, and is ordered after every earlier
+ * stage it conflicts with (read after write, write after read, write after write). Stages without conflicts run concurrently.
+ *
+ * Resources are plain names, e.g. a component type or a GPU buffer, and only have to be spelled consistently within one graph.
+ */
+class TaskGraph {
+public:
+	using StageFunction = std::function<void()>;
+
+	class StageBuilder {
+	public:
+		// Resource names are stored as views, so they should be string literals.
+		auto reads(std::initializer_list<std::string_view> resources) -> StageBuilder&;
+		auto writes(std::initializer_list<std::string_view> resources) -> StageBuilder&;
+
+	private:
+		StageBuilder(TaskGraph& graph, std::size_t index)
+			: graph(graph)
+			, index(index)
+		{
+		}
+
+		TaskGraph& graph;
+		std::size_t index;
+
+		friend class TaskGraph;
+	};
+
+	auto add_stage(std::string_view name, StageFunction&& function) -> StageBuilder;
+
+	/**
+	 * @brief Runs all stages on the pool, helping from the calling thread, and records timings. Rethrows the first exception a stage threw.
+	 */
+	void execute(ThreadPool& pool);
+
+	/**
+	 * @brief Removes all stages. Statistics of the last execution are kept.
+	 */
+	void clear();
+
+	[[nodiscard]] auto get_statistics() const -> const TaskGraphStatistics& { return statistics; }
+	[[nodiscard]] auto get_stage_count() const -> std::size_t { return stages.size(); }
+	[[nodiscard]] auto get_dependencies(std::size_t stage) const -> const std::vector<std::size_t>&;
+
+private:
+	struct Stage {
+		std::string name {};
+		StageFunction function {};
+		std::vector<std::string_view> reads {};
+		std::vector<std::string_view> writes {};
+		std::vector<std::size_t> dependencies {};
+		std::vector<std::size_t> dependents {};
+	};
+
+	struct ExecutionState;
+
+	void build_edges();
+	void schedule_stage(ThreadPool& pool, ExecutionState& state, std::size_t index);
+	void compute_critical_path();
+
+	std::vector<Stage> stages {};
+	TaskGraphStatistics statistics {};
+};
+
+} // namespace Disarray::Threading
@@ -1,37 +1,23 @@
 #pragma once
 
-/**
- * @file BS_ThreadPool.hpp
- * @author Barak Shoshany (baraksh@gmail.com) (http://baraksh.com)
- * @version 3.5.0
- * @date 2023-05-25
- * @copyright Copyright (c) 2023 Barak Shoshany. Licensed under the MIT license. If you found this project useful, please consider starring it on
- * GitHub! If you use this library in software of any kind, please provide a link to the GitHub repository https://github.com/bshoshany/thread-pool in
- * the source code and documentation. If you use this library in published research, please cite it as follows: Barak Shoshany, "A C++17 Thread Pool
- * for High-Performance Scientific Computing", doi:10.5281/zenodo.4742687, arXiv:2105.00613 (May 2021)
- *
- * @brief BS::ThreadPool: a fast, lightweight, and easy-to-use C++17 thread pool library. This header file contains the entire library, including the
- * main BS::ThreadPool class and the helper classes BS::MultiFuture, BS::blocks, BS:SyncedStream, and BS::Timer.
- */
-
-#include "core/UsageBadge.hpp"
-#define BS_ThreadPool_VERSION "v3.5.0 (2023-05-25)"
-
-#include <chrono> // std::chrono
-#include <condition_variable> // std::condition_variable
-#include <exception> // std::current_exception
-#include <functional> // std::bind, std::function, std::invoke
-#include <future> // std::future, std::promise
-#include <iostream> // std::cout, std::endl, std::flush, std::ostream
-#include <memory> // std::make_shared, std::make_unique, std::shared_ptr, std::unique_ptr
-#include <mutex> // std::mutex, std::scoped_lock, std::unique_lock
-#include <queue> // std::queue
-#include <thread> // std::thread
-#include <type_traits> // std::common_type_t, std::conditional_t, std::decay_t, std::invoke_result_t, std::is_void_v
-#include <utility> // std::forward, std::move, std::swap
-#include <vector> // std::vector
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #include "Forward.hpp"
+#include "core/UsageBadge.hpp"
 
 namespace Disarray::Threading {
 
@@ -40,792 +26,289 @@ namespace Disarray::Threading {
  */
 using concurrency_t = std::invoke_result_t<decltype(std::thread::hardware_concurrency)>;
 
-// ============================================================================================= //
-//                                    Begin class MultiFuture                                   //
-
 /**
- * @brief A helper class to facilitate waiting for and/or getting the results of multiple futures at once.
- *
- * @tparam T The return type of the futures.
+ * @brief Tracks a group of jobs. Scheduling a job with a counter increments it, and the job decrements it when it has run.
+ * ThreadPool::wait runs other jobs until the counter reaches zero, instead of blocking the waiting thread.
  */
-template <typename T> class [[nodiscard]] MultiFuture {
+class JobCounter {
 public:
-	/**
-	 * @brief Construct a MultiFuture object with the given number of futures.
-	 *
-	 * @param num_futures The desired number of futures to store.
-	 */
-	MultiFuture(const size_t num_futures = 0)
-		: futures(num_futures)
+	JobCounter() = default;
+	~JobCounter() = default;
+	JobCounter(const JobCounter&) = delete;
+	JobCounter(JobCounter&&) = delete;
+	auto operator=(const JobCounter&) -> JobCounter& = delete;
+	auto operator=(JobCounter&&) -> JobCounter& = delete;
+
+	void add(std::uint32_t count = 1) { pending.fetch_add(count, std::memory_order_relaxed); }
+	void decrement()
 	{
-	}
-
-	/**
-	 * @brief Get the results from all the futures stored in this MultiFuture object, rethrowing any stored exceptions.
-	 *
-	 * @return If the futures return void, this function returns void as well. Otherwise, it returns a vector containing the results.
-	 */
-	[[nodiscard]] std::conditional_t<std::is_void_v<T>, void, std::vector<T>> get()
-	{
-		if constexpr (std::is_void_v<T>) {
-			for (size_t i = 0; i < futures.size(); ++i) {
-				futures[i].get();
-			}
-			return;
-		} else {
-			std::vector<T> results(futures.size());
-			for (size_t i = 0; i < futures.size(); ++i) {
-				results[i] = futures[i].get();
-			}
-			return results;
+		// Counters usually live on the waiter's stack, and the waiter may return as soon as pending reaches zero. Waiters also wait for
+		// decrementing to reach zero, so the notify below can not touch a counter that has already been destroyed.
+		decrementing.fetch_add(1, std::memory_order_relaxed);
+		if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+			pending.notify_all();
 		}
+		decrementing.fetch_sub(1, std::memory_order_release);
 	}
 
-	/**
-	 * @brief Get a reference to one of the futures stored in this MultiFuture object.
-	 *
-	 * @param i The index of the desired future.
-	 * @return The future.
-	 */
-	[[nodiscard]] auto operator[](const size_t index) -> std::future<T>& { return futures[index]; }
-
-	/**
-	 * @brief Append a future to this MultiFuture object.
-	 *
-	 * @param future The future to append.
-	 */
-	void push_back(std::future<T> future) { futures.push_back(std::move(future)); }
-
-	/**
-	 * @brief Get the number of futures stored in this MultiFuture object.
-	 *
-	 * @return The number of futures.
-	 */
-	[[nodiscard]] auto size() const -> size_t { return futures.size(); }
+	[[nodiscard]] auto is_done() const -> bool { return get_pending() == 0 && decrementing.load(std::memory_order_acquire) == 0; }
+	[[nodiscard]] auto get_pending() const -> std::uint32_t { return pending.load(std::memory_order_acquire); }
 
 	/**
-	 * @brief Wait for all the futures stored in this MultiFuture object.
+	 * @brief Blocks without helping. Only use this from threads that are not part of a pool.
 	 */
-	void wait() const
+	void wait_blocking() const
 	{
-		for (size_t i = 0; i < futures.size(); ++i) {
-			futures[i].wait();
+		auto current = get_pending();
+		while (current != 0) {
+			pending.wait(current, std::memory_order_acquire);
+			current = get_pending();
+		}
+		// The last decrement is at most a notify away from finishing.
+		while (!is_done()) {
+			std::this_thread::yield();
 		}
 	}
 
 private:
-	/**
-	 * @brief A vector to store the futures.
-	 */
-	std::vector<std::future<T>> futures;
+	std::atomic<std::uint32_t> pending { 0 };
+	std::atomic<std::uint32_t> decrementing { 0 };
 };
 
-//                                     End class MultiFuture                                    //
-// ============================================================================================= //
-
-// ============================================================================================= //
-//                                       Begin class blocks                                      //
-
-/**
- * @brief A helper class to divide a range into blocks. Used by parallelize_loop() and push_loop().
- *
- * @tparam T1 The type of the first index in the range. Should be a signed or unsigned integer.
- * @tparam T2 The type of the index after the last index in the range. Should be a signed or unsigned integer. If T1 is not the same as T2, a
- * common type will be automatically inferred.
- * @tparam T The common type of T1 and T2.
- */
-template <typename T1, typename T2, typename T = std::common_type_t<T1, T2>> class [[nodiscard]] Blocks {
-public:
+namespace Detail {
 	/**
-	 * @brief Construct a blocks object with the given specifications.
-	 *
-	 * @param first_index_in The first index in the range.
-	 * @param index_after_last_in The index after the last index in the range.
-	 * @param num_blocks_in The desired number of blocks to divide the range into.
+	 * @brief A type-erased job, sized to a cache line. Small callables are constructed in place, larger ones on the heap.
 	 */
-	Blocks(const T1 first_index_in, const T2 index_after_last_in, const size_t num_blocks_in)
-		: first_index(static_cast<T>(first_index_in))
-		, index_after_last(static_cast<T>(index_after_last_in))
-		, num_blocks(num_blocks_in)
-	{
-		if (index_after_last < first_index) {
-			std::swap(index_after_last, first_index);
-		}
-		total_size = static_cast<size_t>(index_after_last - first_index);
-		block_size = static_cast<size_t>(total_size / num_blocks);
-		if (block_size == 0) {
-			block_size = 1;
-			num_blocks = (total_size > 1) ? total_size : 1;
-		}
-	}
+	struct alignas(64) Job {
+		static constexpr std::size_t storage_size = 48;
+		using Invoker = void (*)(Job&);
 
-	/**
-	 * @brief Get the first index of a block.
-	 *
-	 * @param i The block number.
-	 * @return The first index.
-	 */
-	[[nodiscard]] auto start(const size_t index) const -> T { return static_cast<T>(index * block_size) + first_index; }
+		Invoker invoke { nullptr };
+		JobCounter* counter { nullptr };
+		alignas(std::max_align_t) std::array<std::byte, storage_size> storage {};
 
-	/**
-	 * @brief Get the index after the last index of a block.
-	 *
-	 * @param i The block number.
-	 * @return The index after the last index.
-	 */
-	[[nodiscard]] auto end(const size_t index) const -> T
-	{
-		return (index == num_blocks - 1) ? index_after_last : (static_cast<T>((index + 1) * block_size) + first_index);
-	}
+		template <class F> void emplace(F&& func)
+		{
+			using Callable = std::decay_t<F>;
+			if constexpr (sizeof(Callable) <= storage_size && alignof(Callable) <= alignof(std::max_align_t)) {
+				::new (storage.data()) Callable(std::forward<F>(func));
+				invoke = [](Job& self) {
+					auto* callable = std::launder(reinterpret_cast<Callable*>(self.storage.data()));
+					(*callable)();
+					callable->~Callable();
+				};
+			} else {
+				::new (storage.data()) Callable*(new Callable(std::forward<F>(func)));
+				invoke = [](Job& self) {
+					std::unique_ptr<Callable> callable { *std::launder(reinterpret_cast<Callable**>(self.storage.data())) };
+					(*callable)();
+				};
+			}
+		}
+	};
+	static_assert(sizeof(Job) == 64);
 
 	/**
-	 * @brief Get the number of blocks. Note that this may be different than the desired number of blocks that was passed to the constructor.
-	 *
-	 * @return The number of blocks.
+	 * @brief Chase-Lev deque. The owning worker pushes and pops at the bottom, every other thread steals from the top.
+	 * The buffer does not grow, push returns false when it is full.
 	 */
-	[[nodiscard]] auto get_num_blocks() const -> size_t { return num_blocks; }
+	class WorkStealingDeque {
+	public:
+		static constexpr std::int64_t capacity = 4096;
 
-	/**
-	 * @brief Get the total number of indices in the range.
-	 *
-	 * @return The total number of indices.
-	 */
-	[[nodiscard]] auto get_total_size() const -> size_t { return total_size; }
+		auto push(Job* job) -> bool;
+		auto pop() -> Job*;
+		auto steal() -> Job*;
 
-private:
-	/**
-	 * @brief The size of each block (except possibly the last block).
-	 */
-	size_t block_size = 0;
+	private:
+		static constexpr std::int64_t mask = capacity - 1;
+		static_assert((capacity & mask) == 0);
 
-	/**
-	 * @brief The first index in the range.
-	 */
-	T first_index = 0;
+		alignas(64) std::atomic<std::int64_t> top { 0 };
+		alignas(64) std::atomic<std::int64_t> bottom { 0 };
+		alignas(64) std::array<std::atomic<Job*>, capacity> buffer {};
+	};
 
 	/**
-	 * @brief The index after the last index in the range.
+	 * @brief Recycles jobs through a bounded multi-producer, multi-consumer queue, so that steady state scheduling does not allocate.
 	 */
-	T index_after_last = 0;
+	class JobAllocator {
+	public:
+		JobAllocator();
+		~JobAllocator();
+		JobAllocator(const JobAllocator&) = delete;
+		JobAllocator(JobAllocator&&) = delete;
+		auto operator=(const JobAllocator&) -> JobAllocator& = delete;
+		auto operator=(JobAllocator&&) -> JobAllocator& = delete;
 
-	/**
-	 * @brief The number of blocks.
-	 */
-	size_t num_blocks = 0;
+		auto allocate() -> Job*;
+		void release(Job* job);
 
-	/**
-	 * @brief The total number of indices in the range.
-	 */
-	size_t total_size = 0;
-};
+	private:
+		auto try_pop() -> Job*;
 
-//                                        End class blocks                                       //
-// ============================================================================================= //
+		static constexpr std::size_t capacity = 1024;
+		static constexpr std::size_t mask = capacity - 1;
 
-// ============================================================================================= //
-//                                    Begin class ThreadPool                                    //
+		struct Cell {
+			std::atomic<std::size_t> sequence { 0 };
+			Job* job { nullptr };
+		};
+
+		std::unique_ptr<Cell[]> cells;
+		alignas(64) std::atomic<std::size_t> enqueue_position { 0 };
+		alignas(64) std::atomic<std::size_t> dequeue_position { 0 };
+	};
+} // namespace Detail
 
 /**
- * @brief A fast, lightweight, and easy-to-use C++17 thread pool class.
+ * @brief Work-stealing job system. Every worker owns a deque, threads outside of the pool submit through a shared injection queue.
  */
-class [[nodiscard]] ThreadPool {
+class ThreadPool {
 public:
-	// ============================
-	// Constructors and destructors
-	// ============================
-
 	/**
 	 * @brief Construct a new thread pool.
 	 *
-	 * @param thread_count_in The number of threads to use. The default value is the total number of hardware threads available, as reported by the
-	 * implementation. This is usually determined by the number of cores in the CPU. If a core is hyperthreaded, it will count as two threads.
+	 * @param thread_count The number of workers to use. The default value is the total number of hardware threads available.
 	 */
-	ThreadPool(UsageBadge<Disarray::App>, const concurrency_t thread_count = 0)
-		: thread_count(determine_thread_count(thread_count))
-		, threads(std::make_unique<std::thread[]>(determine_thread_count(thread_count)))
-	{
-		create_threads();
-	}
+	explicit ThreadPool(UsageBadge<Disarray::App>, concurrency_t thread_count = 0);
+	~ThreadPool();
+
 	ThreadPool(const ThreadPool&) = delete;
 	ThreadPool(ThreadPool&&) noexcept = delete;
 	auto operator=(const ThreadPool& other) -> ThreadPool& = delete;
 	auto operator=(ThreadPool&&) noexcept -> ThreadPool& = delete;
 
 	/**
-	 * @brief Destruct the thread pool. Waits for all tasks to complete, then destroys all threads. Note that if the pool is paused, then any
-	 * tasks still in the queue will never be executed.
-	 */
-	~ThreadPool()
-	{
-		wait_for_tasks();
-		destroy_threads();
-	}
-
-	// =======================
-	// Public member functions
-	// =======================
-
-	/**
-	 * @brief Get the number of tasks currently waiting in the queue to be executed by the threads.
-	 *
-	 * @return The number of queued tasks.
-	 */
-	[[nodiscard]] auto get_tasks_queued() const -> size_t
-	{
-		const std::scoped_lock tasks_lock(tasks_mutex);
-		return tasks.size();
-	}
-
-	/**
-	 * @brief Get the number of tasks currently being executed by the threads.
-	 *
-	 * @return The number of running tasks.
-	 */
-	[[nodiscard]] auto get_tasks_running() const -> size_t
-	{
-		const std::scoped_lock tasks_lock(tasks_mutex);
-		return tasks_running;
-	}
-
-	/**
-	 * @brief Get the total number of unfinished tasks: either still waiting in the queue, or running in a thread. Note that get_tasks_total() ==
-	 * get_tasks_queued() + get_tasks_running().
-	 *
-	 * @return The total number of tasks.
-	 */
-	[[nodiscard]] auto get_tasks_total() const -> size_t
-	{
-		const std::scoped_lock tasks_lock(tasks_mutex);
-		return tasks_running + tasks.size();
-	}
-
-	/**
-	 * @brief Get the number of threads in the pool.
-	 *
-	 * @return The number of threads.
-	 */
-	[[nodiscard]] auto get_thread_count() const -> concurrency_t { return thread_count; }
-
-	/**
-	 * @brief Check whether the pool is currently paused.
-	 *
-	 * @return true if the pool is paused, false if it is not paused.
-	 */
-	[[nodiscard]] auto is_paused() const -> bool
-	{
-		const std::scoped_lock tasks_lock(tasks_mutex);
-		return paused;
-	}
-
-	/**
-	 * @brief Parallelize a loop by automatically splitting it into blocks and submitting each block separately to the queue. Returns a
-	 * MultiFuture object that contains the futures for all of the blocks.
-	 *
-	 * @tparam F The type of the function to loop through.
-	 * @tparam T1 The type of the first index in the loop. Should be a signed or unsigned integer.
-	 * @tparam T2 The type of the index after the last index in the loop. Should be a signed or unsigned integer. If T1 is not the same as T2, a
-	 * common type will be automatically inferred.
-	 * @tparam T The common type of T1 and T2.
-	 * @tparam R The return value of the loop function F (can be void).
-	 * @param first_index The first index in the loop.
-	 * @param index_after_last The index after the last index in the loop. The loop will iterate from first_index to (index_after_last - 1)
-	 * inclusive. In other words, it will be equivalent to "for (T i = first_index; i < index_after_last; ++i)". Note that if index_after_last ==
-	 * first_index, no blocks will be submitted.
-	 * @param loop The function to loop through. Will be called once per block. Should take exactly two arguments: the first index in the block
-	 * and the index after the last index in the block. loop(start, end) should typically involve a loop of the form "for (T i = start; i < end;
-	 * ++i)".
-	 * @param num_blocks The maximum number of blocks to split the loop into. The default is to use the number of threads in the pool.
-	 * @return A MultiFuture object that can be used to wait for all the blocks to finish. If the loop function returns a value, the MultiFuture
-	 * object can also be used to obtain the values returned by each block.
+	 * @brief Schedule a job. If a counter is given, it is incremented now and decremented once the job has run.
 	 */
-	template <typename F, typename T1, typename T2, typename T = std::common_type_t<T1, T2>, typename R = std::invoke_result_t<std::decay_t<F>, T, T>>
-	[[nodiscard]] auto parallelize_loop(const T1 first_index, const T2 index_after_last, F&& loop, const size_t num_blocks = 0) -> MultiFuture<R>
+	template <class F> void schedule(F&& func, JobCounter* counter = nullptr)
 	{
-		Blocks blks(first_index, index_after_last, num_blocks ? num_blocks : thread_count);
-		if (blks.get_total_size() > 0) {
-			MultiFuture<R> multi_future(blks.get_num_blocks());
-			for (size_t i = 0; i < blks.get_num_blocks(); ++i) {
-				multi_future[i] = submit(std::forward<F>(loop), blks.start(i), blks.end(i));
-			}
-			return multi_future;
+		auto* job = job_allocator.allocate();
+		job->emplace(std::forward<F>(func));
+		job->counter = counter;
+		if (counter != nullptr) {
+			counter->add();
 		}
-		return MultiFuture<R>();
-	}
-
-	/**
-	 * @brief Parallelize a loop by automatically splitting it into blocks and submitting each block separately to the queue. Returns a
-	 * MultiFuture object that contains the futures for all of the blocks. This overload is used for the special case where the first index is 0.
-	 *
-	 * @tparam F The type of the function to loop through.
-	 * @tparam T The type of the loop indices. Should be a signed or unsigned integer.
-	 * @tparam R The return value of the loop function F (can be void).
-	 * @param index_after_last The index after the last index in the loop. The loop will iterate from 0 to (index_after_last - 1) inclusive. In
-	 * other words, it will be equivalent to "for (T i = 0; i < index_after_last; ++i)". Note that if index_after_last == 0, no blocks will be
-	 * submitted.
-	 * @param loop The function to loop through. Will be called once per block. Should take exactly two arguments: the first index in the block
-	 * and the index after the last index in the block. loop(start, end) should typically involve a loop of the form "for (T i = start; i < end;
-	 * ++i)".
-	 * @param num_blocks The maximum number of blocks to split the loop into. The default is to use the number of threads in the pool.
-	 * @return A MultiFuture object that can be used to wait for all the blocks to finish. If the loop function returns a value, the MultiFuture
-	 * object can also be used to obtain the values returned by each block.
-	 */
-	template <typename F, typename T, typename R = std::invoke_result_t<std::decay_t<F>, T, T>>
-	[[nodiscard]] auto parallelize_loop(const T index_after_last, F&& loop, const size_t num_blocks = 0) -> MultiFuture<R>
-	{
-		return parallelize_loop(0, index_after_last, std::forward<F>(loop), num_blocks);
+		outstanding_jobs.add();
+		enqueue(job);
 	}
 
 	/**
-	 * @brief Pause the pool. The workers will temporarily stop retrieving new tasks out of the queue, although any tasks already executed will
-	 * keep running until they are finished.
+	 * @brief Run queued jobs on the calling thread until the counter reaches zero.
 	 */
-	void pause()
-	{
-		const std::scoped_lock tasks_lock(tasks_mutex);
-		paused = true;
-	}
+	void wait(JobCounter& counter);
 
 	/**
-	 * @brief Purge all the tasks waiting in the queue. Tasks that are currently running will not be affected, but any tasks still waiting in the
-	 * queue will be discarded, and will never be executed by the threads. Please note that there is no way to restore the purged tasks.
-	 */
-	void purge()
-	{
-		const std::scoped_lock tasks_lock(tasks_mutex);
-		while (!tasks.empty()) {
-			tasks.pop();
-		}
-	}
-
-	/**
-	 * @brief Parallelize a loop by automatically splitting it into blocks and submitting each block separately to the queue. Does not return a
-	 * MultiFuture, so the user must use wait_for_tasks() or some other method to ensure that the loop finishes executing, otherwise bad things
-	 * will happen.
-	 *
-	 * @tparam F The type of the function to loop through.
-	 * @tparam T1 The type of the first index in the loop. Should be a signed or unsigned integer.
-	 * @tparam T2 The type of the index after the last index in the loop. Should be a signed or unsigned integer. If T1 is not the same as T2, a
-	 * common type will be automatically inferred.
-	 * @tparam T The common type of T1 and T2.
-	 * @param first_index The first index in the loop.
-	 * @param index_after_last The index after the last index in the loop. The loop will iterate from first_index to (index_after_last - 1)
-	 * inclusive. In other words, it will be equivalent to "for (T i = first_index; i < index_after_last; ++i)". Note that if index_after_last ==
-	 * first_index, no blocks will be submitted.
-	 * @param loop The function to loop through. Will be called once per block. Should take exactly two arguments: the first index in the block
-	 * and the index after the last index in the block. loop(start, end) should typically involve a loop of the form "for (T i = start; i < end;
-	 * ++i)".
-	 * @param num_blocks The maximum number of blocks to split the loop into. The default is to use the number of threads in the pool.
-	 */
-	template <typename F, typename T1, typename T2, typename T = std::common_type_t<T1, T2>>
-	void push_loop(const T1 first_index, const T2 index_after_last, F&& loop, const size_t num_blocks = 0)
-	{
-		Blocks blks(first_index, index_after_last, num_blocks ? num_blocks : thread_count);
-		if (blks.get_total_size() > 0) {
-			for (size_t i = 0; i < blks.get_num_blocks(); ++i) {
-				push_task(std::forward<F>(loop), blks.start(i), blks.end(i));
-			}
-		}
-	}
-
-	/**
-	 * @brief Parallelize a loop by automatically splitting it into blocks and submitting each block separately to the queue. Does not return a
-	 * MultiFuture, so the user must use wait_for_tasks() or some other method to ensure that the loop finishes executing, otherwise bad things
-	 * will happen. This overload is used for the special case where the first index is 0.
-	 *
-	 * @tparam F The type of the function to loop through.
-	 * @tparam T The type of the loop indices. Should be a signed or unsigned integer.
-	 * @param index_after_last The index after the last index in the loop. The loop will iterate from 0 to (index_after_last - 1) inclusive. In
-	 * other words, it will be equivalent to "for (T i = 0; i < index_after_last; ++i)". Note that if index_after_last == 0, no blocks will be
-	 * submitted.
-	 * @param loop The function to loop through. Will be called once per block. Should take exactly two arguments: the first index in the block
-	 * and the index after the last index in the block. loop(start, end) should typically involve a loop of the form "for (T i = start; i < end;
-	 * ++i)".
-	 * @param num_blocks The maximum number of blocks to split the loop into. The default is to use the number of threads in the pool.
-	 */
-	template <typename F, typename T> void push_loop(const T index_after_last, F&& loop, const size_t num_blocks = 0)
-	{
-		push_loop(0, index_after_last, std::forward<F>(loop), num_blocks);
-	}
-
-	/**
-	 * @brief Push a function with zero or more arguments, but no return value, into the task queue. Does not return a future, so the user must
-	 * use wait_for_tasks() or some other method to ensure that the task finishes executing, otherwise bad things will happen.
-	 *
-	 * @tparam F The type of the function.
-	 * @tparam A The types of the arguments.
-	 * @param task The function to push.
-	 * @param args The zero or more arguments to pass to the function. Note that if the task is a class member function, the first argument must
-	 * be a pointer to the object, i.e. &object (or this), followed by the actual arguments.
+	 * @brief Push a function with zero or more arguments, but no return value, into the pool.
 	 */
 	template <typename F, typename... A> void push_task(F&& task, A&&... args)
 	{
-		{
-			const std::scoped_lock tasks_lock(tasks_mutex);
-			tasks.push(std::bind(std::forward<F>(task), std::forward<A>(args)...)); // cppcheck-suppress ignoredReturnValue
+		if constexpr (sizeof...(A) == 0) {
+			schedule(std::forward<F>(task));
+		} else {
+			schedule(std::bind(std::forward<F>(task), std::forward<A>(args)...));
 		}
-		task_available_cv.notify_one();
 	}
 
 	/**
-	 * @brief Reset the number of threads in the pool. Waits for all currently running tasks to be completed, then destroys all threads in the
-	 * pool and creates a new thread pool with the new number of threads. Any tasks that were waiting in the queue before the pool was reset will
-	 * then be executed by the new threads. If the pool was paused before resetting it, the new pool will be paused as well.
+	 * @brief Submit a function with zero or more arguments into the pool. Prefer schedule with a JobCounter for short jobs.
 	 *
-	 * @param thread_count_in The number of threads to use. The default value is the total number of hardware threads available, as reported by the
-	 * implementation. This is usually determined by the number of cores in the CPU. If a core is hyperthreaded, it will count as two threads.
-	 */
-	void reset(const concurrency_t thread_count_inin = 0)
-	{
-		std::unique_lock tasks_lock(tasks_mutex);
-		const bool was_paused = paused;
-		paused = true;
-		tasks_lock.unlock();
-		wait_for_tasks();
-		destroy_threads();
-		thread_count = determine_thread_count(thread_count_inin);
-		threads = std::make_unique<std::thread[]>(thread_count);
-		paused = was_paused;
-		create_threads();
-	}
-
-	/**
-	 * @brief Submit a function with zero or more arguments into the task queue. If the function has a return value, get a future for the eventual
-	 * returned value. If the function has no return value, get an std::future<void> which can be used to wait until the task finishes.
-	 *
-	 * @tparam F The type of the function.
-	 * @tparam A The types of the zero or more arguments to pass to the function.
-	 * @tparam R The return type of the function (can be void).
-	 * @param task The function to submit.
-	 * @param args The zero or more arguments to pass to the function. Note that if the task is a class member function, the first argument must
-	 * be a pointer to the object, i.e. &object (or this), followed by the actual arguments.
 	 * @return A future to be used later to wait for the function to finish executing and/or obtain its returned value if it has one.
 	 */
 	template <typename F, typename... A, typename R = std::invoke_result_t<std::decay_t<F>, std::decay_t<A>...>>
 	[[nodiscard]] auto submit(F&& task, A&&... args) -> std::future<R>
 	{
-		std::shared_ptr<std::promise<R>> task_promise = std::make_shared<std::promise<R>>();
-		push_task([task_function = std::bind(std::forward<F>(task), std::forward<A>(args)...), task_promise] {
+		auto promise = std::make_shared<std::promise<R>>();
+		auto future = promise->get_future();
+		schedule([bound = std::bind(std::forward<F>(task), std::forward<A>(args)...), promise]() mutable {
 			try {
 				if constexpr (std::is_void_v<R>) {
-					std::invoke(task_function);
-					task_promise->set_value();
+					std::invoke(bound);
+					promise->set_value();
 				} else {
-					task_promise->set_value(std::invoke(task_function));
+					promise->set_value(std::invoke(bound));
 				}
 			} catch (...) {
-				try {
-					task_promise->set_exception(std::current_exception());
-				} catch (...) {
-				}
+				promise->set_exception(std::current_exception());
 			}
 		});
-		return task_promise->get_future();
-	}
-
-	/**
-	 * @brief Unpause the pool. The workers will resume retrieving new tasks out of the queue.
-	 */
-	void unpause()
-	{
-		const std::scoped_lock tasks_lock(tasks_mutex);
-		paused = false;
-	}
-
-	/**
-	 * @brief Wait for tasks to be completed. Normally, this function waits for all tasks, both those that are currently running in the threads
-	 * and those that are still waiting in the queue. However, if the pool is paused, this function only waits for the currently running tasks
-	 * (otherwise it would wait forever). Note: To wait for just one specific task, use submit() instead, and call the wait() member function of
-	 * the generated future.
-	 */
-	void wait_for_tasks()
-	{
-		std::unique_lock tasks_lock(tasks_mutex);
-		waiting = true;
-		tasks_done_cv.wait(tasks_lock, [this] { return !tasks_running && (paused || tasks.empty()); });
-		waiting = false;
-	}
-
-	/**
-	 * @brief Wait for tasks to be completed, but stop waiting after the specified duration has passed.
-	 *
-	 * @tparam R An arithmetic type representing the number of ticks to wait.
-	 * @tparam P An std::ratio representing the length of each tick in seconds.
-	 * @param duration The time duration to wait.
-	 * @return true if all tasks finished running, false if the duration expired but some tasks are still running.
-	 */
-	template <typename R, typename P> auto wait_for_tasks_duration(const std::chrono::duration<R, P>& duration) -> bool
-	{
-		std::unique_lock tasks_lock(tasks_mutex);
-		waiting = true;
-		const bool status = tasks_done_cv.wait_for(tasks_lock, duration, [this] { return !tasks_running && (paused || tasks.empty()); });
-		waiting = false;
-		return status;
-	}
-
-	/**
-	 * @brief Wait for tasks to be completed, but stop waiting after the specified time point has been reached.
-	 *
-	 * @tparam C The type of the clock used to measure time.
-	 * @tparam D An std::chrono::duration type used to indicate the time point.
-	 * @param timeout_time The time point at which to stop waiting.
-	 * @return true if all tasks finished running, false if the time point was reached but some tasks are still running.
-	 */
-	template <typename C, typename D> auto wait_for_tasks_until(const std::chrono::time_point<C, D>& timeout_time) -> bool
-	{
-		std::unique_lock tasks_lock(tasks_mutex);
-		waiting = true;
-		const bool status = tasks_done_cv.wait_until(tasks_lock, timeout_time, [this] { return !tasks_running && (paused || tasks.empty()); });
-		waiting = false;
-		return status;
-	}
-
-private:
-	// ========================
-	// Private member functions
-	// ========================
-
-	/**
-	 * @brief Create the threads in the pool and assign a worker to each thread.
-	 */
-	void create_threads()
-	{
-		{
-			const std::scoped_lock tasks_lock(tasks_mutex);
-			workers_running = true;
-		}
-		for (concurrency_t i = 0; i < thread_count; ++i) {
-			threads[i] = std::thread(&ThreadPool::worker, this);
-		}
-	}
-
-	/**
-	 * @brief Destroy the threads in the pool.
-	 */
-	void destroy_threads()
-	{
-		{
-			const std::scoped_lock tasks_lock(tasks_mutex);
-			workers_running = false;
-		}
-		task_available_cv.notify_all();
-		for (concurrency_t i = 0; i < thread_count; ++i) {
-			threads[i].join();
-		}
+		return future;
 	}
 
 	/**
-	 * @brief Determine how many threads the pool should have, based on the parameter passed to the constructor or reset().
-	 *
-	 * @param thread_count_in The parameter passed to the constructor or reset(). If the parameter is a positive number, then the pool will be
-	 * created with this number of threads. If the parameter is non-positive, or a parameter was not supplied (in which case it will have the
-	 * default value of 0), then the pool will be created with the total number of hardware threads available, as obtained from
-	 * std::thread::hardware_concurrency(). If the latter returns a non-positive number for some reason, then the pool will be created with just
-	 * one thread.
-	 * @return The number of threads to use for constructing the pool.
-	 */
-	[[nodiscard]] static concurrency_t determine_thread_count(const concurrency_t thread_count_in)
-	{
-		if (thread_count_in > 0) {
-			return thread_count_in;
-		}
-		if (std::thread::hardware_concurrency() > 0) {
-			return std::thread::hardware_concurrency();
-		}
-		return 1;
-	}
-
-	/**
-	 * @brief A worker function to be assigned to each thread in the pool. Waits until it is notified by push_task() that a task is available, and
-	 * then retrieves the task from the queue and executes it. Once the task finishes, the worker notifies wait_for_tasks() in case it is waiting.
-	 */
-	void worker()
-	{
-		std::function<void()> task;
-		while (true) {
-			std::unique_lock tasks_lock(tasks_mutex);
-			task_available_cv.wait(tasks_lock, [this] { return !tasks.empty() || !workers_running; });
-			if (!workers_running) {
-				break;
-			}
-			if (paused) {
-				continue;
-			}
-			task = std::move(tasks.front());
-			tasks.pop();
-			++tasks_running;
-			tasks_lock.unlock();
-			task();
-			tasks_lock.lock();
-			--tasks_running;
-			if (waiting && !tasks_running && (paused || tasks.empty()))
-				tasks_done_cv.notify_all();
-		}
-	}
-
-	// ============
-	// Private data
-	// ============
-
-	/**
-	 * @brief A flag indicating whether the workers should pause. When set to true, the workers temporarily stop retrieving new tasks out of the
-	 * queue, although any tasks already executed will keep running until they are finished. When set to false again, the workers resume
-	 * retrieving tasks.
-	 */
-	bool paused = false;
-
-	/**
-	 * @brief A condition variable to notify worker() that a new task has become available.
-	 */
-	std::condition_variable task_available_cv = {};
-
-	/**
-	 * @brief A condition variable to notify wait_for_tasks() that the tasks are done.
-	 */
-	std::condition_variable tasks_done_cv = {};
-
-	/**
-	 * @brief A queue of tasks to be executed by the threads.
-	 */
-	std::queue<std::function<void()>> tasks = {};
-
-	/**
-	 * @brief A counter for the total number of currently running tasks.
-	 */
-	size_t tasks_running = 0;
-
-	/**
-	 * @brief A mutex to synchronize access to the task queue by different threads.
-	 */
-	mutable std::mutex tasks_mutex = {};
-
-	/**
-	 * @brief The number of threads in the pool.
-	 */
-	concurrency_t thread_count = 0;
-
-	/**
-	 * @brief A smart pointer to manage the memory allocated for the threads.
+	 * @brief Run a function that does not return for a long time (e.g. a polling loop) on its own thread.
+	 * These never occupy a worker, and threads that help while waiting can never pick them up.
 	 */
-	std::unique_ptr<std::thread[]> threads = nullptr;
-
-	/**
-	 * @brief A flag indicating that wait_for_tasks() is active and expects to be notified whenever a task is done.
-	 */
-	bool waiting = false;
-
-	/**
-	 * @brief A flag indicating to the workers to keep running. When set to false, the workers terminate permanently.
-	 */
-	bool workers_running = false;
-};
-
-//                                     End class ThreadPool                                     //
-// ============================================================================================= //
-
-// ============================================================================================= //
-//                                   Begin class SyncedStream                                   //
-
-/**
- * @brief A helper class to synchronize printing to an output stream by different threads.
- */
-class [[nodiscard]] SyncedStream {
-public:
-	/**
-	 * @brief Construct a new synced stream.
-	 *
-	 * @param out_stream_in The output stream to print to. The default value is std::cout.
-	 */
-	SyncedStream(std::ostream& out_stream_in = std::cout)
-		: out_stream(out_stream_in)
+	template <typename F, typename... A, typename R = std::invoke_result_t<std::decay_t<F>, std::decay_t<A>...>>
+	[[nodiscard]] auto submit_long_running(F&& task, A&&... args) -> std::future<R>
 	{
+		std::packaged_task<R()> packaged { std::bind(std::forward<F>(task), std::forward<A>(args)...) };
+		auto future = packaged.get_future();
+
+		std::scoped_lock lock { long_running_mutex };
+		join_finished_long_running();
+		auto finished = std::make_shared<std::atomic_bool>(false);
+		long_running.push_back({
+			.thread = std::thread { [packaged = std::move(packaged), finished]() mutable {
+				packaged();
+				*finished = true;
+			} },
+			.finished = finished,
+		});
+		return future;
 	}
 
 	/**
-	 * @brief Print any number of items into the output stream. Ensures that no other threads print to this stream simultaneously, as long as they
-	 * all exclusively use the same SyncedStream object to print.
-	 *
-	 * @tparam T The types of the items
-	 * @param items The items to print.
+	 * @brief Wait for every job scheduled on the pool, helping out in the meantime. Must not be called from a job.
 	 */
-	template <typename... T> void print(T&&... items)
-	{
-		const std::scoped_lock lock(stream_mutex);
-		(out_stream << ... << std::forward<T>(items));
-	}
+	void wait_for_tasks();
 
 	/**
-	 * @brief Print any number of items into the output stream, followed by a newline character. Ensures that no other threads print to this
-	 * stream simultaneously, as long as they all exclusively use the same SyncedStream object to print.
+	 * @brief Wait for all scheduled jobs, then recreate the workers.
 	 *
-	 * @tparam T The types of the items
-	 * @param items The items to print.
+	 * @param thread_count The number of workers to use. The default value is the total number of hardware threads available.
 	 */
-	template <typename... T> void println(T&&... items) { print(std::forward<T>(items)..., '\n'); }
+	void reset(concurrency_t thread_count = 0);
 
-	/**
-	 * @brief A stream manipulator to pass to a SyncedStream (an explicit cast of std::endl). Prints a newline character to the stream, and then
-	 * flushes it. Should only be used if flushing is desired, otherwise '\n' should be used instead.
-	 */
-	inline static std::ostream& (&endl)(std::ostream&) = static_cast<std::ostream& (&)(std::ostream&)>(std::endl);
-
-	/**
-	 * @brief A stream manipulator to pass to a SyncedStream (an explicit cast of std::flush). Used to flush the stream.
-	 */
-	inline static std::ostream& (&flush)(std::ostream&) = static_cast<std::ostream& (&)(std::ostream&)>(std::flush);
-
-private:
-	/**
-	 * @brief The output stream to print to.
-	 */
-	std::ostream& out_stream;
-
-	/**
-	 * @brief A mutex to synchronize printing.
-	 */
-	mutable std::mutex stream_mutex = {};
-};
-
-//                                    End class SyncedStream                                    //
-// ============================================================================================= //
-
-// ============================================================================================= //
-//                                       Begin class Timer                                       //
-
-/**
- * @brief A helper class to measure execution time for benchmarking purposes.
- */
-class [[nodiscard]] Timer {
-public:
-	/**
-	 * @brief Start (or restart) measuring time.
-	 */
-	void start() { start_time = std::chrono::steady_clock::now(); }
-
-	/**
-	 * @brief Stop measuring time and store the elapsed time since start().
-	 */
-	void stop() { elapsed_time = std::chrono::steady_clock::now() - start_time; }
-
-	/**
-	 * @brief Get the number of milliseconds that have elapsed between start() and stop().
-	 *
-	 * @return The number of milliseconds.
-	 */
-	[[nodiscard]] std::chrono::milliseconds::rep ms() const { return (std::chrono::duration_cast<std::chrono::milliseconds>(elapsed_time)).count(); }
+	[[nodiscard]] auto get_thread_count() const -> concurrency_t { return thread_count; }
+	[[nodiscard]] auto get_tasks_queued() const -> std::size_t { return queued_jobs.load(std::memory_order_relaxed); }
+	[[nodiscard]] auto get_tasks_total() const -> std::size_t { return outstanding_jobs.get_pending(); }
+	[[nodiscard]] auto is_worker_thread() const -> bool;
 
 private:
-	/**
-	 * @brief The time point when measuring started.
-	 */
-	std::chrono::time_point<std::chrono::steady_clock> start_time = std::chrono::steady_clock::now();
-
-	/**
-	 * @brief The duration that has elapsed between start() and stop().
-	 */
-	std::chrono::duration<double> elapsed_time = std::chrono::duration<double>::zero();
+	void enqueue(Detail::Job* job);
+	auto try_take_job() -> Detail::Job*;
+	void run_job(Detail::Job* job) noexcept;
+	void worker(std::size_t index);
+	void create_threads();
+	void destroy_threads();
+	void join_finished_long_running();
+	[[nodiscard]] static auto determine_thread_count(concurrency_t thread_count) -> concurrency_t;
+
+	concurrency_t thread_count { 0 };
+	std::vector<std::thread> threads {};
+	std::vector<std::unique_ptr<Detail::WorkStealingDeque>> deques {};
+	Detail::JobAllocator job_allocator {};
+
+	std::mutex injection_mutex {};
+	std::deque<Detail::Job*> injection_queue {};
+	std::atomic<std::size_t> injection_size { 0 };
+
+	std::atomic<std::size_t> queued_jobs { 0 };
+	JobCounter outstanding_jobs {};
+
+	std::mutex sleep_mutex {};
+	std::condition_variable sleep_condition {};
+	std::atomic<std::size_t> sleeping_threads { 0 };
+	std::atomic_bool running { false };
+
+	struct LongRunning {
+		std::thread thread;
+		std::shared_ptr<std::atomic_bool> finished;
+	};
+	std::mutex long_running_mutex {};
+	std::vector<LongRunning> long_running {};
 };
 
-//                                        End class Timer                                        //
-// ============================================================================================= //
-
 } // namespace Disarray::Threading
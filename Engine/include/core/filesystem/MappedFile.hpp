@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <string_view>
+
+namespace Disarray::FS {
+
+/**
+ * @brief A read-only view of a whole file. Memory mapped where possible, read into an uninitialised buffer otherwise.
+ * The views stay valid for as long as the MappedFile is alive. Truncating a file while it is mapped makes reading past the new end fault,
+ * so files that are being edited should not stay mapped for longer than it takes to consume them.
+ */
+class MappedFile {
+public:
+	MappedFile() = default;
+	explicit MappedFile(const std::filesystem::path& path);
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	auto operator=(const MappedFile&) -> MappedFile& = delete;
+	MappedFile(MappedFile&& other) noexcept;
+	auto operator=(MappedFile&& other) noexcept -> MappedFile&;
+
+	[[nodiscard]] auto is_valid() const -> bool { return valid; }
+	[[nodiscard]] auto is_mapped() const -> bool { return mapping != nullptr; }
+	[[nodiscard]] auto size() const -> std::size_t { return file_size; }
+	[[nodiscard]] auto empty() const -> bool { return file_size == 0; }
+	[[nodiscard]] auto data() const -> const std::byte* { return bytes_begin; }
+
+	[[nodiscard]] auto bytes() const -> std::span<const std::byte> { return { bytes_begin, file_size }; }
+	[[nodiscard]] auto view() const -> std::string_view { return { reinterpret_cast<const char*>(bytes_begin), file_size }; }
+
+	explicit operator bool() const { return valid; }
+
+private:
+	void release();
+	auto map(const std::filesystem::path& path) -> bool;
+	auto read(const std::filesystem::path& path) -> bool;
+
+	const std::byte* bytes_begin { nullptr };
+	std::size_t file_size { 0 };
+	bool valid { false };
+
+	void* mapping { nullptr };
+	std::unique_ptr<std::byte[]> fallback {};
+};
+
+} // namespace Disarray::FS
@@ -2,6 +2,11 @@
 
 #include <glm/glm.hpp>
 
+#include <cstdint>
+#include <span>
+
+#include "graphics/ModelVertex.hpp"
+
 namespace Disarray {
 
 enum class AABBAxis : std::uint8_t {
@@ -14,6 +19,24 @@ struct AABBRange {
 	float min {};
 	float max {};
 };
+
+struct BoundingSphere {
+	glm::vec3 centre { 0.0F };
+	float radius { 0.0F };
+
+	/**
+	 * @brief The smallest sphere around centre that holds every vertex. Pass the middle point of their AABB for a reasonably tight one.
+	 */
+	[[nodiscard]] static auto from_vertices(std::span<const ModelVertex> vertices, const glm::vec3& centre) -> BoundingSphere;
+
+	/**
+	 * @brief Scales the radius by the longest axis of the transform, which holds the transformed vertices for any mix of rotation, scale
+	 * and translation but not for shears.
+	 */
+	[[nodiscard]] auto transformed(const glm::mat4& transform) const -> BoundingSphere;
+	[[nodiscard]] auto intersects(const BoundingSphere& other) const -> bool;
+};
+
 class AABB {
 
 public:
@@ -45,8 +68,30 @@ public:
 		}
 	}
 
+	/**
+	 * @brief Holds nothing: it intersects nothing, and merging a box into it gives that box.
+	 */
+	[[nodiscard]] static auto empty() -> AABB;
+	/**
+	 * @brief Min and max reduction over the positions, with AVX or SSE2 when the target has them. Empty for no vertices.
+	 */
+	[[nodiscard]] static auto from_vertices(std::span<const ModelVertex> vertices) -> AABB;
+
 	[[nodiscard]] auto calculate_scale_matrix() const -> glm::mat4;
 	[[nodiscard]] auto middle_point() const -> glm::vec3;
+	[[nodiscard]] auto minimum() const -> glm::vec3;
+	[[nodiscard]] auto maximum() const -> glm::vec3;
+	[[nodiscard]] auto is_empty() const -> bool;
+
+	/**
+	 * @brief The box around this one after an affine transform, from Arvo, "Transforming Axis-Aligned Bounding Boxes". The same box as
+	 * transforming all eight corners, for a fraction of the work.
+	 */
+	[[nodiscard]] auto transformed(const glm::mat4& transform) const -> AABB;
+	[[nodiscard]] auto merged(const AABB& other) const -> AABB;
+	[[nodiscard]] auto intersects(const AABB& other) const -> bool;
+	[[nodiscard]] auto intersects(const BoundingSphere& sphere) const -> bool;
+	[[nodiscard]] auto contains(const glm::vec3& point) const -> bool;
 
 private:
 	AABBRange min_max_x {};
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "graphics/ModelVertex.hpp"
+#include "graphics/Pipeline.hpp"
+
+namespace Disarray {
+
+enum class VertexFormat : std::uint8_t {
+	/** @brief ModelVertex as imported, 72 bytes */
+	Full,
+	/** @brief CompactVertex, 32 bytes */
+	Compact,
+	/** @brief QuantisedCompactVertex, 28 bytes. Needs the PositionDequantisation of its submesh to place vertices */
+	CompactQuantised,
+};
+
+/**
+ * @brief Normals are octahedral encoded, and the tangent frame is a quaternion whose sign is the sign of the bitangent.
+ */
+struct CompactVertex {
+	glm::vec3 pos;
+	/** @brief Two halfs */
+	std::uint32_t uvs;
+	/** @brief Two snorm16s */
+	std::uint32_t normal;
+	/** @brief Four snorm16s */
+	std::array<std::uint32_t, 2> tangent_frame;
+	/** @brief RGBA8 */
+	std::uint32_t colour;
+};
+
+/**
+ * @brief As CompactVertex, but positions are unorm16s relative to the bounds of the submesh. The fourth component is zero.
+ */
+struct QuantisedCompactVertex {
+	std::array<std::uint16_t, 4> pos;
+	std::uint32_t uvs;
+	std::uint32_t normal;
+	std::array<std::uint32_t, 2> tangent_frame;
+	std::uint32_t colour;
+};
+
+static_assert(sizeof(CompactVertex) == 32);
+static_assert(sizeof(QuantisedCompactVertex) == 28);
+
+/**
+ * @brief Position of a quantised vertex is offset + scale * pos, which is what shaders have to apply.
+ */
+struct PositionDequantisation {
+	glm::vec3 offset { 0.0F };
+	glm::vec3 scale { 1.0F };
+};
+
+struct TangentFrame {
+	glm::vec3 normal { 0.0F };
+	glm::vec3 tangent { 0.0F };
+	glm::vec3 bitangent { 0.0F };
+};
+
+struct MeshFootprint {
+	std::size_t vertex_count { 0 };
+	std::size_t index_count { 0 };
+	/** @brief Bytes the vertices take as ModelVertex */
+	std::size_t full_vertex_bytes { 0 };
+	/** @brief Bytes the vertices take in the chosen format */
+	std::size_t vertex_bytes { 0 };
+	std::size_t index_bytes { 0 };
+
+	[[nodiscard]] auto total_bytes() const -> std::size_t { return vertex_bytes + index_bytes; }
+	[[nodiscard]] auto saved_bytes() const -> std::size_t { return full_vertex_bytes - vertex_bytes; }
+
+	auto operator+=(const MeshFootprint& other) -> MeshFootprint&;
+};
+
+namespace CompactVertices {
+
+	[[nodiscard]] auto vertex_size(VertexFormat) -> std::size_t;
+
+	/**
+	 * @brief The layout to build pipelines for vertices in this format with. Shaders decode them with Include/CompactVertex.glsl.
+	 */
+	[[nodiscard]] auto layout(VertexFormat) -> VertexLayout;
+
+	[[nodiscard]] auto footprint(std::size_t vertex_count, std::size_t index_count, VertexFormat) -> MeshFootprint;
+
+	[[nodiscard]] auto encode_uvs(const glm::vec2& uvs) -> std::uint32_t;
+	[[nodiscard]] auto decode_uvs(std::uint32_t encoded) -> glm::vec2;
+
+	[[nodiscard]] auto encode_normal(const glm::vec3& normal) -> std::uint32_t;
+	[[nodiscard]] auto decode_normal(std::uint32_t encoded) -> glm::vec3;
+
+	/**
+	 * @brief The tangent is orthogonalised against the normal first. Without a usable tangent any tangent orthogonal to the normal is chosen.
+	 */
+	[[nodiscard]] auto encode_tangent_frame(const glm::vec3& normal, const glm::vec3& tangent, const glm::vec3& bitangent)
+		-> std::array<std::uint32_t, 2>;
+	[[nodiscard]] auto decode_tangent_frame(const std::array<std::uint32_t, 2>& encoded) -> TangentFrame;
+
+	[[nodiscard]] auto encode_colour(const glm::vec4& colour) -> std::uint32_t;
+	[[nodiscard]] auto decode_colour(std::uint32_t encoded) -> glm::vec4;
+
+	/**
+	 * @brief Maps the bounds of the positions onto [0, 1]. Flat axes keep a scale of one.
+	 */
+	[[nodiscard]] auto dequantisation_for(std::span<const ModelVertex> vertices) -> PositionDequantisation;
+
+	[[nodiscard]] auto encode(std::span<const ModelVertex> vertices) -> std::vector<CompactVertex>;
+	[[nodiscard]] auto encode_quantised(std::span<const ModelVertex> vertices, const PositionDequantisation& dequantisation)
+		-> std::vector<QuantisedCompactVertex>;
+
+	[[nodiscard]] auto decode(const CompactVertex& vertex) -> ModelVertex;
+	[[nodiscard]] auto decode(const QuantisedCompactVertex& vertex, const PositionDequantisation& dequantisation) -> ModelVertex;
+
+} // namespace CompactVertices
+
+} // namespace Disarray
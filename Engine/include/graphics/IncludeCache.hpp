@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace Disarray {
+
+/**
+ * @brief The contents of a shader include, read once and shared by every compilation that includes it. Compilers point glslang straight
+ * at source, so a file stays alive for as long as a compilation holds it, even after the cache has moved on to a newer version.
+ */
+struct IncludeFile {
+	std::filesystem::path path {};
+	std::string source {};
+	std::filesystem::file_time_type last_write_time {};
+	std::uintmax_t size { 0 };
+
+	[[nodiscard]] auto view() const -> std::string_view { return source; }
+};
+
+using IncludeHandle = std::shared_ptr<const IncludeFile>;
+
+struct IncludeCacheStatistics {
+	std::uint64_t hits { 0 };
+	std::uint64_t misses { 0 };
+	std::uint64_t invalidations { 0 };
+	std::uint64_t bytes_read { 0 };
+};
+
+namespace IncludeCache {
+
+	/**
+	 * @brief The include at path, read from disk on the first use and whenever its modification time or size changed since. Nullptr when
+	 * it does not exist or cannot be read. Safe to call from any thread.
+	 */
+	[[nodiscard]] auto get(const std::filesystem::path& path) -> IncludeHandle;
+
+	/**
+	 * @brief Forgets path, for when a file watcher saw it change within the resolution of its modification time.
+	 */
+	void invalidate(const std::filesystem::path& path);
+	void clear();
+
+	[[nodiscard]] auto statistics() -> IncludeCacheStatistics;
+	void reset_statistics();
+
+} // namespace IncludeCache
+
+} // namespace Disarray
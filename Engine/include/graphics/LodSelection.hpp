@@ -0,0 +1,49 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <span>
+
+#include "graphics/AABB.hpp"
+
+namespace Disarray {
+
+struct LodSelectionSettings {
+	/** @brief How far in pixels a level may be from the base mesh on screen */
+	float pixel_error { 1.0F };
+	/** @brief A coarser level is only taken once its error is this fraction below pixel_error, so meshes near a switch do not flicker */
+	float hysteresis { 0.25F };
+	bool enabled { true };
+};
+
+/**
+ * @brief What selection needs from the camera: where it is, and how many pixels a unit at distance one covers.
+ */
+struct LodProjection {
+	glm::vec3 camera_position { 0.0F };
+	float pixels_per_unit { 0.0F };
+};
+
+namespace LodSelection {
+
+	[[nodiscard]] auto projection_for(const glm::mat4& view, const glm::mat4& projection, std::uint32_t viewport_height) -> LodProjection;
+
+	/**
+	 * @brief Pixels per object space unit for a mesh with these bounds, measured at the nearest point of its bounding sphere. Infinite when
+	 * the camera is inside the sphere.
+	 */
+	[[nodiscard]] auto projected_scale(const AABB& bounds, const glm::mat4& transform, const LodProjection& projection) -> float;
+
+	/**
+	 * @brief The coarsest level whose error, scaled to pixels, is within the settings. Moving to a finer level happens as soon as the
+	 * current one is over the bound, moving to a coarser one only once it is under the bound by the hysteresis.
+	 *
+	 * @param level_errors Object space error per level, starting with the base mesh.
+	 */
+	[[nodiscard]] auto select(std::span<const float> level_errors, float scale, std::uint32_t current, const LodSelectionSettings& settings)
+		-> std::uint32_t;
+
+} // namespace LodSelection
+
+} // namespace Disarray
@@ -4,6 +4,7 @@
 
 #include <filesystem>
 #include <future>
+#include <span>
 
 #include "core/Collections.hpp"
 #include "core/DisarrayObject.hpp"
@@ -23,13 +24,46 @@ struct MeshProperties {
 	std::filesystem::path path {};
 	glm::mat4 initial_rotation { 1.0F };
 	ImportFlag flags { default_import_flags };
+	MeshOptimisationSettings optimisation {};
+	LodSettings lods {};
+	MeshletSettings meshlets {};
+	/**
+	 * @brief Anything but Full needs pipelines built with CompactVertices::layout and shaders that decode with CompactVertex.glsl.
+	 */
+	VertexFormat vertex_format { VertexFormat::Full };
 	std::unordered_set<VertexInput> include_inputs = { std::begin(default_vertex_inputs), std::end(default_vertex_inputs) };
 };
 
+struct MeshLod {
+	Scope<Disarray::IndexBuffer> indices {};
+	/** @brief Object space, see SubmeshLod */
+	float error { 0.0F };
+};
+
 struct MeshSubstructure {
 	Scope<Disarray::VertexBuffer> vertices {};
 	Scope<Disarray::IndexBuffer> indices {};
 	std::unordered_set<std::int32_t> texture_indices {};
+	/** @brief Only meaningful for VertexFormat::CompactQuantised */
+	PositionDequantisation dequantisation {};
+	/** @brief Coarser index buffers into the same vertices, level one first */
+	std::vector<MeshLod> lods {};
+	/** @brief Ranges of indices with their bounds, for Meshlets::cull. Empty unless MeshProperties::meshlets is enabled */
+	std::vector<Meshlet> meshlets {};
+	/** @brief Object space bounds of this submesh alone */
+	AABB aabb {};
+	BoundingSphere bounding_sphere {};
+
+	/**
+	 * @brief The indices for a level of detail, where zero is the full mesh. Submeshes with fewer levels draw their coarsest one.
+	 */
+	[[nodiscard]] auto get_indices(std::uint32_t lod) const -> Disarray::IndexBuffer&
+	{
+		if (lod == 0 || lods.empty()) {
+			return *indices;
+		}
+		return *lods[std::min<std::size_t>(lod, lods.size()) - 1].indices;
+	}
 };
 
 class Mesh : public ReferenceCountable {
@@ -42,6 +76,10 @@ public:
 	[[nodiscard]] virtual auto get_textures() const -> const RefVector<Disarray::Texture>& = 0;
 
 	virtual auto get_aabb() const -> const AABB& = 0;
+	/**
+	 * @brief The largest error of any submesh per level of detail, starting with zero for the full mesh. Input to LodSelection::select.
+	 */
+	[[nodiscard]] virtual auto get_lod_errors() const -> std::span<const float> = 0;
 	virtual auto has_children() const -> bool = 0;
 
 	[[nodiscard]] virtual auto invalid() const -> bool = 0;
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "core/filesystem/MappedFile.hpp"
+#include "graphics/AABB.hpp"
+#include "graphics/MeshOptimiser.hpp"
+#include "graphics/MeshSimplifier.hpp"
+#include "graphics/Meshlets.hpp"
+#include "graphics/ModelLoader.hpp"
+#include "graphics/ModelVertex.hpp"
+
+namespace Disarray {
+
+struct CachedLod {
+	std::span<const std::uint32_t> indices {};
+	float error { 0.0F };
+};
+
+struct CachedSubmesh {
+	std::string_view name {};
+	std::span<const ModelVertex> vertices {};
+	std::span<const std::uint32_t> indices {};
+	std::vector<TextureProperties> texture_properties {};
+	std::vector<CachedLod> lods {};
+	std::span<const Meshlet> meshlets {};
+};
+
+/**
+ * @brief A mesh read from a .dmesh file. Vertices, indices and names point straight into the mapped file, so they live as long as this does.
+ */
+class CachedMesh {
+public:
+	explicit CachedMesh(FS::MappedFile in_file, std::vector<CachedSubmesh> in_submeshes, const AABB& in_aabb)
+		: file(std::move(in_file))
+		, submeshes(std::move(in_submeshes))
+		, aabb(in_aabb)
+	{
+	}
+
+	[[nodiscard]] auto get_submeshes() const -> const std::vector<CachedSubmesh>& { return submeshes; }
+	[[nodiscard]] auto find(std::string_view name) const -> const CachedSubmesh*;
+	[[nodiscard]] auto get_aabb() const -> const AABB& { return aabb; }
+
+	/**
+	 * @brief Submeshes with their texture properties only, which is what texture construction needs.
+	 */
+	[[nodiscard]] auto to_texture_tables() const -> ImportedMesh;
+
+private:
+	FS::MappedFile file;
+	std::vector<CachedSubmesh> submeshes;
+	AABB aabb {};
+};
+
+struct MeshCacheConfiguration {
+	bool enabled { true };
+	/** @brief Where .dmesh files are kept. A directory under the system's temporary directory when empty */
+	std::filesystem::path directory {};
+};
+
+namespace MeshCache {
+
+	/**
+	 * @brief Bumped whenever the layout of a .dmesh file or of ModelVertex changes, older files are then ignored.
+	 */
+	inline constexpr std::uint32_t version = 6;
+
+	void configure(const MeshCacheConfiguration& configuration);
+
+	/**
+	 * @brief The cache file for a source as it is now. Keyed by the source's content, the import flags, the initial rotation, the
+	 * optimisation stages, the levels of detail and the meshlets.
+	 */
+	[[nodiscard]] auto cache_path(const std::filesystem::path& source, ImportFlag flags, const glm::mat4& initial_rotation,
+		const MeshOptimisationSettings& optimisation = {}, const LodSettings& lods = {}, const MeshletSettings& meshlets = {})
+		-> std::filesystem::path;
+
+	/**
+	 * @brief The cached import of source, if there is one and it is intact.
+	 */
+	[[nodiscard]] auto load(const std::filesystem::path& source, ImportFlag flags, const glm::mat4& initial_rotation,
+		const MeshOptimisationSettings& optimisation = {}, const LodSettings& lods = {}, const MeshletSettings& meshlets = {})
+		-> std::optional<CachedMesh>;
+
+	/**
+	 * @brief Writes the imported mesh to a temporary file and renames it into place, so readers never see a partial file.
+	 */
+	auto store(const std::filesystem::path& source, ImportFlag flags, const glm::mat4& initial_rotation, const ImportedMesh& mesh, const AABB& aabb,
+		const MeshOptimisationSettings& optimisation = {}, const LodSettings& lods = {}, const MeshletSettings& meshlets = {}) -> bool;
+
+} // namespace MeshCache
+
+} // namespace Disarray
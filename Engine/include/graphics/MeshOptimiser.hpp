@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "graphics/ModelVertex.hpp"
+
+namespace Disarray {
+
+struct MeshOptimisationSettings {
+	/** @brief Reorders triangles so consecutive ones share vertices (Tipsify) */
+	bool vertex_cache { false };
+	/** @brief Sorts clusters of the vertex cache order so outward facing ones are drawn first. Implies vertex_cache */
+	bool overdraw { false };
+	/** @brief Renumbers vertices in the order the indices first use them, dropping unused ones */
+	bool vertex_fetch { false };
+	/** @brief How much worse than the vertex cache order the ACMR of the overdraw order may be */
+	float overdraw_threshold { 1.05F };
+
+	[[nodiscard]] auto any() const -> bool { return vertex_cache || overdraw || vertex_fetch; }
+};
+
+struct VertexCacheStatistics {
+	/** @brief Average cache miss ratio, vertex shader invocations per triangle. Between 0.5 and 3, lower is better */
+	float acmr { 0.0F };
+	/** @brief Average transformed vertex ratio, vertex shader invocations per referenced vertex. At least 1, lower is better */
+	float atvr { 0.0F };
+};
+
+struct MeshOptimisationReport {
+	VertexCacheStatistics before {};
+	VertexCacheStatistics after {};
+};
+
+namespace MeshOptimiser {
+
+	/**
+	 * @brief Size of the FIFO post-transform cache that statistics and optimisation assume.
+	 */
+	inline constexpr std::uint32_t default_cache_size = 16;
+
+	[[nodiscard]] auto analyse_vertex_cache(std::span<const std::uint32_t> indices, std::size_t vertex_count,
+		std::uint32_t cache_size = default_cache_size) -> VertexCacheStatistics;
+
+	/**
+	 * @brief Tipsify, from Sander, Nehab and Barczak, "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw".
+	 */
+	[[nodiscard]] auto optimise_vertex_cache(std::span<const std::uint32_t> indices, std::size_t vertex_count,
+		std::uint32_t cache_size = default_cache_size) -> std::vector<std::uint32_t>;
+
+	/**
+	 * @brief Splits indices, which should already be in vertex cache order, into clusters and sorts those from the outside of the mesh
+	 * in. Clusters end where the cache would have been flushed anyway, or where their ACMR reaches threshold times that of the whole.
+	 */
+	[[nodiscard]] auto optimise_overdraw(std::span<const std::uint32_t> indices, std::span<const ModelVertex> vertices, float threshold,
+		std::uint32_t cache_size = default_cache_size) -> std::vector<std::uint32_t>;
+
+	/**
+	 * @brief Reorders vertices to match the order indices first reference them in and rewrites indices to match.
+	 */
+	void optimise_vertex_fetch(std::vector<ModelVertex>& vertices, std::vector<std::uint32_t>& indices);
+
+	/**
+	 * @brief Runs the enabled stages in order: vertex cache, overdraw and then vertex fetch.
+	 */
+	auto optimise(std::vector<ModelVertex>& vertices, std::vector<std::uint32_t>& indices, const MeshOptimisationSettings& settings)
+		-> MeshOptimisationReport;
+
+} // namespace MeshOptimiser
+
+} // namespace Disarray
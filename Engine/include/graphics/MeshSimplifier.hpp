@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "graphics/ModelVertex.hpp"
+
+namespace Disarray {
+
+struct LodSettings {
+	/** @brief Triangle count of every level as a fraction of the base mesh, finest first. No levels are built when empty */
+	std::vector<float> ratios {};
+	/** @brief Largest error a level may have, relative to the diagonal of the bounds of its submesh */
+	float max_error { 0.05F };
+
+	[[nodiscard]] auto any() const -> bool { return !ratios.empty(); }
+};
+
+/**
+ * @brief A simplified index buffer into the vertices of the submesh it was built from.
+ */
+struct SubmeshLod {
+	std::vector<std::uint32_t> indices {};
+	/** @brief Estimated distance from the base mesh, in object space units */
+	float error { 0.0F };
+};
+
+struct SimplificationResult {
+	std::vector<std::uint32_t> indices {};
+	float error { 0.0F };
+};
+
+namespace MeshSimplifier {
+
+	/**
+	 * @brief Collapses edges in order of their quadric error (Garland and Heckbert, "Surface Simplification Using Quadric Error Metrics")
+	 * until at most target_index_count indices are left or the next collapse would exceed max_error, in object space units.
+	 *
+	 * Vertices only move onto their neighbours, so the output indexes the same vertices. Vertices on open borders and attribute seams only
+	 * move along them, and vertices where seams meet or the mesh is non-manifold never move.
+	 */
+	[[nodiscard]] auto simplify(std::span<const std::uint32_t> indices, std::span<const ModelVertex> vertices, std::size_t target_index_count,
+		float max_error) -> SimplificationResult;
+
+	/**
+	 * @brief One level per ratio, each simplified from the base mesh and put in vertex cache order. Stops early once a level is no
+	 * smaller than the one before, usually because the error bound was reached. Errors never decrease from one level to the next.
+	 */
+	[[nodiscard]] auto generate_lods(std::span<const std::uint32_t> indices, std::span<const ModelVertex> vertices, const LodSettings& settings)
+		-> std::vector<SubmeshLod>;
+
+} // namespace MeshSimplifier
+
+} // namespace Disarray
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "graphics/ModelVertex.hpp"
+
+namespace Disarray {
+
+struct MeshletSettings {
+	bool enabled { false };
+	std::uint32_t max_vertices { 64 };
+	std::uint32_t max_triangles { 124 };
+	/** @brief How much a triangle that bends the normal cone counts against one that adds a vertex, from zero to about one half */
+	float cone_weight { 0.25F };
+};
+
+/**
+ * @brief Object space bounds of a meshlet. The cone holds the face normals of its triangles, taking counter clockwise ones as front facing.
+ */
+struct MeshletBounds {
+	glm::vec3 centre { 0.0F };
+	float radius { 0.0F };
+	glm::vec3 minimum { 0.0F };
+	glm::vec3 maximum { 0.0F };
+	glm::vec3 cone_axis { 0.0F, 0.0F, 1.0F };
+	/** @brief Sine of the cone's half angle, one when the normals spread over a hemisphere or more and the cone culls nothing */
+	float cone_cutoff { 1.0F };
+
+	[[nodiscard]] auto has_cone() const -> bool { return cone_cutoff < 1.0F; }
+};
+
+/**
+ * @brief A run of whole triangles in the submesh's index buffer that touches at most MeshletSettings::max_vertices vertices.
+ */
+struct Meshlet {
+	std::uint32_t first_index { 0 };
+	std::uint32_t index_count { 0 };
+	std::uint32_t vertex_count { 0 };
+	std::uint32_t padding { 0 };
+	MeshletBounds bounds {};
+
+	[[nodiscard]] auto triangle_count() const -> std::uint32_t { return index_count / 3; }
+};
+
+struct IndexRange {
+	std::uint32_t first_index { 0 };
+	std::uint32_t index_count { 0 };
+
+	auto operator==(const IndexRange&) const -> bool = default;
+};
+
+struct MeshletStatistics {
+	std::size_t meshlet_count { 0 };
+	/** @brief Mean vertices and triangles per meshlet as a fraction of the limits */
+	float vertex_fill { 0.0F };
+	float triangle_fill { 0.0F };
+	/** @brief Mean sine of the cone half angles, counting meshlets without a cone as one */
+	float mean_cone_cutoff { 0.0F };
+	std::size_t meshlets_with_cones { 0 };
+};
+
+/**
+ * @brief Frustum planes and camera position in the object space of one mesh, so meshlet bounds are tested without being transformed.
+ */
+struct MeshletCullingView {
+	/** @brief Left, right, bottom, top, near and far, normalised, pointing inwards */
+	std::array<glm::vec4, 6> planes {};
+	glm::vec3 camera_position { 0.0F };
+};
+
+struct MeshletCullingStatistics {
+	std::size_t visible { 0 };
+	std::size_t frustum_culled { 0 };
+	std::size_t cone_culled { 0 };
+	std::size_t visible_indices { 0 };
+};
+
+namespace Meshlets {
+
+	/**
+	 * @brief Greedily grows meshlets out of triangles that share the most vertices with them and bend their normal cone the least, and
+	 * reorders the indices so every meshlet is a contiguous run. Triangles are kept whole and none is dropped.
+	 */
+	[[nodiscard]] auto build(std::vector<std::uint32_t>& indices, std::span<const ModelVertex> vertices, const MeshletSettings& settings)
+		-> std::vector<Meshlet>;
+
+	/**
+	 * @brief Cuts the indices into meshlets where the next triangle would go over a limit, and leaves their order alone. For index buffers
+	 * in vertex cache order, whose gains build would throw away: the meshlets are less compact, and so cull less, than those of build.
+	 */
+	[[nodiscard]] auto build_in_order(std::span<const std::uint32_t> indices, std::span<const ModelVertex> vertices, const MeshletSettings& settings)
+		-> std::vector<Meshlet>;
+
+	[[nodiscard]] auto compute_bounds(std::span<const std::uint32_t> triangle_indices, std::span<const ModelVertex> vertices) -> MeshletBounds;
+
+	[[nodiscard]] auto statistics(std::span<const Meshlet> meshlets, const MeshletSettings& settings) -> MeshletStatistics;
+
+	/**
+	 * @brief Gribb and Hartmann plane extraction from projection * view * transform. The near plane is taken as w + z, which is exact for
+	 * a [-1, 1] depth range and conservative for [0, 1].
+	 */
+	[[nodiscard]] auto culling_view(const glm::mat4& view, const glm::mat4& projection, const glm::mat4& transform) -> MeshletCullingView;
+
+	/**
+	 * @brief False when the meshlet is outside one of the frustum planes, or every one of its triangles faces away from the camera.
+	 */
+	[[nodiscard]] auto is_visible(const MeshletBounds& bounds, const MeshletCullingView& view) -> bool;
+
+	/**
+	 * @brief Writes the index ranges of the visible meshlets to output, merging neighbours, so each range is one indexed draw.
+	 */
+	auto cull(std::span<const Meshlet> meshlets, const MeshletCullingView& view, std::vector<IndexRange>& output) -> MeshletCullingStatistics;
+
+} // namespace Meshlets
+
+} // namespace Disarray
@@ -7,6 +7,10 @@
 #include "core/Collections.hpp"
 #include "core/PointerDefinition.hpp"
 #include "graphics/AABB.hpp"
+#include "graphics/CompactVertex.hpp"
+#include "graphics/MeshOptimiser.hpp"
+#include "graphics/MeshSimplifier.hpp"
+#include "graphics/Meshlets.hpp"
 #include "graphics/ModelVertex.hpp"
 #include "graphics/Texture.hpp"
 
@@ -20,6 +24,10 @@ struct Submesh {
 	std::vector<uint32_t> indices {};
 	std::vector<Disarray::TextureProperties> texture_properties {};
 	std::vector<Ref<Disarray::Texture>> textures {};
+	/** @brief Coarser index buffers into the same vertices, finest first */
+	std::vector<SubmeshLod> lods {};
+	/** @brief Contiguous runs of indices, empty unless meshlets were built */
+	std::vector<Meshlet> meshlets {};
 
 	template <SubmeshMember T> [[nodiscard]] auto count() const -> std::size_t
 	{
@@ -128,9 +136,29 @@ public:
 	explicit ModelLoader() = default;
 	explicit ModelLoader(Scope<IModelImporter>);
 	explicit ModelLoader(Scope<IModelImporter>, const std::filesystem::path&, ImportFlag);
+	/**
+	 * @brief For mesh data that was already imported, e.g. from the mesh cache.
+	 */
+	explicit ModelLoader(const std::filesystem::path&, ImportedMesh);
 	void import_model(const std::filesystem::path&, ImportFlag);
 	[[nodiscard]] auto construct_textures(const Device&) -> std::vector<Ref<Disarray::Texture>>;
 
+	/**
+	 * @brief Optimises every submesh on the thread pool and logs their vertex cache statistics before and after.
+	 */
+	auto optimise(const MeshOptimisationSettings&) -> Collections::StringMap<MeshOptimisationReport>;
+
+	/**
+	 * @brief Simplifies every submesh on the thread pool into its levels of detail. Run after optimise, which renumbers the vertices.
+	 */
+	auto generate_lods(const LodSettings&) -> void;
+
+	/**
+	 * @brief Splits every submesh into meshlets on the thread pool. Run after optimise: indices it put in vertex cache order are cut into
+	 * meshlets as they are, any others are reordered into more compact meshlets.
+	 */
+	auto build_meshlets(const MeshletSettings&) -> void;
+
 	[[nodiscard]] auto get_mesh_data() -> const ImportedMesh& { return mesh_data; }
 	[[nodiscard]] auto get_aabb() const -> AABB;
 
@@ -138,6 +166,7 @@ private:
 	Scope<IModelImporter> importer { nullptr };
 	std::filesystem::path mesh_path {};
 	ImportedMesh mesh_data {};
+	bool in_vertex_cache_order { false };
 };
 
 } // namespace Disarray
@@ -51,6 +51,11 @@ enum class ElementType : std::uint8_t {
 	Uint2,
 	Uint3,
 	Uint4,
+	Half2,
+	Snorm16x2,
+	Snorm16x4,
+	Unorm16x4,
+	Unorm8x4,
 };
 enum class VertexInput : std::uint8_t {
 	Position,
@@ -82,6 +87,13 @@ static constexpr auto to_size(ElementType type) -> std::size_t
 		return sizeof(float) * 4;
 	case ElementType::Uint:
 		return sizeof(std::uint32_t);
+	case ElementType::Half2:
+	case ElementType::Snorm16x2:
+	case ElementType::Unorm8x4:
+		return sizeof(std::uint32_t);
+	case ElementType::Snorm16x4:
+	case ElementType::Unorm16x4:
+		return sizeof(std::uint64_t);
 	default:
 		unreachable("Could not map to size.");
 	}
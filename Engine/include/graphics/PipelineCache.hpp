@@ -4,7 +4,9 @@
 
 #include <algorithm>
 #include <filesystem>
+#include <mutex>
 #include <set>
+#include <span>
 #include <unordered_map>
 #include <utility>
 
@@ -13,6 +15,8 @@
 #include "graphics/PushConstantLayout.hpp"
 #include "graphics/ResourceCache.hpp"
 #include "graphics/Shader.hpp"
+#include "graphics/ShaderDependencyGraph.hpp"
+#include "graphics/ShaderKeywords.hpp"
 #include "graphics/Swapchain.hpp"
 
 using VkDescriptorSetLayout = struct VkDescriptorSetLayout_T*;
@@ -39,6 +43,8 @@ struct PipelineCacheCreationProperties {
 	bool test_depth { true };
 	std::vector<VkDescriptorSetLayout> descriptor_set_layouts {};
 	SpecialisationConstantDescription specialisation_constant {};
+	/** @brief Keywords to compile both stages with, see ShaderKeywords. Each stage ignores those it does not declare */
+	std::vector<std::string> shader_keywords {};
 };
 
 class PipelineCache : public ResourceCache<Ref<Disarray::Pipeline>, PipelineCacheCreationProperties, PipelineCache, std::string, StringHash> {
@@ -57,8 +63,8 @@ public:
 	auto create_from_impl(const PipelineCacheCreationProperties& props) -> Ref<Disarray::Pipeline>
 	{
 		PipelineProperties properties {
-			.vertex_shader = shader_cache[props.vertex_shader_key],
-			.fragment_shader = shader_cache[props.fragment_shader_key],
+			.vertex_shader = get_shader_variant(props.vertex_shader_key, props.shader_keywords),
+			.fragment_shader = get_shader_variant(props.fragment_shader_key, props.shader_keywords),
 			.framebuffer = props.framebuffer,
 			.layout = props.layout,
 			.push_constant_layout = props.push_constant_layout,
@@ -75,6 +81,16 @@ public:
 			.specialisation_constants = props.specialisation_constant,
 		};
 
+		pipeline_stages.insert_or_assign(props.pipeline_key,
+			PipelineStages {
+				.vertex_shader = props.vertex_shader_key,
+				.fragment_shader = props.fragment_shader_key,
+				.keywords = props.shader_keywords,
+			});
+		{
+			std::scoped_lock lock { reload_mutex };
+			dependencies.add_pipeline(props.pipeline_key, props.vertex_shader_key, props.fragment_shader_key);
+		}
 		return Pipeline::construct(get_device(), properties);
 	}
 
@@ -94,7 +110,72 @@ public:
 		return shader_cache.at(key.string());
 	}
 
+	/**
+	 * @brief The shader compiled with the keywords it declares out of keywords, compiled now if no pipeline has used that permutation yet.
+	 * Falls back to the shader without keywords if the permutation does not compile.
+	 */
+	auto get_shader_variant(const std::string& shader_key, std::span<const std::string> keywords) -> const Ref<Shader>&;
+
+	/**
+	 * @brief Compiles the permutations that are not compiled yet in parallel, each distinct one once, e.g. at startup so that creating
+	 * pipelines later does not stall on the compiler.
+	 */
+	void precompile_variants(std::span<const ShaderVariantRequest> requests);
+
+	/**
+	 * @brief Recompiles, on the calling thread, only the shaders that are or include the changed file. They are kept for apply_reloads
+	 * only if every one of them compiled, so a pipeline never mixes an old and a new stage. The variants of a shader whose keywords
+	 * changed are not recompiled, apply_reloads drops them instead.
+	 */
+	void reload_affected_by(const std::filesystem::path& changed);
+
+	/**
+	 * @brief Swaps in the shaders of finished reloads and recreates the pipelines that use them, no others. Call it from the render thread.
+	 * Returns how many pipelines were recreated.
+	 */
+	auto apply_reloads() -> std::size_t;
+
 private:
+	struct ShaderReload {
+		Collections::StringMap<Ref<Shader>> shaders {};
+		std::vector<std::string> pipelines {};
+		// Shaders whose keywords changed, so their variants are dropped rather than recompiled.
+		std::vector<std::string> stale_variants {};
+	};
+
+	struct CompiledVariant {
+		std::string key {};
+		std::string defines {};
+	};
+
+	struct CompiledVariants {
+		// What the masks in the keys were packed against.
+		std::vector<std::string> keywords {};
+		std::vector<CompiledVariant> variants {};
+	};
+
+	// The stages are kept as shader keys and keywords, not variant keys, so that they are packed again when the keywords change.
+	struct PipelineStages {
+		std::string vertex_shader {};
+		std::string fragment_shader {};
+		std::vector<std::string> keywords {};
+	};
+
+	auto keywords_of(std::string_view shader_key) -> const ShaderKeywords&;
+	auto variant_of(std::string_view shader_key, std::span<const std::string> keywords) -> ShaderVariant;
+	void add_variant(const ShaderVariant& variant, std::string defines, Ref<Shader> shader);
+
+	// Variants are kept next to their shaders, under ShaderVariant::key.
 	std::unordered_map<std::string, Ref<Shader>> shader_cache {};
+	Collections::StringMap<std::filesystem::path> shader_paths {};
+	Collections::StringMap<ShaderKeywords> shader_keywords {};
+	Collections::StringMap<PipelineStages> pipeline_stages {};
+
+	// Guards the graph, the variants to recompile with each shader and the finished reloads, which the file watcher thread and the render
+	// thread both touch.
+	std::mutex reload_mutex {};
+	ShaderDependencyGraph dependencies {};
+	Collections::StringMap<CompiledVariants> compiled_variants {};
+	std::vector<ShaderReload> finished_reloads {};
 };
 } // namespace Disarray
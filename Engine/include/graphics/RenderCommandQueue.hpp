@@ -1,23 +1,95 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
 #include "Forward.hpp"
 #include "core/UsageBadge.hpp"
 
 namespace Disarray {
 
+/**
+ * @brief Commands are placement-constructed into a chunked byte arena, behind a small header with a trampoline that runs and destroys them.
+ * Any thread can allocate: space is reserved with a single atomic add, and a record is published by its ready flag.
+ * execute runs the commands in the order their space was reserved, and keeps the chunks for the next frame.
+ */
 class RenderCommandQueue {
 public:
-	using RenderCommandFunction = std::function<void()>;
+	static constexpr std::size_t chunk_size = 64ULL * 1024ULL;
+	static constexpr std::size_t max_chunks = 1024;
+
 	explicit RenderCommandQueue(UsageBadge<Renderer>);
 	~RenderCommandQueue();
 
-	void allocate(RenderCommandFunction&& func);
+	RenderCommandQueue(const RenderCommandQueue&) = delete;
+	RenderCommandQueue(RenderCommandQueue&&) = delete;
+	auto operator=(const RenderCommandQueue&) -> RenderCommandQueue& = delete;
+	auto operator=(RenderCommandQueue&&) -> RenderCommandQueue& = delete;
+
+	template <class Func> void allocate(Func&& func)
+	{
+		using Command = std::decay_t<Func>;
+		static_assert(std::is_invocable_v<Command&>, "Render commands take no arguments.");
+		static_assert(alignof(Command) <= record_alignment, "Over-aligned render commands are not supported.");
+
+		constexpr auto size = record_size(sizeof(Command));
+		static_assert(size <= chunk_size / 2, "Render command is too large, capture a pointer to the data instead.");
+
+		auto* header = reserve(size);
+		::new (payload(header)) Command(std::forward<Func>(func));
+		header->invoke = [](void* storage, bool run) {
+			struct Destroy {
+				Command* command;
+				~Destroy() { command->~Command(); }
+			} destroy { std::launder(static_cast<Command*>(storage)) };
+			if (run) {
+				(*destroy.command)();
+			}
+		};
+		header->ready.store(1, std::memory_order_release);
+	}
+
+	/**
+	 * @brief Runs every command in submission order. Must not be called while other threads, or the commands themselves, are still allocating.
+	 * If a command throws, the remaining commands are destroyed without running and the exception is rethrown.
+	 */
 	void execute();
 
+	[[nodiscard]] auto get_bytes_used() const -> std::size_t { return write_offset.load(std::memory_order_relaxed); }
+
 private:
-	static constexpr auto function_size = sizeof(RenderCommandFunction);
-	std::array<RenderCommandFunction, 10'000 / function_size> storage_buffer;
-	std::uint32_t command_count { 0 };
+	using Invoker = void (*)(void*, bool);
+
+	struct alignas(16) CommandHeader {
+		// nullptr marks padding at the end of a chunk.
+		Invoker invoke { nullptr };
+		std::uint32_t size { 0 };
+		std::atomic<std::uint32_t> ready { 0 };
+	};
+	static constexpr std::size_t record_alignment = alignof(CommandHeader);
+	static_assert(sizeof(CommandHeader) == record_alignment);
+	static_assert(chunk_size % record_alignment == 0);
+
+	static constexpr auto record_size(std::size_t payload_size) -> std::size_t
+	{
+		return sizeof(CommandHeader) + (payload_size + record_alignment - 1) / record_alignment * record_alignment;
+	}
+	static auto payload(CommandHeader* header) -> void* { return reinterpret_cast<std::byte*>(header) + sizeof(CommandHeader); }
+
+	auto reserve(std::size_t size) -> CommandHeader*;
+	auto get_chunk(std::size_t index) -> std::byte*;
+	void write_padding(std::size_t offset, std::size_t size);
+	void destroy_from(std::size_t offset, std::size_t end);
+	auto wait_for_record(std::size_t offset) -> CommandHeader*;
+
+	std::array<std::atomic<std::byte*>, max_chunks> chunks {};
+	alignas(64) std::atomic<std::size_t> write_offset { 0 };
 };
 
 } // namespace Disarray
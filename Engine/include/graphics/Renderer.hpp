@@ -10,6 +10,7 @@
 #include <span>
 #include <tuple>
 
+#include "core/FrameAllocator.hpp"
 #include "core/Types.hpp"
 #include "graphics/CommandExecutor.hpp"
 #include "graphics/IndexBuffer.hpp"
@@ -156,21 +157,21 @@ public:
 
 	template <typename... Args> void draw_text(const glm::uvec2& position, fmt::format_string<Args...> fmt_string, Args&&... args)
 	{
-		return draw_text(fmt::format(fmt_string, std::forward<Args>(args)...), position, 1.0F);
+		return draw_text(frame_format(fmt_string, std::forward<Args>(args)...), position, 1.0F);
 	};
 	template <typename... Args> void draw_text(const glm::vec3& position, fmt::format_string<Args...> fmt_string, Args&&... args)
 	{
-		return draw_text(fmt::format(fmt_string, std::forward<Args>(args)...), position, 1.0F);
+		return draw_text(frame_format(fmt_string, std::forward<Args>(args)...), position, 1.0F);
 	};
 	template <typename... Args>
 	void draw_text(const glm::uvec2& position, const glm::vec4& colour, fmt::format_string<Args...> fmt_string, Args&&... args)
 	{
-		return draw_text(fmt::format(fmt_string, std::forward<Args>(args)...), position, 1.0F, colour);
+		return draw_text(frame_format(fmt_string, std::forward<Args>(args)...), position, 1.0F, colour);
 	};
 	template <typename... Args>
 	void draw_text(const glm::vec3& position, const glm::vec4& colour, fmt::format_string<Args...> fmt_string, Args&&... args)
 	{
-		return draw_text(fmt::format(fmt_string, std::forward<Args>(args)...), position, 1.0F, colour);
+		return draw_text(frame_format(fmt_string, std::forward<Args>(args)...), position, 1.0F, colour);
 	};
 
 	virtual void set_scissors(Disarray::CommandExecutor& executor, const glm::vec2& scissor_extent, const glm::vec2& offset) = 0;
@@ -39,26 +39,26 @@ public:
 
 	auto contains(const Key& key) -> bool { return storage.contains(key); }
 
-	auto put(const Props& props) -> const Resource&
+	auto put(Props props) -> const Resource&
 	{
 		const auto key = create_key(props);
 		if (contains(key)) {
 			return get(key);
 		}
 
-		auto resource = create_from(props);
+		auto resource = create_from(std::move(props));
 		const auto& [pair, could] = storage.try_emplace(std::move(key), std::move(resource));
 		return pair->second;
 	}
 
-	auto try_put(const Props& props) -> std::tuple<bool, const Resource&>
+	auto try_put(Props props) -> std::tuple<bool, const Resource&>
 	{
 		const auto key = create_key(props);
 		if (contains(key)) {
 			return { false, get(key) };
 		}
 
-		auto resource = create_from(props);
+		auto resource = create_from(std::move(props));
 		const auto& [pair, could] = storage.try_emplace(std::move(key), std::move(resource));
 		return { could, pair->second };
 	}
@@ -66,7 +66,8 @@ public:
 	template <class Func> void for_each_in_storage(Func&& func) { Collections::for_each(storage, std::forward<Func>(func)); }
 
 	void force_recreation(const Extent& extent) { return get_child().force_recreation_impl(extent); };
-	auto create_from(const Props& props) -> Resource { return get_child().create_from_impl(props); }
+	// Props are handed over, so that e.g. decoded pixels move into the resource instead of being copied.
+	auto create_from(Props&& props) -> Resource { return get_child().create_from_impl(std::move(props)); }
 	auto create_key(const Props& props) -> Key
 	{
 		auto key = Child::create_key(props);
@@ -10,6 +10,7 @@
 #include "core/DisarrayObject.hpp"
 #include "core/ReferenceCounted.hpp"
 #include "core/Types.hpp"
+#include "graphics/SpirvCache.hpp"
 
 namespace Disarray {
 
@@ -56,6 +57,8 @@ inline auto to_shader_type(const std::filesystem::path& path_like)
 
 struct ShaderProperties {
 	std::optional<std::vector<std::uint32_t>> code { std::nullopt };
+	/** @brief Reflection of code, e.g. from ShaderCompiler::compile_cached. Reflected again when missing */
+	std::optional<ShaderReflection> reflection { std::nullopt };
 	std::optional<std::filesystem::path> path { std::nullopt };
 	std::filesystem::path identifier;
 	ShaderType type { ShaderType::Vertex };
@@ -4,9 +4,14 @@
 
 #include <filesystem>
 #include <memory>
+#include <span>
+#include <string_view>
 #include <vector>
 
 #include "core/Collections.hpp"
+#include "core/filesystem/MappedFile.hpp"
+#include "graphics/IncludeCache.hpp"
+#include "graphics/SpirvCache.hpp"
 
 namespace Disarray {
 enum class ShaderType : std::uint8_t;
@@ -17,12 +22,20 @@ namespace Disarray::Runtime {
 class BasicIncluder {
 public:
 	explicit BasicIncluder(std::filesystem::path directory = "Assets/Shaders/Include");
-	void replace_all_includes(std::string&);
+
+	/**
+	 * @brief Splits source into pieces with the source of each known include in place of its #include directive, each include at most once.
+	 * Nothing is copied, the pieces point into source and into the IncludeCache, whose files are added to includes to keep them alive.
+	 */
+	void expand_includes(std::string_view source, std::vector<std::string_view>& pieces, std::vector<IncludeHandle>& includes) const;
 
 private:
-	auto check_and_replace(std::string& io_string, std::string_view to_find);
+	void expand_includes(std::string_view source, std::vector<std::string_view>& pieces, std::vector<IncludeHandle>& includes,
+		Collections::StringSet& expanded) const;
+	[[nodiscard]] auto path_of(std::string_view name) const -> std::filesystem::path;
 
-	Collections::StringMap<std::string> include_include_source_map {};
+	std::filesystem::path include_directory {};
+	Collections::StringMap<std::filesystem::path> include_paths {};
 	static inline const Collections::StringViewSet extensions = { ".vert", ".frag", ".comp", ".glsl" };
 };
 
@@ -38,11 +51,24 @@ public:
 	auto compile(const std::filesystem::path&, ShaderType) -> Code;
 	auto try_compile(const std::filesystem::path&, ShaderType) -> std::pair<bool, Code>;
 
+	/**
+	 * @brief Looks the shader up in the SpirvCache by its source with the includes in place, and only compiles and reflects it on a miss,
+	 * storing the result. A hit does no glslang or SPIRV-Cross work. The code is empty when the shader does not compile.
+	 * Defines, see ShaderKeywords::defines_for, are put right after the #version directive and are part of the cache key.
+	 */
+	auto compile_cached(const std::filesystem::path&, ShaderType, std::string_view defines = {}) -> CompiledShader;
+
+	static auto reflect(std::span<const std::uint32_t> code) -> ShaderReflection;
+
 	static void initialize();
 	static void destroy();
 
 private:
-	void add_include_extension(std::string& glsl_code);
+	void expand_source(const FS::MappedFile& file, const std::filesystem::path&, ShaderType, std::string_view defines,
+		std::vector<std::string_view>& pieces, std::vector<IncludeHandle>& includes);
+	auto compile_pieces(const std::filesystem::path&, std::span<const std::string_view> pieces, ShaderType) -> Code;
+	void add_include_extension(
+		std::string_view glsl_code, std::string_view defines, std::vector<std::string_view>& pieces, std::vector<IncludeHandle>& includes);
 
 	BasicIncluder includer;
 
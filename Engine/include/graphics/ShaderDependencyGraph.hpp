@@ -0,0 +1,72 @@
+#pragma once
+
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "core/Collections.hpp"
+
+namespace Disarray {
+
+/**
+ * @brief Returns the contents of a file, or nothing if it cannot be read. Tests swap the disk for a map of sources.
+ */
+using ShaderSourceReader = std::function<std::optional<std::string>(const std::filesystem::path&)>;
+
+struct ShaderReloadPlan {
+	/** @brief Shaders to recompile, sorted. Their keys are their file names, as in PipelineCache */
+	std::vector<std::filesystem::path> shaders {};
+	/** @brief Pipelines that use any of the shaders, sorted */
+	std::vector<std::string> pipelines {};
+
+	[[nodiscard]] auto empty() const -> bool { return shaders.empty(); }
+};
+
+/**
+ * @brief Which files every shader includes, directly or through other includes, and which shaders every pipeline uses. Files are known
+ * by their file name, since that is how both shaders and includes are looked up. Includes are resolved like BasicIncluder resolves
+ * them, from the include directory.
+ */
+class ShaderDependencyGraph {
+public:
+	explicit ShaderDependencyGraph(std::filesystem::path include_directory = "Assets/Shaders/Include");
+	ShaderDependencyGraph(std::filesystem::path include_directory, ShaderSourceReader reader);
+
+	/**
+	 * @brief Reads the shader and, transitively, the files it includes.
+	 */
+	void add_shader(const std::filesystem::path& path);
+	void add_pipeline(std::string_view pipeline, std::string_view vertex_shader, std::string_view fragment_shader);
+
+	/**
+	 * @brief Every file the shader includes, directly or not, sorted.
+	 */
+	[[nodiscard]] auto includes_of(std::string_view shader) const -> std::vector<std::string>;
+
+	/**
+	 * @brief Re-reads the changed file, whose includes may have changed too, and returns the shaders that are or include it, and the
+	 * pipelines that use those. Nothing else is in the plan.
+	 */
+	auto on_changed(const std::filesystem::path& changed) -> ShaderReloadPlan;
+
+	/**
+	 * @brief The names in the #include "name" directives of source, in order.
+	 */
+	[[nodiscard]] static auto parse_includes(std::string_view source) -> std::vector<std::string_view>;
+
+private:
+	void scan(const std::string& name);
+	[[nodiscard]] auto path_of(std::string_view name) const -> std::filesystem::path;
+
+	std::filesystem::path include_directory {};
+	ShaderSourceReader reader {};
+	Collections::StringMap<std::filesystem::path> shaders {};
+	Collections::StringMap<std::vector<std::string>> direct_includes {};
+	Collections::StringMap<std::pair<std::string, std::string>> pipelines {};
+};
+
+} // namespace Disarray
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Disarray {
+
+/**
+ * @brief One bit per keyword a shader declares, in the order it declares them. Zero is the shader without any keyword.
+ */
+using KeywordMask = std::uint64_t;
+
+/**
+ * @brief The keywords a shader can be compiled with, declared in its source as
+ * @code
+ * #pragma keywords SHADOWS NORMAL_MAPPING
+ * #pragma keywords ALPHA_TEST
+ * @endcode
+ * Every permutation is compiled with a #define for each keyword it enables, so the shader can strip the features it does not use
+ * with #ifdef instead of branching on them at runtime.
+ */
+class ShaderKeywords {
+public:
+	static constexpr std::size_t max_keywords = 64;
+
+	ShaderKeywords() = default;
+	explicit ShaderKeywords(std::vector<std::string> keywords);
+
+	/**
+	 * @brief Collects the keywords of every #pragma keywords line, skipping repeats and anything that is not an identifier.
+	 */
+	[[nodiscard]] static auto parse(std::string_view source) -> ShaderKeywords;
+
+	/**
+	 * @brief Packs the enabled keywords into a mask. Keywords the shader does not declare cannot change its code, so they are ignored,
+	 * which makes requests that differ only in those, in order or in repeats the same permutation.
+	 */
+	[[nodiscard]] auto mask_of(std::span<const std::string> enabled) const -> KeywordMask;
+	[[nodiscard]] auto enabled_in(KeywordMask mask) const -> std::vector<std::string_view>;
+
+	/**
+	 * @brief A #define line for each keyword in the mask, in declaration order.
+	 */
+	[[nodiscard]] auto defines_for(KeywordMask mask) const -> std::string;
+
+	[[nodiscard]] auto get_keywords() const -> const std::vector<std::string>& { return keywords; }
+	[[nodiscard]] auto empty() const -> bool { return keywords.empty(); }
+
+private:
+	std::vector<std::string> keywords {};
+};
+
+struct ShaderVariantRequest {
+	std::string shader {};
+	std::vector<std::string> keywords {};
+};
+
+struct ShaderVariant {
+	std::string shader {};
+	KeywordMask mask { 0 };
+
+	/**
+	 * @brief What the variant is cached under: the shader key for mask zero, so that it is the shader itself, with the mask appended otherwise.
+	 */
+	[[nodiscard]] auto key() const -> std::string;
+
+	auto operator<=>(const ShaderVariant&) const = default;
+};
+
+/**
+ * @brief Packs every request with the keywords of its shader and drops those that come out as the same permutation. Sorted.
+ */
+[[nodiscard]] auto resolve_variants(std::span<const ShaderVariantRequest> requests,
+	const std::function<const ShaderKeywords&(std::string_view shader)>& keywords_of) -> std::vector<ShaderVariant>;
+
+} // namespace Disarray
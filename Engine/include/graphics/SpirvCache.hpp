@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace Disarray {
+
+/**
+ * @brief What the renderer needs to know about a shader beyond its code, read from the SPIR-V with SPIRV-Cross.
+ */
+struct ShaderReflection {
+	/** @brief Colour outputs of a fragment shader, zero for every other stage */
+	std::uint32_t attachment_count { 0 };
+};
+
+struct CompiledShader {
+	std::vector<std::uint32_t> code {};
+	ShaderReflection reflection {};
+};
+
+struct SpirvCacheConfiguration {
+	bool enabled { true };
+	/** @brief Where .dspv files are kept. A directory under the system's temporary directory when empty */
+	std::filesystem::path directory {};
+	/** @brief Least recently used files are removed after a store until the cache fits */
+	std::uint64_t max_bytes { 64ULL * 1024 * 1024 };
+};
+
+namespace SpirvCache {
+
+	/**
+	 * @brief Bumped whenever the layout of a .dspv file or of ShaderReflection changes, older files are then ignored.
+	 */
+	inline constexpr std::uint32_t version = 1;
+
+	void configure(const SpirvCacheConfiguration& configuration);
+	[[nodiscard]] auto directory() -> std::filesystem::path;
+
+	/**
+	 * @brief Hashes a shader source given as pieces, see BasicIncluder::expand_includes, into a key seeded with everything else that
+	 * changes the output: the stage, the resource limits and the compiler options.
+	 */
+	[[nodiscard]] auto key_for(std::span<const std::string_view> pieces, std::uint64_t compiler_seed) -> std::uint64_t;
+
+	/**
+	 * @brief The cached shader for key, if there is one and it is intact. A hit marks the file as recently used.
+	 */
+	[[nodiscard]] auto load(std::uint64_t key) -> std::optional<CompiledShader>;
+
+	/**
+	 * @brief Writes the shader to a temporary file and renames it into place, so readers never see a partial file, then evicts.
+	 */
+	auto store(std::uint64_t key, const CompiledShader& shader) -> bool;
+
+	/**
+	 * @brief Removes the least recently used files until the cache takes at most max_bytes. Returns how many were removed.
+	 */
+	auto evict(std::uint64_t max_bytes) -> std::size_t;
+
+} // namespace SpirvCache
+
+} // namespace Disarray
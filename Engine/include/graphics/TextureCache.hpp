@@ -8,6 +8,7 @@
 #include <unordered_map>
 #include <utility>
 
+#include "core/DataBuffer.hpp"
 #include "core/Types.hpp"
 #include "graphics/PushConstantLayout.hpp"
 #include "graphics/ResourceCache.hpp"
@@ -23,6 +24,9 @@ struct TextureCacheCreationProperties {
 	std::filesystem::path path;
 	std::uint32_t mips { 1 };
 	ImageFormat format { ImageFormat::SRGB };
+	/** @brief Pixels decoded ahead of time, see TextureDecoder. The texture decodes path itself when this is empty */
+	DataBuffer pixels { nullptr };
+	Extent extent {};
 };
 
 class TextureCache : public ResourceCache<Ref<Disarray::Texture>, TextureCacheCreationProperties, TextureCache, std::string, StringHash> {
@@ -52,7 +56,7 @@ public:
 		});
 	}
 
-	auto create_from_impl(const TextureCacheCreationProperties& props) -> Ref<Disarray::Texture>
+	auto create_from_impl(TextureCacheCreationProperties&& props) -> Ref<Disarray::Texture>
 	{
 		if (contains(props.key)) {
 			return get(props.key);
@@ -60,9 +64,11 @@ public:
 
 		return Texture::construct(ResourceCache::get_device(),
 			TextureProperties {
+				.extent = props.extent,
 				.generate_mips = true,
 				.mips = props.mips,
 				.path = props.path.string(),
+				.data_buffer = std::move(props.pixels),
 				.locked_extent = true,
 				.debug_name = props.debug_name,
 			});
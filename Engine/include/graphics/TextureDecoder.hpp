@@ -0,0 +1,37 @@
+#pragma once
+
+#include <filesystem>
+#include <span>
+#include <vector>
+
+#include "core/DataBuffer.hpp"
+#include "graphics/Extent.hpp"
+
+namespace Disarray {
+
+/**
+ * @brief RGBA8 pixels of an image file, ready to be handed to a texture through TextureProperties::data_buffer.
+ */
+struct DecodedTexture {
+	std::filesystem::path path {};
+	Extent extent {};
+	DataBuffer pixels {};
+
+	[[nodiscard]] auto valid() const -> bool { return pixels.is_valid(); }
+};
+
+namespace TextureDecoder {
+
+	/**
+	 * @brief Decodes one image on the calling thread. The result is invalid when the file is missing or could not be decoded.
+	 */
+	[[nodiscard]] auto decode(const std::filesystem::path& path) -> DecodedTexture;
+
+	/**
+	 * @brief Decodes every path on the thread pool, one image per task. The results are in the order of the paths.
+	 */
+	[[nodiscard]] auto decode_all(std::span<const std::filesystem::path> paths) -> std::vector<DecodedTexture>;
+
+} // namespace TextureDecoder
+
+} // namespace Disarray
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "graphics/ModelVertex.hpp"
+
+namespace Disarray {
+
+struct WeldOptions {
+	/**
+	 * @brief Zero welds vertices whose compared attributes are equal. Above zero, attributes are snapped to a grid of this size first,
+	 * so vertices in the same cell are welded. Vertices just either side of a cell boundary are not.
+	 */
+	float epsilon { 0.0F };
+};
+
+struct WeldResult {
+	std::vector<ModelVertex> vertices {};
+	std::vector<std::uint32_t> indices {};
+};
+
+/**
+ * @brief Deduplicates vertices on the attributes ModelVertex compares (position, uvs, colour and normals), with an open addressing table
+ * sized up front. Welding is per instance, so separate submeshes can be welded concurrently with one welder each.
+ */
+class VertexWelder {
+public:
+	explicit VertexWelder(std::size_t expected_vertex_count = 0, const WeldOptions& options = {});
+
+	/**
+	 * @brief The index of vertex among the unique vertices, adding it if there is no match.
+	 */
+	auto weld(const ModelVertex& vertex) -> std::uint32_t;
+
+	[[nodiscard]] auto get_vertices() const -> const std::vector<ModelVertex>& { return vertices; }
+	[[nodiscard]] auto take_vertices() -> std::vector<ModelVertex>;
+
+	/**
+	 * @brief Welds an unindexed stream, where every three vertices used to form a triangle.
+	 */
+	[[nodiscard]] static auto weld(std::span<const ModelVertex> stream, const WeldOptions& options = {}) -> WeldResult;
+
+private:
+	using Key = std::array<std::uint32_t, 12>;
+
+	[[nodiscard]] auto key_of(const ModelVertex& vertex) const -> Key;
+	[[nodiscard]] static auto hash_key(const Key& key) -> std::uint64_t;
+	void grow();
+	void insert_slot(std::uint32_t vertex_index, std::uint64_t hash);
+
+	WeldOptions options;
+	float inverse_epsilon { 0.0F };
+	std::vector<ModelVertex> vertices {};
+	std::vector<Key> keys {};
+	/** @brief Upper half of the hash, then index into vertices plus one. Zero is an empty slot */
+	std::vector<std::uint64_t> slots {};
+	std::size_t mask { 0 };
+};
+
+} // namespace Disarray
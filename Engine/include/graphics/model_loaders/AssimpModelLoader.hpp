@@ -20,7 +20,7 @@ struct AssimpModelLoader final : public IModelImporter {
 
 private:
 	static auto process_mesh(aiMesh* mesh, const std::filesystem::path& base_directory, const aiScene* scene) -> Submesh;
-	static auto process_current_node(ImportedMesh& mesh_map, const std::filesystem::path& base_directory, aiNode* current_node, const aiScene* scene);
+	static auto process_scene(const std::filesystem::path& base_directory, const aiScene* scene) -> ImportedMesh;
 
 	glm::mat4 initial_rotation { 1.0F };
 };
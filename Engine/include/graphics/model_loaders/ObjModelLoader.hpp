@@ -0,0 +1,24 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <filesystem>
+
+#include "graphics/ModelLoader.hpp"
+
+namespace Disarray {
+
+/**
+ * @brief Imports Wavefront OBJ geometry from a mapped file, parsing chunks of lines in parallel. Produces the same mesh as
+ * TinyObjModelLoader, a single submesh welded per shape, but does not read materials.
+ */
+struct ObjModelLoader final : public IModelImporter {
+	explicit ObjModelLoader(const glm::mat4& rot = glm::mat4 { 1.0F })
+		: initial_rotation(rot) {};
+	auto import_model(const std::filesystem::path& path, ImportFlag) -> ImportedMesh final;
+
+private:
+	glm::mat4 initial_rotation { 1.0F };
+};
+
+} // namespace Disarray
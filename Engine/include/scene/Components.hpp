@@ -77,6 +77,8 @@ struct Mesh {
 
 	Ref<Disarray::Mesh> mesh { nullptr };
 	bool draw_aabb { false };
+	/** @brief Level of detail picked for this frame by Scene, not serialised */
+	std::uint32_t lod { 0 };
 };
 template <> inline constexpr std::string_view component_name<Mesh> = "Mesh";
 
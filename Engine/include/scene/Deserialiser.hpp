@@ -12,6 +12,7 @@
 #include "core/Formatters.hpp"
 #include "core/Tuple.hpp"
 #include "core/exceptions/BaseException.hpp"
+#include "core/filesystem/MappedFile.hpp"
 #include "scene/Component.hpp"
 #include "scene/ComponentSerialisers.hpp"
 #include "scene/Components.hpp"
@@ -137,13 +138,13 @@ namespace Detail {
 			, device(dev)
 			, path(std::move(input_path))
 		{
-			json parsed;
-			std::ifstream input_stream { path };
-			if (!input_stream) {
+			const FS::MappedFile file { path };
+			if (!file) {
 				return;
 			}
 
-			parsed = json::parse(input_stream);
+			const auto view = file.view();
+			json parsed = json::parse(view.begin(), view.end());
 
 			bool could_serialise { true };
 			could_serialise = try_deserialise(parsed);
@@ -5,17 +5,21 @@
 #include <entt/entt.hpp>
 
 #include <concepts>
+#include <memory_resource>
 #include <mutex>
 #include <queue>
 #include <type_traits>
 
 #include "core/Collections.hpp"
 #include "core/FileWatcher.hpp"
+#include "core/FrameAllocator.hpp"
+#include "core/TaskGraph.hpp"
 #include "core/ThreadPool.hpp"
 #include "core/Types.hpp"
 #include "core/events/Event.hpp"
 #include "graphics/CommandExecutor.hpp"
 #include "graphics/Framebuffer.hpp"
+#include "graphics/LodSelection.hpp"
 #include "graphics/Mesh.hpp"
 #include "graphics/StorageBuffer.hpp"
 #include "graphics/Texture.hpp"
@@ -95,10 +99,13 @@ public:
 	auto on_update_simulation(float time_step) -> void;
 	auto on_update_runtime(float time_step) -> void;
 
-	template <ValidComponent... T> auto entities_with() -> std::vector<Entity>
+	/**
+	 * @brief The returned vector lives in the frame allocator, so it should not be kept beyond the current frame.
+	 */
+	template <ValidComponent... T> auto entities_with() -> std::pmr::vector<Entity>
 	{
 		auto view_for = registry.view<T...>();
-		std::vector<Entity> out;
+		std::pmr::vector<Entity> out { frame_resource() };
 		if constexpr (sizeof...(T) == 1) {
 			out.reserve(view_for.size());
 		} else {
@@ -112,11 +119,14 @@ public:
 
 	template <ValidComponent... Ts> auto get_by_components() -> std::optional<Entity>
 	{
-		std::vector<Entity> found = entities_with<Ts...>();
-		if (found.size() != 1) {
-			return std::nullopt;
+		std::optional<Entity> found {};
+		for (const auto entity : registry.view<Ts...>()) {
+			if (found.has_value()) {
+				return std::nullopt;
+			}
+			found.emplace(this, entity);
 		}
-		return std::optional { found.at(0) };
+		return found;
 	}
 
 	void update_picked_entity(std::uint32_t handle);
@@ -150,6 +160,13 @@ public:
 
 	template <class Func> auto submit_preframe_work(Func&& func) { frame_start_callbacks.emplace(std::forward<Func>(func)); }
 
+	/**
+	 * @brief Per stage timings of the last begin_frame, including the critical path through the stages.
+	 */
+	[[nodiscard]] auto get_frame_statistics() const -> const Threading::TaskGraphStatistics& { return frame_graph.get_statistics(); }
+
+	[[nodiscard]] auto get_lod_selection() -> LodSelectionSettings& { return lod_selection; }
+
 private:
 	PhysicsEngine engine;
 	void physics_update(float time_step);
@@ -165,8 +182,14 @@ private:
 	std::int32_t step_frames { 0 };
 
 	Extent extent {};
+	LodSelectionSettings lod_selection {};
 
 	entt::registry registry;
+	Threading::TaskGraph frame_graph {};
+
+	struct FrameInputs;
+	Scope<FrameInputs, PimplDeleter<FrameInputs>> frame_inputs;
+	void build_frame_graph();
 
 	void draw_shadows(SceneRenderer& renderer);
 	void draw_identifiers(SceneRenderer& renderer);
@@ -63,10 +63,13 @@ public:
 	auto draw_point_lights(const Disarray::Mesh& point_light_mesh, std::uint32_t count, const Disarray::Pipeline& pipeline) -> void;
 	auto draw_planar_geometry(Geometry, const GeometryProperties&) -> void;
 	auto draw_aabb(const AABB& aabb, const glm::vec4& colour, const glm::mat4& transform) -> void;
+	/**
+	 * @brief Submeshes without that many levels of detail draw their coarsest one.
+	 */
 	auto draw_static_submeshes(const Collections::ScopedStringMap<Disarray::MeshSubstructure>&, const Disarray::Pipeline&, const glm::mat4& transform,
-		const glm::vec4& colour) -> void;
-	auto draw_single_static_mesh(const Disarray::Mesh& mesh, const Disarray::Pipeline& pipeline, const glm::mat4& transform, const glm::vec4& colour)
-		-> void;
+		const glm::vec4& colour, std::uint32_t lod = 0) -> void;
+	auto draw_single_static_mesh(const Disarray::Mesh& mesh, const Disarray::Pipeline& pipeline, const glm::mat4& transform, const glm::vec4& colour,
+		std::uint32_t lod = 0) -> void;
 	auto draw_single_static_mesh(const Disarray::VertexBuffer& vertices, const Disarray::IndexBuffer& indices, const Disarray::Pipeline& pipeline,
 		const glm::mat4& transform, const glm::vec4& colour) -> void;
 	/**
@@ -0,0 +1,77 @@
+#include "DisarrayPCH.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include "core/Allocations.hpp"
+
+namespace Disarray::Allocations {
+
+namespace {
+	std::atomic<std::uint64_t> allocation_count { 0 };
+} // namespace
+
+auto get_allocation_count() -> std::uint64_t { return allocation_count.load(std::memory_order_relaxed); }
+
+#ifdef DISARRAY_COUNT_ALLOCATIONS
+auto is_counting() -> bool { return true; }
+#else
+auto is_counting() -> bool { return false; }
+#endif
+
+#ifdef DISARRAY_COUNT_ALLOCATIONS
+namespace {
+	auto counted_allocate(std::size_t size) -> void*
+	{
+		allocation_count.fetch_add(1, std::memory_order_relaxed);
+		if (auto* pointer = std::malloc(size == 0 ? 1 : size)) {
+			return pointer;
+		}
+		throw std::bad_alloc {};
+	}
+
+	auto counted_allocate(std::size_t size, std::align_val_t alignment) -> void*
+	{
+		allocation_count.fetch_add(1, std::memory_order_relaxed);
+		const auto align = static_cast<std::size_t>(alignment);
+		const auto rounded = ((size == 0 ? 1 : size) + align - 1) & ~(align - 1);
+#ifdef DISARRAY_WINDOWS
+		auto* pointer = _aligned_malloc(rounded, align);
+#else
+		auto* pointer = std::aligned_alloc(align, rounded);
+#endif
+		if (pointer != nullptr) {
+			return pointer;
+		}
+		throw std::bad_alloc {};
+	}
+
+	void aligned_free(void* pointer)
+	{
+#ifdef DISARRAY_WINDOWS
+		_aligned_free(pointer);
+#else
+		std::free(pointer);
+#endif
+	}
+} // namespace
+#endif
+
+} // namespace Disarray::Allocations
+
+#ifdef DISARRAY_COUNT_ALLOCATIONS
+auto operator new(std::size_t size) -> void* { return Disarray::Allocations::counted_allocate(size); }
+auto operator new[](std::size_t size) -> void* { return Disarray::Allocations::counted_allocate(size); }
+auto operator new(std::size_t size, std::align_val_t alignment) -> void* { return Disarray::Allocations::counted_allocate(size, alignment); }
+auto operator new[](std::size_t size, std::align_val_t alignment) -> void* { return Disarray::Allocations::counted_allocate(size, alignment); }
+
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete[](void* pointer) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, std::size_t) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::align_val_t) noexcept { Disarray::Allocations::aligned_free(pointer); }
+void operator delete[](void* pointer, std::align_val_t) noexcept { Disarray::Allocations::aligned_free(pointer); }
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept { Disarray::Allocations::aligned_free(pointer); }
+void operator delete[](void* pointer, std::size_t, std::align_val_t) noexcept { Disarray::Allocations::aligned_free(pointer); }
+#endif
@@ -5,12 +5,15 @@
 #include <thread>
 
 #include "core/AllocatorConfigurator.hpp"
+#include "core/Allocations.hpp"
 #include "core/App.hpp"
 #include "core/Clock.hpp"
 #include "core/DebugConfigurator.hpp"
 #include "core/Formatters.hpp"
 #include "core/Input.hpp"
+#include "core/Instrumentation.hpp"
 #include "core/Log.hpp"
+#include "core/Metrics.hpp"
 #include "core/ThreadPool.hpp"
 #include "core/Window.hpp"
 #include "graphics/Swapchain.hpp"
@@ -20,6 +23,7 @@
 namespace Disarray {
 
 App::App(const Disarray::ApplicationProperties& props)
+	: trace_output(props.trace_output)
 {
 	const auto& path = props.working_directory;
 	std::filesystem::current_path(path);
@@ -37,6 +41,11 @@ App::App(const Disarray::ApplicationProperties& props)
 	initialise_debug_applications(*device);
 	initialise_allocator(*device, window->get_instance());
 	swapchain = Swapchain::construct(*window, *device);
+
+	Metrics::configure({
+		.output = props.metrics_output,
+		.dump_interval = std::chrono::seconds { props.metrics_interval },
+	});
 }
 
 void App::on_event(Event& event)
@@ -78,7 +87,17 @@ void App::run()
 	static constexpr auto minimum_hertz = 1000.0F / minimum_time_step;
 	static auto current_time = Clock::ms();
 	static float step = minimum_time_step;
+
+#ifdef DISARRAY_PROFILE
+	DISARRAY_PROFILE_THREAD("Main")
+	Instrumentation::begin_session();
+#endif
+
 	while (!window->should_close()) {
+		DISARRAY_PROFILE_FRAME()
+		frame_allocator.begin_frame({});
+		const auto allocations_at_frame_start = Allocations::get_allocation_count();
+
 		const auto could_prepare = could_prepare_frame();
 
 #ifdef DISARRAY_VSYNC
@@ -89,26 +108,55 @@ void App::run()
 #endif
 
 		window->handle_input(step);
-		update_layers(step, could_prepare);
-		render_layers();
-		Renderer::execute_queue();
+		{
+			DISARRAY_PROFILE_SCOPE("Update layers")
+			update_layers(step, could_prepare);
+		}
+		{
+			DISARRAY_PROFILE_SCOPE("Render layers")
+			render_layers();
+			Renderer::execute_queue();
+		}
 		statistics.cpu_time = step;
-		render_ui(ui_layer);
+		{
+			DISARRAY_PROFILE_SCOPE("Render UI")
+			render_ui(ui_layer);
+		}
 
 		swapchain->reset_recreation_status();
 
 		auto begin_present_time = Clock::ns();
-		swapchain->present();
+		{
+			DISARRAY_PROFILE_SCOPE("Present")
+			swapchain->present();
+		}
 		statistics.presentation_time = Clock::ns() - begin_present_time;
 
 		window->update();
+		statistics.heap_allocations = Allocations::get_allocation_count() - allocations_at_frame_start;
+		statistics.frame_arena_bytes = frame_allocator.get_bytes_used();
 		statistics.frame_time = Clock::ms() - current_time;
 		current_time = Clock::ms();
 
 		step = glm::min<float>(statistics.frame_time, minimum_time_step);
+
+		Metrics::record_timing("Frame", statistics.frame_time);
+		Metrics::record_timing("CPU", statistics.cpu_time);
+		Metrics::record_timing("Presentation", statistics.presentation_time / 1'000'000.0);
+		Metrics::add(Metrics::Counter::HeapAllocations, statistics.heap_allocations);
+		Metrics::end_frame();
+
+#ifdef DISARRAY_PROFILE
+		Instrumentation::collect();
+#endif
 	}
 
+#ifdef DISARRAY_PROFILE
+	Instrumentation::end_session(trace_output);
+#endif
+
 	wait_for_idle(*device);
+	Metrics::dump();
 
 	UI::InterfaceCaches::destruct();
 	for (auto& layer : layers) {
@@ -117,6 +165,7 @@ void App::run()
 	layers.clear();
 
 	on_detach();
+	Logging::Logger::the().flush();
 }
 
 void App::update_layers(float time_step, bool could_prepare)
@@ -0,0 +1,108 @@
+#include "DisarrayPCH.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+
+#include "core/App.hpp"
+#include "core/Collections.hpp"
+#include "core/ThreadPool.hpp"
+
+namespace Disarray::Collections {
+
+namespace {
+#ifdef DISARRAY_FORCE_SERIAL_EXECUTION
+	std::atomic_bool serial_execution { true };
+#else
+	std::atomic_bool serial_execution { false };
+#endif
+
+	// Oversubscribe a little, so that uneven chunks balance out between the workers.
+	constexpr std::size_t chunks_per_thread = 4;
+
+	struct ParallelForState {
+		const Detail::ChunkFunction* chunk_function { nullptr };
+		std::size_t count { 0 };
+		std::size_t grain_size { 1 };
+		std::size_t chunk_count { 0 };
+
+		std::atomic<std::size_t> next_chunk { 0 };
+		std::atomic_bool cancelled { false };
+
+		std::mutex exception_mutex {};
+		std::exception_ptr exception { nullptr };
+	};
+
+	void run_chunks(ParallelForState& state)
+	{
+		while (true) {
+			const auto chunk = state.next_chunk.fetch_add(1, std::memory_order_relaxed);
+			if (chunk >= state.chunk_count) {
+				return;
+			}
+
+			if (!state.cancelled.load(std::memory_order_relaxed)) {
+				const auto begin = chunk * state.grain_size;
+				const auto end = std::min(begin + state.grain_size, state.count);
+				try {
+					(*state.chunk_function)(begin, end);
+				} catch (...) {
+					std::scoped_lock lock { state.exception_mutex };
+					if (!state.exception) {
+						state.exception = std::current_exception();
+					}
+					state.cancelled = true;
+				}
+			}
+
+		}
+	}
+} // namespace
+
+void set_serial_execution(bool serial) { serial_execution = serial; }
+
+auto is_serial_execution() -> bool { return serial_execution; }
+
+namespace Detail {
+	void parallel_for_chunks(std::size_t count, std::size_t grain_size, const ChunkFunction& chunk_function)
+	{
+		if (count == 0) {
+			return;
+		}
+
+		auto& pool = App::get_thread_pool();
+		const auto thread_count = static_cast<std::size_t>(pool.get_thread_count());
+		if (grain_size == 0) {
+			grain_size = std::max<std::size_t>(1, count / ((thread_count + 1) * chunks_per_thread));
+		}
+
+		if (serial_execution || thread_count == 0 || count <= grain_size) {
+			chunk_function(0, count);
+			return;
+		}
+
+		ParallelForState state {};
+		state.chunk_function = &chunk_function;
+		state.count = count;
+		state.grain_size = grain_size;
+		state.chunk_count = (count + grain_size - 1) / grain_size;
+
+		// Helpers that start after every chunk has been claimed return immediately. Waiting on the counter
+		// runs any helper that has not been picked up yet, so the state can live on this stack frame.
+		Threading::JobCounter helpers_done {};
+		const auto helpers = std::min(thread_count, state.chunk_count - 1);
+		for (std::size_t i = 0; i < helpers; i++) {
+			pool.schedule([&state]() { run_chunks(state); }, &helpers_done);
+		}
+
+		run_chunks(state);
+		pool.wait(helpers_done);
+
+		if (state.exception) {
+			std::rethrow_exception(state.exception);
+		}
+	}
+} // namespace Detail
+
+} // namespace Disarray::Collections
@@ -4,6 +4,10 @@
 #include <magic_enum.hpp>
 
 #include <algorithm>
+#include <condition_variable>
+#include <system_error>
+
+#include "core/Log.hpp"
 
 namespace Disarray {
 
@@ -45,136 +49,321 @@ constexpr auto to_filetype(const auto& extension) -> FileType
 	return FileType::UNKNOWN;
 }
 
-FileWatcher::FileWatcher(Threading::ThreadPool& pool, const std::filesystem::path& in_path, std::chrono::duration<int, std::milli> in_delay)
-	: FileWatcher(pool, in_path, { "*" }, in_delay)
+namespace {
+	/**
+	 * @brief Asks for a rescan every delay, the file watcher does the walking.
+	 */
+	class PollingBackend final : public Detail::WatchBackend {
+	public:
+		explicit PollingBackend(std::chrono::milliseconds in_interval)
+			: interval(in_interval)
+			, next_scan(std::chrono::steady_clock::now() + in_interval)
+		{
+		}
+
+		void wait(std::vector<Detail::WatchEvent>& events, std::optional<std::chrono::milliseconds> timeout) override
+		{
+			std::unique_lock lock { mutex };
+			auto until = next_scan;
+			if (timeout) {
+				until = std::min(until, std::chrono::steady_clock::now() + *timeout);
+			}
+			condition.wait_until(lock, until, [this]() { return woken; });
+			woken = false;
+
+			if (const auto now = std::chrono::steady_clock::now(); now >= next_scan) {
+				next_scan = now + interval;
+				events.push_back({ .type = Detail::WatchEventType::Rescan });
+			}
+		}
+
+		void wake() override
+		{
+			{
+				std::scoped_lock lock { mutex };
+				woken = true;
+			}
+			condition.notify_one();
+		}
+
+	private:
+		std::chrono::milliseconds interval;
+		std::chrono::steady_clock::time_point next_scan;
+		std::mutex mutex {};
+		std::condition_variable condition {};
+		bool woken { false };
+	};
+
+	auto to_file_information(const std::filesystem::path& path, FileStatus status) -> FileInformation
+	{
+		std::error_code error_code {};
+		const auto type_if_not_directory = std::filesystem::is_directory(path, error_code) ? FileType::DIRECTORY : to_filetype(path.extension());
+		return FileInformation {
+			.type = type_if_not_directory,
+			.path = path.string(),
+			.last_modified = std::filesystem::last_write_time(path, error_code),
+			.status = status,
+		};
+	}
+
+	auto is_below(std::string_view path, std::string_view directory) -> bool
+	{
+		return path.size() > directory.size() && path.starts_with(directory)
+			&& (path[directory.size()] == '/' || path[directory.size()] == std::filesystem::path::preferred_separator);
+	}
+
+	auto register_callback(FileStatus status, std::mutex& mutex, auto& activations, auto&& function)
+	{
+		auto func = [activation = function, status = status](const FileInformation& file) {
+			const auto is_given_status = (file.status & status) != FileStatus {};
+			if (is_given_status) {
+				Log::debug("FileWatcher", "Status for file '{}': Old status: '{}', New status: '{}'", file.path, magic_enum::enum_name(file.status),
+					magic_enum::enum_name(status));
+				activation(file);
+			}
+		};
+		std::scoped_lock lock { mutex };
+		activations.push_back(func);
+	}
+
+	const std::string no_previous_path {};
+} // namespace
+
+#ifndef __linux__
+auto Detail::create_native_watch_backend(const std::filesystem::path&) -> Scope<WatchBackend> { return nullptr; }
+#endif
+
+FileWatcher::FileWatcher(Threading::ThreadPool& pool, const std::filesystem::path& in_path, std::chrono::duration<int, std::milli> in_delay,
+	const FileWatcherSettings& in_settings)
+	: FileWatcher(pool, in_path, { "*" }, in_delay, in_settings)
 {
 }
 
 FileWatcher::FileWatcher(Threading::ThreadPool& pool, const std::filesystem::path& in_path, const Collections::StringSet& exts,
-	std::chrono::duration<int, std::milli> in_delay)
+	std::chrono::duration<int, std::milli> in_delay, const FileWatcherSettings& in_settings)
 	: root(in_path)
 	, extensions(exts)
 	, delay(in_delay)
+	, settings(in_settings)
 {
-	for (const auto& file : std::filesystem::recursive_directory_iterator { root }) {
-		if (!in_extensions(file)) {
-			continue;
+	// The backend is set up before the tree is walked, so that nothing created in between is missed.
+	if (settings.backend != FileWatcherBackend::Polling) {
+		backend = Detail::create_native_watch_backend(root);
+		if (backend) {
+			backend_type = FileWatcherBackend::Native;
+		} else if (settings.backend == FileWatcherBackend::Native) {
+			Log::error("FileWatcher", "No native backend for {}, falling back to polling.", root.string());
 		}
+	}
+	if (!backend) {
+		backend = make_scope<PollingBackend>(std::chrono::duration_cast<std::chrono::milliseconds>(delay));
+		backend_type = FileWatcherBackend::Polling;
+	}
 
-		const auto path = file.path().string();
-		const auto type_if_not_directory = std::filesystem::is_directory(file) ? FileType::DIRECTORY : to_filetype(file.path().extension());
+	std::error_code error_code {};
+	for (const auto& file : std::filesystem::recursive_directory_iterator { root, std::filesystem::directory_options::skip_permission_denied, error_code }) {
+		if (!in_extensions(file.path())) {
+			continue;
+		}
 
-		paths[path] = FileInformation {
-			.type = type_if_not_directory,
-			.path = path,
-			.last_modified = std::filesystem::last_write_time(path),
-		};
+		auto information = to_file_information(file.path(), FileStatus::Created);
+		paths[information.path] = std::move(information);
 	}
 
-	finaliser = pool.submit(&FileWatcher::loop_until, this);
+	finaliser = pool.submit_long_running(&FileWatcher::loop_until, this);
 }
 
 void FileWatcher::loop_until()
 {
+	std::vector<Detail::WatchEvent> events;
 	while (running) {
-		std::this_thread::sleep_for(delay);
-		update();
+		backend->wait(events, next_deadline());
+
+		const auto now = std::chrono::steady_clock::now();
+		for (const auto& event : events) {
+			handle(event, now);
+		}
+		events.clear();
+
+		dispatch_due(now);
 	}
 }
 
-namespace {
-	auto check_for_delete(auto& paths, auto& activations, auto* func)
-	{
-		auto path_iterator = paths.begin();
-		while (path_iterator != paths.end()) {
-			if (!std::filesystem::exists(path_iterator->first)) {
-				path_iterator->second.status = FileStatus::Deleted;
-				const auto& current = path_iterator->second;
-				func(current, activations);
-				path_iterator = paths.erase(path_iterator);
-			} else {
-				path_iterator++;
+void FileWatcher::handle(const Detail::WatchEvent& event, std::chrono::steady_clock::time_point now)
+{
+	switch (event.type) {
+	case Detail::WatchEventType::Created:
+	case Detail::WatchEventType::Modified:
+		queue(event.path, no_previous_path, now);
+		break;
+	case Detail::WatchEventType::Deleted: {
+		// A deleted directory takes everything known below it along.
+		std::vector<std::string> below {};
+		for (const auto& [path, information] : paths) {
+			if (is_below(path, event.path)) {
+				below.push_back(path);
 			}
 		}
+		for (const auto& path : below) {
+			queue(path, no_previous_path, now);
+		}
+		queue(event.path, no_previous_path, now);
+		break;
 	}
-
-	auto register_callback(FileStatus status, auto& activations, auto&& function)
-	{
-		auto func = [activation = function, status = status](const FileInformation& file) {
-			const auto is_given_status = (file.status & status) != FileStatus {};
-			if (is_given_status) {
-				Log::info("FileWatcher", "Status for file '{}': Old status: '{}', New status: '{}'", file.path, magic_enum::enum_name(file.status),
-					magic_enum::enum_name(status));
-				activation(file);
+	case Detail::WatchEventType::Renamed: {
+		std::vector<std::pair<std::string, std::string>> moved {};
+		for (const auto& [path, information] : paths) {
+			if (is_below(path, event.previous_path)) {
+				moved.emplace_back(event.path + path.substr(event.previous_path.size()), path);
 			}
-		};
-		activations.push_back(func);
+		}
+		moved.emplace_back(event.path, event.previous_path);
+
+		for (const auto& [to, from] : moved) {
+			queue(from, no_previous_path, now);
+			queue(to, from, now);
+		}
+		break;
+	}
+	case Detail::WatchEventType::Rescan:
+		rescan(now);
+		break;
 	}
+}
 
-} // namespace
+void FileWatcher::queue(const std::string& path, const std::string& previous_path, std::chrono::steady_clock::time_point now)
+{
+	if (!in_extensions(path)) {
+		return;
+	}
+
+	auto [iterator, inserted] = pending.try_emplace(path, PendingChange { .existed = paths.contains(path) });
+	iterator->second.deadline = now + settings.debounce;
+	if (!previous_path.empty()) {
+		iterator->second.previous_path = previous_path;
+	}
+}
 
-void FileWatcher::update()
+void FileWatcher::rescan(std::chrono::steady_clock::time_point now)
 {
-	check_for_delete(paths, activations, &for_each);
+	std::vector<std::string> changed {};
+	for (const auto& [path, information] : paths) {
+		std::error_code error_code {};
+		if (!std::filesystem::exists(path, error_code)) {
+			changed.push_back(path);
+		}
+	}
 
-	for (const auto& file : std::filesystem::recursive_directory_iterator(root)) {
-		if (!in_extensions(file)) {
+	std::error_code error_code {};
+	for (const auto& file : std::filesystem::recursive_directory_iterator { root, std::filesystem::directory_options::skip_permission_denied, error_code }) {
+		if (!in_extensions(file.path())) {
 			continue;
 		}
 
-		auto current_file_last_write_time = std::filesystem::last_write_time(file);
-		const auto view = file.path().string();
+		auto path = file.path().string();
+		const auto found = paths.find(path);
+		std::error_code time_error {};
+		if (found == paths.end() || found->second.last_modified != std::filesystem::last_write_time(file.path(), time_error)) {
+			changed.push_back(std::move(path));
+		}
+	}
 
-		if (!paths.contains(view)) {
-			const auto type_if_not_directory = std::filesystem::is_directory(file) ? FileType::DIRECTORY : to_filetype(file.path().extension());
+	for (const auto& path : changed) {
+		queue(path, no_previous_path, now);
+	}
+}
 
-			paths[file.path().string()] = FileInformation {
-				.type = type_if_not_directory, .path = view, .last_modified = current_file_last_write_time, .status = FileStatus::Created
-			};
+auto FileWatcher::next_deadline() const -> std::optional<std::chrono::milliseconds>
+{
+	if (pending.empty()) {
+		return std::nullopt;
+	}
 
-			const auto& current = paths[file.path().string()];
-			for_each(current, activations);
+	auto earliest = std::chrono::steady_clock::time_point::max();
+	for (const auto& [path, change] : pending) {
+		earliest = std::min(earliest, change.deadline);
+	}
+	const auto remaining = std::chrono::ceil<std::chrono::milliseconds>(earliest - std::chrono::steady_clock::now());
+	return std::max(remaining, std::chrono::milliseconds { 0 });
+}
+
+void FileWatcher::dispatch_due(std::chrono::steady_clock::time_point now)
+{
+	std::vector<std::pair<std::string, PendingChange>> due {};
+	for (auto iterator = pending.begin(); iterator != pending.end();) {
+		if (iterator->second.deadline <= now) {
+			due.emplace_back(iterator->first, std::move(iterator->second));
+			iterator = pending.erase(iterator);
 		} else {
-			auto& current = paths[file.path().string()];
+			iterator++;
+		}
+	}
 
-			if (current.last_modified != current_file_last_write_time) {
-				current.last_modified = current_file_last_write_time;
-				current.status = FileStatus::Modified;
-				for_each(current, activations);
+	// Known paths first, so that the old name of a renamed file is reported gone before the new one shows up.
+	std::stable_partition(due.begin(), due.end(), [](const auto& change) { return change.second.existed; });
+
+	std::scoped_lock lock { activation_mutex };
+	for (auto& [path, change] : due) {
+		// Whatever happened in between, only the difference to what was last reported is reported.
+		std::error_code error_code {};
+		const auto exists = std::filesystem::exists(path, error_code);
+		if (!change.existed && exists) {
+			auto information = to_file_information(path, FileStatus::Created);
+			information.previous_path = std::move(change.previous_path);
+			const auto& current = paths[path] = std::move(information);
+			for_each(current, activations);
+		} else if (change.existed && !exists) {
+			const auto found = paths.find(path);
+			if (found == paths.end()) {
+				continue;
 			}
+			auto information = std::move(found->second);
+			paths.erase(found);
+			information.status = FileStatus::Deleted;
+			for_each(information, activations);
+		} else if (change.existed && exists) {
+			auto& current = paths[path];
+			current.last_modified = std::filesystem::last_write_time(path, error_code);
+			current.status = FileStatus::Modified;
+			current.previous_path.clear();
+			for_each(current, activations);
 		}
 	}
 }
 
-void FileWatcher::start(const std::function<void(const FileInformation&)>& activation_function) { activations.push_back(activation_function); }
+void FileWatcher::start(const std::function<void(const FileInformation&)>& activation_function)
+{
+	std::scoped_lock lock { activation_mutex };
+	activations.push_back(activation_function);
+}
 
 void FileWatcher::on_created(const std::function<void(const FileInformation&)>& activation_function)
 {
-	register_callback(FileStatus::Created, activations, activation_function);
+	register_callback(FileStatus::Created, activation_mutex, activations, activation_function);
 }
 
 void FileWatcher::on_modified(const std::function<void(const FileInformation&)>& activation_function)
 {
-	register_callback(FileStatus::Modified, activations, activation_function);
+	register_callback(FileStatus::Modified, activation_mutex, activations, activation_function);
 }
 void FileWatcher::on_created_or_modified(const std::function<void(const FileInformation&)>& activation_function)
 {
-	register_callback(FileStatus::Modified | FileStatus::Created, activations, activation_function);
+	register_callback(FileStatus::Modified | FileStatus::Created, activation_mutex, activations, activation_function);
 }
 
 void FileWatcher::on_deleted(const std::function<void(const FileInformation&)>& activation_function)
 {
-	register_callback(FileStatus::Deleted, activations, activation_function);
+	register_callback(FileStatus::Deleted, activation_mutex, activations, activation_function);
 }
 
 void FileWatcher::on_created_or_deleted(const std::function<void(const FileInformation&)>& activation_function)
 {
-	register_callback(FileStatus::Deleted | FileStatus::Created, activations, activation_function);
+	register_callback(FileStatus::Deleted | FileStatus::Created, activation_mutex, activations, activation_function);
 }
 
 void FileWatcher::on(FileStatus info, const std::function<void(const FileInformation&)>& activation_function)
 {
-	register_callback(info, activations, activation_function);
+	register_callback(info, activation_mutex, activations, activation_function);
 }
 
 FileWatcher::~FileWatcher() { stop(); }
@@ -182,7 +371,9 @@ FileWatcher::~FileWatcher() { stop(); }
 void FileWatcher::stop()
 {
 	running = false;
+	backend->wake();
 	finaliser.wait();
+	std::scoped_lock lock { activation_mutex };
 	activations.clear();
 }
 
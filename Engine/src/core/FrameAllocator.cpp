@@ -0,0 +1,88 @@
+#include "DisarrayPCH.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+#include "core/App.hpp"
+#include "core/FrameAllocator.hpp"
+
+namespace Disarray {
+
+LinearArena::LinearArena(std::size_t size)
+	: block_size(size)
+{
+}
+
+auto LinearArena::allocate(std::size_t bytes, std::size_t alignment) -> void*
+{
+	bytes = std::max<std::size_t>(bytes, 1);
+	while (true) {
+		if (current_block < blocks.size()) {
+			auto& block = blocks[current_block];
+			const auto base = reinterpret_cast<std::uintptr_t>(block.memory.get());
+			const auto aligned = (base + offset + alignment - 1) & ~(alignment - 1);
+			const auto end = aligned - base + bytes;
+			if (end <= block.size) {
+				offset = end;
+				bytes_used += bytes;
+				return reinterpret_cast<void*>(aligned);
+			}
+
+			current_block++;
+			offset = 0;
+			continue;
+		}
+
+		const auto size = std::max(block_size, bytes + alignment);
+		blocks.push_back(Block { .memory = std::unique_ptr<std::byte[]>(new std::byte[size]), .size = size });
+	}
+}
+
+void LinearArena::reset()
+{
+	// If the frame needed more than one block, replace them with one block that fits the whole frame.
+	if (blocks.size() > 1) {
+		block_size = std::max(block_size, get_capacity());
+		blocks.clear();
+	}
+
+	current_block = 0;
+	offset = 0;
+	bytes_used = 0;
+}
+
+auto LinearArena::get_capacity() const -> std::size_t
+{
+	return std::accumulate(blocks.begin(), blocks.end(), std::size_t { 0 }, [](std::size_t total, const Block& block) { return total + block.size; });
+}
+
+FrameAllocator::FrameAllocator(UsageBadge<App>)
+	: resources { LinearArenaResource { arenas[0] }, LinearArenaResource { arenas[1] } }
+{
+}
+
+void FrameAllocator::begin_frame(UsageBadge<App>)
+{
+	current_frame = (current_frame + 1) % frames_in_flight;
+	arenas.at(current_frame).reset();
+}
+
+auto FrameAllocator::get_resource() -> std::pmr::memory_resource*
+{
+	if (!is_owner_thread()) {
+		return std::pmr::get_default_resource();
+	}
+	return &resources.at(current_frame);
+}
+
+auto FrameAllocator::get_capacity() const -> std::size_t
+{
+	return std::accumulate(
+		arenas.begin(), arenas.end(), std::size_t { 0 }, [](std::size_t total, const LinearArena& arena) { return total + arena.get_capacity(); });
+}
+
+auto frame_resource() -> std::pmr::memory_resource* { return App::get_frame_allocator().get_resource(); }
+
+auto is_frame_thread() -> bool { return App::get_frame_allocator().is_owner_thread(); }
+
+} // namespace Disarray
@@ -1,20 +1,229 @@
+#include "DisarrayPCH.hpp"
+
 #include "core/Instrumentation.hpp"
 
-#include "core/Clock.hpp"
+#include <fmt/format.h>
+
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+
 #include "core/Log.hpp"
 
 namespace Disarray::Instrumentation {
 
-Profiler::Profiler(std::string_view scope_name)
-	: name(scope_name)
-	, start_time(Clock::nanos<double>())
+namespace {
+	// Beyond this, collected events are dropped, so that a forgotten session cannot eat all memory.
+	constexpr std::size_t max_collected_events_per_thread = 1ULL << 22ULL;
+
+	struct Registry {
+		std::mutex mutex {};
+		std::vector<SourceLocation> locations { SourceLocation { .name = "Frame", .function = "", .file = "", .line = 0 } };
+		std::vector<std::shared_ptr<Detail::ThreadState>> threads {};
+		std::uint64_t session_start { 0 };
+		std::chrono::steady_clock::time_point session_start_time {};
+	};
+
+	auto registry() -> Registry&
+	{
+		static Registry instance {};
+		return instance;
+	}
+
+	constexpr std::uint32_t frame_location = 0;
+
+	void collect_locked(Registry& state)
+	{
+		for (auto& thread : state.threads) {
+			thread->ring.drain([&thread](const Event& event) {
+				if (thread->collected.size() < max_collected_events_per_thread) {
+					thread->collected.push_back(event);
+				} else {
+					thread->dropped.fetch_add(1, std::memory_order_relaxed);
+				}
+			});
+		}
+	}
+
+	auto escape(std::string_view input) -> std::string
+	{
+		std::string output;
+		output.reserve(input.size());
+		for (const auto character : input) {
+			switch (character) {
+			case '"':
+				output += "\\\"";
+				break;
+			case '\\':
+				output += "\\\\";
+				break;
+			case '\n':
+				output += "\\n";
+				break;
+			default:
+				output += character;
+			}
+		}
+		return output;
+	}
+
+	struct TickConversion {
+		std::uint64_t start { 0 };
+		double microseconds_per_tick { 0.0 };
+
+		[[nodiscard]] auto to_microseconds(std::uint64_t timestamp) const -> double
+		{
+			return timestamp < start ? 0.0 : static_cast<double>(timestamp - start) * microseconds_per_tick;
+		}
+	};
+} // namespace
+
+namespace Detail {
+	auto current_thread() -> ThreadState&
+	{
+		thread_local ThreadState* state = nullptr;
+		if (state != nullptr) {
+			return *state;
+		}
+
+		auto created = std::make_shared<ThreadState>();
+		auto& instance = registry();
+		std::scoped_lock lock { instance.mutex };
+		created->thread_id = static_cast<std::uint32_t>(instance.threads.size() + 1);
+		created->name = fmt::format("Thread {}", created->thread_id);
+		// The registry keeps the state alive after the thread exits, so its events can still be exported.
+		instance.threads.push_back(created);
+		state = created.get();
+		return *state;
+	}
+} // namespace Detail
+
+auto register_location(const SourceLocation& location) -> std::uint32_t
 {
+	auto& instance = registry();
+	std::scoped_lock lock { instance.mutex };
+	instance.locations.push_back(location);
+	return static_cast<std::uint32_t>(instance.locations.size() - 1);
 }
 
-Profiler::~Profiler()
+void set_thread_name(std::string_view name)
+{
+	auto& thread = Detail::current_thread();
+	std::scoped_lock lock { registry().mutex };
+	thread.name = name;
+}
+
+void mark_frame() { Detail::emit(frame_location, EventType::Frame); }
+
+void begin_session()
 {
-	const auto end_time = Clock::nanos<double>() - start_time;
-	Log::to_file("Profile", "Scope {} took {}ms.", name, 1000.0 * end_time);
+	auto& instance = registry();
+	{
+		std::scoped_lock lock { instance.mutex };
+		collect_locked(instance);
+		for (auto& thread : instance.threads) {
+			thread->collected.clear();
+			thread->dropped = 0;
+		}
+		instance.session_start_time = std::chrono::steady_clock::now();
+		instance.session_start = Detail::now();
+	}
+	Detail::recording = true;
+}
+
+void collect()
+{
+	auto& instance = registry();
+	std::scoped_lock lock { instance.mutex };
+	collect_locked(instance);
+}
+
+auto is_recording() -> bool { return Detail::recording; }
+
+void end_session(const std::filesystem::path& output)
+{
+	Detail::recording = false;
+	const auto session_end = Detail::now();
+	const auto session_end_time = std::chrono::steady_clock::now();
+
+	auto& instance = registry();
+	std::scoped_lock lock { instance.mutex };
+	collect_locked(instance);
+
+	const auto elapsed = std::chrono::duration<double, std::micro>(session_end_time - instance.session_start_time).count();
+	const TickConversion conversion {
+		.start = instance.session_start,
+		.microseconds_per_tick = session_end > instance.session_start ? elapsed / static_cast<double>(session_end - instance.session_start) : 0.0,
+	};
+
+	std::ofstream stream { output };
+	if (!stream) {
+		Log::error("Instrumentation", "Could not open {} for writing.", output.string());
+		return;
+	}
+
+	fmt::memory_buffer buffer;
+	auto out = std::back_inserter(buffer);
+	fmt::format_to(out, "{{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+
+	bool first = true;
+	const auto separator = [&first, &out]() {
+		if (!first) {
+			fmt::format_to(out, ",\n");
+		}
+		first = false;
+	};
+
+	std::uint64_t total_dropped = 0;
+	for (const auto& thread : instance.threads) {
+		separator();
+		fmt::format_to(
+			out, R"({{"name":"thread_name","ph":"M","pid":1,"tid":{},"args":{{"name":"{}"}}}})", thread->thread_id, escape(thread->name));
+
+		// Zones that were open when the session started have no begin, and zones still open at the end are closed here.
+		std::size_t depth = 0;
+		for (const auto& event : thread->collected) {
+			const auto timestamp = conversion.to_microseconds(event.timestamp);
+			switch (event.type) {
+			case EventType::Begin: {
+				const auto& location = instance.locations.at(event.location);
+				separator();
+				fmt::format_to(out, R"({{"name":"{}","cat":"zone","ph":"B","pid":1,"tid":{},"ts":{:.3f},"args":{{"function":"{}","file":"{}","line":{}}}}})",
+					escape(location.name), thread->thread_id, timestamp, escape(location.function), escape(location.file), location.line);
+				depth++;
+				break;
+			}
+			case EventType::End:
+				if (depth == 0) {
+					break;
+				}
+				separator();
+				fmt::format_to(out, R"({{"ph":"E","pid":1,"tid":{},"ts":{:.3f}}})", thread->thread_id, timestamp);
+				depth--;
+				break;
+			case EventType::Frame:
+				separator();
+				fmt::format_to(out, R"({{"name":"Frame","cat":"frame","ph":"i","s":"g","pid":1,"tid":{},"ts":{:.3f}}})", thread->thread_id, timestamp);
+				break;
+			}
+		}
+		for (; depth > 0; depth--) {
+			separator();
+			fmt::format_to(out, R"({{"ph":"E","pid":1,"tid":{},"ts":{:.3f}}})", thread->thread_id, conversion.to_microseconds(session_end));
+		}
+
+		total_dropped += thread->dropped.load();
+		thread->collected.clear();
+		thread->collected.shrink_to_fit();
+	}
+	fmt::format_to(out, "\n]}}\n");
+	stream.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+
+	if (total_dropped > 0) {
+		Log::info("Instrumentation", "Dropped {} events, collect more often or raise the ring capacity.", total_dropped);
+	}
+	Log::info("Instrumentation", "Wrote trace to {}.", output.string());
 }
 
 } // namespace Disarray::Instrumentation
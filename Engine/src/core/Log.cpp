@@ -8,8 +8,13 @@
 #include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/spdlog.h>
 
+#include <bit>
+#include <condition_variable>
 #include <cstdarg>
 #include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <vector>
 
 #include "core/PointerDefinition.hpp"
@@ -20,14 +25,232 @@ namespace Disarray {
 
 namespace Logging {
 
-	using LoggerType = std::shared_ptr<spdlog::logger>;
+	namespace {
+		auto to_spdlog(Level level) -> spdlog::level::level_enum
+		{
+			switch (level) {
+			case Level::Trace:
+				return spdlog::level::trace;
+			case Level::Debug:
+				return spdlog::level::debug;
+			case Level::Info:
+				return spdlog::level::info;
+			case Level::Error:
+				return spdlog::level::err;
+			}
+			return spdlog::level::info;
+		}
+
+		auto from_spdlog(spdlog::level::level_enum level) -> Level
+		{
+			switch (level) {
+			case spdlog::level::trace:
+				return Level::Trace;
+			case spdlog::level::debug:
+				return Level::Debug;
+			case spdlog::level::info:
+				return Level::Info;
+			default:
+				return Level::Error;
+			}
+		}
+
+		struct Record {
+			Level level { Level::Info };
+			spdlog::log_clock::time_point time {};
+			bool is_deferred { false };
+			std::string text {};
+			Detail::DeferredMessage deferred {};
+		};
+
+		/**
+		 * @brief Bounded multi-producer queue (Vyukov), drained by the single writer thread.
+		 */
+		class RecordQueue {
+		public:
+			explicit RecordQueue(std::size_t requested_capacity)
+				: capacity(std::bit_ceil(std::max<std::size_t>(requested_capacity, 2)))
+				, mask(capacity - 1)
+				, cells(std::make_unique<Cell[]>(capacity))
+			{
+				for (std::size_t i = 0; i < capacity; i++) {
+					cells[i].sequence.store(i, std::memory_order_relaxed);
+				}
+			}
+
+			auto try_push(Record&& record) -> bool
+			{
+				auto position = enqueue_position.load(std::memory_order_relaxed);
+				Cell* cell = nullptr;
+				while (true) {
+					cell = &cells[position & mask];
+					const auto sequence = cell->sequence.load(std::memory_order_acquire);
+					const auto difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+					if (difference == 0) {
+						if (enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+							break;
+						}
+					} else if (difference < 0) {
+						return false;
+					} else {
+						position = enqueue_position.load(std::memory_order_relaxed);
+					}
+				}
+
+				cell->record = std::move(record);
+				cell->sequence.store(position + 1, std::memory_order_release);
+				return true;
+			}
+
+			// Only called from the writer thread.
+			auto try_pop(Record& output) -> bool
+			{
+				const auto position = dequeue_position.load(std::memory_order_relaxed);
+				auto& cell = cells[position & mask];
+				if (cell.sequence.load(std::memory_order_acquire) != position + 1) {
+					return false;
+				}
+
+				output = std::move(cell.record);
+				dequeue_position.store(position + 1, std::memory_order_relaxed);
+				cell.sequence.store(position + mask + 1, std::memory_order_release);
+				return true;
+			}
+
+		private:
+			struct Cell {
+				std::atomic<std::size_t> sequence { 0 };
+				Record record {};
+			};
+
+			std::size_t capacity;
+			std::size_t mask;
+			std::unique_ptr<Cell[]> cells;
+			alignas(64) std::atomic<std::size_t> enqueue_position { 0 };
+			alignas(64) std::atomic<std::size_t> dequeue_position { 0 };
+		};
+
+		constexpr auto writer_idle_wait = std::chrono::milliseconds(5);
+	} // namespace
+
+	namespace Detail {
+		void DeferredMessage::format_to(fmt::memory_buffer& out) const
+		{
+			fmt::format_to(std::back_inserter(out), "[{}] ", std::string_view { scope.data(), scope_length });
+			formatter(storage.data(), out);
+		}
+	} // namespace Detail
+
 	struct Logger::LoggerDataPimpl {
 		spdlog::logger logger;
 
+		std::unique_ptr<RecordQueue> queue { nullptr };
+		OverflowPolicy overflow { OverflowPolicy::Block };
+		std::thread writer {};
+		std::atomic_bool running { false };
+
+		std::mutex wake_mutex {};
+		std::condition_variable wake_condition {};
+		std::atomic_bool writer_sleeping { false };
+
+		std::atomic<std::uint64_t> pushed { 0 };
+		std::atomic<std::uint64_t> written { 0 };
+		std::atomic<std::uint64_t> dropped { 0 };
+		std::atomic<std::uint64_t> unreported_drops { 0 };
+
 		LoggerDataPimpl(spdlog::logger&& in_logger)
 			: logger(in_logger)
 		{
 		}
+
+		~LoggerDataPimpl() { stop_writer(); }
+
+		void write(const Record& record, fmt::memory_buffer& buffer)
+		{
+			if (!record.is_deferred) {
+				logger.log(record.time, spdlog::source_loc {}, to_spdlog(record.level), record.text);
+				return;
+			}
+
+			buffer.clear();
+			record.deferred.format_to(buffer);
+			logger.log(record.time, spdlog::source_loc {}, to_spdlog(record.level), std::string_view { buffer.data(), buffer.size() });
+		}
+
+		void writer_loop()
+		{
+			Record record {};
+			fmt::memory_buffer buffer;
+			while (true) {
+				if (queue->try_pop(record)) {
+					write(record, buffer);
+					written.fetch_add(1, std::memory_order_release);
+
+					if (const auto drops = unreported_drops.exchange(0, std::memory_order_relaxed); drops > 0) {
+						logger.log(spdlog::level::err, "[Log] Dropped {} messages, the queue was full.", drops);
+					}
+					continue;
+				}
+
+				if (!running.load(std::memory_order_acquire)) {
+					// Producers stopped before running was cleared, so one last empty pop means the queue is drained.
+					if (!queue->try_pop(record)) {
+						break;
+					}
+					write(record, buffer);
+					written.fetch_add(1, std::memory_order_release);
+					continue;
+				}
+
+				std::unique_lock lock { wake_mutex };
+				writer_sleeping = true;
+				wake_condition.wait_for(lock, writer_idle_wait);
+				writer_sleeping = false;
+			}
+			logger.flush();
+		}
+
+		void wake_writer()
+		{
+			if (writer_sleeping.load(std::memory_order_relaxed)) {
+				wake_condition.notify_one();
+			}
+		}
+
+		void push(Record&& record)
+		{
+			while (!queue->try_push(std::move(record))) {
+				if (overflow != OverflowPolicy::Block) {
+					dropped.fetch_add(1, std::memory_order_relaxed);
+					if (overflow == OverflowPolicy::Count) {
+						unreported_drops.fetch_add(1, std::memory_order_relaxed);
+					}
+					return;
+				}
+				wake_writer();
+				std::this_thread::yield();
+			}
+			pushed.fetch_add(1, std::memory_order_release);
+			wake_writer();
+		}
+
+		void start_writer(const LoggerConfiguration& configuration)
+		{
+			queue = std::make_unique<RecordQueue>(configuration.queue_capacity);
+			overflow = configuration.overflow;
+			running = true;
+			writer = std::thread { [this]() { writer_loop(); } };
+		}
+
+		void stop_writer()
+		{
+			if (!writer.joinable()) {
+				return;
+			}
+			running = false;
+			wake_condition.notify_one();
+			writer.join();
+		}
 	};
 
 	Logger::Logger()
@@ -35,26 +258,109 @@ namespace Logging {
 		auto engine_logger = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
 		auto err_file_logger = std::make_shared<spdlog::sinks::basic_file_sink_mt>("Assets/Logs/disarray_errors.log", true);
 		auto trace_file_logger = std::make_shared<spdlog::sinks::basic_file_sink_mt>("Assets/Logs/disarray_trace.log", true);
-		err_file_logger->set_level(spdlog::level::trace);
+		// Filtering by level happens before formatting, in Log::log. The sinks only decide where each level ends up.
+		engine_logger->set_level(spdlog::level::trace);
+		err_file_logger->set_level(spdlog::level::err);
 		trace_file_logger->set_level(spdlog::level::trace);
 		spdlog::logger logger { "Disarray", { engine_logger, err_file_logger, trace_file_logger } };
+		logger.set_level(spdlog::level::trace);
 		logger_data = make_scope<LoggerDataPimpl, PimplDeleter<LoggerDataPimpl>>(std::move(logger));
 
 		logger_data->logger.critical("Logging engine level set to: {}", spdlog::level::to_string_view(spdlog::get_level()));
 	}
 
-	auto Logger::Logger::debug(const std::string& message) -> void { logger_data->logger.debug(message); }
+	void Logger::log(Level level, std::string&& message)
+	{
+		if (!is_asynchronous()) {
+			logger_data->logger.log(to_spdlog(level), message);
+			return;
+		}
+
+		logger_data->push(Record {
+			.level = level,
+			.time = spdlog::log_clock::now(),
+			.is_deferred = false,
+			.text = std::move(message),
+		});
+	}
+
+	void Logger::log(Level level, const Detail::DeferredMessage& message)
+	{
+		if (!is_asynchronous()) {
+			fmt::memory_buffer buffer;
+			message.format_to(buffer);
+			logger_data->logger.log(to_spdlog(level), std::string_view { buffer.data(), buffer.size() });
+			return;
+		}
+
+		logger_data->push(Record {
+			.level = level,
+			.time = spdlog::log_clock::now(),
+			.is_deferred = true,
+			.deferred = message,
+		});
+	}
+
+	auto Logger::Logger::debug(const std::string& message) -> void
+	{
+		if (should_log(Level::Debug)) {
+			log(Level::Debug, std::string { message });
+		}
+	}
+
+	auto Logger::Logger::to_file(const std::string& message) -> void
+	{
+		if (should_log(Level::Trace)) {
+			log(Level::Trace, std::string { message });
+		}
+	}
+
+	auto Logger::Logger::info(const std::string& message) -> void
+	{
+		if (should_log(Level::Info)) {
+			log(Level::Info, std::string { message });
+		}
+	}
+
+	auto Logger::Logger::error(const std::string& message) -> void
+	{
+		if (should_log(Level::Error)) {
+			log(Level::Error, std::string { message });
+		}
+	}
+
+	void Logger::configure(const LoggerConfiguration& configuration)
+	{
+		if (is_asynchronous()) {
+			asynchronous = false;
+			logger_data->stop_writer();
+		}
 
-	auto Logger::Logger::to_file(const std::string& message) -> void { logger_data->logger.trace(message); }
+		if (configuration.asynchronous) {
+			logger_data->start_writer(configuration);
+			asynchronous = true;
+		}
+	}
 
-	auto Logger::Logger::info(const std::string& message) -> void { logger_data->logger.info(message); }
+	void Logger::flush()
+	{
+		if (is_asynchronous()) {
+			const auto target = logger_data->pushed.load(std::memory_order_acquire);
+			while (logger_data->written.load(std::memory_order_acquire) < target) {
+				logger_data->wake_writer();
+				std::this_thread::yield();
+			}
+		}
+		logger_data->logger.flush();
+	}
 
-	auto Logger::Logger::error(const std::string& message) -> void { logger_data->logger.error(message); }
+	auto Logger::get_dropped_count() const -> std::uint64_t { return logger_data->dropped.load(std::memory_order_relaxed); }
 
 	void Logger::initialise_logger(const std::string& log_level)
 	{
 		auto level = spdlog::level::from_str(log_level);
 		spdlog::set_level(level);
+		the().runtime_level = from_spdlog(level);
 	}
 
 } // namespace Logging
@@ -0,0 +1,230 @@
+#include "DisarrayPCH.hpp"
+
+#include "core/Metrics.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <fstream>
+#include <map>
+#include <mutex>
+
+#include "core/Log.hpp"
+#include "magic_enum.hpp"
+
+namespace Disarray::Metrics {
+
+namespace {
+	struct Registry {
+		std::mutex mutex {};
+		MetricsConfiguration configuration {};
+		std::map<std::string, RollingHistogram, std::less<>> timings {};
+		std::array<RollingHistogram, counter_count> counter_histograms {};
+		std::chrono::steady_clock::time_point last_dump { std::chrono::steady_clock::now() };
+	};
+
+	auto registry() -> Registry&
+	{
+		static Registry instance {};
+		return instance;
+	}
+
+	// Kept outside of the registry, adding to a counter should never take the lock.
+	std::array<std::atomic<std::uint64_t>, counter_count> counters {};
+
+	auto percentile(const std::vector<double>& sorted, double fraction) -> double
+	{
+		// Nearest rank, so that p99.9 of a small window is the maximum rather than an interpolation below it.
+		const auto rank = static_cast<std::size_t>(std::ceil(fraction * static_cast<double>(sorted.size())));
+		return sorted[std::clamp<std::size_t>(rank, 1, sorted.size()) - 1];
+	}
+
+	auto counter_name(Counter counter) -> std::string { return fmt::format("Counter: {}", magic_enum::enum_name(counter)); }
+
+	auto snapshot(Registry& instance) -> std::vector<std::pair<std::string, HistogramSummary>>
+	{
+		std::vector<std::pair<std::string, HistogramSummary>> output;
+		output.reserve(instance.timings.size() + counter_count);
+		for (const auto& [name, histogram] : instance.timings) {
+			output.emplace_back(name, histogram.summarise());
+		}
+		for (std::size_t i = 0; i < counter_count; i++) {
+			output.emplace_back(counter_name(static_cast<Counter>(i)), instance.counter_histograms.at(i).summarise());
+		}
+		return output;
+	}
+
+	void write_csv(std::ostream& stream, const std::vector<std::pair<std::string, HistogramSummary>>& summaries)
+	{
+		stream << "name,count,min,max,mean,p50,p95,p99,p99.9\n";
+		for (const auto& [name, summary] : summaries) {
+			stream << fmt::format("\"{}\",{},{},{},{},{},{},{},{}\n", name, summary.count, summary.min, summary.max, summary.mean, summary.p50, summary.p95,
+				summary.p99, summary.p999);
+		}
+	}
+
+	void write_json(std::ostream& stream, const std::vector<std::pair<std::string, HistogramSummary>>& summaries)
+	{
+		stream << "{\n";
+		for (std::size_t i = 0; i < summaries.size(); i++) {
+			const auto& [name, summary] = summaries[i];
+			stream << fmt::format(R"(	"{}": {{ "count": {}, "min": {}, "max": {}, "mean": {}, "p50": {}, "p95": {}, "p99": {}, "p99.9": {} }})", name, summary.count,
+				summary.min, summary.max, summary.mean, summary.p50, summary.p95, summary.p99, summary.p999);
+			stream << (i + 1 < summaries.size() ? ",\n" : "\n");
+		}
+		stream << "}\n";
+	}
+} // namespace
+
+RollingHistogram::RollingHistogram(std::size_t window)
+	: samples(std::max<std::size_t>(window, 1))
+{
+}
+
+void RollingHistogram::record(double value)
+{
+	samples[next] = value;
+	next = (next + 1) % samples.size();
+	filled = std::min(filled + 1, samples.size());
+}
+
+void RollingHistogram::clear()
+{
+	next = 0;
+	filled = 0;
+}
+
+auto RollingHistogram::summarise() const -> HistogramSummary
+{
+	if (filled == 0) {
+		return {};
+	}
+
+	std::vector<double> sorted { samples.begin(), samples.begin() + static_cast<std::ptrdiff_t>(filled) };
+	std::sort(sorted.begin(), sorted.end());
+
+	double total = 0.0;
+	for (const auto sample : sorted) {
+		total += sample;
+	}
+
+	return {
+		.count = filled,
+		.min = sorted.front(),
+		.max = sorted.back(),
+		.mean = total / static_cast<double>(filled),
+		.p50 = percentile(sorted, 0.50),
+		.p95 = percentile(sorted, 0.95),
+		.p99 = percentile(sorted, 0.99),
+		.p999 = percentile(sorted, 0.999),
+	};
+}
+
+void configure(const MetricsConfiguration& configuration)
+{
+	auto& instance = registry();
+	std::scoped_lock lock { instance.mutex };
+	instance.configuration = configuration;
+	instance.timings.clear();
+	for (auto& histogram : instance.counter_histograms) {
+		histogram = RollingHistogram { configuration.window };
+	}
+	instance.last_dump = std::chrono::steady_clock::now();
+}
+
+void record_timing(std::string_view name, double milliseconds)
+{
+	auto& instance = registry();
+	std::scoped_lock lock { instance.mutex };
+	auto found = instance.timings.find(name);
+	if (found == instance.timings.end()) {
+		found = instance.timings.emplace(std::string { name }, RollingHistogram { instance.configuration.window }).first;
+	}
+	found->second.record(milliseconds);
+}
+
+void add(Counter counter, std::uint64_t value) { counters.at(static_cast<std::size_t>(counter)).fetch_add(value, std::memory_order_relaxed); }
+
+void end_frame()
+{
+	auto& instance = registry();
+	bool should_dump = false;
+	{
+		std::scoped_lock lock { instance.mutex };
+		for (std::size_t i = 0; i < counter_count; i++) {
+			instance.counter_histograms.at(i).record(static_cast<double>(counters.at(i).exchange(0, std::memory_order_relaxed)));
+		}
+
+		const auto interval = instance.configuration.dump_interval;
+		const auto now = std::chrono::steady_clock::now();
+		if (interval.count() > 0 && now - instance.last_dump >= interval) {
+			instance.last_dump = now;
+			should_dump = true;
+		}
+	}
+
+	if (should_dump) {
+		dump();
+	}
+}
+
+auto get_summary(std::string_view name) -> std::optional<HistogramSummary>
+{
+	auto& instance = registry();
+	std::scoped_lock lock { instance.mutex };
+	if (const auto found = instance.timings.find(name); found != instance.timings.end()) {
+		return found->second.summarise();
+	}
+	return std::nullopt;
+}
+
+auto get_summary(Counter counter) -> HistogramSummary
+{
+	auto& instance = registry();
+	std::scoped_lock lock { instance.mutex };
+	return instance.counter_histograms.at(static_cast<std::size_t>(counter)).summarise();
+}
+
+auto get_summaries() -> std::vector<std::pair<std::string, HistogramSummary>>
+{
+	auto& instance = registry();
+	std::scoped_lock lock { instance.mutex };
+	return snapshot(instance);
+}
+
+void write(const std::filesystem::path& output, OutputFormat format)
+{
+	const auto summaries = get_summaries();
+
+	std::ofstream stream { output };
+	if (!stream) {
+		Log::error("Metrics", "Could not open {} for writing.", output.string());
+		return;
+	}
+
+	if (format == OutputFormat::JSON) {
+		write_json(stream, summaries);
+	} else {
+		write_csv(stream, summaries);
+	}
+}
+
+void dump()
+{
+	std::filesystem::path output {};
+	{
+		auto& instance = registry();
+		std::scoped_lock lock { instance.mutex };
+		output = instance.configuration.output;
+	}
+
+	if (output.empty()) {
+		return;
+	}
+	write(output, output.extension() == ".json" ? OutputFormat::JSON : OutputFormat::CSV);
+}
+
+} // namespace Disarray::Metrics
@@ -0,0 +1,177 @@
+#include "DisarrayPCH.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <memory>
+#include <mutex>
+
+#include "core/Instrumentation.hpp"
+#include "core/TaskGraph.hpp"
+#include "core/ThreadPool.hpp"
+
+namespace Disarray::Threading {
+
+namespace {
+	auto intersects(const std::vector<std::string_view>& left, const std::vector<std::string_view>& right) -> bool
+	{
+		return std::any_of(left.begin(), left.end(), [&right](std::string_view resource) {
+			return std::find(right.begin(), right.end(), resource) != right.end();
+		});
+	}
+} // namespace
+
+struct TaskGraph::ExecutionState {
+	using Clock = std::chrono::steady_clock;
+
+	Clock::time_point start {};
+	std::unique_ptr<std::atomic<std::uint32_t>[]> remaining_dependencies {};
+	JobCounter counter {};
+
+	std::mutex exception_mutex {};
+	std::exception_ptr exception { nullptr };
+
+	[[nodiscard]] auto elapsed_ms() const -> double
+	{
+		return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+	}
+};
+
+auto TaskGraph::StageBuilder::reads(std::initializer_list<std::string_view> resources) -> StageBuilder&
+{
+	auto& stage_reads = graph.stages.at(index).reads;
+	stage_reads.insert(stage_reads.end(), resources.begin(), resources.end());
+	return *this;
+}
+
+auto TaskGraph::StageBuilder::writes(std::initializer_list<std::string_view> resources) -> StageBuilder&
+{
+	auto& stage_writes = graph.stages.at(index).writes;
+	stage_writes.insert(stage_writes.end(), resources.begin(), resources.end());
+	return *this;
+}
+
+auto TaskGraph::add_stage(std::string_view name, StageFunction&& function) -> StageBuilder
+{
+	auto& stage = stages.emplace_back();
+	stage.name = name;
+	stage.function = std::move(function);
+	return StageBuilder { *this, stages.size() - 1 };
+}
+
+auto TaskGraph::get_dependencies(std::size_t stage) const -> const std::vector<std::size_t>& { return stages.at(stage).dependencies; }
+
+void TaskGraph::clear() { stages.clear(); }
+
+void TaskGraph::build_edges()
+{
+	for (std::size_t current = 0; current < stages.size(); current++) {
+		auto& stage = stages[current];
+		stage.dependencies.clear();
+		stage.dependents.clear();
+
+		for (std::size_t earlier = 0; earlier < current; earlier++) {
+			auto& other = stages[earlier];
+			const auto read_after_write = intersects(stage.reads, other.writes);
+			const auto write_after_read = intersects(stage.writes, other.reads);
+			const auto write_after_write = intersects(stage.writes, other.writes);
+			if (read_after_write || write_after_read || write_after_write) {
+				stage.dependencies.push_back(earlier);
+				other.dependents.push_back(current);
+			}
+		}
+	}
+}
+
+void TaskGraph::schedule_stage(ThreadPool& pool, ExecutionState& state, std::size_t index)
+{
+	pool.schedule(
+		[this, &pool, &state, index]() {
+			auto& stage = stages[index];
+			auto& timing = statistics.tasks[index];
+
+			timing.start_ms = state.elapsed_ms();
+			try {
+				stage.function();
+			} catch (...) {
+				std::scoped_lock lock { state.exception_mutex };
+				if (!state.exception) {
+					state.exception = std::current_exception();
+				}
+			}
+			timing.duration_ms = state.elapsed_ms() - timing.start_ms;
+
+			for (const auto dependent : stage.dependents) {
+				if (state.remaining_dependencies[dependent].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+					schedule_stage(pool, state, dependent);
+				}
+			}
+		},
+		&state.counter);
+}
+
+void TaskGraph::execute(ThreadPool& pool)
+{
+	DISARRAY_PROFILE_FUNCTION()
+	build_edges();
+
+	statistics.tasks.resize(stages.size());
+	for (std::size_t i = 0; i < stages.size(); i++) {
+		statistics.tasks[i] = TaskStatistics { .name = stages[i].name };
+	}
+
+	ExecutionState state {};
+	state.remaining_dependencies = std::make_unique<std::atomic<std::uint32_t>[]>(stages.size());
+	for (std::size_t i = 0; i < stages.size(); i++) {
+		state.remaining_dependencies[i].store(static_cast<std::uint32_t>(stages[i].dependencies.size()), std::memory_order_relaxed);
+	}
+
+	state.start = ExecutionState::Clock::now();
+	for (std::size_t i = 0; i < stages.size(); i++) {
+		if (stages[i].dependencies.empty()) {
+			schedule_stage(pool, state, i);
+		}
+	}
+	pool.wait(state.counter);
+	statistics.wall_time_ms = state.elapsed_ms();
+
+	compute_critical_path();
+
+	if (state.exception) {
+		std::rethrow_exception(state.exception);
+	}
+}
+
+void TaskGraph::compute_critical_path()
+{
+	// Stages only depend on earlier stages, so declaration order is a topological order.
+	const auto count = stages.size();
+	std::vector<double> finish(count, 0.0);
+	std::vector<std::size_t> slowest_dependency(count, count);
+
+	for (std::size_t i = 0; i < count; i++) {
+		double ready = 0.0;
+		for (const auto dependency : stages[i].dependencies) {
+			if (finish[dependency] >= ready) {
+				ready = finish[dependency];
+				slowest_dependency[i] = dependency;
+			}
+		}
+		finish[i] = ready + statistics.tasks[i].duration_ms;
+	}
+
+	statistics.critical_path_ms = 0.0;
+	if (count == 0) {
+		return;
+	}
+
+	auto current = static_cast<std::size_t>(std::distance(finish.begin(), std::max_element(finish.begin(), finish.end())));
+	statistics.critical_path_ms = finish[current];
+	while (current != count) {
+		statistics.tasks[current].on_critical_path = true;
+		current = slowest_dependency[current];
+	}
+}
+
+} // namespace Disarray::Threading
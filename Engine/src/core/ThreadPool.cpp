@@ -0,0 +1,376 @@
+#include "DisarrayPCH.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <chrono>
+
+#include "core/Instrumentation.hpp"
+#include "core/ThreadPool.hpp"
+
+namespace Disarray::Threading {
+
+namespace {
+	struct WorkerContext {
+		const ThreadPool* pool { nullptr };
+		std::size_t index { 0 };
+	};
+	thread_local WorkerContext current_worker {};
+
+	auto next_random() -> std::uint32_t
+	{
+		thread_local std::uint32_t state = static_cast<std::uint32_t>(std::hash<std::thread::id> {}(std::this_thread::get_id())) | 1U;
+		state ^= state << 13U;
+		state ^= state >> 17U;
+		state ^= state << 5U;
+		return state;
+	}
+
+	constexpr std::size_t injection_batch_size = 16;
+	constexpr std::size_t idle_spin_count = 32;
+
+	// Workers that are waiting on a counter re-check the queues this often, since a counter reaching zero does not wake them.
+	constexpr auto helping_poll_interval = std::chrono::microseconds(200);
+} // namespace
+
+namespace Detail {
+	auto WorkStealingDeque::push(Job* job) -> bool
+	{
+		const auto current_bottom = bottom.load(std::memory_order_relaxed);
+		const auto current_top = top.load(std::memory_order_acquire);
+		if (current_bottom - current_top >= capacity) {
+			return false;
+		}
+
+		buffer[static_cast<std::size_t>(current_bottom & mask)].store(job, std::memory_order_relaxed);
+		bottom.store(current_bottom + 1, std::memory_order_release);
+		return true;
+	}
+
+	auto WorkStealingDeque::pop() -> Job*
+	{
+		const auto current_bottom = bottom.load(std::memory_order_relaxed) - 1;
+		bottom.store(current_bottom, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		auto current_top = top.load(std::memory_order_relaxed);
+
+		if (current_top > current_bottom) {
+			bottom.store(current_bottom + 1, std::memory_order_relaxed);
+			return nullptr;
+		}
+
+		auto* job = buffer[static_cast<std::size_t>(current_bottom & mask)].load(std::memory_order_relaxed);
+		if (current_top == current_bottom) {
+			// Last element, race against the thieves for it.
+			if (!top.compare_exchange_strong(current_top, current_top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+				job = nullptr;
+			}
+			bottom.store(current_bottom + 1, std::memory_order_relaxed);
+		}
+		return job;
+	}
+
+	auto WorkStealingDeque::steal() -> Job*
+	{
+		auto current_top = top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		const auto current_bottom = bottom.load(std::memory_order_acquire);
+		if (current_top >= current_bottom) {
+			return nullptr;
+		}
+
+		auto* job = buffer[static_cast<std::size_t>(current_top & mask)].load(std::memory_order_relaxed);
+		if (!top.compare_exchange_strong(current_top, current_top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+			return nullptr;
+		}
+		return job;
+	}
+
+	JobAllocator::JobAllocator()
+		: cells(std::make_unique<Cell[]>(capacity))
+	{
+		for (std::size_t i = 0; i < capacity; i++) {
+			cells[i].sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	JobAllocator::~JobAllocator()
+	{
+		while (auto* job = try_pop()) {
+			delete job;
+		}
+	}
+
+	auto JobAllocator::allocate() -> Job*
+	{
+		if (auto* job = try_pop(); job != nullptr) {
+			return job;
+		}
+		return new Job {};
+	}
+
+	auto JobAllocator::try_pop() -> Job*
+	{
+		auto position = dequeue_position.load(std::memory_order_relaxed);
+		Cell* cell = nullptr;
+		while (true) {
+			cell = &cells[position & mask];
+			const auto sequence = cell->sequence.load(std::memory_order_acquire);
+			const auto difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position + 1);
+			if (difference == 0) {
+				if (dequeue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+					break;
+				}
+			} else if (difference < 0) {
+				return nullptr;
+			} else {
+				position = dequeue_position.load(std::memory_order_relaxed);
+			}
+		}
+
+		auto* job = cell->job;
+		cell->job = nullptr;
+		cell->sequence.store(position + mask + 1, std::memory_order_release);
+		return job;
+	}
+
+	void JobAllocator::release(Job* job)
+	{
+		job->invoke = nullptr;
+		job->counter = nullptr;
+
+		auto position = enqueue_position.load(std::memory_order_relaxed);
+		Cell* cell = nullptr;
+		while (true) {
+			cell = &cells[position & mask];
+			const auto sequence = cell->sequence.load(std::memory_order_acquire);
+			const auto difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+			if (difference == 0) {
+				if (enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+					break;
+				}
+			} else if (difference < 0) {
+				delete job;
+				return;
+			} else {
+				position = enqueue_position.load(std::memory_order_relaxed);
+			}
+		}
+
+		cell->job = job;
+		cell->sequence.store(position + 1, std::memory_order_release);
+	}
+} // namespace Detail
+
+ThreadPool::ThreadPool(UsageBadge<Disarray::App>, const concurrency_t thread_count_in)
+	: thread_count(determine_thread_count(thread_count_in))
+{
+	create_threads();
+}
+
+ThreadPool::~ThreadPool()
+{
+	wait_for_tasks();
+	destroy_threads();
+
+	std::scoped_lock lock { long_running_mutex };
+	for (auto& [thread, finished] : long_running) {
+		if (thread.joinable()) {
+			thread.join();
+		}
+	}
+	long_running.clear();
+}
+
+auto ThreadPool::is_worker_thread() const -> bool { return current_worker.pool == this; }
+
+void ThreadPool::enqueue(Detail::Job* job)
+{
+	queued_jobs.fetch_add(1, std::memory_order_seq_cst);
+
+	if (!is_worker_thread() || !deques[current_worker.index]->push(job)) {
+		std::scoped_lock lock { injection_mutex };
+		injection_queue.push_back(job);
+		injection_size.fetch_add(1, std::memory_order_release);
+	}
+
+	if (sleeping_threads.load(std::memory_order_seq_cst) > 0) {
+		std::scoped_lock lock { sleep_mutex };
+		sleep_condition.notify_one();
+	}
+}
+
+auto ThreadPool::try_take_job() -> Detail::Job*
+{
+	Detail::Job* job = nullptr;
+	if (is_worker_thread()) {
+		job = deques[current_worker.index]->pop();
+	}
+
+	if (job == nullptr && injection_size.load(std::memory_order_acquire) > 0) {
+		std::scoped_lock lock { injection_mutex };
+		if (!injection_queue.empty()) {
+			job = injection_queue.front();
+			injection_queue.pop_front();
+			injection_size.fetch_sub(1, std::memory_order_release);
+		}
+
+		// Workers move a batch onto their own deque, where the other workers can steal it without taking the lock.
+		for (std::size_t i = 0; is_worker_thread() && i < injection_batch_size && !injection_queue.empty(); i++) {
+			if (!deques[current_worker.index]->push(injection_queue.front())) {
+				break;
+			}
+			injection_queue.pop_front();
+			injection_size.fetch_sub(1, std::memory_order_release);
+		}
+	}
+
+	if (job == nullptr && !deques.empty()) {
+		const auto count = deques.size();
+		const auto start = static_cast<std::size_t>(next_random()) % count;
+		for (std::size_t i = 0; i < count && job == nullptr; i++) {
+			const auto victim = (start + i) % count;
+			if (is_worker_thread() && victim == current_worker.index) {
+				continue;
+			}
+			job = deques[victim]->steal();
+		}
+	}
+
+	if (job != nullptr) {
+		queued_jobs.fetch_sub(1, std::memory_order_relaxed);
+	}
+	return job;
+}
+
+void ThreadPool::run_job(Detail::Job* job) noexcept
+{
+	DISARRAY_PROFILE_SCOPE("Job")
+	auto* counter = job->counter;
+	job->invoke(*job);
+	job_allocator.release(job);
+
+	if (counter != nullptr) {
+		counter->decrement();
+	}
+	outstanding_jobs.decrement();
+}
+
+void ThreadPool::wait(JobCounter& counter)
+{
+	while (!counter.is_done()) {
+		if (auto* job = try_take_job(); job != nullptr) {
+			run_job(job);
+			continue;
+		}
+
+		if (!is_worker_thread()) {
+			// Everything left is running on a worker, and the workers drain anything those jobs schedule.
+			if (queued_jobs.load(std::memory_order_acquire) == 0) {
+				counter.wait_blocking();
+			}
+			continue;
+		}
+
+		// Blocking here could starve jobs this counter depends on, so sleep until there is work to steal and poll the counter.
+		std::unique_lock lock { sleep_mutex };
+		sleeping_threads.fetch_add(1, std::memory_order_seq_cst);
+		sleep_condition.wait_for(lock, helping_poll_interval, [this, &counter] { return queued_jobs.load() > 0 || counter.is_done(); });
+		sleeping_threads.fetch_sub(1, std::memory_order_seq_cst);
+	}
+}
+
+void ThreadPool::wait_for_tasks() { wait(outstanding_jobs); }
+
+void ThreadPool::reset(const concurrency_t thread_count_in)
+{
+	wait_for_tasks();
+	destroy_threads();
+	thread_count = determine_thread_count(thread_count_in);
+	create_threads();
+}
+
+void ThreadPool::worker(std::size_t index)
+{
+	current_worker = { .pool = this, .index = index };
+	DISARRAY_PROFILE_THREAD(fmt::format("Worker {}", index))
+
+	std::size_t idle_spins = 0;
+	while (true) {
+		if (auto* job = try_take_job(); job != nullptr) {
+			run_job(job);
+			idle_spins = 0;
+			continue;
+		}
+
+		// Jobs tend to arrive in bursts, so look again a few times before paying for a sleep and a wake up.
+		if (idle_spins++ < idle_spin_count) {
+			std::this_thread::yield();
+			continue;
+		}
+		idle_spins = 0;
+
+		std::unique_lock lock { sleep_mutex };
+		if (!running) {
+			break;
+		}
+		sleeping_threads.fetch_add(1, std::memory_order_seq_cst);
+		sleep_condition.wait(lock, [this] { return queued_jobs.load(std::memory_order_seq_cst) > 0 || !running; });
+		sleeping_threads.fetch_sub(1, std::memory_order_seq_cst);
+		if (!running && queued_jobs.load() == 0) {
+			break;
+		}
+	}
+
+	current_worker = {};
+}
+
+void ThreadPool::create_threads()
+{
+	running = true;
+	deques.clear();
+	for (concurrency_t i = 0; i < thread_count; i++) {
+		deques.push_back(std::make_unique<Detail::WorkStealingDeque>());
+	}
+
+	threads.reserve(thread_count);
+	for (concurrency_t i = 0; i < thread_count; i++) {
+		threads.emplace_back(&ThreadPool::worker, this, static_cast<std::size_t>(i));
+	}
+}
+
+void ThreadPool::destroy_threads()
+{
+	{
+		std::scoped_lock lock { sleep_mutex };
+		running = false;
+	}
+	sleep_condition.notify_all();
+
+	for (auto& thread : threads) {
+		thread.join();
+	}
+	threads.clear();
+}
+
+void ThreadPool::join_finished_long_running()
+{
+	auto finished = std::remove_if(long_running.begin(), long_running.end(), [](LongRunning& entry) {
+		if (!*entry.finished) {
+			return false;
+		}
+		entry.thread.join();
+		return true;
+	});
+	long_running.erase(finished, long_running.end());
+}
+
+auto ThreadPool::determine_thread_count(const concurrency_t thread_count_in) -> concurrency_t
+{
+	if (thread_count_in > 0) {
+		return thread_count_in;
+	}
+	return std::max<concurrency_t>(std::thread::hardware_concurrency(), 1);
+}
+
+} // namespace Disarray::Threading
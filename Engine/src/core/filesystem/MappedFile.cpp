@@ -0,0 +1,163 @@
+#include "DisarrayPCH.hpp"
+
+#include "core/filesystem/MappedFile.hpp"
+
+#include <fstream>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Disarray::FS {
+
+MappedFile::MappedFile(const std::filesystem::path& path)
+{
+	valid = map(path) || read(path);
+}
+
+MappedFile::~MappedFile() { release(); }
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+	: bytes_begin(std::exchange(other.bytes_begin, nullptr))
+	, file_size(std::exchange(other.file_size, 0))
+	, valid(std::exchange(other.valid, false))
+	, mapping(std::exchange(other.mapping, nullptr))
+	, fallback(std::move(other.fallback))
+{
+}
+
+auto MappedFile::operator=(MappedFile&& other) noexcept -> MappedFile&
+{
+	if (this != &other) {
+		release();
+		bytes_begin = std::exchange(other.bytes_begin, nullptr);
+		file_size = std::exchange(other.file_size, 0);
+		valid = std::exchange(other.valid, false);
+		mapping = std::exchange(other.mapping, nullptr);
+		fallback = std::move(other.fallback);
+	}
+	return *this;
+}
+
+void MappedFile::release()
+{
+	if (mapping != nullptr) {
+#ifdef _WIN32
+		UnmapViewOfFile(mapping);
+#else
+		::munmap(mapping, file_size);
+#endif
+	}
+	mapping = nullptr;
+	fallback.reset();
+	bytes_begin = nullptr;
+	file_size = 0;
+	valid = false;
+}
+
+#ifdef _WIN32
+auto MappedFile::map(const std::filesystem::path& path) -> bool
+{
+	auto* file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+		FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+
+	LARGE_INTEGER length {};
+	if (!GetFileSizeEx(file, &length)) {
+		CloseHandle(file);
+		return false;
+	}
+
+	file_size = static_cast<std::size_t>(length.QuadPart);
+	if (file_size == 0) {
+		// Empty files cannot be mapped, and there is nothing to view anyway.
+		CloseHandle(file);
+		return true;
+	}
+
+	auto* file_mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	CloseHandle(file);
+	if (file_mapping == nullptr) {
+		file_size = 0;
+		return false;
+	}
+
+	mapping = MapViewOfFile(file_mapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(file_mapping);
+	if (mapping == nullptr) {
+		file_size = 0;
+		return false;
+	}
+
+	bytes_begin = static_cast<const std::byte*>(mapping);
+	return true;
+}
+#else
+auto MappedFile::map(const std::filesystem::path& path) -> bool
+{
+	const auto descriptor = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (descriptor < 0) {
+		return false;
+	}
+
+	struct stat status { };
+	if (::fstat(descriptor, &status) != 0 || !S_ISREG(status.st_mode)) {
+		::close(descriptor);
+		return false;
+	}
+
+	file_size = static_cast<std::size_t>(status.st_size);
+	if (file_size == 0) {
+		// Empty files cannot be mapped, and there is nothing to view anyway.
+		::close(descriptor);
+		return true;
+	}
+
+	auto* mapped = ::mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+	// The mapping keeps its own reference to the file.
+	::close(descriptor);
+	if (mapped == MAP_FAILED) {
+		file_size = 0;
+		return false;
+	}
+
+	::madvise(mapped, file_size, MADV_SEQUENTIAL);
+	mapping = mapped;
+	bytes_begin = static_cast<const std::byte*>(mapping);
+	return true;
+}
+#endif
+
+auto MappedFile::read(const std::filesystem::path& path) -> bool
+{
+	std::ifstream stream { path, std::ios::binary | std::ios::ate };
+	if (!stream) {
+		return false;
+	}
+
+	const auto length = static_cast<std::size_t>(stream.tellg());
+	stream.seekg(0);
+
+	// Not value-initialised, every byte is overwritten by the read.
+	fallback.reset(new std::byte[length]);
+	if (!stream.read(reinterpret_cast<char*>(fallback.get()), static_cast<std::streamsize>(length))) {
+		fallback.reset();
+		return false;
+	}
+
+	bytes_begin = fallback.get();
+	file_size = length;
+	return true;
+}
+
+} // namespace Disarray::FS
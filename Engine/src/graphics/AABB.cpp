@@ -1,7 +1,171 @@
 #include "graphics/AABB.hpp"
 
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+
+#if !defined(DISARRAY_NO_SIMD) && defined(__AVX__)
+#include <immintrin.h>
+#define DISARRAY_BOUNDS_AVX
+#define DISARRAY_BOUNDS_SSE
+#elif !defined(DISARRAY_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define DISARRAY_BOUNDS_SSE
+#endif
+
 namespace Disarray {
 
+namespace {
+	static_assert(offsetof(ModelVertex, pos) + 4 * sizeof(float) <= sizeof(ModelVertex), "Positions are loaded as four floats");
+
+	struct PositionRange {
+		glm::vec3 minimum { std::numeric_limits<float>::max() };
+		glm::vec3 maximum { std::numeric_limits<float>::lowest() };
+	};
+
+	auto to_aabb(const glm::vec3& minimum, const glm::vec3& maximum) -> AABB
+	{
+		return { AABBRange { minimum.x, maximum.x }, AABBRange { minimum.y, maximum.y }, AABBRange { minimum.z, maximum.z } };
+	}
+
+#ifdef DISARRAY_BOUNDS_SSE
+	// The fourth lane is the first uv coordinate, which the reductions below never read back.
+	auto load_position(const ModelVertex& vertex) -> __m128 { return _mm_loadu_ps(&vertex.pos.x); }
+
+	auto to_vec3(__m128 value) -> glm::vec3
+	{
+		alignas(16) std::array<float, 4> lanes {};
+		_mm_store_ps(lanes.data(), value);
+		return { lanes[0], lanes[1], lanes[2] };
+	}
+#endif
+
+	// Two independent accumulators on each path, so consecutive min and max operations do not wait on each other.
+	auto position_range(std::span<const ModelVertex> vertices) -> PositionRange
+	{
+		PositionRange range {};
+		std::size_t index = 0;
+#if defined(DISARRAY_BOUNDS_AVX)
+		if (vertices.size() >= 4) {
+			auto minimum_first = _mm256_set1_ps(std::numeric_limits<float>::max());
+			auto minimum_second = minimum_first;
+			auto maximum_first = _mm256_set1_ps(std::numeric_limits<float>::lowest());
+			auto maximum_second = maximum_first;
+			for (; index + 4 <= vertices.size(); index += 4) {
+				const auto first
+					= _mm256_insertf128_ps(_mm256_castps128_ps256(load_position(vertices[index])), load_position(vertices[index + 1]), 1);
+				const auto second
+					= _mm256_insertf128_ps(_mm256_castps128_ps256(load_position(vertices[index + 2])), load_position(vertices[index + 3]), 1);
+				minimum_first = _mm256_min_ps(minimum_first, first);
+				maximum_first = _mm256_max_ps(maximum_first, first);
+				minimum_second = _mm256_min_ps(minimum_second, second);
+				maximum_second = _mm256_max_ps(maximum_second, second);
+			}
+			const auto minimum = _mm256_min_ps(minimum_first, minimum_second);
+			const auto maximum = _mm256_max_ps(maximum_first, maximum_second);
+			range.minimum = to_vec3(_mm_min_ps(_mm256_castps256_ps128(minimum), _mm256_extractf128_ps(minimum, 1)));
+			range.maximum = to_vec3(_mm_max_ps(_mm256_castps256_ps128(maximum), _mm256_extractf128_ps(maximum, 1)));
+		}
+#elif defined(DISARRAY_BOUNDS_SSE)
+		if (vertices.size() >= 2) {
+			auto minimum_first = _mm_set1_ps(std::numeric_limits<float>::max());
+			auto minimum_second = minimum_first;
+			auto maximum_first = _mm_set1_ps(std::numeric_limits<float>::lowest());
+			auto maximum_second = maximum_first;
+			for (; index + 2 <= vertices.size(); index += 2) {
+				const auto first = load_position(vertices[index]);
+				const auto second = load_position(vertices[index + 1]);
+				minimum_first = _mm_min_ps(minimum_first, first);
+				maximum_first = _mm_max_ps(maximum_first, first);
+				minimum_second = _mm_min_ps(minimum_second, second);
+				maximum_second = _mm_max_ps(maximum_second, second);
+			}
+			range.minimum = to_vec3(_mm_min_ps(minimum_first, minimum_second));
+			range.maximum = to_vec3(_mm_max_ps(maximum_first, maximum_second));
+		}
+#endif
+		for (; index < vertices.size(); index++) {
+			const auto& position = vertices[index].pos;
+			range.minimum.x = std::min(range.minimum.x, position.x);
+			range.minimum.y = std::min(range.minimum.y, position.y);
+			range.minimum.z = std::min(range.minimum.z, position.z);
+			range.maximum.x = std::max(range.maximum.x, position.x);
+			range.maximum.y = std::max(range.maximum.y, position.y);
+			range.maximum.z = std::max(range.maximum.z, position.z);
+		}
+		return range;
+	}
+
+	auto max_squared_distance(std::span<const ModelVertex> vertices, const glm::vec3& centre) -> float
+	{
+		auto result = 0.0F;
+		std::size_t index = 0;
+#ifdef DISARRAY_BOUNDS_SSE
+		// Four positions at a time, transposed so each register holds one axis of all four.
+		if (vertices.size() >= 4) {
+			const auto centre_x = _mm_set1_ps(centre.x);
+			const auto centre_y = _mm_set1_ps(centre.y);
+			const auto centre_z = _mm_set1_ps(centre.z);
+			auto maximum = _mm_setzero_ps();
+			for (; index + 4 <= vertices.size(); index += 4) {
+				auto xs = load_position(vertices[index]);
+				auto ys = load_position(vertices[index + 1]);
+				auto zs = load_position(vertices[index + 2]);
+				auto unused = load_position(vertices[index + 3]);
+				_MM_TRANSPOSE4_PS(xs, ys, zs, unused);
+				const auto x = _mm_sub_ps(xs, centre_x);
+				const auto y = _mm_sub_ps(ys, centre_y);
+				const auto z = _mm_sub_ps(zs, centre_z);
+				maximum = _mm_max_ps(maximum, _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z)));
+			}
+			alignas(16) std::array<float, 4> lanes {};
+			_mm_store_ps(lanes.data(), maximum);
+			result = std::max({ lanes[0], lanes[1], lanes[2], lanes[3] });
+		}
+#endif
+		for (; index < vertices.size(); index++) {
+			const auto offset = vertices[index].pos - centre;
+			result = std::max(result, glm::dot(offset, offset));
+		}
+		return result;
+	}
+} // namespace
+
+auto BoundingSphere::from_vertices(std::span<const ModelVertex> vertices, const glm::vec3& centre) -> BoundingSphere
+{
+	return { centre, std::sqrt(max_squared_distance(vertices, centre)) };
+}
+
+auto BoundingSphere::transformed(const glm::mat4& transform) const -> BoundingSphere
+{
+	const auto scale = std::max({ glm::length(glm::vec3 { transform[0] }), glm::length(glm::vec3 { transform[1] }),
+		glm::length(glm::vec3 { transform[2] }) });
+	return { glm::vec3 { transform * glm::vec4 { centre, 1.0F } }, radius * scale };
+}
+
+auto BoundingSphere::intersects(const BoundingSphere& other) const -> bool
+{
+	const auto offset = other.centre - centre;
+	const auto reach = radius + other.radius;
+	return glm::dot(offset, offset) <= reach * reach;
+}
+
+auto AABB::empty() -> AABB
+{
+	const PositionRange range {};
+	return to_aabb(range.minimum, range.maximum);
+}
+
+auto AABB::from_vertices(std::span<const ModelVertex> vertices) -> AABB
+{
+	const auto range = position_range(vertices);
+	return to_aabb(range.minimum, range.maximum);
+}
+
 auto AABB::calculate_scale_matrix() const -> glm::mat4
 {
 	glm::vec3 max {
@@ -34,4 +198,63 @@ auto AABB::middle_point() const -> glm::vec3
 	return (max + min) * 0.5F;
 }
 
+auto AABB::minimum() const -> glm::vec3 { return { min_max_x.min, min_max_y.min, min_max_z.min }; }
+
+auto AABB::maximum() const -> glm::vec3 { return { min_max_x.max, min_max_y.max, min_max_z.max }; }
+
+auto AABB::is_empty() const -> bool { return min_max_x.min > min_max_x.max || min_max_y.min > min_max_y.max || min_max_z.min > min_max_z.max; }
+
+auto AABB::transformed(const glm::mat4& transform) const -> AABB
+{
+	if (is_empty()) {
+		return *this;
+	}
+
+	// Every output axis starts at the translation and adds the smaller, respectively larger, contribution of each input axis.
+	const auto lower = minimum();
+	const auto upper = maximum();
+	glm::vec3 output_minimum { transform[3] };
+	glm::vec3 output_maximum { transform[3] };
+	for (glm::length_t column = 0; column < 3; column++) {
+		for (glm::length_t row = 0; row < 3; row++) {
+			const auto from_lower = transform[column][row] * lower[column];
+			const auto from_upper = transform[column][row] * upper[column];
+			output_minimum[row] += std::min(from_lower, from_upper);
+			output_maximum[row] += std::max(from_lower, from_upper);
+		}
+	}
+	return to_aabb(output_minimum, output_maximum);
+}
+
+auto AABB::merged(const AABB& other) const -> AABB
+{
+	return to_aabb(glm::min(minimum(), other.minimum()), glm::max(maximum(), other.maximum()));
+}
+
+auto AABB::intersects(const AABB& other) const -> bool
+{
+	if (is_empty() || other.is_empty()) {
+		return false;
+	}
+	const auto lower = glm::max(minimum(), other.minimum());
+	const auto upper = glm::min(maximum(), other.maximum());
+	return lower.x <= upper.x && lower.y <= upper.y && lower.z <= upper.z;
+}
+
+auto AABB::intersects(const BoundingSphere& sphere) const -> bool
+{
+	if (is_empty()) {
+		return false;
+	}
+	const auto closest = glm::clamp(sphere.centre, minimum(), maximum());
+	const auto offset = closest - sphere.centre;
+	return glm::dot(offset, offset) <= sphere.radius * sphere.radius;
+}
+
+auto AABB::contains(const glm::vec3& point) const -> bool
+{
+	return point.x >= min_max_x.min && point.x <= min_max_x.max && point.y >= min_max_y.min && point.y <= min_max_y.max && point.z >= min_max_z.min
+		&& point.z <= min_max_z.max;
+}
+
 } // namespace Disarray
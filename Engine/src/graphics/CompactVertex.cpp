@@ -0,0 +1,256 @@
+#include "DisarrayPCH.hpp"
+
+#include "graphics/CompactVertex.hpp"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+
+namespace Disarray {
+
+auto MeshFootprint::operator+=(const MeshFootprint& other) -> MeshFootprint&
+{
+	vertex_count += other.vertex_count;
+	index_count += other.index_count;
+	full_vertex_bytes += other.full_vertex_bytes;
+	vertex_bytes += other.vertex_bytes;
+	index_bytes += other.index_bytes;
+	return *this;
+}
+
+namespace CompactVertices {
+
+	namespace {
+		// The smallest w a snorm16 keeps away from zero, so the sign of the bitangent survives quantisation.
+		constexpr float quaternion_w_bias = 1.0F / 32767.0F;
+
+		auto sign_not_zero(float value) -> float { return value < 0.0F ? -1.0F : 1.0F; }
+
+		auto any_orthogonal(const glm::vec3& normal) -> glm::vec3
+		{
+			const auto axis = std::abs(normal.x) < 0.9F ? glm::vec3 { 1.0F, 0.0F, 0.0F } : glm::vec3 { 0.0F, 1.0F, 0.0F };
+			return glm::normalize(glm::cross(normal, axis));
+		}
+
+		auto to_words(std::uint64_t packed) -> std::array<std::uint32_t, 2> { return std::bit_cast<std::array<std::uint32_t, 2>>(packed); }
+		auto from_words(const std::array<std::uint32_t, 2>& words) -> std::uint64_t { return std::bit_cast<std::uint64_t>(words); }
+
+		template <class Vertex> auto encode_attributes(const ModelVertex& vertex, Vertex& output)
+		{
+			output.uvs = encode_uvs(vertex.uvs);
+			output.normal = encode_normal(vertex.normals);
+			output.tangent_frame = encode_tangent_frame(vertex.normals, vertex.tangents, vertex.bitangents);
+			output.colour = encode_colour(vertex.color);
+		}
+
+		template <class Vertex> auto decode_attributes(const Vertex& vertex, ModelVertex& output)
+		{
+			output.uvs = decode_uvs(vertex.uvs);
+			output.normals = decode_normal(vertex.normal);
+			const auto frame = decode_tangent_frame(vertex.tangent_frame);
+			output.tangents = frame.tangent;
+			output.bitangents = frame.bitangent;
+			output.color = decode_colour(vertex.colour);
+		}
+	} // namespace
+
+	auto vertex_size(VertexFormat format) -> std::size_t
+	{
+		switch (format) {
+		case VertexFormat::Full:
+			return sizeof(ModelVertex);
+		case VertexFormat::Compact:
+			return sizeof(CompactVertex);
+		case VertexFormat::CompactQuantised:
+			return sizeof(QuantisedCompactVertex);
+		default:
+			unreachable("Could not map vertex format to size.");
+		}
+	}
+
+	auto layout(VertexFormat format) -> VertexLayout
+	{
+		switch (format) {
+		case VertexFormat::Full:
+			return {
+				{ ElementType::Float3, "position" },
+				{ ElementType::Float2, "uvs" },
+				{ ElementType::Float4, "colour" },
+				{ ElementType::Float3, "normals" },
+				{ ElementType::Float3, "tangents" },
+				{ ElementType::Float3, "bitangents" },
+			};
+		case VertexFormat::Compact:
+			return {
+				{ ElementType::Float3, "position" },
+				{ ElementType::Half2, "uvs" },
+				{ ElementType::Snorm16x2, "normal" },
+				{ ElementType::Snorm16x4, "tangent_frame" },
+				{ ElementType::Unorm8x4, "colour" },
+			};
+		case VertexFormat::CompactQuantised:
+			return {
+				{ ElementType::Unorm16x4, "position" },
+				{ ElementType::Half2, "uvs" },
+				{ ElementType::Snorm16x2, "normal" },
+				{ ElementType::Snorm16x4, "tangent_frame" },
+				{ ElementType::Unorm8x4, "colour" },
+			};
+		default:
+			unreachable("Could not map vertex format to layout.");
+		}
+	}
+
+	auto footprint(std::size_t vertex_count, std::size_t index_count, VertexFormat format) -> MeshFootprint
+	{
+		return {
+			.vertex_count = vertex_count,
+			.index_count = index_count,
+			.full_vertex_bytes = vertex_count * sizeof(ModelVertex),
+			.vertex_bytes = vertex_count * vertex_size(format),
+			.index_bytes = index_count * sizeof(std::uint32_t),
+		};
+	}
+
+	auto encode_uvs(const glm::vec2& uvs) -> std::uint32_t { return glm::packHalf2x16(uvs); }
+	auto decode_uvs(std::uint32_t encoded) -> glm::vec2 { return glm::unpackHalf2x16(encoded); }
+
+	// Cigolle et al., "A Survey of Efficient Representations for Independent Unit Vectors".
+	auto encode_normal(const glm::vec3& normal) -> std::uint32_t
+	{
+		const auto manhattan = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+		if (manhattan == 0.0F) {
+			return glm::packSnorm2x16(glm::vec2 { 0.0F });
+		}
+
+		glm::vec2 octahedral { normal.x / manhattan, normal.y / manhattan };
+		if (normal.z < 0.0F) {
+			octahedral = glm::vec2 {
+				(1.0F - std::abs(octahedral.y)) * sign_not_zero(octahedral.x),
+				(1.0F - std::abs(octahedral.x)) * sign_not_zero(octahedral.y),
+			};
+		}
+		return glm::packSnorm2x16(octahedral);
+	}
+
+	auto decode_normal(std::uint32_t encoded) -> glm::vec3
+	{
+		const auto octahedral = glm::unpackSnorm2x16(encoded);
+		glm::vec3 normal { octahedral.x, octahedral.y, 1.0F - std::abs(octahedral.x) - std::abs(octahedral.y) };
+		if (normal.z < 0.0F) {
+			const auto x = normal.x;
+			normal.x = (1.0F - std::abs(normal.y)) * sign_not_zero(x);
+			normal.y = (1.0F - std::abs(x)) * sign_not_zero(normal.y);
+		}
+		return glm::normalize(normal);
+	}
+
+	auto encode_tangent_frame(const glm::vec3& normal, const glm::vec3& tangent, const glm::vec3& bitangent) -> std::array<std::uint32_t, 2>
+	{
+		const auto normal_length = glm::length(normal);
+		const auto unit_normal = normal_length > 0.0F ? normal / normal_length : glm::vec3 { 0.0F, 0.0F, 1.0F };
+
+		auto orthogonal = tangent - unit_normal * glm::dot(unit_normal, tangent);
+		const auto tangent_length = glm::length(orthogonal);
+		const auto unit_tangent = tangent_length > 1e-6F ? orthogonal / tangent_length : any_orthogonal(unit_normal);
+		const auto unit_bitangent = glm::cross(unit_normal, unit_tangent);
+		const auto handedness = glm::dot(unit_bitangent, bitangent) < 0.0F ? -1.0F : 1.0F;
+
+		auto frame = glm::normalize(glm::quat_cast(glm::mat3 { unit_tangent, unit_bitangent, unit_normal }));
+		if (frame.w < 0.0F) {
+			frame = -frame;
+		}
+		if (frame.w < quaternion_w_bias) {
+			const auto rescale = std::sqrt(1.0F - quaternion_w_bias * quaternion_w_bias);
+			frame = glm::quat { quaternion_w_bias, frame.x * rescale, frame.y * rescale, frame.z * rescale };
+		}
+		if (handedness < 0.0F) {
+			frame = -frame;
+		}
+		return to_words(glm::packSnorm4x16(glm::vec4 { frame.x, frame.y, frame.z, frame.w }));
+	}
+
+	auto decode_tangent_frame(const std::array<std::uint32_t, 2>& encoded) -> TangentFrame
+	{
+		const auto unpacked = glm::unpackSnorm4x16(from_words(encoded));
+		const auto handedness = sign_not_zero(unpacked.w);
+		const auto frame = glm::normalize(glm::quat { unpacked.w, unpacked.x, unpacked.y, unpacked.z });
+
+		TangentFrame output {};
+		output.normal = frame * glm::vec3 { 0.0F, 0.0F, 1.0F };
+		output.tangent = frame * glm::vec3 { 1.0F, 0.0F, 0.0F };
+		output.bitangent = glm::cross(output.normal, output.tangent) * handedness;
+		return output;
+	}
+
+	auto encode_colour(const glm::vec4& colour) -> std::uint32_t { return glm::packUnorm4x8(colour); }
+	auto decode_colour(std::uint32_t encoded) -> glm::vec4 { return glm::unpackUnorm4x8(encoded); }
+
+	auto dequantisation_for(std::span<const ModelVertex> vertices) -> PositionDequantisation
+	{
+		if (vertices.empty()) {
+			return {};
+		}
+
+		glm::vec3 minimum { std::numeric_limits<float>::max() };
+		glm::vec3 maximum { std::numeric_limits<float>::lowest() };
+		for (const auto& vertex : vertices) {
+			minimum = glm::min(minimum, vertex.pos);
+			maximum = glm::max(maximum, vertex.pos);
+		}
+
+		PositionDequantisation output { .offset = minimum };
+		for (glm::length_t axis = 0; axis < 3; axis++) {
+			const auto extent = maximum[axis] - minimum[axis];
+			output.scale[axis] = extent > 0.0F ? extent : 1.0F;
+		}
+		return output;
+	}
+
+	auto encode(std::span<const ModelVertex> vertices) -> std::vector<CompactVertex>
+	{
+		std::vector<CompactVertex> output(vertices.size());
+		for (std::size_t index = 0; index < vertices.size(); index++) {
+			output[index].pos = vertices[index].pos;
+			encode_attributes(vertices[index], output[index]);
+		}
+		return output;
+	}
+
+	auto encode_quantised(std::span<const ModelVertex> vertices, const PositionDequantisation& dequantisation)
+		-> std::vector<QuantisedCompactVertex>
+	{
+		std::vector<QuantisedCompactVertex> output(vertices.size());
+		for (std::size_t index = 0; index < vertices.size(); index++) {
+			const auto normalised = (vertices[index].pos - dequantisation.offset) / dequantisation.scale;
+			output[index].pos = std::bit_cast<std::array<std::uint16_t, 4>>(glm::packUnorm4x16(glm::vec4 { normalised, 0.0F }));
+			encode_attributes(vertices[index], output[index]);
+		}
+		return output;
+	}
+
+	auto decode(const CompactVertex& vertex) -> ModelVertex
+	{
+		ModelVertex output {};
+		output.pos = vertex.pos;
+		decode_attributes(vertex, output);
+		return output;
+	}
+
+	auto decode(const QuantisedCompactVertex& vertex, const PositionDequantisation& dequantisation) -> ModelVertex
+	{
+		ModelVertex output {};
+		const glm::vec3 normalised = glm::unpackUnorm4x16(std::bit_cast<std::uint64_t>(vertex.pos));
+		output.pos = dequantisation.offset + dequantisation.scale * normalised;
+		decode_attributes(vertex, output);
+		return output;
+	}
+
+} // namespace CompactVertices
+
+} // namespace Disarray
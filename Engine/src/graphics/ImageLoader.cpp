@@ -26,13 +26,17 @@ ImageLoader::ImageLoader(const std::filesystem::path& path, Disarray::DataBuffer
 
 	int requested = STBI_rgb_alpha;
 	data = stbi_load(path.string().c_str(), &tex_width, &tex_height, &channels, requested);
+	if (data == nullptr) {
+		Log::error("ImageLoader", "Could not decode {}: {}", path, stbi_failure_reason());
+		return;
+	}
 	size = tex_width * tex_height * requested;
 
 	extent.width = static_cast<std::uint32_t>(tex_width);
 	extent.height = static_cast<std::uint32_t>(tex_height);
 
 	DataBuffer data_buffer { data, size };
-	buffer.copy_from(data_buffer);
+	swap(buffer, data_buffer);
 }
 
 ImageLoader::~ImageLoader() { free(); }
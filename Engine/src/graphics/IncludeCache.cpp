@@ -0,0 +1,126 @@
+#include "DisarrayPCH.hpp"
+
+#include "graphics/IncludeCache.hpp"
+
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <system_error>
+
+#include "core/Collections.hpp"
+#include "core/Log.hpp"
+#include "core/filesystem/MappedFile.hpp"
+
+namespace Disarray {
+
+namespace {
+	struct Registry {
+		std::mutex mutex {};
+		Collections::StringMap<IncludeHandle> files {};
+		IncludeCacheStatistics statistics {};
+	};
+
+	auto registry() -> Registry&
+	{
+		static Registry instance {};
+		return instance;
+	}
+
+	auto key_of(const std::filesystem::path& path) -> std::string
+	{
+		std::error_code error_code {};
+		const auto absolute = std::filesystem::absolute(path, error_code);
+		return (error_code ? path : absolute).lexically_normal().generic_string();
+	}
+
+	auto is_current(const IncludeFile& file, std::filesystem::file_time_type last_write_time, std::uintmax_t size) -> bool
+	{
+		return file.last_write_time == last_write_time && file.size == size;
+	}
+} // namespace
+
+namespace IncludeCache {
+
+	auto get(const std::filesystem::path& path) -> IncludeHandle
+	{
+		auto& instance = registry();
+		const auto key = key_of(path);
+
+		std::error_code error_code {};
+		const auto last_write_time = std::filesystem::last_write_time(path, error_code);
+		const auto size = error_code ? 0 : std::filesystem::file_size(path, error_code);
+		if (error_code) {
+			invalidate(path);
+			return nullptr;
+		}
+
+		{
+			std::scoped_lock lock { instance.mutex };
+			if (const auto found = instance.files.find(key); found != instance.files.end() && is_current(*found->second, last_write_time, size)) {
+				instance.statistics.hits++;
+				return found->second;
+			}
+		}
+
+		// Read without the lock, so compilations that need different files do not wait on each other. The mapping is only kept while
+		// copying, an editor truncating the file later would otherwise make reading it fault.
+		auto file = std::make_shared<IncludeFile>();
+		{
+			const FS::MappedFile mapped { path };
+			if (!mapped) {
+				Log::error("IncludeCache", "Could not read {}", path.string());
+				return nullptr;
+			}
+			file->source = std::string { mapped.view() };
+		}
+		file->path = path;
+		file->last_write_time = last_write_time;
+		file->size = size;
+
+		std::scoped_lock lock { instance.mutex };
+		instance.statistics.misses++;
+		instance.statistics.bytes_read += file->source.size();
+		auto& entry = instance.files[key];
+		// Another thread may have read the same version meanwhile, every caller then shares the first one.
+		if (entry && is_current(*entry, last_write_time, size)) {
+			return entry;
+		}
+		entry = std::move(file);
+		return entry;
+	}
+
+	void invalidate(const std::filesystem::path& path)
+	{
+		auto& instance = registry();
+		const auto key = key_of(path);
+		std::scoped_lock lock { instance.mutex };
+		if (instance.files.erase(key) > 0) {
+			instance.statistics.invalidations++;
+		}
+	}
+
+	void clear()
+	{
+		auto& instance = registry();
+		std::scoped_lock lock { instance.mutex };
+		instance.files.clear();
+	}
+
+	auto statistics() -> IncludeCacheStatistics
+	{
+		auto& instance = registry();
+		std::scoped_lock lock { instance.mutex };
+		return instance.statistics;
+	}
+
+	void reset_statistics()
+	{
+		auto& instance = registry();
+		std::scoped_lock lock { instance.mutex };
+		instance.statistics = {};
+	}
+
+} // namespace IncludeCache
+
+} // namespace Disarray
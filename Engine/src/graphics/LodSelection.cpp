@@ -0,0 +1,66 @@
+#include "DisarrayPCH.hpp"
+
+#include "graphics/LodSelection.hpp"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace Disarray::LodSelection {
+
+namespace {
+	auto deepest_within(std::span<const float> level_errors, float scale, float bound) -> std::uint32_t
+	{
+		std::uint32_t deepest = 0;
+		for (std::uint32_t level = 1; level < level_errors.size(); level++) {
+			if (level_errors[level] * scale <= bound) {
+				deepest = level;
+			}
+		}
+		return deepest;
+	}
+} // namespace
+
+auto projection_for(const glm::mat4& view, const glm::mat4& projection, std::uint32_t viewport_height) -> LodProjection
+{
+	const auto camera = glm::inverse(view)[3];
+	return {
+		.camera_position = glm::vec3 { camera.x, camera.y, camera.z },
+		.pixels_per_unit = std::abs(projection[1][1]) * static_cast<float>(viewport_height) * 0.5F,
+	};
+}
+
+auto projected_scale(const AABB& bounds, const glm::mat4& transform, const LodProjection& projection) -> float
+{
+	const auto [min_x, max_x] = bounds.for_axis<AABBAxis::X>();
+	const auto [min_y, max_y] = bounds.for_axis<AABBAxis::Y>();
+	const auto [min_z, max_z] = bounds.for_axis<AABBAxis::Z>();
+	const auto half_diagonal = 0.5F * glm::length(glm::vec3 { max_x - min_x, max_y - min_y, max_z - min_z });
+
+	const auto column_scale = std::max({ glm::length(glm::vec3 { transform[0] }), glm::length(glm::vec3 { transform[1] }),
+		glm::length(glm::vec3 { transform[2] }) });
+	const auto centre = transform * glm::vec4 { bounds.middle_point(), 1.0F };
+	const auto radius = half_diagonal * column_scale;
+	const auto distance = glm::length(glm::vec3 { centre } - projection.camera_position) - radius;
+	if (distance <= 0.0F) {
+		return std::numeric_limits<float>::infinity();
+	}
+	return projection.pixels_per_unit * column_scale / distance;
+}
+
+auto select(std::span<const float> level_errors, float scale, std::uint32_t current, const LodSelectionSettings& settings) -> std::uint32_t
+{
+	if (!settings.enabled || level_errors.size() <= 1 || !std::isfinite(scale)) {
+		return 0;
+	}
+
+	const auto refine_to = deepest_within(level_errors, scale, settings.pixel_error);
+	if (current > refine_to) {
+		return refine_to;
+	}
+	return std::max(current, deepest_within(level_errors, scale, settings.pixel_error * (1.0F - settings.hysteresis)));
+}
+
+} // namespace Disarray::LodSelection
@@ -0,0 +1,508 @@
+#include "DisarrayPCH.hpp"
+
+#include "graphics/MeshCache.hpp"
+
+#include <fmt/format.h>
+
+#include <array>
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+
+#include "core/Hashes.hpp"
+#include "core/Log.hpp"
+
+namespace Disarray {
+
+namespace {
+	static_assert(std::is_trivially_copyable_v<ModelVertex>, "ModelVertex is written to and viewed from .dmesh files as raw bytes");
+	static_assert(std::is_trivially_copyable_v<Meshlet>, "Meshlet is written to and viewed from .dmesh files as raw bytes");
+
+	constexpr std::array<char, 8> magic { 'D', 'M', 'E', 'S', 'H', '\0', '\0', '\0' };
+	constexpr std::size_t blob_alignment = 16;
+
+	struct Header {
+		std::array<char, 8> magic {};
+		std::uint32_t version { 0 };
+		std::uint32_t vertex_size { 0 };
+		std::uint64_t source_hash { 0 };
+		std::uint64_t file_size { 0 };
+		std::uint32_t flags { 0 };
+		std::uint32_t submesh_count { 0 };
+		std::array<float, 16> initial_rotation {};
+		std::array<float, 6> aabb {};
+		std::uint64_t optimisation { 0 };
+		std::uint64_t lods { 0 };
+		std::uint64_t meshlets { 0 };
+	};
+
+	struct SubmeshRecord {
+		std::uint64_t name_offset { 0 };
+		std::uint64_t name_length { 0 };
+		std::uint64_t vertex_offset { 0 };
+		std::uint64_t vertex_count { 0 };
+		std::uint64_t index_offset { 0 };
+		std::uint64_t index_count { 0 };
+		std::uint64_t texture_offset { 0 };
+		std::uint64_t texture_count { 0 };
+		std::uint64_t lod_offset { 0 };
+		std::uint64_t lod_count { 0 };
+		std::uint64_t meshlet_offset { 0 };
+		std::uint64_t meshlet_count { 0 };
+	};
+
+	struct LodRecord {
+		std::uint64_t index_offset { 0 };
+		std::uint64_t index_count { 0 };
+		float error { 0.0F };
+		std::uint32_t padding { 0 };
+	};
+
+	struct TextureRecord {
+		std::uint64_t path_offset { 0 };
+		std::uint64_t path_length { 0 };
+		std::uint64_t name_offset { 0 };
+		std::uint64_t name_length { 0 };
+		std::uint32_t mips { 0 };
+		std::uint32_t generate_mips { 0 };
+	};
+
+	struct Registry {
+		std::mutex mutex {};
+		MeshCacheConfiguration configuration {};
+	};
+
+	auto registry() -> Registry&
+	{
+		static Registry instance {};
+		return instance;
+	}
+
+	auto get_configuration() -> MeshCacheConfiguration
+	{
+		auto& instance = registry();
+		std::scoped_lock lock { instance.mutex };
+		return instance.configuration;
+	}
+
+	auto align_up(std::uint64_t value, std::uint64_t alignment) -> std::uint64_t { return (value + alignment - 1) / alignment * alignment; }
+
+	auto to_array(const glm::mat4& matrix) -> std::array<float, 16>
+	{
+		std::array<float, 16> output {};
+		std::memcpy(output.data(), &matrix[0][0], sizeof(output));
+		return output;
+	}
+
+	auto to_array(const AABB& aabb) -> std::array<float, 6>
+	{
+		const auto x = aabb.for_axis<AABBAxis::X>();
+		const auto y = aabb.for_axis<AABBAxis::Y>();
+		const auto z = aabb.for_axis<AABBAxis::Z>();
+		return { x.min, x.max, y.min, y.max, z.min, z.max };
+	}
+
+	// Optimisation rewrites the stored vertices and indices, so the enabled stages are part of the key.
+	auto to_bits(const MeshOptimisationSettings& settings) -> std::uint64_t
+	{
+		std::uint64_t bits = (settings.vertex_cache ? 1U : 0U) | (settings.overdraw ? 2U : 0U) | (settings.vertex_fetch ? 4U : 0U);
+		if (settings.overdraw) {
+			bits |= static_cast<std::uint64_t>(std::bit_cast<std::uint32_t>(settings.overdraw_threshold)) << 32U;
+		}
+		return bits;
+	}
+
+	// Zero when no levels are built, so meshes without them keep the keys they had.
+	auto to_bits(const LodSettings& settings) -> std::uint64_t
+	{
+		if (!settings.any()) {
+			return 0;
+		}
+		const auto bits = hash_bytes(std::as_bytes(std::span { settings.ratios }), std::bit_cast<std::uint32_t>(settings.max_error));
+		return bits == 0 ? 1 : bits;
+	}
+
+	// Zero when meshlets are off, for the same reason.
+	auto to_bits(const MeshletSettings& settings) -> std::uint64_t
+	{
+		if (!settings.enabled) {
+			return 0;
+		}
+		const std::array<std::uint32_t, 3> values {
+			settings.max_vertices,
+			settings.max_triangles,
+			std::bit_cast<std::uint32_t>(settings.cone_weight),
+		};
+		const auto bits = hash_bytes(std::as_bytes(std::span { values }));
+		return bits == 0 ? 1 : bits;
+	}
+
+	auto key_for(std::uint64_t source_hash, ImportFlag flags, const glm::mat4& initial_rotation, const MeshOptimisationSettings& optimisation,
+		const LodSettings& lods, const MeshletSettings& meshlets) -> std::uint64_t
+	{
+		const auto rotation = to_array(initial_rotation);
+		auto key = hash_bytes(std::as_bytes(std::span { rotation }), source_hash);
+		const auto flag_bits = static_cast<std::uint32_t>(flags);
+		key = hash_bytes(std::as_bytes(std::span { &flag_bits, 1 }), key);
+		const auto optimisation_bits = to_bits(optimisation);
+		key = optimisation_bits == 0 ? key : hash_bytes(std::as_bytes(std::span { &optimisation_bits, 1 }), key);
+		const auto lod_bits = to_bits(lods);
+		key = lod_bits == 0 ? key : hash_bytes(std::as_bytes(std::span { &lod_bits, 1 }), key);
+		const auto meshlet_bits = to_bits(meshlets);
+		return meshlet_bits == 0 ? key : hash_bytes(std::as_bytes(std::span { &meshlet_bits, 1 }), key);
+	}
+
+	auto directory_of(const MeshCacheConfiguration& configuration) -> std::filesystem::path
+	{
+		if (!configuration.directory.empty()) {
+			return configuration.directory;
+		}
+		std::error_code error_code {};
+		const auto temporary = std::filesystem::temp_directory_path(error_code);
+		return (error_code ? std::filesystem::path { "." } : temporary) / "disarray-mesh-cache";
+	}
+
+	auto path_for(const std::filesystem::path& source, std::uint64_t key) -> std::filesystem::path
+	{
+		return directory_of(get_configuration()) / fmt::format("{}.{:016x}.dmesh", source.filename().string(), key);
+	}
+
+	/**
+	 * @brief Bounds checked views into a mapped file. Anything out of range or misaligned makes the whole file invalid.
+	 */
+	class Reader {
+	public:
+		explicit Reader(std::span<const std::byte> in_bytes)
+			: bytes(in_bytes)
+		{
+		}
+
+		template <class T> auto read(std::uint64_t offset, std::uint64_t count) -> std::span<const T>
+		{
+			if (count == 0) {
+				return {};
+			}
+			if (offset > bytes.size() || count > (bytes.size() - offset) / sizeof(T)
+				|| reinterpret_cast<std::uintptr_t>(bytes.data() + offset) % alignof(T) != 0) {
+				valid = false;
+				return {};
+			}
+			return { reinterpret_cast<const T*>(bytes.data() + offset), static_cast<std::size_t>(count) };
+		}
+
+		auto read_string(std::uint64_t offset, std::uint64_t length) -> std::string_view
+		{
+			const auto characters = read<char>(offset, length);
+			return { characters.data(), characters.size() };
+		}
+
+		[[nodiscard]] auto is_valid() const -> bool { return valid; }
+
+	private:
+		std::span<const std::byte> bytes;
+		bool valid { true };
+	};
+
+	template <class T> void write_raw(std::ofstream& stream, const T& value)
+	{
+		stream.write(reinterpret_cast<const char*>(&value), static_cast<std::streamsize>(sizeof(T)));
+	}
+
+	void write_padding(std::ofstream& stream, std::uint64_t& position, std::uint64_t target)
+	{
+		static constexpr std::array<char, blob_alignment> zeroes {};
+		while (position < target) {
+			const auto count = std::min<std::uint64_t>(target - position, zeroes.size());
+			stream.write(zeroes.data(), static_cast<std::streamsize>(count));
+			position += count;
+		}
+	}
+} // namespace
+
+auto CachedMesh::find(std::string_view name) const -> const CachedSubmesh*
+{
+	for (const auto& submesh : submeshes) {
+		if (submesh.name == name) {
+			return &submesh;
+		}
+	}
+	return nullptr;
+}
+
+auto CachedMesh::to_texture_tables() const -> ImportedMesh
+{
+	ImportedMesh output {};
+	for (const auto& submesh : submeshes) {
+		output.try_emplace(std::string { submesh.name }, Submesh { .texture_properties = submesh.texture_properties });
+	}
+	return output;
+}
+
+namespace MeshCache {
+
+	void configure(const MeshCacheConfiguration& configuration)
+	{
+		auto& instance = registry();
+		std::scoped_lock lock { instance.mutex };
+		instance.configuration = configuration;
+	}
+
+	auto cache_path(const std::filesystem::path& source, ImportFlag flags, const glm::mat4& initial_rotation,
+		const MeshOptimisationSettings& optimisation, const LodSettings& lods, const MeshletSettings& meshlets) -> std::filesystem::path
+	{
+		const FS::MappedFile source_file { source };
+		if (!source_file) {
+			return {};
+		}
+		return path_for(source, key_for(hash_bytes(source_file.bytes()), flags, initial_rotation, optimisation, lods, meshlets));
+	}
+
+	auto load(const std::filesystem::path& source, ImportFlag flags, const glm::mat4& initial_rotation, const MeshOptimisationSettings& optimisation,
+		const LodSettings& lods, const MeshletSettings& meshlets) -> std::optional<CachedMesh>
+	{
+		if (!get_configuration().enabled) {
+			return std::nullopt;
+		}
+
+		std::uint64_t source_hash = 0;
+		{
+			const FS::MappedFile source_file { source };
+			if (!source_file) {
+				return std::nullopt;
+			}
+			source_hash = hash_bytes(source_file.bytes());
+		}
+
+		const auto path = path_for(source, key_for(source_hash, flags, initial_rotation, optimisation, lods, meshlets));
+		FS::MappedFile file { path };
+		if (!file || file.size() < sizeof(Header)) {
+			return std::nullopt;
+		}
+
+		Header header {};
+		std::memcpy(&header, file.data(), sizeof(Header));
+		if (header.magic != magic || header.version != version || header.vertex_size != sizeof(ModelVertex) || header.file_size != file.size()
+			|| header.source_hash != source_hash || header.flags != static_cast<std::uint32_t>(flags)
+			|| header.initial_rotation != to_array(initial_rotation) || header.optimisation != to_bits(optimisation)
+			|| header.lods != to_bits(lods) || header.meshlets != to_bits(meshlets)) {
+			return std::nullopt;
+		}
+
+		Reader reader { file.bytes() };
+		const auto records = reader.read<SubmeshRecord>(sizeof(Header), header.submesh_count);
+
+		std::vector<CachedSubmesh> submeshes {};
+		submeshes.reserve(records.size());
+		for (const auto& record : records) {
+			auto& submesh = submeshes.emplace_back();
+			submesh.name = reader.read_string(record.name_offset, record.name_length);
+			submesh.vertices = reader.read<ModelVertex>(record.vertex_offset, record.vertex_count);
+			submesh.indices = reader.read<std::uint32_t>(record.index_offset, record.index_count);
+
+			for (const auto& texture : reader.read<TextureRecord>(record.texture_offset, record.texture_count)) {
+				auto& properties = submesh.texture_properties.emplace_back();
+				properties.path = reader.read_string(texture.path_offset, texture.path_length);
+				properties.debug_name = reader.read_string(texture.name_offset, texture.name_length);
+				properties.mips = texture.mips;
+				properties.generate_mips = texture.generate_mips != 0;
+			}
+
+			for (const auto& lod : reader.read<LodRecord>(record.lod_offset, record.lod_count)) {
+				submesh.lods.push_back({ .indices = reader.read<std::uint32_t>(lod.index_offset, lod.index_count), .error = lod.error });
+			}
+			submesh.meshlets = reader.read<Meshlet>(record.meshlet_offset, record.meshlet_count);
+		}
+
+		if (!reader.is_valid()) {
+			Log::error("MeshCache", "{} is corrupt, ignoring it.", path.string());
+			return std::nullopt;
+		}
+
+		const auto& bounds = header.aabb;
+		const AABB aabb { AABBRange { bounds[0], bounds[1] }, AABBRange { bounds[2], bounds[3] }, AABBRange { bounds[4], bounds[5] } };
+		return CachedMesh { std::move(file), std::move(submeshes), aabb };
+	}
+
+	auto store(const std::filesystem::path& source, ImportFlag flags, const glm::mat4& initial_rotation, const ImportedMesh& mesh, const AABB& aabb,
+		const MeshOptimisationSettings& optimisation, const LodSettings& lods, const MeshletSettings& meshlets) -> bool
+	{
+		if (!get_configuration().enabled) {
+			return false;
+		}
+
+		std::uint64_t source_hash = 0;
+		{
+			const FS::MappedFile source_file { source };
+			if (!source_file) {
+				return false;
+			}
+			source_hash = hash_bytes(source_file.bytes());
+		}
+		const auto path = path_for(source, key_for(source_hash, flags, initial_rotation, optimisation, lods, meshlets));
+
+		// Lay the file out first: header, submesh records, texture records, level of detail records, meshlets, strings, then the aligned
+		// vertex and index blobs.
+		std::vector<SubmeshRecord> records {};
+		std::vector<TextureRecord> textures {};
+		std::vector<LodRecord> lod_records {};
+		std::vector<std::string> texture_paths {};
+		records.reserve(mesh.size());
+
+		std::uint64_t texture_total = 0;
+		std::uint64_t lod_total = 0;
+		std::uint64_t meshlet_total = 0;
+		for (const auto& [name, submesh] : mesh) {
+			texture_total += submesh.texture_properties.size();
+			lod_total += submesh.lods.size();
+			meshlet_total += submesh.meshlets.size();
+		}
+
+		const auto texture_start = sizeof(Header) + mesh.size() * sizeof(SubmeshRecord);
+		const auto lod_start = static_cast<std::uint64_t>(texture_start + texture_total * sizeof(TextureRecord));
+		const auto meshlet_start = lod_start + lod_total * sizeof(LodRecord);
+		auto meshlet_position = meshlet_start;
+		auto string_position = meshlet_start + meshlet_total * sizeof(Meshlet);
+		for (const auto& [name, submesh] : mesh) {
+			auto& record = records.emplace_back();
+			record.name_offset = string_position;
+			record.name_length = name.size();
+			string_position += name.size();
+
+			record.texture_offset = texture_start + textures.size() * sizeof(TextureRecord);
+			record.texture_count = submesh.texture_properties.size();
+			for (const auto& properties : submesh.texture_properties) {
+				auto& texture = textures.emplace_back();
+				const auto& texture_path = texture_paths.emplace_back(properties.path.generic_string());
+				texture.path_offset = string_position;
+				texture.path_length = texture_path.size();
+				string_position += texture_path.size();
+				texture.name_offset = string_position;
+				texture.name_length = properties.debug_name.size();
+				string_position += properties.debug_name.size();
+				texture.mips = properties.mips.value_or(1);
+				texture.generate_mips = properties.generate_mips ? 1 : 0;
+			}
+
+			record.lod_offset = lod_start + lod_records.size() * sizeof(LodRecord);
+			record.lod_count = submesh.lods.size();
+			for (const auto& lod : submesh.lods) {
+				lod_records.push_back({ .index_count = lod.indices.size(), .error = lod.error });
+			}
+
+			record.meshlet_offset = meshlet_position;
+			record.meshlet_count = submesh.meshlets.size();
+			meshlet_position += submesh.meshlets.size() * sizeof(Meshlet);
+		}
+
+		auto blob_position = align_up(string_position, blob_alignment);
+		{
+			std::size_t index = 0;
+			for (const auto& [name, submesh] : mesh) {
+				auto& record = records[index++];
+				record.vertex_offset = blob_position;
+				record.vertex_count = submesh.vertices.size();
+				blob_position = align_up(blob_position + submesh.size<ModelVertex>(), blob_alignment);
+				record.index_offset = blob_position;
+				record.index_count = submesh.indices.size();
+				blob_position = align_up(blob_position + submesh.size<std::uint32_t>(), blob_alignment);
+				for (auto lod = record.lod_offset; lod < record.lod_offset + record.lod_count * sizeof(LodRecord); lod += sizeof(LodRecord)) {
+					auto& lod_record = lod_records[(lod - lod_start) / sizeof(LodRecord)];
+					lod_record.index_offset = blob_position;
+					blob_position = align_up(blob_position + lod_record.index_count * sizeof(std::uint32_t), blob_alignment);
+				}
+			}
+		}
+
+		Header header {
+			.magic = magic,
+			.version = version,
+			.vertex_size = sizeof(ModelVertex),
+			.source_hash = source_hash,
+			.file_size = blob_position,
+			.flags = static_cast<std::uint32_t>(flags),
+			.submesh_count = static_cast<std::uint32_t>(mesh.size()),
+			.initial_rotation = to_array(initial_rotation),
+			.aabb = to_array(aabb),
+			.optimisation = to_bits(optimisation),
+			.lods = to_bits(lods),
+			.meshlets = to_bits(meshlets),
+		};
+
+		std::error_code error_code {};
+		std::filesystem::create_directories(path.parent_path(), error_code);
+		const auto temporary = std::filesystem::path { fmt::format("{}.{}.tmp", path.string(), std::hash<std::thread::id> {}(std::this_thread::get_id())) };
+		{
+			std::ofstream stream { temporary, std::ios::binary | std::ios::trunc };
+			if (!stream) {
+				Log::error("MeshCache", "Could not open {} for writing.", temporary.string());
+				return false;
+			}
+
+			write_raw(stream, header);
+			for (const auto& record : records) {
+				write_raw(stream, record);
+			}
+			for (const auto& texture : textures) {
+				write_raw(stream, texture);
+			}
+			for (const auto& lod : lod_records) {
+				write_raw(stream, lod);
+			}
+			for (const auto& [name, submesh] : mesh) {
+				const auto meshlet_bytes = submesh.meshlets.size() * sizeof(Meshlet);
+				stream.write(reinterpret_cast<const char*>(submesh.meshlets.data()), static_cast<std::streamsize>(meshlet_bytes));
+			}
+
+			std::size_t texture_index = 0;
+			for (const auto& [name, submesh] : mesh) {
+				stream.write(name.data(), static_cast<std::streamsize>(name.size()));
+				for (const auto& properties : submesh.texture_properties) {
+					const auto& texture_path = texture_paths[texture_index++];
+					stream.write(texture_path.data(), static_cast<std::streamsize>(texture_path.size()));
+					stream.write(properties.debug_name.data(), static_cast<std::streamsize>(properties.debug_name.size()));
+				}
+			}
+
+			std::uint64_t position = string_position;
+			std::size_t index = 0;
+			for (const auto& [name, submesh] : mesh) {
+				const auto& record = records[index++];
+				write_padding(stream, position, record.vertex_offset);
+				stream.write(reinterpret_cast<const char*>(submesh.vertices.data()), static_cast<std::streamsize>(submesh.size<ModelVertex>()));
+				position += submesh.size<ModelVertex>();
+				write_padding(stream, position, record.index_offset);
+				stream.write(reinterpret_cast<const char*>(submesh.indices.data()), static_cast<std::streamsize>(submesh.size<std::uint32_t>()));
+				position += submesh.size<std::uint32_t>();
+				for (std::size_t lod = 0; lod < submesh.lods.size(); lod++) {
+					const auto& indices = submesh.lods[lod].indices;
+					write_padding(stream, position, lod_records[(record.lod_offset - lod_start) / sizeof(LodRecord) + lod].index_offset);
+					stream.write(reinterpret_cast<const char*>(indices.data()), static_cast<std::streamsize>(indices.size() * sizeof(std::uint32_t)));
+					position += indices.size() * sizeof(std::uint32_t);
+				}
+			}
+			write_padding(stream, position, blob_position);
+
+			if (!stream) {
+				Log::error("MeshCache", "Could not write {}.", temporary.string());
+				stream.close();
+				std::filesystem::remove(temporary, error_code);
+				return false;
+			}
+		}
+
+		std::filesystem::rename(temporary, path, error_code);
+		if (error_code) {
+			Log::error("MeshCache", "Could not move {} into place: {}", path.string(), error_code.message());
+			std::filesystem::remove(temporary, error_code);
+			return false;
+		}
+		return true;
+	}
+
+} // namespace MeshCache
+
+} // namespace Disarray
@@ -0,0 +1,322 @@
+#include "DisarrayPCH.hpp"
+
+#include "graphics/MeshOptimiser.hpp"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+namespace Disarray::MeshOptimiser {
+
+namespace {
+	constexpr auto no_vertex = std::numeric_limits<std::uint32_t>::max();
+
+	/**
+	 * @brief A FIFO post-transform cache. A vertex is cached while fewer than cache_size misses have happened since it was added.
+	 */
+	class CacheSimulation {
+	public:
+		CacheSimulation(std::size_t vertex_count, std::uint32_t size)
+			: timestamps(vertex_count, 0)
+			, cache_size(size)
+			, time(size + 1)
+		{
+		}
+
+		auto access(std::uint32_t vertex) -> std::uint32_t
+		{
+			if (time - timestamps[vertex] <= cache_size) {
+				return 0;
+			}
+			timestamps[vertex] = time++;
+			return 1;
+		}
+
+		auto access_triangle(std::span<const std::uint32_t> indices, std::size_t triangle) -> std::uint32_t
+		{
+			return access(indices[3 * triangle + 0]) + access(indices[3 * triangle + 1]) + access(indices[3 * triangle + 2]);
+		}
+
+		void flush() { time += cache_size + 1; }
+
+	private:
+		std::vector<std::uint32_t> timestamps;
+		std::uint32_t cache_size;
+		std::uint32_t time;
+	};
+
+	struct Cluster {
+		std::size_t begin { 0 };
+		std::size_t end { 0 };
+		float sort_key { 0.0F };
+	};
+
+	// A cluster starts wherever all three vertices of a triangle miss, which is usually a new patch of the mesh.
+	auto hard_boundaries(std::span<const std::uint32_t> indices, std::size_t vertex_count, std::uint32_t cache_size) -> std::vector<std::size_t>
+	{
+		const auto triangle_count = indices.size() / 3;
+		CacheSimulation cache { vertex_count, cache_size };
+		std::vector<std::size_t> boundaries;
+		for (std::size_t triangle = 0; triangle < triangle_count; triangle++) {
+			if (cache.access_triangle(indices, triangle) == 3 || triangle == 0) {
+				boundaries.push_back(triangle);
+			}
+		}
+		return boundaries;
+	}
+
+	// Splits each hard cluster again as soon as its running ACMR, counted from a flushed cache, reaches threshold times the ACMR of the
+	// whole hard cluster. A tail that never gets there is merged into the cluster before it.
+	auto soft_boundaries(std::span<const std::uint32_t> indices, std::size_t vertex_count, std::span<const std::size_t> hard, float threshold,
+		std::uint32_t cache_size) -> std::vector<std::size_t>
+	{
+		const auto triangle_count = indices.size() / 3;
+		CacheSimulation cache { vertex_count, cache_size };
+		std::vector<std::size_t> boundaries;
+		for (std::size_t cluster = 0; cluster < hard.size(); cluster++) {
+			const auto begin = hard[cluster];
+			const auto end = cluster + 1 < hard.size() ? hard[cluster + 1] : triangle_count;
+
+			cache.flush();
+			std::uint32_t cluster_misses = 0;
+			for (auto triangle = begin; triangle < end; triangle++) {
+				cluster_misses += cache.access_triangle(indices, triangle);
+			}
+			const auto cluster_threshold = threshold * static_cast<float>(cluster_misses) / static_cast<float>(end - begin);
+
+			const auto first_boundary = boundaries.size();
+			boundaries.push_back(begin);
+			cache.flush();
+			std::uint32_t running_misses = 0;
+			std::uint32_t running_triangles = 0;
+			for (auto triangle = begin; triangle < end; triangle++) {
+				running_misses += cache.access_triangle(indices, triangle);
+				running_triangles++;
+				if (static_cast<float>(running_misses) / static_cast<float>(running_triangles) <= cluster_threshold) {
+					boundaries.push_back(triangle + 1);
+					cache.flush();
+					running_misses = 0;
+					running_triangles = 0;
+				}
+			}
+
+			if (boundaries.back() == end || (running_triangles > 0 && boundaries.size() - first_boundary > 1)) {
+				boundaries.pop_back();
+			}
+		}
+		return boundaries;
+	}
+
+	auto position_of(std::span<const ModelVertex> vertices, std::uint32_t index) -> glm::vec3 { return vertices[index].pos; }
+} // namespace
+
+auto analyse_vertex_cache(std::span<const std::uint32_t> indices, std::size_t vertex_count, std::uint32_t cache_size) -> VertexCacheStatistics
+{
+	if (indices.size() < 3) {
+		return {};
+	}
+
+	CacheSimulation cache { vertex_count, cache_size };
+	std::vector<bool> referenced(vertex_count, false);
+	std::size_t referenced_count = 0;
+	std::size_t misses = 0;
+	for (const auto index : indices) {
+		misses += cache.access(index);
+		if (!referenced[index]) {
+			referenced[index] = true;
+			referenced_count++;
+		}
+	}
+
+	return {
+		.acmr = static_cast<float>(misses) / static_cast<float>(indices.size() / 3),
+		.atvr = static_cast<float>(misses) / static_cast<float>(referenced_count),
+	};
+}
+
+auto optimise_vertex_cache(std::span<const std::uint32_t> indices, std::size_t vertex_count, std::uint32_t cache_size) -> std::vector<std::uint32_t>
+{
+	const auto triangle_count = indices.size() / 3;
+
+	// Triangles around every vertex, and how many of them have not been emitted yet.
+	std::vector<std::uint32_t> live(vertex_count, 0);
+	for (std::size_t index = 0; index < triangle_count * 3; index++) {
+		live[indices[index]]++;
+	}
+	std::vector<std::uint32_t> offsets(vertex_count + 1, 0);
+	std::inclusive_scan(live.begin(), live.end(), offsets.begin() + 1);
+	std::vector<std::uint32_t> adjacency(triangle_count * 3);
+	{
+		auto fill = offsets;
+		for (std::size_t index = 0; index < triangle_count * 3; index++) {
+			adjacency[fill[indices[index]]++] = static_cast<std::uint32_t>(index / 3);
+		}
+	}
+
+	std::vector<std::uint32_t> output;
+	output.reserve(triangle_count * 3);
+	std::vector<std::uint32_t> cache_time(vertex_count, 0);
+	std::vector<bool> emitted(triangle_count, false);
+	std::vector<std::uint32_t> dead_end;
+	std::vector<std::uint32_t> candidates;
+	std::uint32_t time = cache_size + 1;
+	std::size_t cursor = 0;
+
+	const auto skip_dead_end = [&]() -> std::uint32_t {
+		while (!dead_end.empty()) {
+			const auto vertex = dead_end.back();
+			dead_end.pop_back();
+			if (live[vertex] > 0) {
+				return vertex;
+			}
+		}
+		for (; cursor < vertex_count; cursor++) {
+			if (live[cursor] > 0) {
+				return static_cast<std::uint32_t>(cursor);
+			}
+		}
+		return no_vertex;
+	};
+
+	// Prefers the candidate that entered the cache longest ago but will still be cached after its remaining triangles are emitted.
+	const auto next_vertex = [&]() -> std::uint32_t {
+		auto best = no_vertex;
+		std::int64_t best_priority = -1;
+		for (const auto vertex : candidates) {
+			if (live[vertex] == 0) {
+				continue;
+			}
+			std::int64_t priority = 0;
+			if (time - cache_time[vertex] + 2 * live[vertex] <= cache_size) {
+				priority = time - cache_time[vertex];
+			}
+			if (priority > best_priority) {
+				best_priority = priority;
+				best = vertex;
+			}
+		}
+		return best == no_vertex ? skip_dead_end() : best;
+	};
+
+	for (auto fanning = skip_dead_end(); fanning != no_vertex; fanning = next_vertex()) {
+		candidates.clear();
+		for (auto adjacent = offsets[fanning]; adjacent < offsets[fanning + 1]; adjacent++) {
+			const auto triangle = adjacency[adjacent];
+			if (emitted[triangle]) {
+				continue;
+			}
+			for (std::size_t corner = 0; corner < 3; corner++) {
+				const auto vertex = indices[3 * triangle + corner];
+				output.push_back(vertex);
+				dead_end.push_back(vertex);
+				candidates.push_back(vertex);
+				live[vertex]--;
+				if (time - cache_time[vertex] > cache_size) {
+					cache_time[vertex] = time++;
+				}
+			}
+			emitted[triangle] = true;
+		}
+	}
+
+	return output;
+}
+
+auto optimise_overdraw(std::span<const std::uint32_t> indices, std::span<const ModelVertex> vertices, float threshold, std::uint32_t cache_size)
+	-> std::vector<std::uint32_t>
+{
+	const auto triangle_count = indices.size() / 3;
+	if (triangle_count == 0) {
+		return {};
+	}
+
+	const auto hard = hard_boundaries(indices, vertices.size(), cache_size);
+	const auto soft = soft_boundaries(indices, vertices.size(), hard, threshold, cache_size);
+
+	glm::vec3 mesh_centroid { 0.0F };
+	for (std::size_t index = 0; index < triangle_count * 3; index++) {
+		mesh_centroid += position_of(vertices, indices[index]);
+	}
+	mesh_centroid /= static_cast<float>(triangle_count * 3);
+
+	// Clusters facing away from the centre of the mesh are likely to occlude the rest, so they are drawn first.
+	std::vector<Cluster> clusters(soft.size());
+	for (std::size_t cluster = 0; cluster < soft.size(); cluster++) {
+		auto& output = clusters[cluster];
+		output.begin = soft[cluster];
+		output.end = cluster + 1 < soft.size() ? soft[cluster + 1] : triangle_count;
+
+		glm::vec3 weighted_centroid { 0.0F };
+		glm::vec3 normal { 0.0F };
+		float area = 0.0F;
+		for (auto triangle = output.begin; triangle < output.end; triangle++) {
+			const auto first = position_of(vertices, indices[3 * triangle + 0]);
+			const auto second = position_of(vertices, indices[3 * triangle + 1]);
+			const auto third = position_of(vertices, indices[3 * triangle + 2]);
+			const auto cross = glm::cross(second - first, third - first);
+			const auto triangle_area = glm::length(cross);
+			weighted_centroid += (first + second + third) * (triangle_area / 3.0F);
+			normal += cross;
+			area += triangle_area;
+		}
+
+		const auto normal_length = glm::length(normal);
+		if (area > 0.0F && normal_length > 0.0F) {
+			output.sort_key = glm::dot(weighted_centroid / area - mesh_centroid, normal / normal_length);
+		}
+	}
+
+	std::stable_sort(clusters.begin(), clusters.end(), [](const Cluster& left, const Cluster& right) { return left.sort_key > right.sort_key; });
+
+	std::vector<std::uint32_t> output;
+	output.reserve(triangle_count * 3);
+	for (const auto& cluster : clusters) {
+		output.insert(output.end(), indices.begin() + static_cast<std::ptrdiff_t>(cluster.begin * 3),
+			indices.begin() + static_cast<std::ptrdiff_t>(cluster.end * 3));
+	}
+	return output;
+}
+
+void optimise_vertex_fetch(std::vector<ModelVertex>& vertices, std::vector<std::uint32_t>& indices)
+{
+	std::vector<std::uint32_t> remap(vertices.size(), no_vertex);
+	std::uint32_t next = 0;
+	for (auto& index : indices) {
+		if (remap[index] == no_vertex) {
+			remap[index] = next++;
+		}
+		index = remap[index];
+	}
+
+	std::vector<ModelVertex> reordered(next);
+	for (std::size_t vertex = 0; vertex < vertices.size(); vertex++) {
+		if (remap[vertex] != no_vertex) {
+			reordered[remap[vertex]] = vertices[vertex];
+		}
+	}
+	vertices = std::move(reordered);
+}
+
+auto optimise(std::vector<ModelVertex>& vertices, std::vector<std::uint32_t>& indices, const MeshOptimisationSettings& settings)
+	-> MeshOptimisationReport
+{
+	MeshOptimisationReport report {};
+	report.before = analyse_vertex_cache(indices, vertices.size());
+
+	if (settings.vertex_cache || settings.overdraw) {
+		indices = optimise_vertex_cache(indices, vertices.size());
+	}
+	if (settings.overdraw) {
+		indices = optimise_overdraw(indices, vertices, settings.overdraw_threshold);
+	}
+	if (settings.vertex_fetch) {
+		optimise_vertex_fetch(vertices, indices);
+	}
+
+	report.after = analyse_vertex_cache(indices, vertices.size());
+	return report;
+}
+
+} // namespace Disarray::MeshOptimiser
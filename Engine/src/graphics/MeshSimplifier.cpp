@@ -0,0 +1,655 @@
+#include "DisarrayPCH.hpp"
+
+#include "graphics/MeshSimplifier.hpp"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <utility>
+
+#include "graphics/MeshOptimiser.hpp"
+
+namespace Disarray::MeshSimplifier {
+
+namespace {
+	constexpr auto no_vertex = std::numeric_limits<std::uint32_t>::max();
+	// Planes through open borders and attribute seams count this much more than faces, which keeps outlines and seams in place.
+	constexpr double border_weight = 10.0;
+	// A pass takes collapses up to this much more expensive than the one that would meet its goal, so the cheapest collapses across the
+	// whole mesh go first. Squared, like the costs.
+	constexpr double pass_error_slack = 1.5 * 1.5;
+	// Faces may not turn by more than about 75 degrees in a collapse.
+	constexpr float min_normal_cosine = 0.25F;
+	constexpr std::size_t max_passes = 100;
+
+	/**
+	 * @brief What a vertex may collapse onto. Manifold vertices onto any neighbour, border vertices along their border, and seam vertices,
+	 * which have two wedges split by an attribute seam running through them, along their seam. Everything else stays in place.
+	 */
+	enum class VertexKind : std::uint8_t { Manifold, Border, Seam, Locked };
+
+	/**
+	 * @brief Sum of squared distances to a set of weighted planes, and the sum of their weights.
+	 */
+	struct Quadric {
+		double xx { 0.0 };
+		double yy { 0.0 };
+		double zz { 0.0 };
+		double xy { 0.0 };
+		double xz { 0.0 };
+		double yz { 0.0 };
+		double x { 0.0 };
+		double y { 0.0 };
+		double z { 0.0 };
+		double constant { 0.0 };
+		double weight { 0.0 };
+
+		auto operator+=(const Quadric& other) -> Quadric&
+		{
+			xx += other.xx;
+			yy += other.yy;
+			zz += other.zz;
+			xy += other.xy;
+			xz += other.xz;
+			yz += other.yz;
+			x += other.x;
+			y += other.y;
+			z += other.z;
+			constant += other.constant;
+			weight += other.weight;
+			return *this;
+		}
+
+		// The weighted mean of the squared distances from point to the planes.
+		[[nodiscard]] auto mean_squared_distance(const glm::vec3& point) const -> double
+		{
+			if (weight <= 0.0) {
+				return 0.0;
+			}
+			const double px = point.x;
+			const double py = point.y;
+			const double pz = point.z;
+			const auto value = xx * px * px + yy * py * py + zz * pz * pz + 2.0 * (xy * px * py + xz * px * pz + yz * py * pz)
+				+ 2.0 * (x * px + y * py + z * pz) + constant;
+			return std::abs(value) / weight;
+		}
+	};
+
+	auto plane_quadric(const glm::vec3& normal, const glm::vec3& point, double weight) -> Quadric
+	{
+		const double nx = normal.x;
+		const double ny = normal.y;
+		const double nz = normal.z;
+		const double distance = -(nx * point.x + ny * point.y + nz * point.z);
+		return {
+			.xx = weight * nx * nx,
+			.yy = weight * ny * ny,
+			.zz = weight * nz * nz,
+			.xy = weight * nx * ny,
+			.xz = weight * nx * nz,
+			.yz = weight * ny * nz,
+			.x = weight * nx * distance,
+			.y = weight * ny * distance,
+			.z = weight * nz * distance,
+			.constant = weight * distance * distance,
+			.weight = weight,
+		};
+	}
+
+	auto edge_key(std::uint32_t from, std::uint32_t to) -> std::uint64_t { return (static_cast<std::uint64_t>(from) << 32U) | to; }
+
+	/**
+	 * @brief Vertices with the same position share a representative, the smallest of their indices. Unreferenced vertices have none.
+	 */
+	struct PositionGroups {
+		std::vector<std::uint32_t> representative {};
+		std::vector<std::uint32_t> wedge_count {};
+	};
+
+	auto group_positions(std::span<const std::uint32_t> indices, std::span<const ModelVertex> vertices) -> PositionGroups
+	{
+		std::vector<std::uint32_t> referenced { indices.begin(), indices.end() };
+		std::sort(referenced.begin(), referenced.end());
+		referenced.erase(std::unique(referenced.begin(), referenced.end()), referenced.end());
+
+		const auto position_less = [&vertices](std::uint32_t left, std::uint32_t right) {
+			const auto& first = vertices[left].pos;
+			const auto& second = vertices[right].pos;
+			if (first.x != second.x) {
+				return first.x < second.x;
+			}
+			if (first.y != second.y) {
+				return first.y < second.y;
+			}
+			if (first.z != second.z) {
+				return first.z < second.z;
+			}
+			return left < right;
+		};
+		std::sort(referenced.begin(), referenced.end(), position_less);
+
+		PositionGroups groups { .representative = std::vector<std::uint32_t>(vertices.size(), no_vertex),
+			.wedge_count = std::vector<std::uint32_t>(vertices.size(), 0) };
+		for (std::size_t begin = 0; begin < referenced.size();) {
+			const auto representative = referenced[begin];
+			auto end = begin + 1;
+			while (end < referenced.size() && vertices[referenced[end]].pos == vertices[representative].pos) {
+				end++;
+			}
+			for (auto wedge = begin; wedge < end; wedge++) {
+				groups.representative[referenced[wedge]] = representative;
+			}
+			groups.wedge_count[representative] = static_cast<std::uint32_t>(end - begin);
+			begin = end;
+		}
+		return groups;
+	}
+
+	// Half-edges between the vertices the indices map to, sorted.
+	auto collect_half_edges(std::span<const std::uint32_t> indices, std::span<const std::uint32_t> mapping) -> std::vector<std::uint64_t>
+	{
+		std::vector<std::uint64_t> half_edges;
+		half_edges.reserve(indices.size());
+		for (std::size_t triangle = 0; triangle < indices.size() / 3; triangle++) {
+			for (std::size_t corner = 0; corner < 3; corner++) {
+				const auto from = mapping[indices[3 * triangle + corner]];
+				const auto to = mapping[indices[3 * triangle + (corner + 1) % 3]];
+				half_edges.push_back(edge_key(from, to));
+			}
+		}
+		std::sort(half_edges.begin(), half_edges.end());
+		return half_edges;
+	}
+
+	auto has_half_edge(std::span<const std::uint64_t> half_edges, std::uint32_t from, std::uint32_t to) -> bool
+	{
+		return std::binary_search(half_edges.begin(), half_edges.end(), edge_key(from, to));
+	}
+
+	auto is_border_edge(std::span<const std::uint64_t> half_edges, std::uint32_t first, std::uint32_t second) -> bool
+	{
+		return has_half_edge(half_edges, first, second) != has_half_edge(half_edges, second, first);
+	}
+
+	/**
+	 * @brief Position and wedge half-edges of the mesh. A seam edge has both of its half-edges between positions, but not between wedges.
+	 */
+	struct Connectivity {
+		std::vector<std::uint64_t> positions {};
+		std::vector<std::uint64_t> wedges {};
+
+		[[nodiscard]] auto is_border(std::uint32_t from, std::uint32_t to) const -> bool { return !has_half_edge(positions, to, from); }
+		[[nodiscard]] auto is_seam(std::uint32_t from_wedge, std::uint32_t to_wedge, std::span<const std::uint32_t> representative) const -> bool
+		{
+			return !is_border(representative[from_wedge], representative[to_wedge]) && !has_half_edge(wedges, to_wedge, from_wedge);
+		}
+	};
+
+	auto connectivity_of(std::span<const std::uint32_t> indices, std::span<const std::uint32_t> representative) -> Connectivity
+	{
+		std::vector<std::uint32_t> identity(representative.size());
+		std::iota(identity.begin(), identity.end(), 0U);
+		return { .positions = collect_half_edges(indices, representative), .wedges = collect_half_edges(indices, identity) };
+	}
+
+	auto classify(std::span<const std::uint32_t> indices, const Connectivity& connectivity, const PositionGroups& groups) -> std::vector<VertexKind>
+	{
+		const auto& half_edges = connectivity.positions;
+		const auto vertex_count = groups.representative.size();
+		std::vector<std::uint32_t> border_out(vertex_count, 0);
+		std::vector<std::uint32_t> border_in(vertex_count, 0);
+		std::vector<bool> non_manifold(vertex_count, false);
+
+		for (std::size_t edge = 0; edge < half_edges.size(); edge++) {
+			const auto from = static_cast<std::uint32_t>(half_edges[edge] >> 32U);
+			const auto to = static_cast<std::uint32_t>(half_edges[edge] & 0xFFFFFFFFU);
+			if (edge + 1 < half_edges.size() && half_edges[edge + 1] == half_edges[edge]) {
+				non_manifold[from] = true;
+				non_manifold[to] = true;
+				continue;
+			}
+			if (connectivity.is_border(from, to)) {
+				border_out[from]++;
+				border_in[to]++;
+			}
+		}
+
+		// A seam passes straight through a position when each of its wedges has one seam edge leaving and one arriving.
+		std::vector<std::uint32_t> seam_out(vertex_count, 0);
+		std::vector<std::uint32_t> seam_in(vertex_count, 0);
+		for (std::size_t triangle = 0; triangle < indices.size() / 3; triangle++) {
+			for (std::size_t corner = 0; corner < 3; corner++) {
+				const auto from = indices[3 * triangle + corner];
+				const auto to = indices[3 * triangle + (corner + 1) % 3];
+				if (groups.representative[from] != groups.representative[to] && connectivity.is_seam(from, to, groups.representative)) {
+					seam_out[from]++;
+					seam_in[to]++;
+				}
+			}
+		}
+		std::vector<bool> straight_seam(vertex_count, true);
+		for (std::size_t wedge = 0; wedge < vertex_count; wedge++) {
+			if (const auto representative = groups.representative[wedge]; representative != no_vertex) {
+				straight_seam[representative] = straight_seam[representative] && seam_out[wedge] == 1 && seam_in[wedge] == 1;
+			}
+		}
+
+		std::vector<VertexKind> kinds(vertex_count, VertexKind::Locked);
+		for (std::size_t vertex = 0; vertex < vertex_count; vertex++) {
+			if (non_manifold[vertex]) {
+				continue;
+			}
+			const auto wedges = groups.wedge_count[vertex];
+			const auto on_border = border_out[vertex] != 0 || border_in[vertex] != 0;
+			if (wedges == 1 && !on_border) {
+				kinds[vertex] = VertexKind::Manifold;
+			} else if (wedges == 1 && border_out[vertex] == 1 && border_in[vertex] == 1) {
+				kinds[vertex] = VertexKind::Border;
+			} else if (wedges == 2 && !on_border && straight_seam[vertex]) {
+				kinds[vertex] = VertexKind::Seam;
+			}
+		}
+		return kinds;
+	}
+
+	auto edge_plane(const glm::vec3& from, const glm::vec3& to, const glm::vec3& face_normal) -> Quadric
+	{
+		const auto edge = to - from;
+		const auto edge_length = glm::length(edge);
+		if (edge_length <= 0.0F) {
+			return {};
+		}
+		const auto normal = glm::normalize(glm::cross(edge / edge_length, face_normal));
+		return plane_quadric(normal, from, border_weight * edge_length * edge_length);
+	}
+
+	/**
+	 * @brief Face planes weighted by area, and planes through border and seam edges at right angles to their face, so that collapses
+	 * along those edges are cheap but collapses away from them are not.
+	 */
+	auto build_quadrics(std::span<const std::uint32_t> indices, std::span<const ModelVertex> vertices, std::span<const std::uint32_t> representative,
+		const Connectivity& connectivity) -> std::vector<Quadric>
+	{
+		std::vector<Quadric> quadrics(vertices.size());
+		for (std::size_t triangle = 0; triangle < indices.size() / 3; triangle++) {
+			const std::array wedges { indices[3 * triangle + 0], indices[3 * triangle + 1], indices[3 * triangle + 2] };
+			const std::array corners { representative[wedges[0]], representative[wedges[1]], representative[wedges[2]] };
+			const auto& first = vertices[corners[0]].pos;
+			const auto cross = glm::cross(vertices[corners[1]].pos - first, vertices[corners[2]].pos - first);
+			const auto doubled_area = glm::length(cross);
+			if (doubled_area <= 0.0F) {
+				continue;
+			}
+
+			const auto normal = cross / doubled_area;
+			const auto face = plane_quadric(normal, first, 0.5 * doubled_area);
+			for (const auto corner : corners) {
+				quadrics[corner] += face;
+			}
+
+			for (std::size_t corner = 0; corner < 3; corner++) {
+				const auto from = corners[corner];
+				const auto to = corners[(corner + 1) % 3];
+				if (from == to) {
+					continue;
+				}
+				if (connectivity.is_border(from, to) || connectivity.is_seam(wedges[corner], wedges[(corner + 1) % 3], representative)) {
+					const auto plane = edge_plane(vertices[from].pos, vertices[to].pos, normal);
+					quadrics[from] += plane;
+					quadrics[to] += plane;
+				}
+			}
+		}
+		return quadrics;
+	}
+
+	struct Collapse {
+		std::uint32_t from { 0 };
+		std::uint32_t to { 0 };
+		double cost { 0.0 };
+	};
+
+	/**
+	 * @brief One round of non-overlapping collapses. Triangles are looked up through the adjacency from the start of the round, with
+	 * collapses made earlier in the round applied on the fly. Vertices touched by a collapse are locked for the rest of the round, so
+	 * that is never more than one step.
+	 */
+	class CollapsePass {
+	public:
+		CollapsePass(std::span<const std::uint32_t> pass_indices, std::span<const ModelVertex> mesh_vertices,
+			std::span<const std::uint32_t> mesh_representative)
+			: indices(pass_indices)
+			, vertices(mesh_vertices)
+			, representative(mesh_representative)
+			, remap(mesh_vertices.size())
+			, locked(mesh_vertices.size(), false)
+			, offsets(mesh_vertices.size() + 1, 0)
+		{
+			std::iota(remap.begin(), remap.end(), 0U);
+			const auto triangle_count = indices.size() / 3;
+			for (std::size_t index = 0; index < triangle_count * 3; index++) {
+				offsets[representative[indices[index]] + 1]++;
+			}
+			std::inclusive_scan(offsets.begin(), offsets.end(), offsets.begin());
+			adjacency.resize(triangle_count * 3);
+			auto fill = offsets;
+			for (std::size_t index = 0; index < triangle_count * 3; index++) {
+				adjacency[fill[representative[indices[index]]]++] = static_cast<std::uint32_t>(index / 3);
+			}
+		}
+
+		[[nodiscard]] auto is_locked(const Collapse& collapse) const -> bool { return locked[collapse.from] || locked[collapse.to]; }
+
+		/**
+		 * @brief The number of triangles the collapse removes, or zero if it would flip a face, tear an attribute seam or make the mesh
+		 * non-manifold. Every wedge of the vertex moves onto the wedge it shares an edge with.
+		 */
+		auto try_collapse(const Collapse& collapse) -> std::size_t
+		{
+			wedge_moves.clear();
+			from_wedges.clear();
+			shared_neighbours.clear();
+			from_neighbours.clear();
+			to_neighbours.clear();
+
+			std::size_t removed = 0;
+			const auto& target = vertices[collapse.to].pos;
+			for (auto adjacent = offsets[collapse.from]; adjacent < offsets[collapse.from + 1]; adjacent++) {
+				const auto corners = current_triangle(adjacency[adjacent]);
+				if (is_degenerate(corners)) {
+					continue;
+				}
+
+				const auto from_corner = find_corner(corners, collapse.from);
+				from_wedges.push_back(corners[from_corner]);
+				for (const auto corner : corners) {
+					if (const auto vertex = representative[corner]; vertex != collapse.from) {
+						from_neighbours.push_back(vertex);
+					}
+				}
+
+				if (const auto to_corner = find_corner(corners, collapse.to); to_corner < 3) {
+					removed++;
+					wedge_moves.emplace_back(corners[from_corner], corners[to_corner]);
+					shared_neighbours.push_back(representative[corners[3 - from_corner - to_corner]]);
+					continue;
+				}
+
+				std::array<glm::vec3, 3> before {};
+				for (std::size_t corner = 0; corner < 3; corner++) {
+					before[corner] = vertices[representative[corners[corner]]].pos;
+				}
+				auto after = before;
+				after[from_corner] = target;
+				const auto normal_before = glm::cross(before[1] - before[0], before[2] - before[0]);
+				const auto normal_after = glm::cross(after[1] - after[0], after[2] - after[0]);
+				if (glm::dot(normal_before, normal_after) <= min_normal_cosine * glm::length(normal_before) * glm::length(normal_after)) {
+					return 0;
+				}
+			}
+			if (removed == 0 || !wedges_move_consistently()) {
+				return 0;
+			}
+
+			for (auto adjacent = offsets[collapse.to]; adjacent < offsets[collapse.to + 1]; adjacent++) {
+				const auto corners = current_triangle(adjacency[adjacent]);
+				if (is_degenerate(corners)) {
+					continue;
+				}
+				for (const auto corner : corners) {
+					if (const auto vertex = representative[corner]; vertex != collapse.to && vertex != collapse.from) {
+						to_neighbours.push_back(vertex);
+					}
+				}
+			}
+
+			// The link condition: the only neighbours the two share are across the triangles that disappear.
+			for (auto* neighbours : { &shared_neighbours, &from_neighbours, &to_neighbours }) {
+				std::sort(neighbours->begin(), neighbours->end());
+				neighbours->erase(std::unique(neighbours->begin(), neighbours->end()), neighbours->end());
+			}
+			std::size_t common = 0;
+			for (const auto neighbour : from_neighbours) {
+				common += std::binary_search(to_neighbours.begin(), to_neighbours.end(), neighbour) ? 1 : 0;
+			}
+			if (common != shared_neighbours.size()) {
+				return 0;
+			}
+
+			for (const auto& [from_wedge, to_wedge] : wedge_moves) {
+				remap[from_wedge] = to_wedge;
+			}
+			locked[collapse.from] = true;
+			locked[collapse.to] = true;
+			return removed;
+		}
+
+		/**
+		 * @brief The indices with every collapse applied and the triangles that degenerated removed.
+		 */
+		[[nodiscard]] auto apply() const -> std::vector<std::uint32_t>
+		{
+			std::vector<std::uint32_t> output;
+			output.reserve(indices.size());
+			for (std::size_t triangle = 0; triangle < indices.size() / 3; triangle++) {
+				const auto corners = current_triangle(static_cast<std::uint32_t>(triangle));
+				if (!is_degenerate(corners)) {
+					output.insert(output.end(), corners.begin(), corners.end());
+				}
+			}
+			return output;
+		}
+
+	private:
+		[[nodiscard]] auto current_triangle(std::uint32_t triangle) const -> std::array<std::uint32_t, 3>
+		{
+			return { remap[indices[3 * triangle + 0]], remap[indices[3 * triangle + 1]], remap[indices[3 * triangle + 2]] };
+		}
+
+		[[nodiscard]] auto is_degenerate(const std::array<std::uint32_t, 3>& corners) const -> bool
+		{
+			const auto first = representative[corners[0]];
+			const auto second = representative[corners[1]];
+			const auto third = representative[corners[2]];
+			return first == second || second == third || first == third;
+		}
+
+		// Every wedge of the collapsing vertex has exactly one wedge to move onto.
+		auto wedges_move_consistently() -> bool
+		{
+			std::sort(from_wedges.begin(), from_wedges.end());
+			from_wedges.erase(std::unique(from_wedges.begin(), from_wedges.end()), from_wedges.end());
+			std::sort(wedge_moves.begin(), wedge_moves.end());
+			wedge_moves.erase(std::unique(wedge_moves.begin(), wedge_moves.end()), wedge_moves.end());
+			if (wedge_moves.size() != from_wedges.size()) {
+				return false;
+			}
+			for (std::size_t move = 0; move < wedge_moves.size(); move++) {
+				if (wedge_moves[move].first != from_wedges[move]) {
+					return false;
+				}
+			}
+			return true;
+		}
+
+		[[nodiscard]] auto find_corner(const std::array<std::uint32_t, 3>& corners, std::uint32_t vertex) const -> std::size_t
+		{
+			for (std::size_t corner = 0; corner < 3; corner++) {
+				if (representative[corners[corner]] == vertex) {
+					return corner;
+				}
+			}
+			return 3;
+		}
+
+		std::span<const std::uint32_t> indices;
+		std::span<const ModelVertex> vertices;
+		std::span<const std::uint32_t> representative;
+		std::vector<std::uint32_t> remap;
+		std::vector<bool> locked;
+		std::vector<std::uint32_t> offsets;
+		std::vector<std::uint32_t> adjacency {};
+
+		std::vector<std::pair<std::uint32_t, std::uint32_t>> wedge_moves {};
+		std::vector<std::uint32_t> from_wedges {};
+		std::vector<std::uint32_t> shared_neighbours {};
+		std::vector<std::uint32_t> from_neighbours {};
+		std::vector<std::uint32_t> to_neighbours {};
+	};
+
+	auto collect_collapses(std::span<const std::uint32_t> indices, std::span<const ModelVertex> vertices,
+		std::span<const std::uint32_t> representative, std::span<const VertexKind> kinds, std::span<const Quadric> quadrics, double max_cost)
+		-> std::vector<Collapse>
+	{
+		const auto connectivity = connectivity_of(indices, representative);
+
+		std::vector<Collapse> collapses;
+		collapses.reserve(indices.size());
+		for (std::size_t triangle = 0; triangle < indices.size() / 3; triangle++) {
+			for (std::size_t corner = 0; corner < 3; corner++) {
+				const auto first_wedge = indices[3 * triangle + corner];
+				const auto second_wedge = indices[3 * triangle + (corner + 1) % 3];
+				const auto first = representative[first_wedge];
+				const auto second = representative[second_wedge];
+				if (first == second) {
+					continue;
+				}
+
+				const auto on_seam = connectivity.is_seam(first_wedge, second_wedge, representative);
+				for (const auto& [from, to] : { std::pair { first, second }, std::pair { second, first } }) {
+					const auto kind = kinds[from];
+					const auto along_border = is_border_edge(connectivity.positions, from, to);
+					const auto allowed
+						= kind == VertexKind::Manifold || (kind == VertexKind::Border && along_border) || (kind == VertexKind::Seam && on_seam);
+					if (!allowed) {
+						continue;
+					}
+					auto combined = quadrics[from];
+					combined += quadrics[to];
+					const auto cost = combined.mean_squared_distance(vertices[to].pos);
+					if (cost <= max_cost) {
+						collapses.push_back({ .from = from, .to = to, .cost = cost });
+					}
+				}
+			}
+		}
+
+		std::sort(collapses.begin(), collapses.end(), [](const Collapse& left, const Collapse& right) {
+			if (left.cost != right.cost) {
+				return left.cost < right.cost;
+			}
+			return edge_key(left.from, left.to) < edge_key(right.from, right.to);
+		});
+		collapses.erase(std::unique(collapses.begin(), collapses.end(),
+							[](const Collapse& left, const Collapse& right) { return left.from == right.from && left.to == right.to; }),
+			collapses.end());
+		return collapses;
+	}
+} // namespace
+
+auto simplify(std::span<const std::uint32_t> indices, std::span<const ModelVertex> vertices, std::size_t target_index_count, float max_error)
+	-> SimplificationResult
+{
+	SimplificationResult result {};
+	result.indices.assign(indices.begin(), indices.begin() + static_cast<std::ptrdiff_t>(indices.size() / 3 * 3));
+	const auto target_triangles = target_index_count / 3;
+	if (result.indices.size() / 3 <= target_triangles) {
+		return result;
+	}
+
+	const auto groups = group_positions(result.indices, vertices);
+	const auto& representative = groups.representative;
+	const auto connectivity = connectivity_of(result.indices, representative);
+	const auto kinds = classify(result.indices, connectivity, groups);
+	auto quadrics = build_quadrics(result.indices, vertices, representative, connectivity);
+
+	const auto max_cost = static_cast<double>(max_error) * static_cast<double>(max_error);
+	double worst_cost = 0.0;
+	auto triangle_count = result.indices.size() / 3;
+	for (std::size_t pass = 0; pass < max_passes && triangle_count > target_triangles; pass++) {
+		const auto collapses = collect_collapses(result.indices, vertices, representative, kinds, quadrics, max_cost);
+		if (collapses.empty()) {
+			break;
+		}
+
+		const auto edge_goal = std::clamp<std::size_t>((triangle_count - target_triangles) / 2, 1, collapses.size());
+		auto pass_limit = std::min(max_cost, collapses[edge_goal - 1].cost * pass_error_slack);
+
+		CollapsePass collapse_pass { result.indices, vertices, representative };
+		std::size_t collapsed = 0;
+		for (const auto& collapse : collapses) {
+			if (collapse.cost > pass_limit) {
+				if (collapsed > 0) {
+					break;
+				}
+				pass_limit = max_cost;
+			}
+			if (collapse_pass.is_locked(collapse)) {
+				continue;
+			}
+
+			const auto removed = collapse_pass.try_collapse(collapse);
+			if (removed == 0) {
+				continue;
+			}
+			quadrics[collapse.to] += quadrics[collapse.from];
+			worst_cost = std::max(worst_cost, collapse.cost);
+			triangle_count -= std::min(removed, triangle_count);
+			collapsed++;
+			if (triangle_count <= target_triangles) {
+				break;
+			}
+		}
+
+		if (collapsed == 0) {
+			break;
+		}
+		result.indices = collapse_pass.apply();
+		triangle_count = result.indices.size() / 3;
+	}
+
+	result.error = static_cast<float>(std::sqrt(worst_cost));
+	return result;
+}
+
+auto generate_lods(std::span<const std::uint32_t> indices, std::span<const ModelVertex> vertices, const LodSettings& settings)
+	-> std::vector<SubmeshLod>
+{
+	std::vector<SubmeshLod> lods {};
+	if (!settings.any() || indices.size() < 3 || vertices.empty()) {
+		return lods;
+	}
+
+	glm::vec3 minimum { std::numeric_limits<float>::max() };
+	glm::vec3 maximum { std::numeric_limits<float>::lowest() };
+	for (const auto index : indices) {
+		minimum = glm::min(minimum, vertices[index].pos);
+		maximum = glm::max(maximum, vertices[index].pos);
+	}
+	const auto max_error = settings.max_error * glm::length(maximum - minimum);
+
+	const auto triangle_count = indices.size() / 3;
+	auto previous_count = triangle_count * 3;
+	float previous_error = 0.0F;
+	for (const auto ratio : settings.ratios) {
+		const auto target = static_cast<std::size_t>(static_cast<double>(triangle_count) * std::clamp(ratio, 0.0F, 1.0F)) * 3;
+		auto simplified = simplify(indices, vertices, target, max_error);
+		if (simplified.indices.size() >= previous_count) {
+			break;
+		}
+
+		previous_count = simplified.indices.size();
+		previous_error = std::max(previous_error, simplified.error);
+		lods.push_back({
+			.indices = MeshOptimiser::optimise_vertex_cache(simplified.indices, vertices.size()),
+			.error = previous_error,
+		});
+	}
+	return lods;
+}
+
+} // namespace Disarray::MeshSimplifier
@@ -0,0 +1,454 @@
+#include "DisarrayPCH.hpp"
+
+#include "graphics/Meshlets.hpp"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace Disarray::Meshlets {
+
+namespace {
+	constexpr auto no_triangle = std::numeric_limits<std::uint32_t>::max();
+	// How far either side of the last triangle, in spatial order, to look for a close triangle once none shares a vertex with the meshlet.
+	constexpr std::size_t nearby_window = 128;
+
+	auto face_normal(const glm::vec3& first, const glm::vec3& second, const glm::vec3& third) -> glm::vec3
+	{
+		const auto cross = glm::cross(second - first, third - first);
+		const auto length = glm::length(cross);
+		return length > 0.0F ? cross / length : glm::vec3 { 0.0F };
+	}
+
+	// Spreads the low ten bits of value so there are two zero bits between each of them.
+	auto spread_bits(std::uint32_t value) -> std::uint32_t
+	{
+		value &= 0x3FFU;
+		value = (value | (value << 16U)) & 0x030000FFU;
+		value = (value | (value << 8U)) & 0x0300F00FU;
+		value = (value | (value << 4U)) & 0x030C30C3U;
+		value = (value | (value << 2U)) & 0x09249249U;
+		return value;
+	}
+
+	// Triangles sorted along a Morton curve through their centroids, so neighbours in the order are usually neighbours in space.
+	auto spatial_order(std::span<const glm::vec3> centroids) -> std::vector<std::uint32_t>
+	{
+		glm::vec3 minimum { std::numeric_limits<float>::max() };
+		glm::vec3 maximum { std::numeric_limits<float>::lowest() };
+		for (const auto& centroid : centroids) {
+			minimum = glm::min(minimum, centroid);
+			maximum = glm::max(maximum, centroid);
+		}
+		const auto extent = maximum - minimum;
+		const auto scale = std::max({ extent.x, extent.y, extent.z, std::numeric_limits<float>::min() });
+
+		std::vector<std::uint32_t> codes(centroids.size());
+		for (std::size_t triangle = 0; triangle < centroids.size(); triangle++) {
+			const auto normalised = (centroids[triangle] - minimum) / scale * 1023.0F;
+			codes[triangle] = spread_bits(static_cast<std::uint32_t>(normalised.x)) | (spread_bits(static_cast<std::uint32_t>(normalised.y)) << 1U)
+				| (spread_bits(static_cast<std::uint32_t>(normalised.z)) << 2U);
+		}
+
+		std::vector<std::uint32_t> order(centroids.size());
+		std::iota(order.begin(), order.end(), 0U);
+		std::stable_sort(order.begin(), order.end(), [&codes](std::uint32_t left, std::uint32_t right) { return codes[left] < codes[right]; });
+		return order;
+	}
+
+	class MeshletBuilder {
+	public:
+		MeshletBuilder(std::span<const std::uint32_t> in_indices, std::span<const ModelVertex> in_vertices, const MeshletSettings& settings)
+			: indices(in_indices)
+			, vertices(in_vertices)
+			, max_vertices(std::max(settings.max_vertices, 3U))
+			, max_triangles(std::max(settings.max_triangles, 1U))
+			, cone_weight(settings.cone_weight)
+			, triangle_count(in_indices.size() / 3)
+			, normals(triangle_count)
+			, centroids(triangle_count)
+			, used(triangle_count, false)
+			, offsets(in_vertices.size() + 1, 0)
+			, live(in_vertices.size(), 0)
+			, vertex_stamps(in_vertices.size(), no_triangle)
+		{
+			for (std::size_t triangle = 0; triangle < triangle_count; triangle++) {
+				const auto& first = vertices[indices[3 * triangle + 0]].pos;
+				const auto& second = vertices[indices[3 * triangle + 1]].pos;
+				const auto& third = vertices[indices[3 * triangle + 2]].pos;
+				normals[triangle] = face_normal(first, second, third);
+				centroids[triangle] = (first + second + third) / 3.0F;
+			}
+
+			for (std::size_t index = 0; index < triangle_count * 3; index++) {
+				offsets[indices[index] + 1]++;
+			}
+			std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+			adjacency.resize(offsets.back());
+			for (std::size_t index = 0; index < triangle_count * 3; index++) {
+				const auto vertex = indices[index];
+				adjacency[offsets[vertex] + live[vertex]++] = static_cast<std::uint32_t>(index / 3);
+			}
+
+			order = spatial_order(centroids);
+			ranks.resize(triangle_count);
+			for (std::size_t rank = 0; rank < order.size(); rank++) {
+				ranks[order[rank]] = static_cast<std::uint32_t>(rank);
+			}
+		}
+
+		auto run(std::vector<std::uint32_t>& output) -> std::vector<Meshlet>
+		{
+			std::vector<Meshlet> meshlets {};
+			output.clear();
+			output.reserve(triangle_count * 3);
+
+			std::size_t cursor = 0;
+			while (true) {
+				while (cursor < order.size() && used[order[cursor]]) {
+					cursor++;
+				}
+				if (cursor == order.size()) {
+					break;
+				}
+
+				begin_meshlet(static_cast<std::uint32_t>(meshlets.size()));
+				auto next = order[cursor];
+				while (next != no_triangle) {
+					add(next);
+					if (meshlet_triangles.size() == max_triangles) {
+						break;
+					}
+					next = best_adjacent();
+					if (next == no_triangle) {
+						next = best_nearby();
+					}
+				}
+
+				auto& meshlet = meshlets.emplace_back();
+				meshlet.first_index = static_cast<std::uint32_t>(output.size());
+				for (const auto triangle : meshlet_triangles) {
+					output.insert(output.end(), indices.begin() + 3 * triangle, indices.begin() + 3 * triangle + 3);
+				}
+				meshlet.index_count = static_cast<std::uint32_t>(output.size()) - meshlet.first_index;
+				meshlet.vertex_count = static_cast<std::uint32_t>(meshlet_vertices.size());
+				meshlet.bounds = compute_bounds(std::span { output }.subspan(meshlet.first_index, meshlet.index_count), vertices);
+			}
+			return meshlets;
+		}
+
+	private:
+		void begin_meshlet(std::uint32_t identifier)
+		{
+			meshlet_identifier = identifier;
+			meshlet_triangles.clear();
+			meshlet_vertices.clear();
+			normal_sum = glm::vec3 { 0.0F };
+			minimum = glm::vec3 { std::numeric_limits<float>::max() };
+			maximum = glm::vec3 { std::numeric_limits<float>::lowest() };
+		}
+
+		[[nodiscard]] auto new_vertices(std::uint32_t triangle) const -> std::uint32_t
+		{
+			const auto first = indices[3 * triangle + 0];
+			const auto second = indices[3 * triangle + 1];
+			const auto third = indices[3 * triangle + 2];
+			std::uint32_t count = vertex_stamps[first] != meshlet_identifier ? 1 : 0;
+			count += vertex_stamps[second] != meshlet_identifier && second != first ? 1 : 0;
+			count += vertex_stamps[third] != meshlet_identifier && third != first && third != second ? 1 : 0;
+			return count;
+		}
+
+		[[nodiscard]] auto cone_penalty(std::uint32_t triangle) const -> float
+		{
+			const auto length = glm::length(normal_sum);
+			return length > 0.0F ? cone_weight * (1.0F - glm::dot(normals[triangle], normal_sum / length)) : 0.0F;
+		}
+
+		void add(std::uint32_t triangle)
+		{
+			used[triangle] = true;
+			meshlet_triangles.push_back(triangle);
+			normal_sum += normals[triangle];
+			for (std::size_t corner = 0; corner < 3; corner++) {
+				const auto vertex = indices[3 * triangle + corner];
+				if (vertex_stamps[vertex] != meshlet_identifier) {
+					vertex_stamps[vertex] = meshlet_identifier;
+					meshlet_vertices.push_back(vertex);
+					minimum = glm::min(minimum, vertices[vertex].pos);
+					maximum = glm::max(maximum, vertices[vertex].pos);
+				}
+
+				// Swap the triangle out of the vertex's live adjacency, so only unused triangles are ever scanned.
+				const auto begin = adjacency.begin() + offsets[vertex];
+				const auto found = std::find(begin, begin + live[vertex], triangle);
+				std::iter_swap(found, begin + --live[vertex]);
+			}
+		}
+
+		[[nodiscard]] auto fits(std::uint32_t extra) const -> bool { return meshlet_vertices.size() + extra <= max_vertices; }
+
+		// The unused triangle sharing a vertex with the meshlet that adds the fewest vertices, then bends its cone the least.
+		[[nodiscard]] auto best_adjacent() const -> std::uint32_t
+		{
+			auto best = no_triangle;
+			auto best_score = std::numeric_limits<float>::max();
+			for (const auto vertex : meshlet_vertices) {
+				for (auto position = offsets[vertex]; position < offsets[vertex] + live[vertex]; position++) {
+					const auto triangle = adjacency[position];
+					const auto extra = new_vertices(triangle);
+					if (!fits(extra)) {
+						continue;
+					}
+					const auto score = static_cast<float>(extra) + cone_penalty(triangle);
+					if (score < best_score || (score == best_score && triangle < best)) {
+						best = triangle;
+						best_score = score;
+					}
+				}
+			}
+			return best;
+		}
+
+		// Meshes with split vertices, like flat shaded ones, run out of adjacent triangles early. Continue with a triangle close to the
+		// meshlet instead, as long as it is no further from its centre than twice the meshlet's diagonal.
+		[[nodiscard]] auto best_nearby() const -> std::uint32_t
+		{
+			const auto centre = (minimum + maximum) * 0.5F;
+			const auto diagonal = std::max(glm::length(maximum - minimum), std::numeric_limits<float>::min());
+			const auto reach = 2.0F * diagonal;
+			const auto last = ranks[meshlet_triangles.back()];
+			const auto begin = last > nearby_window ? last - nearby_window : 0;
+			const auto end = std::min<std::size_t>(last + nearby_window + 1, order.size());
+
+			auto best = no_triangle;
+			auto best_score = std::numeric_limits<float>::max();
+			for (auto rank = begin; rank < end; rank++) {
+				const auto triangle = order[rank];
+				if (used[triangle] || !fits(new_vertices(triangle))) {
+					continue;
+				}
+				const auto distance = glm::length(centroids[triangle] - centre);
+				if (distance > reach) {
+					continue;
+				}
+				const auto score = distance / diagonal + cone_penalty(triangle);
+				if (score < best_score || (score == best_score && triangle < best)) {
+					best = triangle;
+					best_score = score;
+				}
+			}
+			return best;
+		}
+
+		std::span<const std::uint32_t> indices;
+		std::span<const ModelVertex> vertices;
+		std::uint32_t max_vertices;
+		std::uint32_t max_triangles;
+		float cone_weight;
+		std::size_t triangle_count;
+
+		std::vector<glm::vec3> normals;
+		std::vector<glm::vec3> centroids;
+		std::vector<bool> used;
+		std::vector<std::uint32_t> offsets;
+		std::vector<std::uint32_t> live;
+		std::vector<std::uint32_t> adjacency {};
+		std::vector<std::uint32_t> vertex_stamps;
+		std::vector<std::uint32_t> order {};
+		std::vector<std::uint32_t> ranks {};
+
+		std::uint32_t meshlet_identifier { 0 };
+		std::vector<std::uint32_t> meshlet_triangles {};
+		std::vector<std::uint32_t> meshlet_vertices {};
+		glm::vec3 normal_sum { 0.0F };
+		glm::vec3 minimum { 0.0F };
+		glm::vec3 maximum { 0.0F };
+	};
+
+	auto outside_frustum(const MeshletBounds& bounds, const MeshletCullingView& view) -> bool
+	{
+		return std::any_of(view.planes.begin(), view.planes.end(), [&bounds](const glm::vec4& plane) {
+			return glm::dot(glm::vec3 { plane }, bounds.centre) + plane.w < -bounds.radius;
+		});
+	}
+
+	// True when every normal in the cone faces away from every point in the bounding sphere. The radius pads both the distance to the
+	// centre and the offset along the axis, which keeps the test conservative.
+	auto faces_away(const MeshletBounds& bounds, const MeshletCullingView& view) -> bool
+	{
+		if (!bounds.has_cone()) {
+			return false;
+		}
+		const auto direction = bounds.centre - view.camera_position;
+		return glm::dot(direction, bounds.cone_axis) >= bounds.cone_cutoff * (glm::length(direction) + bounds.radius) + bounds.radius;
+	}
+} // namespace
+
+auto build(std::vector<std::uint32_t>& indices, std::span<const ModelVertex> vertices, const MeshletSettings& settings) -> std::vector<Meshlet>
+{
+	if (indices.size() < 3) {
+		return {};
+	}
+	std::vector<std::uint32_t> output {};
+	auto meshlets = MeshletBuilder { indices, vertices, settings }.run(output);
+	indices = std::move(output);
+	return meshlets;
+}
+
+auto build_in_order(std::span<const std::uint32_t> indices, std::span<const ModelVertex> vertices, const MeshletSettings& settings)
+	-> std::vector<Meshlet>
+{
+	const auto max_vertices = std::max(settings.max_vertices, 3U);
+	const auto max_triangles = std::max(settings.max_triangles, 1U);
+	std::vector<std::uint32_t> vertex_stamps(vertices.size(), no_triangle);
+	std::vector<Meshlet> meshlets {};
+	Meshlet meshlet {};
+
+	const auto new_vertices = [&](std::span<const std::uint32_t> triangle) {
+		const auto identifier = static_cast<std::uint32_t>(meshlets.size());
+		std::uint32_t count = vertex_stamps[triangle[0]] != identifier ? 1 : 0;
+		count += vertex_stamps[triangle[1]] != identifier && triangle[1] != triangle[0] ? 1 : 0;
+		count += vertex_stamps[triangle[2]] != identifier && triangle[2] != triangle[0] && triangle[2] != triangle[1] ? 1 : 0;
+		return count;
+	};
+	const auto close = [&]() {
+		meshlet.bounds = compute_bounds(indices.subspan(meshlet.first_index, meshlet.index_count), vertices);
+		meshlets.push_back(meshlet);
+		meshlet = Meshlet { .first_index = meshlet.first_index + meshlet.index_count };
+	};
+
+	for (std::size_t first = 0; first + 2 < indices.size(); first += 3) {
+		const auto triangle = indices.subspan(first, 3);
+		if (meshlet.index_count > 0 && (meshlet.triangle_count() == max_triangles || meshlet.vertex_count + new_vertices(triangle) > max_vertices)) {
+			close();
+		}
+		meshlet.vertex_count += new_vertices(triangle);
+		for (const auto vertex : triangle) {
+			vertex_stamps[vertex] = static_cast<std::uint32_t>(meshlets.size());
+		}
+		meshlet.index_count += 3;
+	}
+	if (meshlet.index_count > 0) {
+		close();
+	}
+	return meshlets;
+}
+
+auto compute_bounds(std::span<const std::uint32_t> triangle_indices, std::span<const ModelVertex> vertices) -> MeshletBounds
+{
+	MeshletBounds bounds {};
+	if (triangle_indices.empty()) {
+		return bounds;
+	}
+
+	bounds.minimum = glm::vec3 { std::numeric_limits<float>::max() };
+	bounds.maximum = glm::vec3 { std::numeric_limits<float>::lowest() };
+	for (const auto index : triangle_indices) {
+		bounds.minimum = glm::min(bounds.minimum, vertices[index].pos);
+		bounds.maximum = glm::max(bounds.maximum, vertices[index].pos);
+	}
+	bounds.centre = (bounds.minimum + bounds.maximum) * 0.5F;
+	for (const auto index : triangle_indices) {
+		bounds.radius = std::max(bounds.radius, glm::length(vertices[index].pos - bounds.centre));
+	}
+
+	glm::vec3 normal_sum { 0.0F };
+	for (std::size_t triangle = 0; triangle + 2 < triangle_indices.size(); triangle += 3) {
+		normal_sum += face_normal(vertices[triangle_indices[triangle]].pos, vertices[triangle_indices[triangle + 1]].pos,
+			vertices[triangle_indices[triangle + 2]].pos);
+	}
+	const auto length = glm::length(normal_sum);
+	if (length <= 0.0F) {
+		return bounds;
+	}
+	const auto axis = normal_sum / length;
+
+	auto min_dot = 1.0F;
+	for (std::size_t triangle = 0; triangle + 2 < triangle_indices.size(); triangle += 3) {
+		const auto normal = face_normal(vertices[triangle_indices[triangle]].pos, vertices[triangle_indices[triangle + 1]].pos,
+			vertices[triangle_indices[triangle + 2]].pos);
+		if (normal != glm::vec3 { 0.0F }) {
+			min_dot = std::min(min_dot, glm::dot(normal, axis));
+		}
+	}
+	bounds.cone_axis = axis;
+	bounds.cone_cutoff = min_dot <= 0.0F ? 1.0F : std::sqrt(std::max(0.0F, 1.0F - min_dot * min_dot));
+	return bounds;
+}
+
+auto statistics(std::span<const Meshlet> meshlets, const MeshletSettings& settings) -> MeshletStatistics
+{
+	MeshletStatistics output { .meshlet_count = meshlets.size() };
+	if (meshlets.empty()) {
+		return output;
+	}
+	for (const auto& meshlet : meshlets) {
+		output.vertex_fill += static_cast<float>(meshlet.vertex_count) / static_cast<float>(settings.max_vertices);
+		output.triangle_fill += static_cast<float>(meshlet.triangle_count()) / static_cast<float>(settings.max_triangles);
+		output.mean_cone_cutoff += meshlet.bounds.cone_cutoff;
+		output.meshlets_with_cones += meshlet.bounds.has_cone() ? 1 : 0;
+	}
+	const auto count = static_cast<float>(meshlets.size());
+	output.vertex_fill /= count;
+	output.triangle_fill /= count;
+	output.mean_cone_cutoff /= count;
+	return output;
+}
+
+auto culling_view(const glm::mat4& view, const glm::mat4& projection, const glm::mat4& transform) -> MeshletCullingView
+{
+	const auto clip = projection * view * transform;
+	const auto row = [&clip](glm::length_t index) { return glm::vec4 { clip[0][index], clip[1][index], clip[2][index], clip[3][index] }; };
+
+	MeshletCullingView output {};
+	output.planes = {
+		row(3) + row(0),
+		row(3) - row(0),
+		row(3) + row(1),
+		row(3) - row(1),
+		row(3) + row(2),
+		row(3) - row(2),
+	};
+	for (auto& plane : output.planes) {
+		const auto length = glm::length(glm::vec3 { plane });
+		plane = length > 0.0F ? plane / length : plane;
+	}
+	output.camera_position = glm::vec3 { glm::inverse(view * transform)[3] };
+	return output;
+}
+
+auto is_visible(const MeshletBounds& bounds, const MeshletCullingView& view) -> bool
+{
+	return !outside_frustum(bounds, view) && !faces_away(bounds, view);
+}
+
+auto cull(std::span<const Meshlet> meshlets, const MeshletCullingView& view, std::vector<IndexRange>& output) -> MeshletCullingStatistics
+{
+	MeshletCullingStatistics result {};
+	output.clear();
+	for (const auto& meshlet : meshlets) {
+		if (outside_frustum(meshlet.bounds, view)) {
+			result.frustum_culled++;
+			continue;
+		}
+		if (faces_away(meshlet.bounds, view)) {
+			result.cone_culled++;
+			continue;
+		}
+
+		result.visible++;
+		result.visible_indices += meshlet.index_count;
+		if (!output.empty() && output.back().first_index + output.back().index_count == meshlet.first_index) {
+			output.back().index_count += meshlet.index_count;
+		} else {
+			output.push_back({ .first_index = meshlet.first_index, .index_count = meshlet.index_count });
+		}
+	}
+	return result;
+}
+
+} // namespace Disarray::Meshlets
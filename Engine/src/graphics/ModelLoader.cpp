@@ -8,6 +8,7 @@
 #include "graphics/Device.hpp"
 #include "graphics/ModelLoader.hpp"
 #include "graphics/TextureCache.hpp"
+#include "graphics/TextureDecoder.hpp"
 #include "util/Timer.hpp"
 #include "vulkan/CommandExecutor.hpp"
 #include "vulkan/Texture.hpp"
@@ -26,6 +27,12 @@ ModelLoader::ModelLoader(Scope<IModelImporter> input, const std::filesystem::pat
 	import_model(mesh_path, flags);
 };
 
+ModelLoader::ModelLoader(const std::filesystem::path& path, ImportedMesh imported)
+	: mesh_path(path)
+	, mesh_data(std::move(imported))
+{
+}
+
 auto ModelLoader::import_model(const std::filesystem::path& path, ImportFlag flags) -> void
 {
 	auto&& meshes = importer->import_model(path, flags);
@@ -34,13 +41,29 @@ auto ModelLoader::import_model(const std::filesystem::path& path, ImportFlag fla
 
 auto ModelLoader::construct_textures(const Disarray::Device& device) -> std::vector<Ref<Disarray::Texture>>
 {
+	// Decoding is the slow part and needs no device, so every unique image is decoded on the thread pool before any texture is created.
+	std::vector<std::filesystem::path> unique_paths {};
+	Collections::StringMap<std::size_t> decoded_index {};
+	for (const auto& [key, value] : mesh_data) {
+		for (const auto& props : value.texture_properties) {
+			if (decoded_index.try_emplace(props.path.string(), unique_paths.size()).second) {
+				unique_paths.push_back(props.path);
+			}
+		}
+	}
+
+	Timer<float> decode_timer;
+	auto decoded = TextureDecoder::decode_all(unique_paths);
+	const auto decode_time = decode_timer.elapsed<Granularity::Millis>();
+
 	TextureCache cache = TextureCache::construct(device, mesh_path.parent_path());
 	Timer<float> texture_timer;
 	std::size_t saved_iterations = 0;
 	for (auto& [key, value] : mesh_data) {
-		Collections::for_each(
-			value.texture_properties, [&saved_iterations, &captured = cache, &texts = value.textures](const TextureProperties& props) {
+		Collections::for_each(value.texture_properties,
+			[&saved_iterations, &decoded, &decoded_index, &captured = cache, &texts = value.textures](const TextureProperties& props) {
 				const auto mip_count = props.generate_mips ? (props.mips.has_value() ? *props.mips : 1) : 1;
+				auto& image = decoded.at(decoded_index.at(props.path.string()));
 
 				auto&& [could, inserted] = captured.try_put(TextureCacheCreationProperties {
 					.key = props.path.string(),
@@ -48,6 +71,8 @@ auto ModelLoader::construct_textures(const Disarray::Device& device) -> std::vec
 					.path = props.path,
 					.mips = mip_count,
 					.format = props.format,
+					.pixels = std::move(image.pixels),
+					.extent = image.extent,
 				});
 
 				saved_iterations = could ? saved_iterations + 1 : saved_iterations;
@@ -55,44 +80,130 @@ auto ModelLoader::construct_textures(const Disarray::Device& device) -> std::vec
 				texts.push_back(inserted);
 			});
 	}
-	Log::info("ModelLoader", "Loading textures took {}ms. Constructed {} textures. {} copies.", texture_timer.elapsed<Granularity::Millis>(),
-		cache.size(), saved_iterations);
+	Log::info("ModelLoader", "Decoding {} images took {}ms, creating textures took {}ms. Constructed {} textures. {} copies.", unique_paths.size(),
+		decode_time, texture_timer.elapsed<Granularity::Millis>(), cache.size(), saved_iterations);
 	return cache.flatten();
 }
 
-auto ModelLoader::get_aabb() const -> AABB
+auto ModelLoader::optimise(const MeshOptimisationSettings& settings) -> Collections::StringMap<MeshOptimisationReport>
 {
-	AABBRange x_aabb {};
-	AABBRange y_aabb {};
-	AABBRange z_aabb {};
+	Collections::StringMap<MeshOptimisationReport> reports {};
+	if (!settings.any()) {
+		return reports;
+	}
 
+	struct OptimisationTask {
+		Submesh* submesh { nullptr };
+		MeshOptimisationReport report {};
+	};
+	std::vector<OptimisationTask> tasks {};
+	tasks.reserve(mesh_data.size());
+	for (auto& [key, value] : mesh_data) {
+		tasks.push_back({ &value });
+	}
+
+	Timer<float> optimisation_timer;
+	Collections::parallel_for_each(
+		tasks,
+		[&settings](OptimisationTask& task) {
+			task.report = MeshOptimiser::optimise(task.submesh->vertices, task.submesh->indices, settings);
+		},
+		1);
+	in_vertex_cache_order = settings.vertex_cache || settings.overdraw;
+
+	std::size_t triangles = 0;
+	float misses_before = 0.0F;
+	float misses_after = 0.0F;
+	auto task = tasks.begin();
 	for (const auto& [key, value] : mesh_data) {
-		const auto& vertices = value.vertices;
-		for (const auto& vertex : vertices) {
-			if (vertex.pos.x > x_aabb.max) {
-				x_aabb.max = vertex.pos.x;
-			}
-			if (vertex.pos.x < x_aabb.min) {
-				x_aabb.min = vertex.pos.x;
-			}
+		const auto& report = (task++)->report;
+		Log::debug("ModelLoader", "{}: ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}", key, report.before.acmr, report.after.acmr, report.before.atvr,
+			report.after.atvr);
+		const auto triangle_count = value.indices.size() / 3;
+		triangles += triangle_count;
+		misses_before += report.before.acmr * static_cast<float>(triangle_count);
+		misses_after += report.after.acmr * static_cast<float>(triangle_count);
+		reports.try_emplace(key, report);
+	}
 
-			if (vertex.pos.y > y_aabb.max) {
-				y_aabb.max = vertex.pos.y;
-			}
-			if (vertex.pos.y < y_aabb.min) {
-				y_aabb.min = vertex.pos.y;
-			}
+	if (triangles > 0) {
+		const auto triangle_count = static_cast<float>(triangles);
+		Log::info("ModelLoader", "Optimised {} in {}ms. ACMR {:.3f} -> {:.3f}", mesh_path.filename().string(),
+			optimisation_timer.elapsed<Granularity::Millis>(), misses_before / triangle_count, misses_after / triangle_count);
+	}
+	return reports;
+}
 
-			if (vertex.pos.z > z_aabb.max) {
-				z_aabb.max = vertex.pos.z;
-			}
-			if (vertex.pos.z < z_aabb.min) {
-				z_aabb.min = vertex.pos.z;
-			}
+auto ModelLoader::generate_lods(const LodSettings& settings) -> void
+{
+	if (!settings.any()) {
+		return;
+	}
+
+	std::vector<Submesh*> submeshes {};
+	submeshes.reserve(mesh_data.size());
+	for (auto& [key, value] : mesh_data) {
+		submeshes.push_back(&value);
+	}
+
+	Timer<float> lod_timer;
+	Collections::parallel_for_each(
+		submeshes,
+		[&settings](Submesh* submesh) { submesh->lods = MeshSimplifier::generate_lods(submesh->indices, submesh->vertices, settings); }, 1);
+
+	std::size_t levels = 0;
+	for (const auto& [key, value] : mesh_data) {
+		for (const auto& lod : value.lods) {
+			Log::debug("ModelLoader", "{}: {} -> {} triangles, error {:.4f}", key, value.indices.size() / 3, lod.indices.size() / 3, lod.error);
 		}
+		levels += value.lods.size();
+	}
+	Log::info("ModelLoader", "Built {} levels of detail for {} in {}ms.", levels, mesh_path.filename().string(),
+		lod_timer.elapsed<Granularity::Millis>());
+}
+
+auto ModelLoader::build_meshlets(const MeshletSettings& settings) -> void
+{
+	if (!settings.enabled) {
+		return;
+	}
+
+	std::vector<Submesh*> submeshes {};
+	submeshes.reserve(mesh_data.size());
+	for (auto& [key, value] : mesh_data) {
+		submeshes.push_back(&value);
+	}
+
+	Timer<float> meshlet_timer;
+	Collections::parallel_for_each(
+		submeshes,
+		[&settings, in_order = in_vertex_cache_order](Submesh* submesh) {
+			if (in_order) {
+				submesh->meshlets = Meshlets::build_in_order(submesh->indices, submesh->vertices, settings);
+			} else {
+				submesh->meshlets = Meshlets::build(submesh->indices, submesh->vertices, settings);
+			}
+		},
+		1);
+
+	std::size_t meshlet_count = 0;
+	for (const auto& [key, value] : mesh_data) {
+		const auto statistics = Meshlets::statistics(value.meshlets, settings);
+		Log::debug("ModelLoader", "{}: {} meshlets, vertex fill {:.2f}, triangle fill {:.2f}, {} with normal cones", key, statistics.meshlet_count,
+			statistics.vertex_fill, statistics.triangle_fill, statistics.meshlets_with_cones);
+		meshlet_count += statistics.meshlet_count;
 	}
+	Log::info("ModelLoader", "Built {} meshlets for {} in {}ms.", meshlet_count, mesh_path.filename().string(),
+		meshlet_timer.elapsed<Granularity::Millis>());
+}
 
-	return { x_aabb, y_aabb, z_aabb };
+auto ModelLoader::get_aabb() const -> AABB
+{
+	auto aabb = AABB::empty();
+	for (const auto& [key, value] : mesh_data) {
+		aabb = aabb.merged(AABB::from_vertices(value.vertices));
+	}
+	return aabb.is_empty() ? AABB {} : aabb;
 }
 
 } // namespace Disarray
@@ -2,43 +2,343 @@
 
 #include "graphics/PipelineCache.hpp"
 
+#include <algorithm>
+#include <exception>
 #include <filesystem>
+#include <span>
+#include <string>
+#include <vector>
 
+#include "core/CleanupAwaiter.hpp"
+#include "core/Collections.hpp"
 #include "core/Log.hpp"
+#include "core/filesystem/MappedFile.hpp"
 #include "graphics/Framebuffer.hpp"
+#include "graphics/IncludeCache.hpp"
 #include "graphics/Pipeline.hpp"
 #include "graphics/Shader.hpp"
 #include "graphics/ShaderCompiler.hpp"
+#include "graphics/ShaderKeywords.hpp"
 #include "graphics/Swapchain.hpp"
+#include "util/Timer.hpp"
 
 namespace Disarray {
 
+namespace {
+	// Used for variants and reloads alike. The reflection is handed over with the code, so a SpirvCache hit never runs SPIRV-Cross.
+	auto compile_shader(const Device& device, Runtime::ShaderCompiler& compiler, const std::filesystem::path& path, std::string_view defines)
+		-> Ref<Shader>
+	{
+		const auto type = to_shader_type(path);
+		auto compiled = compiler.compile_cached(path, type, defines);
+		if (compiled.code.empty()) {
+			return nullptr;
+		}
+		return Shader::construct(device, { .code = std::move(compiled.code), .reflection = compiled.reflection, .identifier = path, .type = type });
+	}
+
+	auto read_keywords(const std::filesystem::path& path) -> ShaderKeywords
+	{
+		const FS::MappedFile file { path };
+		if (!file) {
+			return {};
+		}
+		try {
+			return ShaderKeywords::parse(file.view());
+		} catch (const std::exception& exc) {
+			Log::error("PipelineCache", "Ignoring the keywords of {}: {}", path.string(), exc.what());
+			return {};
+		}
+	}
+} // namespace
+
 PipelineCache::PipelineCache(const Disarray::Device& dev, const std::filesystem::path& base)
 	: ResourceCache(dev, base, { ".vert", ".frag", ".glsl" })
 {
 	const auto all_files = get_unique_files_recursively();
 
-	// create all pairs of shaders
+	struct ShaderCompilation {
+		std::filesystem::path path {};
+		Ref<Shader> shader { nullptr };
+		std::string error {};
+	};
+
+	// Shaders are keyed by file name, so only the first file of each name, in path order, is compiled.
 	std::vector<std::filesystem::path> as_vector { all_files.begin(), all_files.end() };
 	std::sort(as_vector.begin(), as_vector.end());
+	std::vector<ShaderCompilation> compilations {};
+	Collections::StringSet names {};
+	for (const auto& shader_path : as_vector) {
+		if (names.insert(shader_path.filename().string()).second) {
+			compilations.push_back({ .path = std::filesystem::relative(shader_path) });
+		}
+	}
 
+	// glslang compiles on any thread once the process is initialised.
 	Runtime::ShaderCompiler::initialize();
 
-	for (const auto& shader_path : as_vector) {
-		if (auto name = shader_path.filename(); shader_cache.contains(name.string())) {
-			break;
+	Timer<float> compile_timer;
+	Collections::parallel_for_each(
+		compilations,
+		[&device = get_device()](ShaderCompilation& compilation) {
+			try {
+				compilation.shader = Shader::compile(device, compilation.path);
+			} catch (const std::exception& exc) {
+				compilation.error = exc.what();
+			}
+		},
+		1);
+
+	std::size_t failed = 0;
+	for (auto& compilation : compilations) {
+		// Shaders that failed are tracked too, so that fixing them reloads them.
+		dependencies.add_shader(compilation.path);
+		shader_paths.try_emplace(compilation.path.filename().string(), compilation.path);
+		if (!compilation.shader) {
+			Log::error("PipelineCache", "Could not compile {}: {}", compilation.path.string(), compilation.error);
+			failed++;
+			continue;
+		}
+		shader_cache.try_emplace(compilation.path.filename().string(), std::move(compilation.shader));
+	}
+	Log::info("PipelineCache", "Compiled {} shaders in {}ms, {} failed.", compilations.size() - failed, compile_timer.elapsed<Granularity::Millis>(),
+		failed);
+	const auto includes = IncludeCache::statistics();
+	Log::info(
+		"PipelineCache", "Read {} includes ({} bytes) for {} uses of them.", includes.misses, includes.bytes_read, includes.hits + includes.misses);
+}
+
+void PipelineCache::reload_affected_by(const std::filesystem::path& changed)
+{
+	IncludeCache::invalidate(changed);
+	ShaderReloadPlan plan {};
+	{
+		std::scoped_lock lock { reload_mutex };
+		plan = dependencies.on_changed(changed);
+	}
+	if (plan.empty()) {
+		Log::debug("PipelineCache", "No shader uses {}.", changed.string());
+		return;
+	}
+
+	// The includes come from the IncludeCache, so a new compiler costs nothing and sees the files as they are now.
+	Runtime::ShaderCompiler compiler {};
+	Timer<float> compile_timer;
+	ShaderReload reload { .pipelines = std::move(plan.pipelines) };
+	for (const auto& path : plan.shaders) {
+		// Variants are recompiled with the defines they were first compiled with, under the same keys. If the shader now declares other
+		// keywords, the masks in those keys mean other keywords, so the variants are left to be compiled again when pipelines ask for them.
+		const auto keywords = read_keywords(path);
+		std::vector<CompiledVariant> variants { { .key = path.filename().string() } };
+		{
+			std::scoped_lock lock { reload_mutex };
+			const auto found = compiled_variants.find(variants.front().key);
+			if (found != compiled_variants.end() && found->second.keywords == keywords.get_keywords()) {
+				variants.insert(variants.end(), found->second.variants.begin(), found->second.variants.end());
+			} else if (found != compiled_variants.end()) {
+				reload.stale_variants.push_back(variants.front().key);
+			}
+		}
+
+		for (auto& variant : variants) {
+			Ref<Shader> shader { nullptr };
+			try {
+				shader = compile_shader(get_device(), compiler, path, variant.defines);
+			} catch (const std::exception& exc) {
+				Log::error("PipelineCache", "Could not recreate {}: {}, keeping the current shaders.", variant.key, exc.what());
+				return;
+			}
+			if (!shader) {
+				Log::error("PipelineCache", "Could not recompile {} after {} changed, keeping the current shaders.", variant.key, changed.string());
+				return;
+			}
+			reload.shaders.try_emplace(std::move(variant.key), std::move(shader));
+		}
+	}
+	Log::info("PipelineCache", "Recompiled {} shaders for {} pipelines after {} changed, in {}ms.", reload.shaders.size(), reload.pipelines.size(),
+		changed.string(), compile_timer.elapsed<Granularity::Millis>());
+
+	std::scoped_lock lock { reload_mutex };
+	finished_reloads.push_back(std::move(reload));
+}
+
+auto PipelineCache::apply_reloads() -> std::size_t
+{
+	std::vector<ShaderReload> reloads {};
+	{
+		std::scoped_lock lock { reload_mutex };
+		reloads.swap(finished_reloads);
+	}
+	if (reloads.empty()) {
+		return 0;
+	}
+
+	// The pipelines are destroyed and rebuilt, so no frame in flight may still use them.
+	wait_for_idle(get_device());
+
+	const auto swap_stage = [this](Ref<Shader>& stage, const std::string& shader_key, std::span<const std::string> keywords) {
+		if (const auto& shader = get_shader_variant(shader_key, keywords)) {
+			stage = shader;
+		}
+	};
+
+	std::size_t recreated = 0;
+	for (auto& reload : reloads) {
+		for (const auto& shader_key : reload.stale_variants) {
+			std::vector<CompiledVariant> stale {};
+			{
+				std::scoped_lock lock { reload_mutex };
+				if (const auto found = compiled_variants.find(shader_key); found != compiled_variants.end()) {
+					stale = std::move(found->second.variants);
+					compiled_variants.erase(found);
+				}
+			}
+			for (const auto& variant : stale) {
+				shader_cache.erase(variant.key);
+			}
+			Log::debug("PipelineCache", "The keywords of {} changed, dropped {} variants.", shader_key, stale.size());
 		}
+		for (auto& [key, shader] : reload.shaders) {
+			// The keywords a shader declares may have changed with it.
+			shader_keywords.erase(key);
+			shader_cache.insert_or_assign(key, std::move(shader));
+		}
+		for (const auto& key : reload.pipelines) {
+			const auto stages = pipeline_stages.find(key);
+			if (!contains(key) || stages == pipeline_stages.end()) {
+				continue;
+			}
+			auto& pipeline = get(key);
+			auto& properties = pipeline->get_properties();
+			swap_stage(properties.vertex_shader, stages->second.vertex_shader, stages->second.keywords);
+			swap_stage(properties.fragment_shader, stages->second.fragment_shader, stages->second.keywords);
+			pipeline->recreate(true, properties.extent);
+			recreated++;
+		}
+	}
+	return recreated;
+}
+
+auto PipelineCache::get_shader_variant(const std::string& shader_key, std::span<const std::string> keywords) -> const Ref<Shader>&
+{
+	const auto variant = variant_of(shader_key, keywords);
+	if (variant.mask == 0) {
+		return shader_cache[shader_key];
+	}
+
+	const auto key = variant.key();
+	if (const auto found = shader_cache.find(key); found != shader_cache.end()) {
+		return found->second;
+	}
+
+	const auto path = shader_paths.find(shader_key);
+	if (path == shader_paths.end()) {
+		return shader_cache[shader_key];
+	}
+	auto defines = keywords_of(shader_key).defines_for(variant.mask);
+	Runtime::ShaderCompiler compiler {};
+	Ref<Shader> shader { nullptr };
+	try {
+		shader = compile_shader(get_device(), compiler, path->second, defines);
+	} catch (const std::exception& exc) {
+		Log::error("PipelineCache", "Could not recreate {}: {}", key, exc.what());
+	}
+	if (!shader) {
+		Log::error("PipelineCache", "Could not compile {}, using {} without keywords.", key, shader_key);
+		return shader_cache[shader_key];
+	}
+	add_variant(variant, std::move(defines), std::move(shader));
+	return shader_cache.at(key);
+}
+
+void PipelineCache::precompile_variants(std::span<const ShaderVariantRequest> requests)
+{
+	struct VariantCompilation {
+		ShaderVariant variant {};
+		std::filesystem::path path {};
+		std::string defines {};
+		Ref<Shader> shader { nullptr };
+		std::string error {};
+	};
+
+	// Keywords are read here, on the calling thread, the compilations themselves only read what they are given.
+	std::vector<VariantCompilation> compilations {};
+	const auto keywords_lookup = [this](std::string_view shader) -> const ShaderKeywords& { return keywords_of(shader); };
+	for (auto& variant : resolve_variants(requests, keywords_lookup)) {
+		const auto path = shader_paths.find(variant.shader);
+		if (path == shader_paths.end()) {
+			Log::error("PipelineCache", "Cannot precompile {}, there is no such shader.", variant.shader);
+			continue;
+		}
+		if (shader_cache.contains(variant.key())) {
+			continue;
+		}
+		auto defines = keywords_of(variant.shader).defines_for(variant.mask);
+		compilations.push_back({ .variant = std::move(variant), .path = path->second, .defines = std::move(defines) });
+	}
+	if (compilations.empty()) {
+		return;
+	}
 
-		const auto relative_path = std::filesystem::relative(shader_path);
+	Runtime::ShaderCompiler compiler {};
+	Timer<float> compile_timer;
+	Collections::parallel_for_each(
+		compilations,
+		[&device = get_device(), &compiler](VariantCompilation& compilation) {
+			try {
+				compilation.shader = compile_shader(device, compiler, compilation.path, compilation.defines);
+			} catch (const std::exception& exc) {
+				compilation.error = exc.what();
+			}
+		},
+		1);
 
-		auto shader = Shader::compile(get_device(), relative_path);
-		if (!shader) {
+	std::size_t failed = 0;
+	for (auto& compilation : compilations) {
+		if (!compilation.shader) {
+			Log::error("PipelineCache", "Could not compile {}: {}", compilation.variant.key(), compilation.error);
+			failed++;
 			continue;
 		}
+		add_variant(compilation.variant, std::move(compilation.defines), std::move(compilation.shader));
+	}
+	Log::info("PipelineCache", "Compiled {} shader variants in {}ms, {} failed.", compilations.size() - failed,
+		compile_timer.elapsed<Granularity::Millis>(), failed);
+}
+
+auto PipelineCache::keywords_of(std::string_view shader_key) -> const ShaderKeywords&
+{
+	if (const auto found = shader_keywords.find(shader_key); found != shader_keywords.end()) {
+		return found->second;
+	}
 
-		auto filename = relative_path.filename().string();
-		shader_cache.try_emplace(filename, std::move(shader));
+	ShaderKeywords keywords {};
+	if (const auto path = shader_paths.find(shader_key); path != shader_paths.end()) {
+		keywords = read_keywords(path->second);
+	}
+	return shader_keywords.insert_or_assign(std::string { shader_key }, std::move(keywords)).first->second;
+}
+
+auto PipelineCache::variant_of(std::string_view shader_key, std::span<const std::string> keywords) -> ShaderVariant
+{
+	if (keywords.empty()) {
+		return { .shader = std::string { shader_key } };
+	}
+	return { .shader = std::string { shader_key }, .mask = keywords_of(shader_key).mask_of(keywords) };
+}
+
+void PipelineCache::add_variant(const ShaderVariant& variant, std::string defines, Ref<Shader> shader)
+{
+	auto key = variant.key();
+	shader_cache.insert_or_assign(key, std::move(shader));
+	if (variant.mask == 0) {
+		return;
 	}
+	const auto& keywords = keywords_of(variant.shader).get_keywords();
+	std::scoped_lock lock { reload_mutex };
+	auto& compiled = compiled_variants[variant.shader];
+	compiled.keywords = keywords;
+	compiled.variants.push_back({ .key = std::move(key), .defines = std::move(defines) });
 }
 
 } // namespace Disarray
@@ -2,26 +2,119 @@
 
 #include "graphics/RenderCommandQueue.hpp"
 
-#include "core/Collections.hpp"
-#include "core/Log.hpp"
+#include <exception>
+#include <thread>
+
+#include "core/Ensure.hpp"
 
 namespace Disarray {
 
 RenderCommandQueue::RenderCommandQueue(UsageBadge<Renderer>) { }
 
-RenderCommandQueue::~RenderCommandQueue() = default;
+RenderCommandQueue::~RenderCommandQueue()
+{
+	destroy_from(0, write_offset.load(std::memory_order_acquire));
+	for (auto& chunk : chunks) {
+		delete[] chunk.load(std::memory_order_relaxed);
+	}
+}
+
+auto RenderCommandQueue::reserve(std::size_t size) -> CommandHeader*
+{
+	while (true) {
+		const auto offset = write_offset.fetch_add(size, std::memory_order_relaxed);
+		const auto chunk_index = offset / chunk_size;
+		const auto chunk_offset = offset % chunk_size;
+
+		if (chunk_offset + size <= chunk_size) {
+			auto* header = ::new (get_chunk(chunk_index) + chunk_offset) CommandHeader {};
+			header->size = static_cast<std::uint32_t>(size);
+			return header;
+		}
+
+		// The record would straddle two chunks. Both parts of the reservation are multiples of the header size,
+		// so they can be turned into padding, and the command tries again further ahead.
+		const auto first_part = chunk_size - chunk_offset;
+		write_padding(offset, first_part);
+		write_padding(offset + first_part, size - first_part);
+	}
+}
+
+auto RenderCommandQueue::get_chunk(std::size_t index) -> std::byte*
+{
+	ensure(index < max_chunks, "Render command queue is full ({} chunks of {} bytes)", max_chunks, chunk_size);
+
+	auto& slot = chunks.at(index);
+	if (auto* chunk = slot.load(std::memory_order_acquire); chunk != nullptr) {
+		return chunk;
+	}
+
+	// Zeroed, so that every ready flag in a new chunk starts out cleared.
+	auto* created = new std::byte[chunk_size]();
+	std::byte* expected = nullptr;
+	if (!slot.compare_exchange_strong(expected, created, std::memory_order_acq_rel, std::memory_order_acquire)) {
+		delete[] created;
+		return expected;
+	}
+	return created;
+}
+
+void RenderCommandQueue::write_padding(std::size_t offset, std::size_t size)
+{
+	auto* header = ::new (get_chunk(offset / chunk_size) + offset % chunk_size) CommandHeader {};
+	header->size = static_cast<std::uint32_t>(size);
+	header->ready.store(1, std::memory_order_release);
+}
 
-void RenderCommandQueue::allocate(RenderCommandFunction&& fn) { storage_buffer[command_count++] = std::move(fn); }
+auto RenderCommandQueue::wait_for_record(std::size_t offset) -> CommandHeader*
+{
+	auto& slot = chunks.at(offset / chunk_size);
+	auto* chunk = slot.load(std::memory_order_acquire);
+	while (chunk == nullptr) {
+		std::this_thread::yield();
+		chunk = slot.load(std::memory_order_acquire);
+	}
+
+	auto* header = std::launder(reinterpret_cast<CommandHeader*>(chunk + offset % chunk_size));
+	while (header->ready.load(std::memory_order_acquire) == 0) {
+		std::this_thread::yield();
+	}
+	// Cleared so that a record reserved at this offset next frame is not seen as ready before it is written.
+	header->ready.store(0, std::memory_order_relaxed);
+	return header;
+}
+
+void RenderCommandQueue::destroy_from(std::size_t offset, std::size_t end)
+{
+	while (offset < end) {
+		auto* header = wait_for_record(offset);
+		if (header->invoke != nullptr) {
+			header->invoke(payload(header), false);
+		}
+		offset += header->size;
+	}
+}
 
 void RenderCommandQueue::execute()
 {
-	Collections::parallel_for_each(storage_buffer, [](auto& func) {
-		if (func) {
-			func();
+	const auto end = write_offset.load(std::memory_order_acquire);
+
+	std::size_t offset = 0;
+	try {
+		while (offset < end) {
+			auto* header = wait_for_record(offset);
+			offset += header->size;
+			if (header->invoke != nullptr) {
+				header->invoke(payload(header), true);
+			}
 		}
-	});
-	command_count = 0;
-	storage_buffer.fill({});
+	} catch (...) {
+		destroy_from(offset, end);
+		write_offset.store(0, std::memory_order_release);
+		throw;
+	}
+
+	write_offset.store(0, std::memory_order_release);
 }
 
 } // namespace Disarray
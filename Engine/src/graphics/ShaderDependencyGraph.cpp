@@ -0,0 +1,173 @@
+#include "DisarrayPCH.hpp"
+
+#include "graphics/ShaderDependencyGraph.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "core/Collections.hpp"
+#include "core/filesystem/MappedFile.hpp"
+
+namespace Disarray {
+
+namespace {
+	auto read_from_disk(const std::filesystem::path& path) -> std::optional<std::string>
+	{
+		const FS::MappedFile file { path };
+		if (!file) {
+			return std::nullopt;
+		}
+		return std::string { file.view() };
+	}
+} // namespace
+
+ShaderDependencyGraph::ShaderDependencyGraph(std::filesystem::path directory)
+	: ShaderDependencyGraph(std::move(directory), read_from_disk)
+{
+}
+
+ShaderDependencyGraph::ShaderDependencyGraph(std::filesystem::path directory, ShaderSourceReader source_reader)
+	: include_directory(std::move(directory))
+	, reader(std::move(source_reader))
+{
+}
+
+void ShaderDependencyGraph::add_shader(const std::filesystem::path& path)
+{
+	auto name = path.filename().string();
+	shaders.insert_or_assign(name, path);
+	scan(name);
+}
+
+void ShaderDependencyGraph::add_pipeline(std::string_view pipeline, std::string_view vertex_shader, std::string_view fragment_shader)
+{
+	pipelines.insert_or_assign(std::string { pipeline }, std::pair { std::string { vertex_shader }, std::string { fragment_shader } });
+}
+
+auto ShaderDependencyGraph::includes_of(std::string_view shader) const -> std::vector<std::string>
+{
+	Collections::StringSet visited {};
+	std::vector<std::string_view> pending { shader };
+	while (!pending.empty()) {
+		const auto current = pending.back();
+		pending.pop_back();
+		const auto found = direct_includes.find(current);
+		if (found == direct_includes.end()) {
+			continue;
+		}
+		for (const auto& include : found->second) {
+			if (include != shader && visited.insert(include).second) {
+				pending.emplace_back(include);
+			}
+		}
+	}
+
+	std::vector<std::string> includes { visited.begin(), visited.end() };
+	std::ranges::sort(includes);
+	return includes;
+}
+
+auto ShaderDependencyGraph::on_changed(const std::filesystem::path& changed) -> ShaderReloadPlan
+{
+	const auto name = changed.filename().string();
+	if (shaders.contains(name) || direct_includes.contains(name)) {
+		scan(name);
+	}
+
+	// Walks the includes backwards, from the changed file to everything that reaches it.
+	Collections::StringSet affected { name };
+	std::vector<std::string> pending { name };
+	while (!pending.empty()) {
+		const auto current = std::move(pending.back());
+		pending.pop_back();
+		for (const auto& [includer, includes] : direct_includes) {
+			if (!affected.contains(includer) && std::ranges::find(includes, current) != includes.end()) {
+				affected.insert(includer);
+				pending.push_back(includer);
+			}
+		}
+	}
+
+	ShaderReloadPlan plan {};
+	for (const auto& file : affected) {
+		if (const auto found = shaders.find(file); found != shaders.end()) {
+			plan.shaders.push_back(found->second);
+		}
+	}
+	const auto is_recompiled = [this, &affected](const std::string& shader) { return affected.contains(shader) && shaders.contains(shader); };
+	for (const auto& [pipeline, stages] : pipelines) {
+		if (is_recompiled(stages.first) || is_recompiled(stages.second)) {
+			plan.pipelines.push_back(pipeline);
+		}
+	}
+	std::ranges::sort(plan.shaders);
+	std::ranges::sort(plan.pipelines);
+	return plan;
+}
+
+auto ShaderDependencyGraph::parse_includes(std::string_view source) -> std::vector<std::string_view>
+{
+	static constexpr std::string_view directive = "#include \"";
+
+	std::vector<std::string_view> names {};
+	std::size_t position = 0;
+	while (true) {
+		const auto start = source.find(directive, position);
+		if (start == std::string_view::npos) {
+			break;
+		}
+		const auto name_start = start + directive.size();
+		const auto name_end = source.find_first_of("\"\n", name_start);
+		if (name_end == std::string_view::npos || source[name_end] != '"') {
+			position = name_start;
+			continue;
+		}
+		if (name_end > name_start) {
+			names.push_back(source.substr(name_start, name_end - name_start));
+		}
+		position = name_end + 1;
+	}
+	return names;
+}
+
+void ShaderDependencyGraph::scan(const std::string& name)
+{
+	// A file that cannot be read includes nothing, until it changes again.
+	const auto source = reader(path_of(name));
+	std::vector<std::string> includes {};
+	if (source) {
+		for (const auto& include : parse_includes(*source)) {
+			includes.emplace_back(include);
+		}
+	}
+
+	std::vector<std::string> unseen {};
+	for (const auto& include : includes) {
+		if (!direct_includes.contains(include)) {
+			unseen.push_back(include);
+		}
+	}
+	direct_includes.insert_or_assign(name, std::move(includes));
+
+	// Each file is recorded before what it includes is read, so cycles end.
+	for (const auto& include : unseen) {
+		if (!direct_includes.contains(include)) {
+			scan(include);
+		}
+	}
+}
+
+auto ShaderDependencyGraph::path_of(std::string_view name) const -> std::filesystem::path
+{
+	if (const auto found = shaders.find(name); found != shaders.end()) {
+		return found->second;
+	}
+	return include_directory / name;
+}
+
+} // namespace Disarray
@@ -0,0 +1,136 @@
+#include "DisarrayPCH.hpp"
+
+#include "graphics/ShaderKeywords.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cctype>
+#include <functional>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "core/exceptions/GeneralExceptions.hpp"
+
+namespace Disarray {
+
+namespace {
+	constexpr std::string_view whitespace = " \t\r";
+
+	auto is_identifier(std::string_view word) -> bool
+	{
+		const auto is_start = [](char character) { return std::isalpha(static_cast<unsigned char>(character)) != 0 || character == '_'; };
+		const auto is_rest = [&is_start](char character) { return is_start(character) || std::isdigit(static_cast<unsigned char>(character)) != 0; };
+		return !word.empty() && is_start(word.front()) && std::ranges::all_of(word.substr(1), is_rest);
+	}
+
+	auto trim_front(std::string_view text) -> std::string_view
+	{
+		const auto first = text.find_first_not_of(whitespace);
+		return first == std::string_view::npos ? std::string_view {} : text.substr(first);
+	}
+
+	// The rest of the line after "#pragma keywords", if it is one.
+	auto keywords_directive(std::string_view line) -> std::optional<std::string_view>
+	{
+		line = trim_front(line);
+		if (!line.starts_with('#')) {
+			return std::nullopt;
+		}
+		line = trim_front(line.substr(1));
+		for (const std::string_view word : { "pragma", "keywords" }) {
+			if (!line.starts_with(word)) {
+				return std::nullopt;
+			}
+			line.remove_prefix(word.size());
+			if (!line.empty() && whitespace.find(line.front()) == std::string_view::npos) {
+				return std::nullopt;
+			}
+			line = trim_front(line);
+		}
+		return line;
+	}
+} // namespace
+
+ShaderKeywords::ShaderKeywords(std::vector<std::string> input)
+	: keywords(std::move(input))
+{
+	if (keywords.size() > max_keywords) {
+		const auto message = fmt::format("A shader declares {} keywords, at most {} are supported", keywords.size(), max_keywords);
+		throw CouldNotCompileShaderException { message };
+	}
+}
+
+auto ShaderKeywords::parse(std::string_view source) -> ShaderKeywords
+{
+	std::vector<std::string> keywords {};
+	while (!source.empty()) {
+		const auto end = source.find('\n');
+		const auto line = source.substr(0, end);
+		source = end == std::string_view::npos ? std::string_view {} : source.substr(end + 1);
+
+		auto directive = keywords_directive(line);
+		while (directive && !directive->empty()) {
+			const auto word_end = directive->find_first_of(whitespace);
+			const auto word = directive->substr(0, word_end);
+			if (is_identifier(word) && std::ranges::find(keywords, word) == keywords.end()) {
+				keywords.emplace_back(word);
+			}
+			*directive = word_end == std::string_view::npos ? std::string_view {} : trim_front(directive->substr(word_end));
+		}
+	}
+	return ShaderKeywords { std::move(keywords) };
+}
+
+auto ShaderKeywords::mask_of(std::span<const std::string> enabled) const -> KeywordMask
+{
+	KeywordMask mask { 0 };
+	for (const auto& keyword : enabled) {
+		if (const auto found = std::ranges::find(keywords, keyword); found != keywords.end()) {
+			mask |= KeywordMask { 1 } << static_cast<KeywordMask>(found - keywords.begin());
+		}
+	}
+	return mask;
+}
+
+auto ShaderKeywords::enabled_in(KeywordMask mask) const -> std::vector<std::string_view>
+{
+	std::vector<std::string_view> enabled {};
+	for (std::size_t index = 0; index < keywords.size(); index++) {
+		if ((mask & (KeywordMask { 1 } << index)) != 0) {
+			enabled.emplace_back(keywords[index]);
+		}
+	}
+	return enabled;
+}
+
+auto ShaderKeywords::defines_for(KeywordMask mask) const -> std::string
+{
+	std::string defines {};
+	for (const auto& keyword : enabled_in(mask)) {
+		defines += fmt::format("#define {}\n", keyword);
+	}
+	return defines;
+}
+
+auto ShaderVariant::key() const -> std::string { return mask == 0 ? shader : fmt::format("{}#{:x}", shader, mask); }
+
+auto resolve_variants(std::span<const ShaderVariantRequest> requests,
+	const std::function<const ShaderKeywords&(std::string_view shader)>& keywords_of) -> std::vector<ShaderVariant>
+{
+	std::vector<ShaderVariant> variants {};
+	variants.reserve(requests.size());
+	for (const auto& request : requests) {
+		variants.push_back({ .shader = request.shader, .mask = keywords_of(request.shader).mask_of(request.keywords) });
+	}
+	std::ranges::sort(variants);
+	const auto [first, last] = std::ranges::unique(variants);
+	variants.erase(first, last);
+	return variants;
+}
+
+} // namespace Disarray
@@ -0,0 +1,230 @@
+#include "DisarrayPCH.hpp"
+
+#include "graphics/SpirvCache.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+
+#include "core/Hashes.hpp"
+#include "core/Log.hpp"
+#include "core/filesystem/MappedFile.hpp"
+
+namespace Disarray {
+
+namespace {
+	static_assert(std::is_trivially_copyable_v<ShaderReflection>, "ShaderReflection is written to .dspv files as raw bytes");
+
+	constexpr std::array<char, 8> magic { 'D', 'S', 'P', 'I', 'R', 'V', '\0', '\0' };
+	constexpr std::string_view extension = ".dspv";
+
+	struct Header {
+		std::array<char, 8> magic {};
+		std::uint32_t version { 0 };
+		std::uint32_t reflection_size { 0 };
+		std::uint64_t key { 0 };
+		std::uint64_t word_count { 0 };
+		std::uint64_t code_hash { 0 };
+		ShaderReflection reflection {};
+		std::uint32_t padding { 0 };
+	};
+	static_assert(sizeof(Header) % sizeof(std::uint64_t) == 0, "Header has no trailing padding, so .dspv files are written deterministically");
+
+	struct Registry {
+		std::mutex mutex {};
+		SpirvCacheConfiguration configuration {};
+	};
+
+	auto registry() -> Registry&
+	{
+		static Registry instance {};
+		return instance;
+	}
+
+	auto get_configuration() -> SpirvCacheConfiguration
+	{
+		auto& instance = registry();
+		std::scoped_lock lock { instance.mutex };
+		return instance.configuration;
+	}
+
+	auto directory_of(const SpirvCacheConfiguration& configuration) -> std::filesystem::path
+	{
+		if (!configuration.directory.empty()) {
+			return configuration.directory;
+		}
+		std::error_code error_code {};
+		const auto temporary = std::filesystem::temp_directory_path(error_code);
+		return (error_code ? std::filesystem::path { "." } : temporary) / "disarray-spirv-cache";
+	}
+
+	auto path_for(const std::filesystem::path& directory, std::uint64_t key) -> std::filesystem::path
+	{
+		return directory / fmt::format("{:016x}{}", key, extension);
+	}
+
+	auto hash_code(std::span<const std::uint32_t> code) -> std::uint64_t { return hash_bytes(std::as_bytes(code)); }
+} // namespace
+
+namespace SpirvCache {
+
+	void configure(const SpirvCacheConfiguration& configuration)
+	{
+		auto& instance = registry();
+		std::scoped_lock lock { instance.mutex };
+		instance.configuration = configuration;
+	}
+
+	auto directory() -> std::filesystem::path { return directory_of(get_configuration()); }
+
+	auto key_for(std::span<const std::string_view> pieces, std::uint64_t compiler_seed) -> std::uint64_t
+	{
+		auto key = hash_bytes(std::as_bytes(std::span { &version, 1 }), compiler_seed);
+		for (const auto& piece : pieces) {
+			key = hash_bytes(piece, key);
+		}
+		return key;
+	}
+
+	auto load(std::uint64_t key) -> std::optional<CompiledShader>
+	{
+		const auto configuration = get_configuration();
+		if (!configuration.enabled) {
+			return std::nullopt;
+		}
+
+		const auto path = path_for(directory_of(configuration), key);
+		CompiledShader shader {};
+		{
+			const FS::MappedFile file { path };
+			if (!file || file.size() < sizeof(Header)) {
+				return std::nullopt;
+			}
+
+			Header header {};
+			std::memcpy(&header, file.data(), sizeof(Header));
+			const auto code_bytes = file.size() - sizeof(Header);
+			if (header.magic != magic || header.version != version || header.reflection_size != sizeof(ShaderReflection) || header.key != key
+				|| code_bytes % sizeof(std::uint32_t) != 0 || header.word_count != code_bytes / sizeof(std::uint32_t) || header.word_count == 0) {
+				Log::debug("SpirvCache", "Ignoring {}, it was written by another version or is truncated.", path.string());
+				return std::nullopt;
+			}
+
+			shader.code.resize(header.word_count);
+			std::memcpy(shader.code.data(), file.data() + sizeof(Header), code_bytes);
+			if (hash_code(shader.code) != header.code_hash) {
+				Log::error("SpirvCache", "Ignoring {}, its code does not match its checksum.", path.string());
+				return std::nullopt;
+			}
+			shader.reflection = header.reflection;
+		}
+
+		// The modification time doubles as the last use, which is what evict orders by.
+		std::error_code error_code {};
+		std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), error_code);
+		return shader;
+	}
+
+	auto store(std::uint64_t key, const CompiledShader& shader) -> bool
+	{
+		const auto configuration = get_configuration();
+		if (!configuration.enabled || shader.code.empty()) {
+			return false;
+		}
+
+		const auto directory = directory_of(configuration);
+		const auto path = path_for(directory, key);
+		const Header header {
+			.magic = magic,
+			.version = version,
+			.reflection_size = sizeof(ShaderReflection),
+			.key = key,
+			.word_count = shader.code.size(),
+			.code_hash = hash_code(shader.code),
+			.reflection = shader.reflection,
+		};
+
+		std::error_code error_code {};
+		std::filesystem::create_directories(directory, error_code);
+		const auto thread_id = std::hash<std::thread::id> {}(std::this_thread::get_id());
+		const auto temporary = std::filesystem::path { fmt::format("{}.{}.tmp", path.string(), thread_id) };
+		{
+			std::ofstream stream { temporary, std::ios::binary | std::ios::trunc };
+			if (!stream) {
+				Log::error("SpirvCache", "Could not open {} for writing.", temporary.string());
+				return false;
+			}
+			stream.write(reinterpret_cast<const char*>(&header), static_cast<std::streamsize>(sizeof(Header)));
+			stream.write(reinterpret_cast<const char*>(shader.code.data()), static_cast<std::streamsize>(shader.code.size() * sizeof(std::uint32_t)));
+			if (!stream) {
+				Log::error("SpirvCache", "Could not write {}.", temporary.string());
+				stream.close();
+				std::filesystem::remove(temporary, error_code);
+				return false;
+			}
+		}
+
+		std::filesystem::rename(temporary, path, error_code);
+		if (error_code) {
+			Log::error("SpirvCache", "Could not move {} into place: {}", path.string(), error_code.message());
+			std::filesystem::remove(temporary, error_code);
+			return false;
+		}
+
+		evict(configuration.max_bytes);
+		return true;
+	}
+
+	auto evict(std::uint64_t max_bytes) -> std::size_t
+	{
+		struct Entry {
+			std::filesystem::path path {};
+			std::uint64_t size { 0 };
+			std::filesystem::file_time_type last_used {};
+		};
+
+		std::error_code error_code {};
+		std::vector<Entry> entries {};
+		std::uint64_t total = 0;
+		for (const auto& entry : std::filesystem::directory_iterator { directory(), error_code }) {
+			std::error_code entry_error {};
+			if (!entry.is_regular_file(entry_error) || entry.path().extension() != extension) {
+				continue;
+			}
+			const auto size = entry.file_size(entry_error);
+			const auto last_used = entry.last_write_time(entry_error);
+			if (entry_error) {
+				continue;
+			}
+			entries.push_back({ entry.path(), size, last_used });
+			total += size;
+		}
+		if (total <= max_bytes) {
+			return 0;
+		}
+
+		std::ranges::sort(entries, {}, &Entry::last_used);
+		std::size_t removed = 0;
+		for (const auto& entry : entries) {
+			if (total <= max_bytes) {
+				break;
+			}
+			// Another process may have removed or replaced it already, either way it no longer counts.
+			std::filesystem::remove(entry.path, error_code);
+			total -= entry.size;
+			removed++;
+		}
+		Log::debug("SpirvCache", "Evicted {} shaders, {} bytes are left.", removed, total);
+		return removed;
+	}
+
+} // namespace SpirvCache
+
+} // namespace Disarray
@@ -0,0 +1,41 @@
+#include "DisarrayPCH.hpp"
+
+#include "graphics/TextureDecoder.hpp"
+
+#include <filesystem>
+#include <span>
+#include <vector>
+
+#include "core/Collections.hpp"
+#include "graphics/ImageLoader.hpp"
+
+namespace Disarray::TextureDecoder {
+
+namespace {
+	void decode_in_place(DecodedTexture& texture)
+	{
+		const ImageLoader loader { texture.path, texture.pixels };
+		texture.extent = loader.get_extent();
+	}
+} // namespace
+
+auto decode(const std::filesystem::path& path) -> DecodedTexture
+{
+	DecodedTexture decoded { .path = path };
+	decode_in_place(decoded);
+	return decoded;
+}
+
+auto decode_all(std::span<const std::filesystem::path> paths) -> std::vector<DecodedTexture>
+{
+	std::vector<DecodedTexture> decoded(paths.size());
+	for (std::size_t index = 0; index < paths.size(); index++) {
+		decoded[index].path = paths[index];
+	}
+
+	// Images differ a lot in size, so each is its own task and idle workers pick up the next one.
+	Collections::parallel_for_each(decoded, decode_in_place, 1);
+	return decoded;
+}
+
+} // namespace Disarray::TextureDecoder
@@ -0,0 +1,144 @@
+#include "DisarrayPCH.hpp"
+
+#include "graphics/VertexWelder.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+
+#include "core/Hashes.hpp"
+
+namespace Disarray {
+
+namespace {
+	// Keeps the table at most half full, so probe sequences stay short.
+	constexpr std::size_t slots_per_vertex = 2;
+	constexpr std::size_t minimum_slots = 64;
+	// Slots keep the upper half of the hash next to the index, so most mismatches are rejected without touching the stored keys.
+	constexpr std::uint64_t tag_mask = 0xFFFFFFFF00000000ULL;
+
+	auto exact_bits(float value) -> std::uint32_t
+	{
+		// -0 and +0 compare equal, so they have to hash equal too.
+		return std::bit_cast<std::uint32_t>(value == 0.0F ? 0.0F : value);
+	}
+
+	auto quantised_bits(float value, float inverse_epsilon) -> std::uint32_t
+	{
+		constexpr auto lowest = static_cast<double>(std::numeric_limits<std::int32_t>::min());
+		constexpr auto highest = static_cast<double>(std::numeric_limits<std::int32_t>::max());
+		if (std::isnan(value)) {
+			return std::bit_cast<std::uint32_t>(value);
+		}
+		const auto cell = std::clamp(std::floor(static_cast<double>(value) * inverse_epsilon), lowest, highest);
+		return static_cast<std::uint32_t>(static_cast<std::int32_t>(cell));
+	}
+} // namespace
+
+VertexWelder::VertexWelder(std::size_t expected_vertex_count, const WeldOptions& weld_options)
+	: options(weld_options)
+	, inverse_epsilon(weld_options.epsilon > 0.0F ? 1.0F / weld_options.epsilon : 0.0F)
+{
+	vertices.reserve(expected_vertex_count);
+	keys.reserve(expected_vertex_count);
+	slots.assign(std::bit_ceil(std::max(expected_vertex_count * slots_per_vertex, minimum_slots)), 0);
+	mask = slots.size() - 1;
+}
+
+auto VertexWelder::key_of(const ModelVertex& vertex) const -> Key
+{
+	const std::array<float, 12> attributes {
+		vertex.pos.x,
+		vertex.pos.y,
+		vertex.pos.z,
+		vertex.uvs.x,
+		vertex.uvs.y,
+		vertex.color.x,
+		vertex.color.y,
+		vertex.color.z,
+		vertex.color.w,
+		vertex.normals.x,
+		vertex.normals.y,
+		vertex.normals.z,
+	};
+
+	Key key {};
+	if (options.epsilon > 0.0F) {
+		std::transform(attributes.begin(), attributes.end(), key.begin(), [this](float value) { return quantised_bits(value, inverse_epsilon); });
+	} else {
+		std::transform(attributes.begin(), attributes.end(), key.begin(), exact_bits);
+	}
+	return key;
+}
+
+auto VertexWelder::hash_key(const Key& key) -> std::uint64_t { return hash_bytes(std::as_bytes(std::span { key })); }
+
+auto VertexWelder::weld(const ModelVertex& vertex) -> std::uint32_t
+{
+	const auto key = key_of(vertex);
+	const auto hash = hash_key(key);
+	const auto tag = hash & tag_mask;
+
+	for (auto slot = static_cast<std::size_t>(hash) & mask;; slot = (slot + 1) & mask) {
+		const auto entry = slots[slot];
+		if (entry == 0) {
+			break;
+		}
+		const auto index = static_cast<std::uint32_t>(entry) - 1;
+		if ((entry & tag_mask) == tag && keys[index] == key) {
+			return index;
+		}
+	}
+
+	const auto index = static_cast<std::uint32_t>(vertices.size());
+	vertices.push_back(vertex);
+	keys.push_back(key);
+	if (vertices.size() * slots_per_vertex > slots.size()) {
+		grow();
+	} else {
+		insert_slot(index, hash);
+	}
+	return index;
+}
+
+void VertexWelder::insert_slot(std::uint32_t vertex_index, std::uint64_t hash)
+{
+	auto slot = static_cast<std::size_t>(hash) & mask;
+	while (slots[slot] != 0) {
+		slot = (slot + 1) & mask;
+	}
+	slots[slot] = (hash & tag_mask) | (vertex_index + 1);
+}
+
+void VertexWelder::grow()
+{
+	slots.assign(slots.size() * 2, 0);
+	mask = slots.size() - 1;
+	for (std::uint32_t index = 0; index < vertices.size(); index++) {
+		insert_slot(index, hash_key(keys[index]));
+	}
+}
+
+auto VertexWelder::take_vertices() -> std::vector<ModelVertex>
+{
+	auto output = std::move(vertices);
+	vertices.clear();
+	keys.clear();
+	std::fill(slots.begin(), slots.end(), 0);
+	return output;
+}
+
+auto VertexWelder::weld(std::span<const ModelVertex> stream, const WeldOptions& options) -> WeldResult
+{
+	VertexWelder welder { stream.size(), options };
+	WeldResult result {};
+	result.indices.reserve(stream.size());
+	for (const auto& vertex : stream) {
+		result.indices.push_back(welder.weld(vertex));
+	}
+	result.vertices = welder.take_vertices();
+	return result;
+}
+
+} // namespace Disarray
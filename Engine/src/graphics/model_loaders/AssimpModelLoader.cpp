@@ -9,13 +9,15 @@
 #include <magic_enum.hpp>
 
 #include <filesystem>
-#include <mutex>
 #include <span>
+#include <string>
+#include <vector>
 
 #include "core/Collections.hpp"
 #include "core/Formatters.hpp"
 #include "core/Log.hpp"
 #include "graphics/Texture.hpp"
+#include "graphics/VertexWelder.hpp"
 #include "util/Timer.hpp"
 
 namespace Disarray {
@@ -57,10 +59,10 @@ auto AssimpModelLoader::process_mesh(aiMesh* mesh, const std::filesystem::path&
 	const auto has_tangents = !mesh_tangents.empty() && mesh_tangents.data() != nullptr;
 	const auto has_bitangents = !mesh_bitangents.empty() && mesh_bitangents.data() != nullptr;
 
-	std::unordered_map<ModelVertex, uint32_t> unique_vertices {};
-	std::vector<ModelVertex> vertices;
+	VertexWelder welder { mesh->mNumVertices };
 	std::vector<std::uint32_t> indices;
 	std::vector<Disarray::TextureProperties> textures;
+	indices.reserve(mesh->mNumVertices);
 
 	for (std::size_t i = 0; i < mesh->mNumVertices; i++) {
 		ModelVertex model_vertex {};
@@ -111,15 +113,11 @@ auto AssimpModelLoader::process_mesh(aiMesh* mesh, const std::filesystem::path&
 			};
 		}
 
-		if (!unique_vertices.contains(model_vertex)) {
-			const auto current_size = static_cast<std::uint32_t>(vertices.size());
-			unique_vertices.try_emplace(model_vertex, current_size);
-			vertices.push_back(model_vertex);
-		}
-
-		indices.push_back(unique_vertices[model_vertex]);
+		indices.push_back(welder.weld(model_vertex));
 	}
 
+	auto vertices = welder.take_vertices();
+
 	// process material
 
 	constexpr auto texture_types = magic_enum::enum_values<aiTextureType>();
@@ -134,47 +132,65 @@ auto AssimpModelLoader::process_mesh(aiMesh* mesh, const std::filesystem::path&
 		}
 	}
 
-	return Submesh(vertices, indices, textures);
-}
-
-inline auto get_mutex() -> std::mutex&
-{
-	static std::mutex mutex;
-	return mutex;
+	return Submesh(std::move(vertices), std::move(indices), std::move(textures));
 }
 
-auto AssimpModelLoader::process_current_node(
-	ImportedMesh& mesh_map, const std::filesystem::path& base_directory, aiNode* current_node, const aiScene* scene)
-{
-	if (scene == nullptr) {
-		return;
+namespace {
+	struct SubmeshTask {
+		aiMesh* mesh { nullptr };
+		std::string name {};
+		Submesh output {};
+	};
+
+	/**
+	 * @brief Every mesh referenced by the node tree, in the depth first order the tree used to be walked in.
+	 * Meshes referenced from several nodes are only processed once.
+	 */
+	auto flatten_nodes(const aiScene* scene) -> std::vector<SubmeshTask>
+	{
+		std::span scene_meshes { scene->mMeshes, scene->mNumMeshes };
+		std::vector<bool> seen(scene_meshes.size(), false);
+
+		std::vector<SubmeshTask> tasks {};
+		std::vector<const aiNode*> stack { scene->mRootNode };
+		while (!stack.empty()) {
+			const auto* current_node = stack.back();
+			stack.pop_back();
+
+			for (const auto mesh_index : std::span { current_node->mMeshes, current_node->mNumMeshes }) {
+				if (seen[mesh_index]) {
+					continue;
+				}
+				seen[mesh_index] = true;
+				aiMesh* ai_mesh = scene_meshes[mesh_index];
+				tasks.push_back({ .mesh = ai_mesh, .name = std::string { ai_mesh->mName.C_Str(), ai_mesh->mName.length } });
+			}
+
+			const std::span children { current_node->mChildren, current_node->mNumChildren };
+			stack.insert(stack.end(), children.rbegin(), children.rend());
+		}
+		return tasks;
 	}
+} // namespace
 
-	std::span node_meshes { current_node->mMeshes, current_node->mNumMeshes };
-	std::span scene_meshes { scene->mMeshes, scene->mNumMeshes };
-	std::span children { current_node->mChildren, current_node->mNumChildren };
-
-	auto& mutex = get_mutex();
-	Collections::parallel_for_each(node_meshes, [&](const auto& mesh_index) {
-		std::scoped_lock lock { mutex };
-		aiMesh* ai_mesh = scene_meshes[mesh_index];
-		const aiString mesh_name = ai_mesh->mName;
-		std::string name(mesh_name.length, '\0');
-		std::memcpy(name.data(), mesh_name.C_Str(), mesh_name.length);
-		name.resize(mesh_name.length);
-		const auto& aabb = ai_mesh->mAABB;
-
-		mesh_map.try_emplace(name, process_mesh(ai_mesh, base_directory, scene));
-	});
+auto AssimpModelLoader::process_scene(const std::filesystem::path& base_directory, const aiScene* scene) -> ImportedMesh
+{
+	// Each task writes only to its own slot, so extraction needs no locking. The merge keeps the first submesh of each name, like before.
+	auto tasks = flatten_nodes(scene);
+	Collections::parallel_for_each(
+		tasks, [&base_directory, scene](SubmeshTask& task) { task.output = process_mesh(task.mesh, base_directory, scene); }, 1);
 
-	Collections::parallel_for_each(children, [&](auto* child) { process_current_node(mesh_map, base_directory, child, scene); });
+	ImportedMesh output {};
+	output.reserve(tasks.size());
+	for (auto& task : tasks) {
+		output.try_emplace(std::move(task.name), std::move(task.output));
+	}
+	return output;
 }
 
 auto AssimpModelLoader::import_model(const std::filesystem::path& path, ImportFlag flags) -> ImportedMesh
 {
 	MSTimer timer;
-	ImportedMesh output {};
-
 	Assimp::Importer importer;
 	const aiScene* scene = importer.ReadFile(path.string().c_str(), Disarray::bit_cast<aiPostProcessSteps>(flags));
 
@@ -183,7 +199,7 @@ auto AssimpModelLoader::import_model(const std::filesystem::path& path, ImportFl
 	}
 	const auto base_directory = path.parent_path();
 
-	process_current_node(output, base_directory, scene->mRootNode, scene);
+	auto output = process_scene(base_directory, scene);
 
 	Collections::parallel_for_each(output, [&rot = initial_rotation](auto& kv_pair) {
 		auto&& [key, mesh] = kv_pair;
@@ -0,0 +1,507 @@
+#include "DisarrayPCH.hpp"
+
+#include "graphics/model_loaders/ObjModelLoader.hpp"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <numeric>
+#include <span>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include "core/Collections.hpp"
+#include "core/Log.hpp"
+#include "core/filesystem/MappedFile.hpp"
+#include "graphics/ModelLoader.hpp"
+#include "graphics/VertexWelder.hpp"
+
+namespace Disarray {
+
+namespace {
+	constexpr std::size_t chunk_size = 1024ULL * 1024ULL;
+
+	struct Corner {
+		std::int32_t position { -1 };
+		std::int32_t texcoord { -1 };
+		std::int32_t normal { -1 };
+	};
+
+	struct AttributeCounts {
+		std::size_t positions { 0 };
+		std::size_t texcoords { 0 };
+		std::size_t normals { 0 };
+	};
+
+	struct Chunk {
+		std::string_view text {};
+		std::vector<float> positions {};
+		std::vector<float> texcoords {};
+		std::vector<float> normals {};
+		/** @brief Attributes declared in the chunks before this one, which relative indices are resolved against */
+		AttributeCounts offsets {};
+		/** @brief Three per triangle, in file order */
+		std::vector<Corner> corners {};
+		/** @brief Offsets into corners where a g or o line starts a new shape */
+		std::vector<std::size_t> shape_starts {};
+	};
+
+	struct ShapeSegment {
+		const Chunk* chunk { nullptr };
+		std::size_t begin { 0 };
+		std::size_t end { 0 };
+	};
+
+	struct Attributes {
+		std::vector<float> positions {};
+		std::vector<float> texcoords {};
+		std::vector<float> normals {};
+	};
+
+	constexpr auto is_space(char character) -> bool { return character == ' ' || character == '\t'; }
+
+	// Chunks start after a newline, so no line is split between two of them.
+	auto split_into_chunks(std::string_view text) -> std::vector<Chunk>
+	{
+		std::vector<Chunk> chunks;
+		chunks.reserve(text.size() / chunk_size + 1);
+		std::size_t begin = 0;
+		while (begin < text.size()) {
+			auto end = std::min(begin + chunk_size, text.size());
+			if (end < text.size()) {
+				const auto newline = text.find('\n', end);
+				end = newline == std::string_view::npos ? text.size() : newline + 1;
+			}
+			chunks.push_back(Chunk { .text = text.substr(begin, end - begin) });
+			begin = end;
+		}
+		return chunks;
+	}
+
+	// Calls func with every line that is not empty or a comment, without leading whitespace and the line ending.
+	void for_each_line(std::string_view text, auto&& func)
+	{
+		while (!text.empty()) {
+			const auto newline = text.find('\n');
+			auto line = text.substr(0, newline);
+			text.remove_prefix(newline == std::string_view::npos ? text.size() : newline + 1);
+
+			while (!line.empty() && line.back() == '\r') {
+				line.remove_suffix(1);
+			}
+			while (!line.empty() && is_space(line.front())) {
+				line.remove_prefix(1);
+			}
+			if (line.empty() || line.front() == '#') {
+				continue;
+			}
+			func(line);
+		}
+	}
+
+	auto starts_with_keyword(std::string_view line, std::string_view keyword) -> bool
+	{
+		return line.size() > keyword.size() && line.starts_with(keyword) && is_space(line[keyword.size()]);
+	}
+
+	auto next_token(std::string_view& line) -> std::string_view
+	{
+		while (!line.empty() && is_space(line.front())) {
+			line.remove_prefix(1);
+		}
+		const auto length = std::min(line.find_first_of(" \t"), line.size());
+		const auto token = line.substr(0, length);
+		line.remove_prefix(length);
+		return token;
+	}
+
+	// Parsed as double and narrowed, as tinyobjloader does, so both agree on the rounding.
+	auto parse_real(std::string_view& line) -> float
+	{
+		const auto token = next_token(line);
+		const auto* first = token.data();
+		const auto* last = token.data() + token.size();
+		if (first != last && *first == '+') {
+			first++;
+		}
+
+		double value {};
+		if (first == last || std::from_chars(first, last, value).ec != std::errc {}) {
+			return 0.0F;
+		}
+		return static_cast<float>(value);
+	}
+
+	// The leading integer of text, or zero when there is none, like atoi.
+	auto parse_integer(std::string_view text) -> int
+	{
+		const auto* first = text.data();
+		const auto* last = text.data() + text.size();
+		if (first != last && *first == '+') {
+			first++;
+		}
+
+		int value {};
+		if (std::from_chars(first, last, value).ec != std::errc {}) {
+			return 0;
+		}
+		return value;
+	}
+
+	// Makes an OBJ index zero based. Negative indices count back from the attributes declared so far, zero means absent for texture
+	// coordinates and normals.
+	auto resolve_index(int index, std::size_t declared, std::size_t total, bool allow_zero, std::string_view line) -> std::int32_t
+	{
+		std::int64_t resolved = -1;
+		if (index > 0) {
+			resolved = index - 1;
+		} else if (index < 0) {
+			resolved = static_cast<std::int64_t>(declared) + index;
+		} else if (allow_zero) {
+			return -1;
+		}
+
+		if (resolved < 0 || resolved >= static_cast<std::int64_t>(total)) {
+			throw CouldNotLoadModelException(fmt::format("Invalid index in face '{}'", line));
+		}
+		return static_cast<std::int32_t>(resolved);
+	}
+
+	auto parse_corner(std::string_view token, const AttributeCounts& declared, const AttributeCounts& totals, std::string_view line) -> Corner
+	{
+		Corner corner {};
+		const auto first_slash = token.find('/');
+		corner.position = resolve_index(parse_integer(token.substr(0, first_slash)), declared.positions, totals.positions, false, line);
+		if (first_slash == std::string_view::npos) {
+			return corner;
+		}
+
+		token.remove_prefix(first_slash + 1);
+		const auto second_slash = token.find('/');
+		if (second_slash != 0) {
+			corner.texcoord = resolve_index(parse_integer(token.substr(0, second_slash)), declared.texcoords, totals.texcoords, true, line);
+		}
+		if (second_slash != std::string_view::npos) {
+			corner.normal = resolve_index(parse_integer(token.substr(second_slash + 1)), declared.normals, totals.normals, true, line);
+		}
+		return corner;
+	}
+
+	// code from https://wrf.ecse.rpi.edu//Research/Short_Notes/pnpoly.html, as used by tinyobjloader
+	auto point_in_triangle(const std::array<float, 3>& xs, const std::array<float, 3>& ys, float x, float y) -> bool
+	{
+		bool inside = false;
+		for (std::size_t i = 0, j = 2; i < 3; j = i++) {
+			if (((ys[i] > y) != (ys[j] > y)) && (x < (xs[j] - xs[i]) * (y - ys[i]) / (ys[j] - ys[i]) + xs[i])) {
+				inside = !inside;
+			}
+		}
+		return inside;
+	}
+
+	// Mirrors tinyobjloader's built in triangulation, so faces split into the same triangles: quads along their shorter diagonal and
+	// larger polygons by ear clipping in the plane their first corner faces most.
+	void triangulate(std::span<const Corner> face, std::vector<Corner>& remaining, std::span<const float> positions, auto&& emit)
+	{
+		const auto position = [positions](const Corner& corner, std::size_t axis) {
+			return positions[3 * static_cast<std::size_t>(corner.position) + axis];
+		};
+		const auto count = face.size();
+		if (count == 3) {
+			emit(face[0], face[1], face[2]);
+			return;
+		}
+
+		if (count == 4) {
+			std::array<float, 3> diagonal_02 {};
+			std::array<float, 3> diagonal_13 {};
+			for (std::size_t axis = 0; axis < 3; axis++) {
+				diagonal_02[axis] = position(face[2], axis) - position(face[0], axis);
+				diagonal_13[axis] = position(face[3], axis) - position(face[1], axis);
+			}
+			const auto squared_02 = diagonal_02[0] * diagonal_02[0] + diagonal_02[1] * diagonal_02[1] + diagonal_02[2] * diagonal_02[2];
+			const auto squared_13 = diagonal_13[0] * diagonal_13[0] + diagonal_13[1] * diagonal_13[1] + diagonal_13[2] * diagonal_13[2];
+			if (squared_02 < squared_13) {
+				emit(face[0], face[1], face[2]);
+				emit(face[0], face[2], face[3]);
+			} else {
+				emit(face[0], face[1], face[3]);
+				emit(face[1], face[2], face[3]);
+			}
+			return;
+		}
+
+		std::array<std::size_t, 2> axes { 1, 2 };
+		for (std::size_t k = 0; k < count; k++) {
+			const auto& first = face[k % count];
+			const auto& second = face[(k + 1) % count];
+			const auto& third = face[(k + 2) % count];
+			const auto e0x = position(second, 0) - position(first, 0);
+			const auto e0y = position(second, 1) - position(first, 1);
+			const auto e0z = position(second, 2) - position(first, 2);
+			const auto e1x = position(third, 0) - position(second, 0);
+			const auto e1y = position(third, 1) - position(second, 1);
+			const auto e1z = position(third, 2) - position(second, 2);
+			const auto cx = std::fabs(e0y * e1z - e0z * e1y);
+			const auto cy = std::fabs(e0z * e1x - e0x * e1z);
+			const auto cz = std::fabs(e0x * e1y - e0y * e1x);
+			constexpr auto epsilon = std::numeric_limits<float>::epsilon();
+			if (cx > epsilon || cy > epsilon || cz > epsilon) {
+				if (!(cx > cy && cx > cz)) {
+					axes[0] = 0;
+					if (cz > cx && cz > cy) {
+						axes[1] = 1;
+					}
+				}
+				break;
+			}
+		}
+
+		remaining.assign(face.begin(), face.end());
+		std::size_t guess = 0;
+		std::size_t remaining_iterations = count;
+		std::size_t previous_remaining = count;
+		std::array<Corner, 3> ear {};
+		std::array<float, 3> xs {};
+		std::array<float, 3> ys {};
+		while (remaining.size() > 3 && remaining_iterations > 0) {
+			const auto polygon_size = remaining.size();
+			if (guess >= polygon_size) {
+				guess -= polygon_size;
+			}
+
+			if (previous_remaining != polygon_size) {
+				previous_remaining = polygon_size;
+				remaining_iterations = polygon_size;
+			} else {
+				remaining_iterations--;
+			}
+
+			for (std::size_t k = 0; k < 3; k++) {
+				ear[k] = remaining[(guess + k) % polygon_size];
+				xs[k] = position(ear[k], axes[0]);
+				ys[k] = position(ear[k], axes[1]);
+			}
+
+			const auto e0x = xs[1] - xs[0];
+			const auto e0y = ys[1] - ys[0];
+			const auto e1x = xs[2] - xs[1];
+			const auto e1y = ys[2] - ys[1];
+			const auto cross = e0x * e1y - e0y * e1x;
+			const auto area = (xs[0] * ys[1] - ys[0] * xs[1]) * 0.5F;
+			if (cross * area < 0.0F) {
+				guess++;
+				continue;
+			}
+
+			bool overlap = false;
+			for (std::size_t other = 3; other < polygon_size && !overlap; other++) {
+				const auto& corner = remaining[(guess + other) % polygon_size];
+				overlap = point_in_triangle(xs, ys, position(corner, axes[0]), position(corner, axes[1]));
+			}
+			if (overlap) {
+				guess++;
+				continue;
+			}
+
+			emit(ear[0], ear[1], ear[2]);
+			remaining.erase(remaining.begin() + static_cast<std::ptrdiff_t>((guess + 1) % polygon_size));
+		}
+
+		if (remaining.size() == 3) {
+			emit(remaining[0], remaining[1], remaining[2]);
+		}
+	}
+
+	auto to_vertex(const Corner& corner, const Attributes& attributes) -> ModelVertex
+	{
+		ModelVertex vertex {};
+		const auto* position = &attributes.positions[3 * static_cast<std::size_t>(corner.position)];
+		vertex.pos = { position[0], position[1], position[2] };
+		if (corner.texcoord >= 0) {
+			const auto* texcoord = &attributes.texcoords[2 * static_cast<std::size_t>(corner.texcoord)];
+			vertex.uvs = { texcoord[0], 1.0F - texcoord[1] };
+		}
+		vertex.color = { 1.0F, 1.0F, 1.0F, 1.0F };
+		if (corner.normal >= 0) {
+			const auto* normal = &attributes.normals[3 * static_cast<std::size_t>(corner.normal)];
+			vertex.normals = { normal[0], normal[1], normal[2] };
+		}
+		return vertex;
+	}
+
+	void parse_attributes(Chunk& chunk)
+	{
+		for_each_line(chunk.text, [&chunk](std::string_view line) {
+			if (starts_with_keyword(line, "v")) {
+				line.remove_prefix(2);
+				for (auto i = 0; i < 3; i++) {
+					chunk.positions.push_back(parse_real(line));
+				}
+			} else if (starts_with_keyword(line, "vt")) {
+				line.remove_prefix(3);
+				for (auto i = 0; i < 2; i++) {
+					chunk.texcoords.push_back(parse_real(line));
+				}
+			} else if (starts_with_keyword(line, "vn")) {
+				line.remove_prefix(3);
+				for (auto i = 0; i < 3; i++) {
+					chunk.normals.push_back(parse_real(line));
+				}
+			}
+		});
+	}
+
+	void parse_faces(Chunk& chunk, const Attributes& attributes)
+	{
+		const AttributeCounts totals {
+			.positions = attributes.positions.size() / 3,
+			.texcoords = attributes.texcoords.size() / 2,
+			.normals = attributes.normals.size() / 3,
+		};
+		auto declared = chunk.offsets;
+
+		const auto emit = [&chunk](const Corner& first, const Corner& second, const Corner& third) {
+			chunk.corners.push_back(first);
+			chunk.corners.push_back(second);
+			chunk.corners.push_back(third);
+		};
+
+		std::vector<Corner> face;
+		std::vector<Corner> remaining;
+		for_each_line(chunk.text, [&](std::string_view line) {
+			if (starts_with_keyword(line, "v")) {
+				declared.positions++;
+			} else if (starts_with_keyword(line, "vt")) {
+				declared.texcoords++;
+			} else if (starts_with_keyword(line, "vn")) {
+				declared.normals++;
+			} else if (starts_with_keyword(line, "g") || starts_with_keyword(line, "o")) {
+				chunk.shape_starts.push_back(chunk.corners.size());
+			} else if (starts_with_keyword(line, "f")) {
+				face.clear();
+				auto rest = line.substr(2);
+				for (auto token = next_token(rest); !token.empty(); token = next_token(rest)) {
+					face.push_back(parse_corner(token, declared, totals, line));
+				}
+				if (face.size() >= 3) {
+					triangulate(face, remaining, attributes.positions, emit);
+				}
+			}
+		});
+	}
+
+	// Shapes run from one g or o line to the next and may span several chunks.
+	auto collect_shapes(const std::vector<Chunk>& chunks) -> std::vector<std::vector<ShapeSegment>>
+	{
+		std::vector<std::vector<ShapeSegment>> shapes(1);
+		for (const auto& chunk : chunks) {
+			std::size_t begin = 0;
+			const auto add_segment = [&](std::size_t end) {
+				if (end > begin) {
+					shapes.back().push_back({ &chunk, begin, end });
+				}
+				begin = end;
+			};
+			for (const auto start : chunk.shape_starts) {
+				add_segment(start);
+				if (!shapes.back().empty()) {
+					shapes.emplace_back();
+				}
+			}
+			add_segment(chunk.corners.size());
+		}
+		if (shapes.back().empty()) {
+			shapes.pop_back();
+		}
+		return shapes;
+	}
+} // namespace
+
+auto ObjModelLoader::import_model(const std::filesystem::path& path, ImportFlag) -> ImportedMesh
+{
+	const FS::MappedFile file { path };
+	if (!file) {
+		throw CouldNotLoadModelException(fmt::format("Could not open {}", path.string()));
+	}
+
+	auto chunks = split_into_chunks(file.view());
+	Collections::parallel_for_each(chunks, parse_attributes, 1);
+
+	AttributeCounts totals {};
+	for (auto& chunk : chunks) {
+		chunk.offsets = totals;
+		totals.positions += chunk.positions.size() / 3;
+		totals.texcoords += chunk.texcoords.size() / 2;
+		totals.normals += chunk.normals.size() / 3;
+	}
+
+	Attributes attributes {};
+	attributes.positions.resize(totals.positions * 3);
+	attributes.texcoords.resize(totals.texcoords * 2);
+	attributes.normals.resize(totals.normals * 3);
+	Collections::parallel_for_each(
+		chunks,
+		[&attributes](Chunk& chunk) {
+			std::ranges::copy(chunk.positions, attributes.positions.begin() + static_cast<std::ptrdiff_t>(chunk.offsets.positions * 3));
+			std::ranges::copy(chunk.texcoords, attributes.texcoords.begin() + static_cast<std::ptrdiff_t>(chunk.offsets.texcoords * 2));
+			std::ranges::copy(chunk.normals, attributes.normals.begin() + static_cast<std::ptrdiff_t>(chunk.offsets.normals * 3));
+			chunk.positions = {};
+			chunk.texcoords = {};
+			chunk.normals = {};
+		},
+		1);
+
+	Collections::parallel_for_each(chunks, [&attributes](Chunk& chunk) { parse_faces(chunk, attributes); }, 1);
+
+	const auto shapes = collect_shapes(chunks);
+	std::vector<WeldResult> welded(shapes.size());
+	std::vector<std::size_t> shape_indices(shapes.size());
+	std::iota(shape_indices.begin(), shape_indices.end(), std::size_t { 0 });
+	Collections::parallel_for_each(
+		shape_indices,
+		[&](std::size_t shape_index) {
+			std::size_t corner_count = 0;
+			for (const auto& segment : shapes[shape_index]) {
+				corner_count += segment.end - segment.begin;
+			}
+
+			VertexWelder welder { corner_count };
+			auto& output = welded[shape_index];
+			output.indices.reserve(corner_count);
+			for (const auto& segment : shapes[shape_index]) {
+				for (auto corner = segment.begin; corner < segment.end; corner++) {
+					output.indices.push_back(welder.weld(to_vertex(segment.chunk->corners[corner], attributes)));
+				}
+			}
+			output.vertices = welder.take_vertices();
+		},
+		1);
+
+	std::vector<ModelVertex> vertices;
+	std::vector<std::uint32_t> indices;
+	for (const auto& shape : welded) {
+		const auto base = static_cast<std::uint32_t>(vertices.size());
+		vertices.insert(vertices.end(), shape.vertices.begin(), shape.vertices.end());
+		std::ranges::transform(shape.indices, std::back_inserter(indices), [base](std::uint32_t index) { return base + index; });
+	}
+
+	if (initial_rotation != glm::mat4 { 1.0F }) {
+		Collections::parallel_for_each(vertices, [&rot = initial_rotation](auto& vertex) { vertex.rotate_by(rot); });
+	}
+
+	if (vertices.empty() || indices.empty()) {
+		throw CouldNotLoadModelException("Model was empty.");
+	}
+
+	const auto& identifier = path.filename().replace_extension().string();
+	Log::debug("ObjModelLoader", "Imported {} from {} chunks, {} shapes", identifier, chunks.size(), shapes.size());
+	return { { identifier, { std::move(vertices), std::move(indices) } } };
+}
+
+} // namespace Disarray
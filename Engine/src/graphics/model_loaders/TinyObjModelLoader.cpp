@@ -2,8 +2,14 @@
 
 #include <tinyobjloader.h>
 
+#include <algorithm>
+#include <iterator>
+#include <numeric>
+
+#include "core/Collections.hpp"
 #include "core/Log.hpp"
 #include "graphics/ModelLoader.hpp"
+#include "graphics/VertexWelder.hpp"
 
 namespace Disarray {
 
@@ -26,41 +32,52 @@ auto TinyObjModelLoader::import_model(const std::filesystem::path& path, ImportF
 		throw CouldNotLoadModelException(fmt::format("Error: {}, Warning: {}", err, warn));
 	}
 
-	std::unordered_map<ModelVertex, uint32_t> unique_vertices {};
-
-	std::vector<std::vector<ModelVertex>> tasks {};
-
-	std::mutex attrib_mutex;
-	for (const auto& shape : shapes) {
-		auto split = Collections::split_into_batches<tinyobj::index_t, 4>(shape.mesh.indices);
-		for (auto& sub_split : split) {
-			tasks.emplace_back(Collections::map(sub_split, [&attrib, &mutex = attrib_mutex](const auto& index) {
-				std::scoped_lock lock { mutex };
+	// Shapes are welded independently and in parallel, then concatenated. Vertices shared across shapes are kept once per shape.
+	std::vector<WeldResult> welded(shapes.size());
+	std::vector<std::size_t> shape_indices(shapes.size());
+	std::iota(shape_indices.begin(), shape_indices.end(), std::size_t { 0 });
+	Collections::parallel_for_each(
+		shape_indices,
+		[&](std::size_t shape_index) {
+			const auto& mesh_indices = shapes[shape_index].mesh.indices;
+			VertexWelder welder { mesh_indices.size() };
+			auto& output = welded[shape_index];
+			output.indices.reserve(mesh_indices.size());
+			for (const auto& index : mesh_indices) {
 				ModelVertex vertex {};
 
 				vertex.pos = { attrib.vertices[3 * index.vertex_index + 0], attrib.vertices[3 * index.vertex_index + 1],
 					attrib.vertices[3 * index.vertex_index + 2] };
 
-				vertex.uvs = { attrib.texcoords[2 * index.texcoord_index + 0], 1.0f - attrib.texcoords[2 * index.texcoord_index + 1] };
+				if (index.texcoord_index >= 0) {
+					vertex.uvs = { attrib.texcoords[2 * index.texcoord_index + 0], 1.0f - attrib.texcoords[2 * index.texcoord_index + 1] };
+				}
 
 				vertex.color = { 1.0f, 1.0f, 1.0f, 1.0f };
 
-				vertex.normals = { attrib.normals[3 * index.normal_index + 0], attrib.normals[3 * index.normal_index + 1],
-					attrib.normals[3 * index.normal_index + 2] };
-				return vertex;
-			}));
-		};
-	}
+				if (index.normal_index >= 0) {
+					vertex.normals = { attrib.normals[3 * index.normal_index + 0], attrib.normals[3 * index.normal_index + 1],
+						attrib.normals[3 * index.normal_index + 2] };
+				}
 
-	for (auto& vec : tasks) {
-		for (const auto& vertex : vec) {
-			if (!unique_vertices.contains(vertex)) {
-				unique_vertices[vertex] = static_cast<uint32_t>(vertices.size());
-				vertices.push_back(vertex);
+				output.indices.push_back(welder.weld(vertex));
 			}
-
-			indices.push_back(unique_vertices[vertex]);
-		}
+			output.vertices = welder.take_vertices();
+		},
+		1);
+
+	std::size_t vertex_count = 0;
+	std::size_t index_count = 0;
+	for (const auto& shape : welded) {
+		vertex_count += shape.vertices.size();
+		index_count += shape.indices.size();
+	}
+	vertices.reserve(vertex_count);
+	indices.reserve(index_count);
+	for (const auto& shape : welded) {
+		const auto base = static_cast<std::uint32_t>(vertices.size());
+		vertices.insert(vertices.end(), shape.vertices.begin(), shape.vertices.end());
+		std::transform(shape.indices.begin(), shape.indices.end(), std::back_inserter(indices), [base](std::uint32_t index) { return base + index; });
 	}
 
 	if (needs_rotate) {
@@ -73,7 +90,7 @@ auto TinyObjModelLoader::import_model(const std::filesystem::path& path, ImportF
 	const auto& identifier = path.filename().replace_extension().string();
 
 	Log::info("SimpleModelLoader", "Identifier: {}", identifier);
-	return { { identifier, { vertices, indices } } };
+	return { { identifier, { std::move(vertices), std::move(indices) } } };
 }
 
 } // namespace Disarray
@@ -0,0 +1,249 @@
+#include "DisarrayPCH.hpp"
+
+#ifdef __linux__
+
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <system_error>
+#include <unordered_map>
+
+#include "core/FileWatcher.hpp"
+#include "core/Log.hpp"
+
+namespace Disarray {
+
+namespace {
+	constexpr std::uint32_t watch_mask
+		= IN_CREATE | IN_DELETE | IN_MODIFY | IN_CLOSE_WRITE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_ONLYDIR | IN_EXCL_UNLINK;
+
+	/**
+	 * @brief One watch per directory, since inotify is not recursive. Directories that show up later get their watches as they are reported.
+	 */
+	class InotifyWatchBackend final : public Detail::WatchBackend {
+	public:
+		InotifyWatchBackend(int in_inotify, int in_wake)
+			: inotify(in_inotify)
+			, wake_event(in_wake)
+		{
+		}
+
+		~InotifyWatchBackend() override
+		{
+			::close(inotify);
+			::close(wake_event);
+		}
+
+		InotifyWatchBackend(const InotifyWatchBackend&) = delete;
+		InotifyWatchBackend(InotifyWatchBackend&&) = delete;
+		auto operator=(const InotifyWatchBackend&) -> InotifyWatchBackend& = delete;
+		auto operator=(InotifyWatchBackend&&) -> InotifyWatchBackend& = delete;
+
+		auto watch_tree(const std::filesystem::path& directory, std::vector<Detail::WatchEvent>* created) -> bool
+		{
+			if (!add_watch(directory)) {
+				return false;
+			}
+
+			std::error_code error_code {};
+			for (const auto& entry :
+				std::filesystem::recursive_directory_iterator { directory, std::filesystem::directory_options::skip_permission_denied, error_code }) {
+				if (entry.is_directory(error_code) && !add_watch(entry.path())) {
+					return false;
+				}
+				// Anything in a new directory may have been created before its watch was added.
+				if (created != nullptr) {
+					created->push_back({ .type = Detail::WatchEventType::Created, .path = entry.path().string() });
+				}
+			}
+			return true;
+		}
+
+		void wait(std::vector<Detail::WatchEvent>& events, std::optional<std::chrono::milliseconds> timeout) override
+		{
+			std::array<pollfd, 2> descriptors {
+				pollfd { .fd = inotify, .events = POLLIN, .revents = 0 },
+				pollfd { .fd = wake_event, .events = POLLIN, .revents = 0 },
+			};
+			const auto timeout_ms = timeout ? static_cast<int>(timeout->count()) : -1;
+			if (::poll(descriptors.data(), descriptors.size(), timeout_ms) <= 0) {
+				return;
+			}
+
+			if ((descriptors[1].revents & POLLIN) != 0) {
+				std::uint64_t value = 0;
+				[[maybe_unused]] const auto read_bytes = ::read(wake_event, &value, sizeof(value));
+			}
+			if ((descriptors[0].revents & POLLIN) != 0) {
+				read_events(events);
+			}
+		}
+
+		void wake() override
+		{
+			const std::uint64_t value = 1;
+			[[maybe_unused]] const auto written = ::write(wake_event, &value, sizeof(value));
+		}
+
+	private:
+		struct MovedFrom {
+			std::string path {};
+			bool is_directory { false };
+		};
+
+		auto add_watch(const std::filesystem::path& directory) -> bool
+		{
+			const auto descriptor = ::inotify_add_watch(inotify, directory.c_str(), watch_mask);
+			if (descriptor < 0) {
+				// Directories that vanished in the meantime are fine, running out of watches is not.
+				if (errno == ENOENT || errno == ENOTDIR || errno == EACCES) {
+					return true;
+				}
+				Log::error("FileWatcher", "Could not watch {}: {}", directory.string(), std::strerror(errno));
+				return false;
+			}
+			directories[descriptor] = directory.string();
+			return true;
+		}
+
+		void remove_watches_below(std::string_view directory)
+		{
+			for (auto iterator = directories.begin(); iterator != directories.end();) {
+				if (is_at_or_below(iterator->second, directory)) {
+					::inotify_rm_watch(inotify, iterator->first);
+					iterator = directories.erase(iterator);
+				} else {
+					iterator++;
+				}
+			}
+		}
+
+		void rename_watches(std::string_view from, const std::string& to)
+		{
+			for (auto& [descriptor, directory] : directories) {
+				if (is_at_or_below(directory, from)) {
+					directory = to + directory.substr(from.size());
+				}
+			}
+		}
+
+		static auto is_at_or_below(std::string_view path, std::string_view directory) -> bool
+		{
+			return path.starts_with(directory) && (path.size() == directory.size() || path[directory.size()] == '/');
+		}
+
+		void read_events(std::vector<Detail::WatchEvent>& events)
+		{
+			alignas(inotify_event) std::array<char, 64ULL * 1024ULL> buffer {};
+			std::unordered_map<std::uint32_t, MovedFrom> moved_from {};
+
+			while (true) {
+				const auto length = ::read(inotify, buffer.data(), buffer.size());
+				if (length <= 0) {
+					break;
+				}
+
+				for (std::size_t offset = 0; offset < static_cast<std::size_t>(length);) {
+					const auto* event = reinterpret_cast<const inotify_event*>(buffer.data() + offset);
+					offset += sizeof(inotify_event) + event->len;
+					handle(*event, events, moved_from);
+				}
+			}
+
+			// A move whose other half never showed up left the watched tree.
+			for (auto& [cookie, moved] : moved_from) {
+				if (moved.is_directory) {
+					remove_watches_below(moved.path);
+				}
+				events.push_back({ .type = Detail::WatchEventType::Deleted, .path = std::move(moved.path) });
+			}
+		}
+
+		void handle(const inotify_event& event, std::vector<Detail::WatchEvent>& events, std::unordered_map<std::uint32_t, MovedFrom>& moved_from)
+		{
+			if ((event.mask & IN_Q_OVERFLOW) != 0) {
+				Log::error("FileWatcher", "The inotify queue overflowed, rescanning.");
+				events.push_back({ .type = Detail::WatchEventType::Rescan });
+				return;
+			}
+
+			const auto found = directories.find(event.wd);
+			if (found == directories.end()) {
+				return;
+			}
+			if ((event.mask & (IN_DELETE_SELF | IN_IGNORED)) != 0) {
+				directories.erase(found);
+				return;
+			}
+			if (event.len == 0) {
+				return;
+			}
+
+			auto path = (std::filesystem::path { found->second } / event.name).string();
+			const auto is_directory = (event.mask & IN_ISDIR) != 0;
+
+			if ((event.mask & IN_CREATE) != 0) {
+				if (is_directory) {
+					watch_tree(path, &events);
+				}
+				events.push_back({ .type = Detail::WatchEventType::Created, .path = std::move(path) });
+			} else if ((event.mask & (IN_MODIFY | IN_CLOSE_WRITE)) != 0) {
+				events.push_back({ .type = Detail::WatchEventType::Modified, .path = std::move(path) });
+			} else if ((event.mask & IN_DELETE) != 0) {
+				events.push_back({ .type = Detail::WatchEventType::Deleted, .path = std::move(path) });
+			} else if ((event.mask & IN_MOVED_FROM) != 0) {
+				moved_from[event.cookie] = MovedFrom { .path = std::move(path), .is_directory = is_directory };
+			} else if ((event.mask & IN_MOVED_TO) != 0) {
+				if (const auto from = moved_from.find(event.cookie); from != moved_from.end()) {
+					if (is_directory) {
+						rename_watches(from->second.path, path);
+					}
+					events.push_back({ .type = Detail::WatchEventType::Renamed, .path = std::move(path), .previous_path = std::move(from->second.path) });
+					moved_from.erase(from);
+					return;
+				}
+
+				// Moved in from outside of the watched tree.
+				if (is_directory) {
+					watch_tree(path, &events);
+				}
+				events.push_back({ .type = Detail::WatchEventType::Created, .path = std::move(path) });
+			}
+		}
+
+		int inotify;
+		int wake_event;
+		std::unordered_map<int, std::string> directories {};
+	};
+} // namespace
+
+auto Detail::create_native_watch_backend(const std::filesystem::path& root) -> Scope<WatchBackend>
+{
+	const auto inotify = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (inotify < 0) {
+		Log::error("FileWatcher", "Could not initialise inotify: {}", std::strerror(errno));
+		return nullptr;
+	}
+
+	const auto wake_event = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (wake_event < 0) {
+		Log::error("FileWatcher", "Could not create a wake event: {}", std::strerror(errno));
+		::close(inotify);
+		return nullptr;
+	}
+
+	auto backend = make_scope<InotifyWatchBackend>(inotify, wake_event);
+	if (!backend->watch_tree(root, nullptr)) {
+		return nullptr;
+	}
+	return backend;
+}
+
+} // namespace Disarray
+
+#endif
@@ -114,6 +114,32 @@ void MeshDeserialiser::deserialise_impl(const nlohmann::json& object, Components
 		.path = props["path"],
 		.initial_rotation = props["initial_rotation"],
 	};
+	if (props.contains("optimisation")) {
+		const auto& optimisation = props["optimisation"];
+		properties.optimisation = MeshOptimisationSettings {
+			.vertex_cache = optimisation.value("vertex_cache", false),
+			.overdraw = optimisation.value("overdraw", false),
+			.vertex_fetch = optimisation.value("vertex_fetch", false),
+			.overdraw_threshold = optimisation.value("overdraw_threshold", MeshOptimisationSettings {}.overdraw_threshold),
+		};
+	}
+	if (props.contains("lods")) {
+		const auto& lods = props["lods"];
+		properties.lods = LodSettings {
+			.ratios = lods.value("ratios", std::vector<float> {}),
+			.max_error = lods.value("max_error", LodSettings {}.max_error),
+		};
+	}
+	if (props.contains("meshlets")) {
+		const auto& meshlets = props["meshlets"];
+		properties.meshlets = MeshletSettings {
+			.enabled = true,
+			.max_vertices = meshlets.value("max_vertices", MeshletSettings {}.max_vertices),
+			.max_triangles = meshlets.value("max_triangles", MeshletSettings {}.max_triangles),
+			.cone_weight = meshlets.value("cone_weight", MeshletSettings {}.cone_weight),
+		};
+	}
+	properties.vertex_format = to_enum_value<VertexFormat>(props, "vertex_format").value_or(VertexFormat::Full);
 
 	mesh.mesh = Mesh::construct(device, properties);
 }
@@ -43,6 +43,30 @@ void MeshSerialiser::serialise_impl(const Components::Mesh& mesh, nlohmann::json
 		const auto& props = mesh.mesh->get_properties();
 		properties["path"] = props.path;
 		properties["initial_rotation"] = props.initial_rotation;
+		if (props.optimisation.any()) {
+			properties["optimisation"] = {
+				{ "vertex_cache", props.optimisation.vertex_cache },
+				{ "overdraw", props.optimisation.overdraw },
+				{ "vertex_fetch", props.optimisation.vertex_fetch },
+				{ "overdraw_threshold", props.optimisation.overdraw_threshold },
+			};
+		}
+		if (props.lods.any()) {
+			properties["lods"] = {
+				{ "ratios", props.lods.ratios },
+				{ "max_error", props.lods.max_error },
+			};
+		}
+		if (props.meshlets.enabled) {
+			properties["meshlets"] = {
+				{ "max_vertices", props.meshlets.max_vertices },
+				{ "max_triangles", props.meshlets.max_triangles },
+				{ "cone_weight", props.meshlets.cone_weight },
+			};
+		}
+		if (props.vertex_format != VertexFormat::Full) {
+			properties["vertex_format"] = magic_enum::enum_name(props.vertex_format);
+		}
 		object["properties"] = properties;
 	}
 }
@@ -12,6 +12,7 @@
 #include <mutex>
 #include <string_view>
 #include <thread>
+#include <utility>
 
 #include "core/App.hpp"
 #include "core/Collections.hpp"
@@ -19,6 +20,7 @@
 #include "core/Formatters.hpp"
 #include "core/Input.hpp"
 #include "core/Instrumentation.hpp"
+#include "core/Metrics.hpp"
 #include "core/Random.hpp"
 #include "core/ThreadPool.hpp"
 #include "core/events/Event.hpp"
@@ -39,13 +41,40 @@
 
 namespace Disarray {
 
+namespace {
+	template <class... Types> using RegistryView = decltype(std::declval<entt::registry&>().view<Types...>());
+} // namespace
+
+// Everything the frame graph stages touch that changes from frame to frame. The stages are built once and read it from here.
+struct Scene::FrameInputs {
+	RegistryView<const Components::Transform, Components::DirectionalLight> sun_view {};
+	RegistryView<Components::DirectionalLight, Components::Transform> shadow_caster_view {};
+	RegistryView<const Components::SpotLight, Components::Transform> spot_light_orientation_view {};
+	RegistryView<const Components::PointLight, const Components::Transform, Components::Texture> point_light_view {};
+	RegistryView<const Components::SpotLight, const Components::Transform, Components::Texture> spot_light_view {};
+	RegistryView<const Components::Transform, const Components::ID> identifier_view {};
+	RegistryView<const Components::Transform, Components::Mesh> lod_view {};
+
+	SceneRenderer* renderer { nullptr };
+	DirectionalLightUBO* directional { nullptr };
+	ShadowPassUBO* shadow_pass { nullptr };
+	PointLights* point_lights { nullptr };
+	SpotLights* spot_lights { nullptr };
+	PushConstant* push_constant { nullptr };
+	LodProjection lod_projection {};
+};
+
+template <> auto PimplDeleter<Scene::FrameInputs>::operator()(Scene::FrameInputs* ptr) noexcept -> void { delete ptr; }
+
 Scene::Scene(const Device& dev, std::string_view name)
 	: engine(6, 3)
 	, device(dev)
 	, scene_name(name)
+	, frame_inputs(make_scope<FrameInputs, PimplDeleter<FrameInputs>>())
 {
 	picked_entity = make_scope<Entity>(this);
 	selected_entity = make_scope<Entity>(this);
+	build_frame_graph();
 }
 
 void Scene::construct(Disarray::App& app) { extent = app.get_swapchain().get_extent(); }
@@ -62,6 +91,155 @@ void Scene::execute_callbacks(SceneRenderer& renderer)
 	}
 }
 
+void Scene::build_frame_graph()
+{
+	auto& inputs = *frame_inputs;
+	frame_graph
+		.add_stage("SpotLightOrientation",
+			[&inputs]() {
+				for (auto&& [entity, spot_light, pos] : inputs.spot_light_orientation_view.each()) {
+					pos.rotation = glm::quat { spot_light.direction };
+				}
+			})
+		.reads({ "SpotLight" })
+		.writes({ "Transform" });
+
+	frame_graph
+		.add_stage("DirectionalLight",
+			[this, &inputs]() {
+				auto& directional = *inputs.directional;
+				auto& shadow_pass = *inputs.shadow_pass;
+				for (auto&& [entity, transform, sun] : inputs.sun_view.each()) {
+					directional.position = { transform.position, 1.0F };
+					sun.direction = glm::normalize(-directional.position); // Lookat {0,0,0};
+					directional.direction = sun.direction;
+					directional.ambient = sun.ambient;
+					directional.diffuse = sun.diffuse;
+					directional.specular = sun.specular;
+					directional.near_far = glm::vec4 { 0 };
+				}
+
+				std::size_t shadow_casters { 0 };
+				entt::entity shadow_caster { entt::null };
+				for (const auto entity : inputs.shadow_caster_view) {
+					shadow_caster = entity;
+					shadow_casters++;
+				}
+				if (shadow_casters != 1) {
+					return;
+				}
+
+				auto&& [light, transform] = inputs.shadow_caster_view.get<Components::DirectionalLight, Components::Transform>(shadow_caster);
+				auto projection = light.projection_parameters.compute();
+				glm::vec3 center { 0 };
+				if (light.use_direction_vector) {
+					auto lookat_center = transform.position + glm::vec3(light.direction);
+					center = lookat_center;
+					projection = glm::perspective(
+						light.projection_parameters.fov, extent.aspect_ratio(), light.projection_parameters.near, light.projection_parameters.far);
+					directional.near_far = { light.projection_parameters.near, light.projection_parameters.far, 0, 0 };
+				}
+				const auto shadow_pass_view = glm::lookAt(glm::vec3(transform.position), center, { 0.0F, 1.0F, 0.0F });
+
+				const auto view_projection = projection * shadow_pass_view;
+
+				shadow_pass.view = shadow_pass_view;
+				shadow_pass.projection = projection;
+				shadow_pass.view_projection = view_projection;
+			})
+		.reads({ "Transform" })
+		.writes({ "DirectionalLight", "DirectionalLightUBO", "ShadowPassUBO" });
+
+	frame_graph
+		.add_stage("PointLights",
+			[&inputs]() {
+				std::size_t point_light_index { 0 };
+				auto& lights = inputs.point_lights->lights;
+				auto point_light_ssbo = inputs.renderer->get_point_light_transforms().get_mutable<glm::mat4>();
+				auto point_light_ssbo_colour = inputs.renderer->get_point_light_colours().get_mutable<glm::vec4>();
+				for (auto&& [entity, point_light, pos, texture] : inputs.point_light_view.each()) {
+					auto& light = lights.at(point_light_index);
+					light.position = glm::vec4 { pos.position, 0.F };
+					light.ambient = point_light.ambient;
+					light.diffuse = point_light.diffuse;
+					light.specular = point_light.specular;
+					light.factors = point_light.factors;
+					texture.colour = light.ambient;
+
+					point_light_ssbo[point_light_index] = pos.compute();
+					point_light_ssbo_colour[point_light_index] = texture.colour;
+					point_light_index++;
+				}
+				inputs.push_constant->max_point_lights = static_cast<std::uint32_t>(point_light_index);
+			})
+		.reads({ "PointLight", "Transform" })
+		.writes({ "Texture", "PointLightsUBO", "PointLightSSBO", "PushConstant.max_point_lights" });
+
+	frame_graph
+		.add_stage("SpotLights",
+			[&inputs]() {
+				std::size_t spot_light_index { 0 };
+				auto& spot_light_array = inputs.spot_lights->lights;
+				auto spot_light_ssbo = inputs.renderer->get_spot_light_transforms().get_mutable<glm::mat4>();
+				auto spot_light_ssbo_colour = inputs.renderer->get_spot_light_colours().get_mutable<glm::vec4>();
+				for (auto&& [entity, spot_light, pos, texture] : inputs.spot_light_view.each()) {
+					auto& light = spot_light_array.at(spot_light_index);
+					light.position = glm::vec4 { pos.position, 0.F };
+					light.ambient = spot_light.ambient;
+					light.diffuse = spot_light.diffuse;
+					light.specular = spot_light.specular;
+					light.direction_and_cutoff = {
+						-glm::normalize(spot_light.direction),
+						glm::cos(glm::radians(spot_light.cutoff_angle_degrees)),
+					};
+					light.factors_and_outer_cutoff = {
+						glm::vec3(spot_light.factors),
+						glm::cos(glm::radians(spot_light.outer_cutoff_angle_degrees)),
+					};
+					texture.colour = light.ambient;
+
+					spot_light_ssbo[spot_light_index] = pos.compute();
+					spot_light_ssbo_colour[spot_light_index] = texture.colour;
+					spot_light_index++;
+				}
+				inputs.push_constant->max_spot_lights = static_cast<std::uint32_t>(spot_light_index);
+			})
+		.reads({ "SpotLight", "Transform" })
+		.writes({ "Texture", "SpotLightsUBO", "SpotLightSSBO", "PushConstant.max_spot_lights" });
+
+	frame_graph
+		.add_stage("Identifiers",
+			[&inputs]() {
+				std::size_t identifier_index { 0 };
+				auto ssbo_identifiers = inputs.renderer->get_entity_identifiers().get_mutable<std::uint32_t>();
+				auto identifiers_transforms = inputs.renderer->get_entity_transforms().get_mutable<glm::mat4>();
+				for (auto&& [entity, transform, id] : inputs.identifier_view.each()) {
+					if (!id.can_interact_with) {
+						continue;
+					}
+					ssbo_identifiers[identifier_index] = static_cast<std::uint32_t>(entity);
+					identifiers_transforms[identifier_index] = transform.compute();
+					identifier_index++;
+				}
+			})
+		.reads({ "Transform", "ID" })
+		.writes({ "IdentifierSSBO" });
+
+	frame_graph
+		.add_stage("LodSelection",
+			[this, &inputs]() {
+				for (auto&& [entity, transform, mesh] : inputs.lod_view.each()) {
+					if (!mesh.mesh) {
+						continue;
+					}
+					const auto scale = LodSelection::projected_scale(mesh.mesh->get_aabb(), transform.compute(), inputs.lod_projection);
+					mesh.lod = LodSelection::select(mesh.mesh->get_lod_errors(), scale, mesh.lod, lod_selection);
+				}
+			})
+		.reads({ "Transform" })
+		.writes({ "Mesh.lod" });
+}
+
 void Scene::begin_frame(const Camera& camera, SceneRenderer& scene_renderer)
 {
 	if (const auto& view_projection_tuple = get_primary_camera(); view_projection_tuple.has_value()) {
@@ -74,6 +252,7 @@ void Scene::begin_frame(const Camera& camera, SceneRenderer& scene_renderer)
 
 void Scene::begin_frame(const glm::mat4& view, const glm::mat4& proj, const glm::mat4& view_proj, SceneRenderer& scene_renderer)
 {
+	DISARRAY_PROFILE_FUNCTION()
 	execute_callbacks(scene_renderer);
 
 	scene_renderer.begin_frame(view, proj, view_proj);
@@ -83,106 +262,26 @@ void Scene::begin_frame(const glm::mat4& view, const glm::mat4& proj, const glm:
 	auto spot_lights_transaction = scene_renderer.begin_uniform_transaction<SpotLights>();
 	auto shadow_pass_transaction = scene_renderer.begin_uniform_transaction<ShadowPassUBO>();
 
-	auto& shadow_pass = shadow_pass_transaction.get_buffer();
-	auto& directional = directional_transaction.get_buffer();
-	auto& point_lights = point_lights_transaction.get_buffer();
-	auto& spot_lights = spot_lights_transaction.get_buffer();
-
-	auto& push_constant = scene_renderer.get_graphics_resource().get_editable_push_constant();
-
-	{
-		for (auto sun_component_view = registry.view<const Components::Transform, Components::DirectionalLight>();
-			 auto&& [entity, transform, sun] : sun_component_view.each()) {
-			directional.position = { transform.position, 1.0F };
-			sun.direction = glm::normalize(-directional.position); // Lookat {0,0,0};
-			directional.direction = sun.direction;
-			directional.ambient = sun.ambient;
-			directional.diffuse = sun.diffuse;
-			directional.specular = sun.specular;
-			directional.near_far = glm::vec4 { 0 };
-		}
-	}
-
-	auto maybe_directional = get_by_components<Components::DirectionalLight, Components::Transform>();
-	if (maybe_directional.has_value()) {
-
-		auto&& [transform, light] = maybe_directional->get_components<Components::Transform, Components::DirectionalLight>();
-		auto projection = light.projection_parameters.compute();
-		glm::vec3 center { 0 };
-		if (light.use_direction_vector) {
-			auto lookat_center = transform.position + glm::vec3(light.direction);
-			center = lookat_center;
-			projection = glm::perspective(
-				light.projection_parameters.fov, extent.aspect_ratio(), light.projection_parameters.near, light.projection_parameters.far);
-			directional.near_far = { light.projection_parameters.near, light.projection_parameters.far, 0, 0 };
-		}
-		const auto shadow_pass_view = glm::lookAt(glm::vec3(transform.position), center, { 0.0F, 1.0F, 0.0F });
-
-		const auto view_projection = projection * shadow_pass_view;
-
-		shadow_pass.view = shadow_pass_view;
-		shadow_pass.projection = projection;
-		shadow_pass.view_projection = view_projection;
-	}
-
-	std::size_t point_light_index { 0 };
-	auto& lights = point_lights.lights;
-	auto point_light_ssbo = scene_renderer.get_point_light_transforms().get_mutable<glm::mat4>();
-	auto point_light_ssbo_colour = scene_renderer.get_point_light_colours().get_mutable<glm::vec4>();
-	for (auto&& [entity, point_light, pos, texture] :
-		registry.view<const Components::PointLight, const Components::Transform, Components::Texture>().each()) {
-		auto& light = lights.at(point_light_index);
-		light.position = glm::vec4 { pos.position, 0.F };
-		light.ambient = point_light.ambient;
-		light.diffuse = point_light.diffuse;
-		light.specular = point_light.specular;
-		light.factors = point_light.factors;
-		texture.colour = light.ambient;
-
-		point_light_ssbo[point_light_index] = pos.compute();
-		point_light_ssbo_colour[point_light_index] = texture.colour;
-		point_light_index++;
-	}
-	push_constant.max_point_lights = static_cast<std::uint32_t>(point_light_index);
-
-	std::size_t spot_light_index { 0 };
-	auto& spot_light_array = spot_lights.lights;
-	auto spot_light_ssbo = scene_renderer.get_spot_light_transforms().get_mutable<glm::mat4>();
-	auto spot_light_ssbo_colour = scene_renderer.get_spot_light_colours().get_mutable<glm::vec4>();
-	for (auto&& [entity, spot_light, pos, texture] :
-		registry.view<const Components::SpotLight, Components::Transform, Components::Texture>().each()) {
-		auto& light = spot_light_array.at(spot_light_index);
-		pos.rotation = glm::quat { spot_light.direction };
-		light.position = glm::vec4 { pos.position, 0.F };
-		light.ambient = spot_light.ambient;
-		light.diffuse = spot_light.diffuse;
-		light.specular = spot_light.specular;
-		light.direction_and_cutoff = {
-			-glm::normalize(spot_light.direction),
-			glm::cos(glm::radians(spot_light.cutoff_angle_degrees)),
-		};
-		light.factors_and_outer_cutoff = {
-			glm::vec3(spot_light.factors),
-			glm::cos(glm::radians(spot_light.outer_cutoff_angle_degrees)),
-		};
-		texture.colour = light.ambient;
-
-		spot_light_ssbo[spot_light_index] = pos.compute();
-		spot_light_ssbo_colour[spot_light_index] = texture.colour;
-		spot_light_index++;
-	}
-	push_constant.max_spot_lights = static_cast<std::uint32_t>(spot_light_index);
-
-	std::size_t identifier_index { 0 };
-	auto ssbo_identifiers = scene_renderer.get_entity_identifiers().get_mutable<std::uint32_t>();
-	auto identifiers_transforms = scene_renderer.get_entity_transforms().get_mutable<glm::mat4>();
-	for (auto&& [entity, transform, id] : registry.view<const Components::Transform, const Components::ID>().each()) {
-		if (!id.can_interact_with) {
-			continue;
-		}
-		ssbo_identifiers[identifier_index] = static_cast<std::uint32_t>(entity);
-		identifiers_transforms[identifier_index] = transform.compute();
-		identifier_index++;
+	// Views are created up front: creating a view can create the component storage, which must not race with the stages.
+	auto& inputs = *frame_inputs;
+	inputs.sun_view = registry.view<const Components::Transform, Components::DirectionalLight>();
+	inputs.shadow_caster_view = registry.view<Components::DirectionalLight, Components::Transform>();
+	inputs.spot_light_orientation_view = registry.view<const Components::SpotLight, Components::Transform>();
+	inputs.point_light_view = registry.view<const Components::PointLight, const Components::Transform, Components::Texture>();
+	inputs.spot_light_view = registry.view<const Components::SpotLight, const Components::Transform, Components::Texture>();
+	inputs.identifier_view = registry.view<const Components::Transform, const Components::ID>();
+	inputs.lod_view = registry.view<const Components::Transform, Components::Mesh>();
+	inputs.renderer = &scene_renderer;
+	inputs.directional = &directional_transaction.get_buffer();
+	inputs.shadow_pass = &shadow_pass_transaction.get_buffer();
+	inputs.point_lights = &point_lights_transaction.get_buffer();
+	inputs.spot_lights = &spot_lights_transaction.get_buffer();
+	inputs.push_constant = &scene_renderer.get_graphics_resource().get_editable_push_constant();
+	inputs.lod_projection = LodSelection::projection_for(view, proj, extent.height);
+
+	frame_graph.execute(App::get_thread_pool());
+	for (const auto& task : frame_graph.get_statistics().tasks) {
+		Metrics::record_timing(frame_format("Stage: {}", task.name), task.duration_ms);
 	}
 }
 
@@ -206,6 +305,7 @@ void Scene::update(float)
 
 void Scene::render(SceneRenderer& renderer)
 {
+	DISARRAY_PROFILE_FUNCTION()
 	auto render_planar_geometry = [](auto& ren) { ren.planar_geometry_pass(); };
 
 	auto render_text = [](auto& scene_renderer, entt::registry& reg) {
@@ -296,6 +396,7 @@ void Scene::draw_geometry(SceneRenderer& scene_renderer)
 		if (point_light_view_for_count > 0 && point_light_mesh != nullptr) {
 			const auto& pipeline = *scene_renderer.get_pipeline("PointLight");
 			scene_renderer.draw_point_lights(*point_light_mesh, point_light_view_for_count, pipeline);
+			Metrics::add(Metrics::Counter::EntitiesDrawn, point_light_view_for_count);
 		}
 	}
 
@@ -312,6 +413,7 @@ void Scene::draw_geometry(SceneRenderer& scene_renderer)
 		if (spot_light_view_for_count > 0 && spot_light_mesh != nullptr) {
 			const auto& pipeline = *scene_renderer.get_pipeline("SpotLight");
 			scene_renderer.draw_point_lights(*spot_light_mesh, spot_light_view_for_count, pipeline);
+			Metrics::add(Metrics::Counter::EntitiesDrawn, spot_light_view_for_count);
 		}
 	}
 
@@ -356,10 +458,11 @@ void Scene::draw_geometry(SceneRenderer& scene_renderer)
 			scene_renderer.draw_aabb(mesh.mesh->get_aabb(), texture.colour, computed_transform);
 		}
 		if (mesh.mesh->has_children()) {
-			scene_renderer.draw_static_submeshes(mesh.mesh->get_submeshes(), actual_pipeline, computed_transform, texture.colour);
+			scene_renderer.draw_static_submeshes(mesh.mesh->get_submeshes(), actual_pipeline, computed_transform, texture.colour, mesh.lod);
 		} else {
-			scene_renderer.draw_single_static_mesh(*mesh.mesh, actual_pipeline, computed_transform, texture.colour);
+			scene_renderer.draw_single_static_mesh(*mesh.mesh, actual_pipeline, computed_transform, texture.colour, mesh.lod);
 		}
+		Metrics::add(Metrics::Counter::EntitiesDrawn);
 	}
 
 	for (auto&& [entity, mesh, transform] :
@@ -373,7 +476,8 @@ void Scene::draw_geometry(SceneRenderer& scene_renderer)
 
 		const auto& actual_pipeline = *scene_renderer.get_pipeline("StaticMesh");
 		const auto transform_computed = transform.compute();
-		scene_renderer.draw_single_static_mesh(*mesh.mesh, actual_pipeline, transform_computed, { 1, 1, 1, 1 });
+		scene_renderer.draw_single_static_mesh(*mesh.mesh, actual_pipeline, transform_computed, { 1, 1, 1, 1 }, mesh.lod);
+		Metrics::add(Metrics::Counter::EntitiesDrawn);
 		if (mesh.draw_aabb) {
 			scene_renderer.draw_aabb(mesh.mesh->get_aabb(), { 1, 1, 1, 1 }, transform_computed);
 		}
@@ -389,11 +493,12 @@ void Scene::draw_shadows(SceneRenderer& scene_renderer)
 			continue;
 		}
 
+		// Shadows reuse the level picked for the camera.
 		const auto& actual_pipeline = *scene_renderer.get_pipeline("Shadow");
 		if (mesh.mesh->has_children()) {
-			scene_renderer.draw_static_submeshes(mesh.mesh->get_submeshes(), actual_pipeline, transform.compute(), texture.colour);
+			scene_renderer.draw_static_submeshes(mesh.mesh->get_submeshes(), actual_pipeline, transform.compute(), texture.colour, mesh.lod);
 		} else {
-			scene_renderer.draw_single_static_mesh(*mesh.mesh, actual_pipeline, transform.compute(), texture.colour);
+			scene_renderer.draw_single_static_mesh(*mesh.mesh, actual_pipeline, transform.compute(), texture.colour, mesh.lod);
 		}
 	}
 
@@ -408,7 +513,7 @@ void Scene::draw_shadows(SceneRenderer& scene_renderer)
 
 		const auto& actual_pipeline = *scene_renderer.get_pipeline("Shadow");
 		const auto transform_computed = transform.compute();
-		scene_renderer.draw_single_static_mesh(*mesh.mesh, actual_pipeline, transform_computed, { 1, 1, 1, 1 });
+		scene_renderer.draw_single_static_mesh(*mesh.mesh, actual_pipeline, transform_computed, { 1, 1, 1, 1 }, mesh.lod);
 	}
 }
 
@@ -671,7 +776,7 @@ auto Scene::on_update_simulation(float time_step) -> void
 auto Scene::on_update_runtime(float time_step) -> void
 {
 	auto script_view = registry.view<Components::Script>();
-	std::vector<CppScript*> deferred_scripts {};
+	std::pmr::vector<CppScript*> deferred_scripts { frame_resource() };
 	deferred_scripts.reserve(script_view.size());
 	script_view.each([&](const auto entity, Components::Script& script) {
 		if (script.has_been_bound()) {
@@ -767,6 +872,7 @@ auto Scene::sort() -> void
 
 void Scene::physics_update(float time_step)
 {
+	DISARRAY_PROFILE_FUNCTION()
 	if (!is_paused() || step_frames >= 0) {
 		engine.step(time_step);
 		auto view = registry.view<Components::RigidBody, Components::Transform>();
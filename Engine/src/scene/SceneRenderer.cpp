@@ -575,7 +575,7 @@ auto SceneRenderer::draw_submesh(Disarray::CommandExecutor&, const Disarray::Ver
 }
 
 auto SceneRenderer::draw_static_submeshes(const Collections::ScopedStringMap<MeshSubstructure>& submeshes, const Pipeline& pipeline,
-	const glm::mat4& transform, const glm::vec4& colour) -> void
+	const glm::mat4& transform, const glm::vec4& colour, std::uint32_t lod) -> void
 {
 	renderer->bind_descriptor_sets(*command_executor, pipeline);
 	renderer->bind_pipeline(*command_executor, pipeline);
@@ -588,14 +588,22 @@ auto SceneRenderer::draw_static_submeshes(const Collections::ScopedStringMap<Mes
 			push_constant.image_indices.at(index++) = static_cast<int>(texture_index);
 		}
 		push_constant.bound_textures = static_cast<unsigned int>(index);
-		draw_submesh(*command_executor, *mesh->vertices, *mesh->indices, pipeline, colour, transform, push_constant);
+		draw_submesh(*command_executor, *mesh->vertices, mesh->get_indices(lod), pipeline, colour, transform, push_constant);
 		push_constant.bound_textures = 0;
 	});
 }
 
-auto SceneRenderer::draw_single_static_mesh(const Mesh& mesh, const Pipeline& pipeline, const glm::mat4& transform, const glm::vec4& colour) -> void
+auto SceneRenderer::draw_single_static_mesh(
+	const Mesh& mesh, const Pipeline& pipeline, const glm::mat4& transform, const glm::vec4& colour, std::uint32_t lod) -> void
 {
-	renderer->draw_mesh(*command_executor, mesh, pipeline, colour, transform);
+	if (lod == 0 || mesh.get_submeshes().empty()) {
+		renderer->draw_mesh(*command_executor, mesh, pipeline, colour, transform);
+		return;
+	}
+
+	// Without children there is exactly one submesh, and it owns the mesh's buffers.
+	const auto& submesh = *mesh.get_submeshes().begin()->second;
+	renderer->draw_mesh(*command_executor, *submesh.vertices, submesh.get_indices(lod), pipeline, colour, transform);
 }
 
 auto SceneRenderer::draw_single_static_mesh(
@@ -0,0 +1,145 @@
+#include <gtest/gtest.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "graphics/AABB.hpp"
+#include "graphics/ModelVertex.hpp"
+#include "mesh_test_helpers.hpp"
+
+using namespace Disarray;
+using namespace Disarray::Tests;
+
+namespace {
+
+constexpr AABB unit_box { AABBRange { 0.0F, 1.0F }, AABBRange { 0.0F, 1.0F }, AABBRange { 0.0F, 1.0F } };
+
+auto random_vertices(std::size_t count, std::mt19937& generator) -> std::vector<ModelVertex>
+{
+	std::uniform_real_distribution<float> coordinate { -100.0F, 100.0F };
+	std::vector<ModelVertex> vertices {};
+	for (std::size_t index = 0; index < count; index++) {
+		auto vertex = make_vertex({ coordinate(generator), coordinate(generator), coordinate(generator) });
+		// The vectorised paths load the first uv coordinate along with the position, so it must never leak into the bounds.
+		vertex.uvs = { std::numeric_limits<float>::lowest(), std::numeric_limits<float>::max() };
+		vertices.push_back(vertex);
+	}
+	return vertices;
+}
+
+auto corners_of(const AABB& box) -> std::array<glm::vec3, 8>
+{
+	std::array<glm::vec3, 8> corners {};
+	for (std::size_t corner = 0; corner < corners.size(); corner++) {
+		corners[corner] = {
+			(corner & 1U) != 0 ? box.maximum().x : box.minimum().x,
+			(corner & 2U) != 0 ? box.maximum().y : box.minimum().y,
+			(corner & 4U) != 0 ? box.maximum().z : box.minimum().z,
+		};
+	}
+	return corners;
+}
+
+void expect_near(const glm::vec3& actual, const glm::vec3& expected, float tolerance)
+{
+	EXPECT_NEAR(actual.x, expected.x, tolerance);
+	EXPECT_NEAR(actual.y, expected.y, tolerance);
+	EXPECT_NEAR(actual.z, expected.z, tolerance);
+}
+
+} // namespace
+
+// Every count up to 40 ends the AVX and SSE2 loops on each possible remainder, which the scalar tail then has to pick up.
+TEST(AABB, FromVerticesMatchesAScalarReduction)
+{
+	std::mt19937 generator { 7 };
+	EXPECT_TRUE(AABB::from_vertices({}).is_empty());
+	for (std::size_t count = 1; count <= 40; count++) {
+		const auto vertices = random_vertices(count, generator);
+		glm::vec3 minimum = vertices.front().pos;
+		glm::vec3 maximum = vertices.front().pos;
+		for (const auto& vertex : vertices) {
+			minimum = glm::min(minimum, vertex.pos);
+			maximum = glm::max(maximum, vertex.pos);
+		}
+
+		const auto box = AABB::from_vertices(vertices);
+		ASSERT_FALSE(box.is_empty()) << count;
+		EXPECT_EQ(box.minimum(), minimum) << count;
+		EXPECT_EQ(box.maximum(), maximum) << count;
+
+		auto radius = 0.0F;
+		for (const auto& vertex : vertices) {
+			radius = std::max(radius, glm::length(vertex.pos - box.middle_point()));
+		}
+		EXPECT_NEAR(BoundingSphere::from_vertices(vertices, box.middle_point()).radius, radius, radius * 1e-5F) << count;
+	}
+}
+
+TEST(AABB, TransformedMatchesTransformingEveryCorner)
+{
+	std::mt19937 generator { 11 };
+	std::uniform_real_distribution<float> angle { -3.0F, 3.0F };
+	std::uniform_real_distribution<float> scale { 0.1F, 5.0F };
+	std::uniform_real_distribution<float> offset { -50.0F, 50.0F };
+	for (std::size_t iteration = 0; iteration < 100; iteration++) {
+		const auto box = AABB::from_vertices(random_vertices(16, generator));
+		auto transform = glm::translate(glm::mat4 { 1.0F }, { offset(generator), offset(generator), offset(generator) });
+		transform = glm::rotate(transform, angle(generator), glm::normalize(glm::vec3 { offset(generator), offset(generator), 1.0F }));
+		transform = glm::scale(transform, { scale(generator), scale(generator), scale(generator) });
+
+		glm::vec3 minimum { std::numeric_limits<float>::max() };
+		glm::vec3 maximum { std::numeric_limits<float>::lowest() };
+		for (const auto& corner : corners_of(box)) {
+			const auto moved = glm::vec3 { transform * glm::vec4 { corner, 1.0F } };
+			minimum = glm::min(minimum, moved);
+			maximum = glm::max(maximum, moved);
+		}
+
+		const auto transformed = box.transformed(transform);
+		expect_near(transformed.minimum(), minimum, 1e-3F);
+		expect_near(transformed.maximum(), maximum, 1e-3F);
+	}
+	EXPECT_TRUE(AABB::empty().transformed(glm::mat4 { 2.0F }).is_empty());
+}
+
+TEST(AABB, IntersectsBoxesThatOverlapOrTouch)
+{
+	EXPECT_TRUE(unit_box.intersects(unit_box));
+	EXPECT_TRUE(unit_box.intersects(AABB { AABBRange { 1.0F, 2.0F }, AABBRange { 0.5F, 3.0F }, AABBRange { -1.0F, 0.0F } }));
+	EXPECT_TRUE(unit_box.intersects(AABB { AABBRange { 0.25F, 0.5F }, AABBRange { 0.25F, 0.5F }, AABBRange { 0.25F, 0.5F } }));
+	EXPECT_FALSE(unit_box.intersects(AABB { AABBRange { 1.5F, 2.0F }, AABBRange { 0.0F, 1.0F }, AABBRange { 0.0F, 1.0F } }));
+	EXPECT_FALSE(unit_box.intersects(AABB { AABBRange { 0.0F, 1.0F }, AABBRange { 0.0F, 1.0F }, AABBRange { -2.0F, -0.5F } }));
+}
+
+TEST(AABB, EmptyBoxesIntersectNothing)
+{
+	EXPECT_FALSE(AABB::empty().intersects(unit_box));
+	EXPECT_FALSE(unit_box.intersects(AABB::empty()));
+	EXPECT_FALSE(AABB::empty().intersects(AABB::empty()));
+	EXPECT_FALSE(AABB::empty().intersects(BoundingSphere { .centre = glm::vec3 { 0.0F }, .radius = 1000.0F }));
+
+	const auto merged = AABB::empty().merged(unit_box);
+	EXPECT_EQ(merged.minimum(), unit_box.minimum());
+	EXPECT_EQ(merged.maximum(), unit_box.maximum());
+}
+
+TEST(AABB, IntersectsSpheresWithinReachOfTheClosestPoint)
+{
+	EXPECT_TRUE(unit_box.intersects(BoundingSphere { .centre = { 0.5F, 0.5F, 0.5F }, .radius = 0.1F }));
+	EXPECT_TRUE(unit_box.intersects(BoundingSphere { .centre = { 2.0F, 0.5F, 0.5F }, .radius = 1.0F }));
+	EXPECT_FALSE(unit_box.intersects(BoundingSphere { .centre = { 2.0F, 2.0F, 0.5F }, .radius = 1.0F }));
+	// Within reach of each face's plane, but not of the corner.
+	EXPECT_FALSE(unit_box.intersects(BoundingSphere { .centre = { 1.9F, 1.9F, 1.9F }, .radius = 1.0F }));
+
+	EXPECT_TRUE((BoundingSphere { .centre = glm::vec3 { 0.0F }, .radius = 1.0F }.intersects({ .centre = { 2.0F, 0.0F, 0.0F }, .radius = 1.0F })));
+	EXPECT_FALSE((BoundingSphere { .centre = glm::vec3 { 0.0F }, .radius = 1.0F }.intersects({ .centre = { 2.01F, 0.0F, 0.0F }, .radius = 1.0F })));
+}
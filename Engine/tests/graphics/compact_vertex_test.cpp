@@ -0,0 +1,168 @@
+#include <gtest/gtest.h>
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+#include "graphics/CompactVertex.hpp"
+#include "graphics/ModelLoader.hpp"
+#include "mesh_test_helpers.hpp"
+
+using namespace Disarray;
+using namespace Disarray::Tests;
+
+namespace {
+
+// Directions spread evenly over the sphere, plus the axes and the seams of the octahedral map.
+auto unit_directions() -> std::vector<glm::vec3>
+{
+	std::vector<glm::vec3> directions {
+		{ 1.0F, 0.0F, 0.0F },
+		{ -1.0F, 0.0F, 0.0F },
+		{ 0.0F, 1.0F, 0.0F },
+		{ 0.0F, -1.0F, 0.0F },
+		{ 0.0F, 0.0F, 1.0F },
+		{ 0.0F, 0.0F, -1.0F },
+		glm::normalize(glm::vec3 { 1.0F, 1.0F, 0.0F }),
+		glm::normalize(glm::vec3 { -1.0F, 0.0F, -1.0F }),
+	};
+	static constexpr std::size_t count = 4096;
+	const auto golden_angle = pi * (3.0F - std::sqrt(5.0F));
+	for (std::size_t index = 0; index < count; index++) {
+		const auto z = 1.0F - 2.0F * (static_cast<float>(index) + 0.5F) / static_cast<float>(count);
+		const auto radius = std::sqrt(1.0F - z * z);
+		const auto angle = golden_angle * static_cast<float>(index);
+		directions.emplace_back(radius * std::cos(angle), radius * std::sin(angle), z);
+	}
+	return directions;
+}
+
+// atan2 rather than acos, which cannot resolve angles below about 3e-4 in floats.
+auto angle_between(const glm::vec3& left, const glm::vec3& right) -> float
+{
+	return std::atan2(glm::length(glm::cross(left, right)), glm::dot(left, right));
+}
+
+} // namespace
+
+TEST(CompactVertex, LayoutsMatchVertexSizes)
+{
+	for (const auto format : { VertexFormat::Full, VertexFormat::Compact, VertexFormat::CompactQuantised }) {
+		EXPECT_EQ(CompactVertices::layout(format).total_size, CompactVertices::vertex_size(format));
+	}
+	EXPECT_EQ(CompactVertices::vertex_size(VertexFormat::Full), sizeof(ModelVertex));
+	EXPECT_EQ(CompactVertices::layout(VertexFormat::Compact).elements.size(), 5);
+}
+
+TEST(CompactVertex, UvsRoundTripWithinHalfPrecision)
+{
+	for (float u = -8.0F; u <= 8.0F; u += 0.0137F) {
+		const glm::vec2 uvs { u, 1.0F - u };
+		const auto decoded = CompactVertices::decode_uvs(CompactVertices::encode_uvs(uvs));
+		// Halfs keep 11 significant bits.
+		EXPECT_NEAR(decoded.x, uvs.x, std::max(std::abs(uvs.x), 1.0F / 1024.0F) / 2048.0F);
+		EXPECT_NEAR(decoded.y, uvs.y, std::max(std::abs(uvs.y), 1.0F / 1024.0F) / 2048.0F);
+	}
+}
+
+TEST(CompactVertex, NormalsRoundTripWithinAHundredthOfADegree)
+{
+	float worst = 0.0F;
+	for (const auto& direction : unit_directions()) {
+		const auto decoded = CompactVertices::decode_normal(CompactVertices::encode_normal(direction));
+		EXPECT_NEAR(glm::length(decoded), 1.0F, 1e-5F);
+		worst = std::max(worst, angle_between(decoded, direction));
+	}
+	EXPECT_LT(worst, pi / 180.0F * 0.01F);
+}
+
+TEST(CompactVertex, TangentFramesRoundTripWithHandedness)
+{
+	float worst = 0.0F;
+	for (const auto& normal : unit_directions()) {
+		const auto seed = std::abs(normal.z) < 0.9F ? glm::vec3 { 0.0F, 0.0F, 1.0F } : glm::vec3 { 0.0F, 1.0F, 0.0F };
+		const auto tangent = glm::normalize(glm::cross(seed, normal));
+		for (const auto handedness : { 1.0F, -1.0F }) {
+			const auto bitangent = glm::cross(normal, tangent) * handedness;
+			const auto frame = CompactVertices::decode_tangent_frame(CompactVertices::encode_tangent_frame(normal, tangent, bitangent));
+
+			worst = std::max({ worst, angle_between(frame.normal, normal), angle_between(frame.tangent, tangent),
+				angle_between(frame.bitangent, bitangent) });
+			ASSERT_GT(glm::dot(frame.bitangent, bitangent), 0.0F);
+		}
+	}
+	EXPECT_LT(worst, pi / 180.0F * 0.01F);
+}
+
+TEST(CompactVertex, MissingTangentsGetAnOrthogonalOne)
+{
+	const glm::vec3 normal { 0.0F, 1.0F, 0.0F };
+	const auto frame = CompactVertices::decode_tangent_frame(CompactVertices::encode_tangent_frame(normal, glm::vec3 { 0.0F }, glm::vec3 { 0.0F }));
+	EXPECT_NEAR(glm::length(frame.tangent), 1.0F, 1e-4F);
+	EXPECT_NEAR(glm::dot(frame.tangent, normal), 0.0F, 1e-4F);
+	EXPECT_NEAR(glm::dot(frame.normal, normal), 1.0F, 1e-4F);
+}
+
+TEST(CompactVertex, ColoursRoundTripWithinHalfAStep)
+{
+	for (float channel = 0.0F; channel <= 1.0F; channel += 0.01F) {
+		const glm::vec4 colour { channel, 1.0F - channel, channel * 0.5F, 1.0F };
+		const auto decoded = CompactVertices::decode_colour(CompactVertices::encode_colour(colour));
+		for (glm::length_t component = 0; component < 4; component++) {
+			EXPECT_NEAR(decoded[component], colour[component], 0.5F / 255.0F + 1e-6F);
+		}
+	}
+}
+
+TEST(CompactVertex, QuantisedPositionsStayWithinAStepOfTheBounds)
+{
+	const auto submesh = load_submesh("Assets/Models/viking.obj");
+	const auto dequantisation = CompactVertices::dequantisation_for(submesh.vertices);
+	const auto quantised = CompactVertices::encode_quantised(submesh.vertices, dequantisation);
+	const auto compact = CompactVertices::encode(submesh.vertices);
+	ASSERT_EQ(quantised.size(), submesh.vertices.size());
+
+	for (std::size_t index = 0; index < submesh.vertices.size(); index++) {
+		const auto& original = submesh.vertices[index];
+		const auto decoded = CompactVertices::decode(quantised[index], dequantisation);
+		for (glm::length_t axis = 0; axis < 3; axis++) {
+			ASSERT_NEAR(decoded.pos[axis], original.pos[axis], dequantisation.scale[axis] / 65535.0F);
+		}
+		ASSERT_EQ(CompactVertices::decode(compact[index]).pos, original.pos);
+		ASSERT_LT(angle_between(decoded.normals, original.normals), pi / 180.0F * 0.01F);
+	}
+}
+
+TEST(CompactVertex, FlatAxesKeepTheirPosition)
+{
+	std::vector<ModelVertex> vertices(3);
+	vertices[0].pos = { 0.0F, 2.0F, -1.0F };
+	vertices[1].pos = { 4.0F, 2.0F, 1.0F };
+	vertices[2].pos = { 2.0F, 2.0F, 0.0F };
+
+	const auto dequantisation = CompactVertices::dequantisation_for(vertices);
+	EXPECT_FLOAT_EQ(dequantisation.scale.y, 1.0F);
+	const auto quantised = CompactVertices::encode_quantised(vertices, dequantisation);
+	for (std::size_t index = 0; index < vertices.size(); index++) {
+		EXPECT_FLOAT_EQ(CompactVertices::decode(quantised[index], dequantisation).pos.y, 2.0F);
+	}
+}
+
+TEST(CompactVertex, FootprintReportsSavings)
+{
+	const auto footprint = CompactVertices::footprint(1000, 3000, VertexFormat::CompactQuantised);
+	EXPECT_EQ(footprint.full_vertex_bytes, 1000 * sizeof(ModelVertex));
+	EXPECT_EQ(footprint.vertex_bytes, 1000 * sizeof(QuantisedCompactVertex));
+	EXPECT_EQ(footprint.index_bytes, 3000 * sizeof(std::uint32_t));
+	EXPECT_EQ(footprint.saved_bytes(), 1000 * (sizeof(ModelVertex) - sizeof(QuantisedCompactVertex)));
+
+	auto total = footprint;
+	total += CompactVertices::footprint(10, 30, VertexFormat::CompactQuantised);
+	EXPECT_EQ(total.vertex_count, 1010);
+	EXPECT_EQ(total.total_bytes(), 1010 * sizeof(QuantisedCompactVertex) + 3030 * sizeof(std::uint32_t));
+}
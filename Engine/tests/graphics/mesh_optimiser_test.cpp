@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "graphics/MeshOptimiser.hpp"
+#include "graphics/ModelLoader.hpp"
+#include "mesh_test_helpers.hpp"
+
+using namespace Disarray;
+using namespace Disarray::Tests;
+
+namespace {
+
+using VertexKey = std::tuple<float, float, float, float, float, float, float, float>;
+using Triangle = std::array<VertexKey, 3>;
+
+// Every triangle by its vertex data, rotated to start at its smallest corner. Keeps the winding but not the order or numbering.
+auto triangles_of(const Submesh& submesh) -> std::vector<Triangle>
+{
+	const auto key = [&submesh](std::uint32_t index) {
+		const auto& vertex = submesh.vertices.at(index);
+		return VertexKey { vertex.pos.x, vertex.pos.y, vertex.pos.z, vertex.uvs.x, vertex.uvs.y, vertex.normals.x, vertex.normals.y,
+			vertex.normals.z };
+	};
+
+	std::vector<Triangle> triangles;
+	for (std::size_t triangle = 0; triangle + 2 < submesh.indices.size(); triangle += 3) {
+		Triangle corners { key(submesh.indices[triangle]), key(submesh.indices[triangle + 1]), key(submesh.indices[triangle + 2]) };
+		std::rotate(corners.begin(), std::min_element(corners.begin(), corners.end()), corners.end());
+		triangles.push_back(corners);
+	}
+	std::sort(triangles.begin(), triangles.end());
+	return triangles;
+}
+
+class MeshOptimiserModelTest : public ::testing::TestWithParam<std::string> {
+protected:
+	void SetUp() override { submesh = load_submesh(std::filesystem::path { "Assets/Models" } / GetParam()); }
+
+	Submesh submesh {};
+};
+
+} // namespace
+
+TEST(MeshOptimiser, AnalyseCountsFifoMisses)
+{
+	const std::vector<std::uint32_t> single { 0, 1, 2 };
+	const auto single_statistics = MeshOptimiser::analyse_vertex_cache(single, 3);
+	EXPECT_FLOAT_EQ(single_statistics.acmr, 3.0F);
+	EXPECT_FLOAT_EQ(single_statistics.atvr, 1.0F);
+
+	const std::vector<std::uint32_t> quad { 0, 1, 2, 2, 1, 3 };
+	const auto quad_statistics = MeshOptimiser::analyse_vertex_cache(quad, 4);
+	EXPECT_FLOAT_EQ(quad_statistics.acmr, 2.0F);
+	EXPECT_FLOAT_EQ(quad_statistics.atvr, 1.0F);
+
+	const std::vector<std::uint32_t> revisited { 0, 1, 2, 3, 4, 5, 0, 1, 2 };
+	EXPECT_FLOAT_EQ(MeshOptimiser::analyse_vertex_cache(revisited, 6, 3).acmr, 3.0F);
+	EXPECT_FLOAT_EQ(MeshOptimiser::analyse_vertex_cache(revisited, 6, 16).acmr, 2.0F);
+	EXPECT_FLOAT_EQ(MeshOptimiser::analyse_vertex_cache(revisited, 6, 16).atvr, 1.0F);
+}
+
+TEST(MeshOptimiser, EmptyMeshIsLeftAlone)
+{
+	std::vector<ModelVertex> vertices {};
+	std::vector<std::uint32_t> indices {};
+	const auto report = MeshOptimiser::optimise(vertices, indices, { .vertex_cache = true, .overdraw = true, .vertex_fetch = true });
+	EXPECT_TRUE(vertices.empty());
+	EXPECT_TRUE(indices.empty());
+	EXPECT_FLOAT_EQ(report.after.acmr, 0.0F);
+}
+
+TEST_P(MeshOptimiserModelTest, VertexCacheKeepsTrianglesAndDoesNotRaiseAcmr)
+{
+	const auto before = triangles_of(submesh);
+	const auto report = MeshOptimiser::optimise(submesh.vertices, submesh.indices, { .vertex_cache = true });
+
+	EXPECT_EQ(triangles_of(submesh), before);
+	EXPECT_LE(report.after.acmr, report.before.acmr);
+	EXPECT_GE(report.after.atvr, 1.0F);
+}
+
+TEST_P(MeshOptimiserModelTest, OverdrawKeepsTrianglesWithinThreshold)
+{
+	const auto before = triangles_of(submesh);
+	auto cache_only = submesh;
+	const auto cache_report = MeshOptimiser::optimise(cache_only.vertices, cache_only.indices, { .vertex_cache = true });
+
+	const MeshOptimisationSettings settings { .overdraw = true, .overdraw_threshold = 1.05F };
+	const auto report = MeshOptimiser::optimise(submesh.vertices, submesh.indices, settings);
+
+	EXPECT_EQ(triangles_of(submesh), before);
+	// Every cluster starts from a flushed cache, so allow for that on top of the threshold.
+	EXPECT_LE(report.after.acmr, cache_report.after.acmr * settings.overdraw_threshold + 0.25F);
+}
+
+TEST_P(MeshOptimiserModelTest, VertexFetchOrdersVerticesByFirstUse)
+{
+	const auto before = triangles_of(submesh);
+	const auto report = MeshOptimiser::optimise(submesh.vertices, submesh.indices, { .vertex_cache = true, .vertex_fetch = true });
+
+	EXPECT_EQ(triangles_of(submesh), before);
+	std::uint32_t next = 0;
+	for (const auto index : submesh.indices) {
+		ASSERT_LE(index, next);
+		next = std::max(next, index + 1);
+	}
+	EXPECT_EQ(next, submesh.vertices.size());
+	EXPECT_LE(report.after.acmr, report.before.acmr);
+}
+
+TEST_P(MeshOptimiserModelTest, ModelLoaderReportsEverySubmesh)
+{
+	const auto name = std::filesystem::path { GetParam() }.replace_extension().string();
+	ModelLoader loader { std::filesystem::path { "Assets/Models" } / GetParam(), ImportedMesh { { name, submesh } } };
+	const auto reports = loader.optimise({ .vertex_cache = true, .overdraw = true, .vertex_fetch = true });
+
+	ASSERT_TRUE(reports.contains(name));
+	EXPECT_GT(reports.at(name).before.acmr, 0.0F);
+	EXPECT_GE(reports.at(name).after.atvr, 1.0F);
+}
+
+INSTANTIATE_TEST_SUITE_P(BundledModels, MeshOptimiserModelTest, ::testing::Values("cube.obj", "sphere.obj", "arrow.obj", "viking.obj"));
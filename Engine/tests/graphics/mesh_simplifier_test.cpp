@@ -0,0 +1,230 @@
+#include <gtest/gtest.h>
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <limits>
+#include <ranges>
+#include <span>
+#include <vector>
+
+#include "graphics/LodSelection.hpp"
+#include "graphics/MeshSimplifier.hpp"
+#include "graphics/ModelLoader.hpp"
+#include "mesh_test_helpers.hpp"
+
+using namespace Disarray;
+using namespace Disarray::Tests;
+
+namespace {
+
+// The grid with a texture seam down the middle: the columns left of it have u = 0, the ones right of it u = 1.
+auto make_seamed_grid(std::uint32_t size) -> Submesh
+{
+	auto grid = make_grid(size);
+	const auto seam = size / 2;
+	const auto grid_vertices = static_cast<std::uint32_t>(grid.vertices.size());
+	std::vector<std::uint32_t> right_copy(grid_vertices, 0);
+	for (std::uint32_t vertex = 0; vertex < grid_vertices; vertex++) {
+		const auto column = vertex % (size + 1);
+		grid.vertices[vertex].uvs.x = column > seam ? 1.0F : 0.0F;
+		if (column == seam) {
+			right_copy[vertex] = static_cast<std::uint32_t>(grid.vertices.size());
+			auto copy = grid.vertices[vertex];
+			copy.uvs.x = 1.0F;
+			grid.vertices.push_back(copy);
+		}
+	}
+	for (std::size_t triangle = 0; triangle < grid.indices.size() / 3; triangle++) {
+		const auto right_side = std::ranges::any_of(std::span { grid.indices }.subspan(triangle * 3, 3),
+			[&](std::uint32_t vertex) { return vertex % (size + 1) > seam; });
+		for (std::size_t corner = triangle * 3; corner < triangle * 3 + 3; corner++) {
+			if (right_side && grid.indices[corner] % (size + 1) == seam) {
+				grid.indices[corner] = right_copy[grid.indices[corner]];
+			}
+		}
+	}
+	return grid;
+}
+
+// A closed unit sphere with the poles shared, so there are no seams.
+auto make_sphere(std::uint32_t stacks, std::uint32_t slices) -> Submesh
+{
+	Submesh sphere {};
+	sphere.vertices.push_back(make_vertex({ 0.0F, 0.0F, 1.0F }));
+	for (std::uint32_t stack = 1; stack < stacks; stack++) {
+		const auto polar = pi * static_cast<float>(stack) / static_cast<float>(stacks);
+		for (std::uint32_t slice = 0; slice < slices; slice++) {
+			const auto azimuth = 2.0F * pi * static_cast<float>(slice) / static_cast<float>(slices);
+			sphere.vertices.push_back(make_vertex({ std::sin(polar) * std::cos(azimuth), std::sin(polar) * std::sin(azimuth), std::cos(polar) }));
+		}
+	}
+	const auto south = static_cast<std::uint32_t>(sphere.vertices.size());
+	sphere.vertices.push_back(make_vertex({ 0.0F, 0.0F, -1.0F }));
+
+	const auto ring = [slices](std::uint32_t stack, std::uint32_t slice) { return 1 + (stack - 1) * slices + slice % slices; };
+	for (std::uint32_t slice = 0; slice < slices; slice++) {
+		sphere.indices.insert(sphere.indices.end(), { 0, ring(1, slice), ring(1, slice + 1) });
+		sphere.indices.insert(sphere.indices.end(), { south, ring(stacks - 1, slice + 1), ring(stacks - 1, slice) });
+		for (std::uint32_t stack = 1; stack + 1 < stacks; stack++) {
+			const auto top_left = ring(stack, slice);
+			const auto top_right = ring(stack, slice + 1);
+			const auto bottom_left = ring(stack + 1, slice);
+			const auto bottom_right = ring(stack + 1, slice + 1);
+			sphere.indices.insert(sphere.indices.end(), { top_left, bottom_left, bottom_right, top_left, bottom_right, top_right });
+		}
+	}
+	return sphere;
+}
+
+auto normal_of(const std::vector<std::uint32_t>& indices, std::span<const ModelVertex> vertices, std::size_t triangle) -> glm::vec3
+{
+	const auto& first = vertices[indices[triangle * 3]].pos;
+	return glm::cross(vertices[indices[triangle * 3 + 1]].pos - first, vertices[indices[triangle * 3 + 2]].pos - first);
+}
+
+void expect_valid_triangles(const std::vector<std::uint32_t>& indices, std::span<const ModelVertex> vertices)
+{
+	ASSERT_EQ(indices.size() % 3, 0);
+	for (std::size_t triangle = 0; triangle < indices.size() / 3; triangle++) {
+		const auto first = indices[triangle * 3];
+		const auto second = indices[triangle * 3 + 1];
+		const auto third = indices[triangle * 3 + 2];
+		ASSERT_LT(std::max({ first, second, third }), vertices.size());
+		ASSERT_TRUE(first != second && second != third && first != third);
+		ASSERT_GT(glm::length(normal_of(indices, vertices, triangle)), 0.0F);
+	}
+}
+
+} // namespace
+
+TEST(MeshSimplifier, FlatGridCollapsesWithoutError)
+{
+	const auto grid = make_grid(16);
+	const auto result = MeshSimplifier::simplify(grid.indices, grid.vertices, 0, 1e-3F);
+	expect_valid_triangles(result.indices, grid.vertices);
+
+	EXPECT_LE(result.indices.size() / 3, 8);
+	EXPECT_NEAR(result.error, 0.0F, 1e-4F);
+	float area = 0.0F;
+	for (std::size_t triangle = 0; triangle < result.indices.size() / 3; triangle++) {
+		const auto normal = normal_of(result.indices, grid.vertices, triangle);
+		EXPECT_GT(normal.z, 0.0F);
+		area += 0.5F * glm::length(normal);
+	}
+	EXPECT_NEAR(area, 256.0F, 1e-2F);
+}
+
+TEST(MeshSimplifier, SeamVerticesSlideAlongTheirSeam)
+{
+	const auto grid = make_seamed_grid(16);
+	const auto result = MeshSimplifier::simplify(grid.indices, grid.vertices, 0, 1e-3F);
+	expect_valid_triangles(result.indices, grid.vertices);
+
+	EXPECT_LE(result.indices.size() / 3, 16);
+	float area = 0.0F;
+	for (std::size_t triangle = 0; triangle < result.indices.size() / 3; triangle++) {
+		const auto u = grid.vertices[result.indices[triangle * 3]].uvs.x;
+		EXPECT_EQ(grid.vertices[result.indices[triangle * 3 + 1]].uvs.x, u);
+		EXPECT_EQ(grid.vertices[result.indices[triangle * 3 + 2]].uvs.x, u);
+		area += 0.5F * glm::length(normal_of(result.indices, grid.vertices, triangle));
+	}
+	EXPECT_NEAR(area, 256.0F, 1e-2F);
+}
+
+TEST(MeshSimplifier, SphereMeetsTargetWithinErrorAndKeepsItsShape)
+{
+	const auto sphere = make_sphere(32, 64);
+	const auto target = sphere.indices.size() / 4 / 3 * 3;
+	const auto max_error = 0.05F;
+	const auto result = MeshSimplifier::simplify(sphere.indices, sphere.vertices, target, max_error);
+	expect_valid_triangles(result.indices, sphere.vertices);
+
+	EXPECT_LE(result.indices.size(), target);
+	EXPECT_GT(result.indices.size(), target / 2);
+	EXPECT_LE(result.error, max_error);
+	for (std::size_t triangle = 0; triangle < result.indices.size() / 3; triangle++) {
+		const auto& first = sphere.vertices[result.indices[triangle * 3]].pos;
+		const auto centroid = (first + sphere.vertices[result.indices[triangle * 3 + 1]].pos + sphere.vertices[result.indices[triangle * 3 + 2]].pos)
+			/ 3.0F;
+		EXPECT_GT(glm::dot(normal_of(result.indices, sphere.vertices, triangle), centroid), 0.0F);
+		EXPECT_LT(1.0F - glm::length(centroid), 2.0F * max_error);
+	}
+}
+
+TEST(MeshSimplifier, StopsAtTheErrorBound)
+{
+	const auto sphere = make_sphere(32, 64);
+	const auto result = MeshSimplifier::simplify(sphere.indices, sphere.vertices, 0, 0.01F);
+	expect_valid_triangles(result.indices, sphere.vertices);
+
+	EXPECT_LE(result.error, 0.01F);
+	EXPECT_LT(result.indices.size(), sphere.indices.size());
+	EXPECT_GT(result.indices.size(), sphere.indices.size() / 16);
+}
+
+TEST(MeshSimplifier, SimplifiesImportedModels)
+{
+	const auto submesh = load_submesh("Assets/Models/viking.obj");
+	const auto target = submesh.indices.size() / 2 / 3 * 3;
+	const auto result = MeshSimplifier::simplify(submesh.indices, submesh.vertices, target, 0.01F);
+	expect_valid_triangles(result.indices, submesh.vertices);
+
+	EXPECT_LE(result.indices.size(), target);
+	EXPECT_LE(result.error, 0.01F);
+}
+
+TEST(MeshSimplifier, LodChainsGetCoarserAndErrorsNeverDecrease)
+{
+	const auto sphere = make_sphere(32, 64);
+	const LodSettings settings { .ratios = { 0.5F, 0.25F, 0.125F, 0.125F }, .max_error = 0.05F };
+	const auto lods = MeshSimplifier::generate_lods(sphere.indices, sphere.vertices, settings);
+	ASSERT_EQ(lods.size(), 3);
+
+	auto previous_count = sphere.indices.size();
+	float previous_error = 0.0F;
+	for (const auto& lod : lods) {
+		expect_valid_triangles(lod.indices, sphere.vertices);
+		EXPECT_LT(lod.indices.size(), previous_count);
+		EXPECT_GE(lod.error, previous_error);
+		// The bounds of the unit sphere have a diagonal of 2 * sqrt(3).
+		EXPECT_LE(lod.error, settings.max_error * 2.0F * std::sqrt(3.0F));
+		previous_count = lod.indices.size();
+		previous_error = lod.error;
+	}
+
+	EXPECT_TRUE(MeshSimplifier::generate_lods(sphere.indices, sphere.vertices, LodSettings {}).empty());
+}
+
+TEST(LodSelection, PicksTheCoarsestLevelWithinThePixelError)
+{
+	const std::vector<float> errors { 0.0F, 0.01F, 0.02F, 0.04F };
+	const LodSelectionSettings settings { .pixel_error = 1.0F, .hysteresis = 0.0F };
+
+	EXPECT_EQ(LodSelection::select(errors, 200.0F, 0, settings), 0);
+	EXPECT_EQ(LodSelection::select(errors, 100.0F, 0, settings), 1);
+	EXPECT_EQ(LodSelection::select(errors, 50.0F, 0, settings), 2);
+	EXPECT_EQ(LodSelection::select(errors, 1.0F, 0, settings), 3);
+	EXPECT_EQ(LodSelection::select(errors, std::numeric_limits<float>::infinity(), 3, settings), 0);
+	EXPECT_EQ(LodSelection::select(std::vector<float> { 0.0F }, 1.0F, 0, settings), 0);
+	EXPECT_EQ(LodSelection::select(errors, 1.0F, 2, LodSelectionSettings { .enabled = false }), 0);
+}
+
+TEST(LodSelection, HysteresisDelaysCoarseningButNotRefining)
+{
+	const std::vector<float> errors { 0.0F, 0.01F, 0.02F };
+	const LodSelectionSettings settings { .pixel_error = 1.0F, .hysteresis = 0.25F };
+
+	// Level 1 is 0.9 pixels off: within the bound, but not by the hysteresis.
+	EXPECT_EQ(LodSelection::select(errors, 90.0F, 0, settings), 0);
+	EXPECT_EQ(LodSelection::select(errors, 90.0F, 1, settings), 1);
+	EXPECT_EQ(LodSelection::select(errors, 70.0F, 0, settings), 1);
+	// Level 2 is 1.2 pixels off, so a mesh that is on it refines straight away.
+	EXPECT_EQ(LodSelection::select(errors, 60.0F, 2, settings), 1);
+	EXPECT_EQ(LodSelection::select(errors, 200.0F, 2, settings), 0);
+	// Levels that no longer exist are clamped.
+	EXPECT_EQ(LodSelection::select(errors, 1.0F, 7, settings), 2);
+}
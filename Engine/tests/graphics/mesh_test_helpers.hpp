@@ -0,0 +1,50 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <utility>
+
+#include "graphics/ModelLoader.hpp"
+#include "graphics/ModelVertex.hpp"
+#include "graphics/model_loaders/ObjModelLoader.hpp"
+
+namespace Disarray::Tests {
+
+inline constexpr float pi = 3.14159265358979F;
+
+// The first submesh of a model, the only one for the bundled OBJs.
+inline auto load_submesh(const std::filesystem::path& path) -> Submesh
+{
+	ObjModelLoader loader {};
+	auto mesh = loader.import_model(path, default_import_flags);
+	return std::move(mesh.begin()->second);
+}
+
+inline auto make_vertex(const glm::vec3& position) -> ModelVertex
+{
+	ModelVertex vertex {};
+	vertex.pos = position;
+	return vertex;
+}
+
+// A flat square of size by size quads in the xy plane, facing +z.
+inline auto make_grid(std::uint32_t size) -> Submesh
+{
+	Submesh grid {};
+	for (std::uint32_t row = 0; row <= size; row++) {
+		for (std::uint32_t column = 0; column <= size; column++) {
+			grid.vertices.push_back(make_vertex({ static_cast<float>(column), static_cast<float>(row), 0.0F }));
+		}
+	}
+	for (std::uint32_t row = 0; row < size; row++) {
+		for (std::uint32_t column = 0; column < size; column++) {
+			const auto corner = row * (size + 1) + column;
+			grid.indices.insert(grid.indices.end(), { corner, corner + 1, corner + size + 2, corner, corner + size + 2, corner + size + 1 });
+		}
+	}
+	return grid;
+}
+
+} // namespace Disarray::Tests
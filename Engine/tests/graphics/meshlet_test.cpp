@@ -0,0 +1,264 @@
+#include <gtest/gtest.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <ranges>
+#include <set>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "graphics/MeshOptimiser.hpp"
+#include "graphics/Meshlets.hpp"
+#include "graphics/ModelLoader.hpp"
+#include "mesh_test_helpers.hpp"
+
+using namespace Disarray;
+using namespace Disarray::Tests;
+
+namespace {
+
+constexpr MeshletSettings settings { .enabled = true };
+
+auto triangle_set(std::span<const std::uint32_t> indices) -> std::multiset<std::array<std::uint32_t, 3>>
+{
+	std::multiset<std::array<std::uint32_t, 3>> triangles {};
+	for (std::size_t index = 0; index + 2 < indices.size(); index += 3) {
+		triangles.insert({ indices[index], indices[index + 1], indices[index + 2] });
+	}
+	return triangles;
+}
+
+void expect_valid_meshlets(const Submesh& original, std::span<const std::uint32_t> indices, std::span<const Meshlet> meshlets)
+{
+	ASSERT_EQ(triangle_set(original.indices), triangle_set(indices));
+
+	std::uint32_t next_index = 0;
+	for (const auto& meshlet : meshlets) {
+		ASSERT_EQ(meshlet.first_index, next_index);
+		ASSERT_EQ(meshlet.index_count % 3, 0);
+		ASSERT_GT(meshlet.index_count, 0);
+		next_index += meshlet.index_count;
+
+		const auto meshlet_indices = indices.subspan(meshlet.first_index, meshlet.index_count);
+		const std::set<std::uint32_t> unique { meshlet_indices.begin(), meshlet_indices.end() };
+		ASSERT_EQ(unique.size(), meshlet.vertex_count);
+		ASSERT_LE(meshlet.vertex_count, settings.max_vertices);
+		ASSERT_LE(meshlet.triangle_count(), settings.max_triangles);
+	}
+	ASSERT_EQ(next_index, indices.size());
+}
+
+auto face_normal(const Submesh& submesh, std::span<const std::uint32_t> triangle) -> glm::vec3
+{
+	const auto& first = submesh.vertices[triangle[0]].pos;
+	return glm::cross(submesh.vertices[triangle[1]].pos - first, submesh.vertices[triangle[2]].pos - first);
+}
+
+// Whether all three corners are beyond the same clip plane.
+auto outside_frustum(const glm::mat4& clip, const Submesh& submesh, std::span<const std::uint32_t> triangle) -> bool
+{
+	for (glm::length_t axis = 0; axis < 3; axis++) {
+		for (const auto side : { -1.0F, 1.0F }) {
+			const auto outside = std::ranges::all_of(triangle, [&](std::uint32_t index) {
+				const auto position = clip * glm::vec4 { submesh.vertices[index].pos, 1.0F };
+				return side * position[axis] > position.w;
+			});
+			if (outside) {
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+auto camera_at(const glm::vec3& position, const glm::vec3& target) -> std::array<glm::mat4, 2>
+{
+	return { glm::lookAt(position, target, glm::vec3 { 0.0F, 1.0F, 0.0F }), glm::perspective(glm::radians(60.0F), 1.0F, 0.1F, 100.0F) };
+}
+
+} // namespace
+
+TEST(Meshlets, GridMeshletsRespectTheLimitsAndKeepEveryTriangle)
+{
+	const auto grid = make_grid(32);
+	auto indices = grid.indices;
+	const auto meshlets = Meshlets::build(indices, grid.vertices, settings);
+	expect_valid_meshlets(grid, indices, meshlets);
+
+	// A connected grid fills meshlets up to the vertex limit: about 7 by 7 quads, so well over 60 triangles each.
+	const auto statistics = Meshlets::statistics(meshlets, settings);
+	EXPECT_GT(statistics.vertex_fill, 0.8F);
+	EXPECT_GT(statistics.triangle_fill, 0.5F);
+}
+
+TEST(Meshlets, BuildingInOrderKeepsTheIndices)
+{
+	auto submesh = load_submesh("Assets/Models/viking.obj");
+	MeshOptimiser::optimise(submesh.vertices, submesh.indices, { .vertex_cache = true, .overdraw = true });
+	const auto meshlets = Meshlets::build_in_order(submesh.indices, submesh.vertices, settings);
+	expect_valid_meshlets(submesh, submesh.indices, meshlets);
+
+	// Vertex cache order keeps neighbouring triangles together, so cutting it still fills meshlets reasonably.
+	const auto statistics = Meshlets::statistics(meshlets, settings);
+	EXPECT_GT(statistics.vertex_fill, 0.5F);
+	EXPECT_GT(statistics.meshlets_with_cones, 0);
+}
+
+// Meshlets are built after the optimisation stages, which must not undo the vertex cache order.
+TEST(Meshlets, ModelLoaderKeepsTheOptimisedVertexCacheOrder)
+{
+	for (const std::string name : { "sphere", "arrow", "viking" }) {
+		const auto path = std::filesystem::path { "Assets/Models" } / (name + ".obj");
+		ModelLoader loader { path, ImportedMesh { { name, load_submesh(path) } } };
+		const auto reports = loader.optimise({ .vertex_cache = true, .overdraw = true, .vertex_fetch = true });
+		loader.build_meshlets(settings);
+
+		const auto& submesh = loader.get_mesh_data().at(name);
+		ASSERT_FALSE(submesh.meshlets.empty()) << name;
+		EXPECT_LE(MeshOptimiser::analyse_vertex_cache(submesh.indices, submesh.vertices.size()).acmr, reports.at(name).after.acmr) << name;
+	}
+}
+
+TEST(Meshlets, FlatGridsHaveExactCones)
+{
+	const auto grid = make_grid(16);
+	auto indices = grid.indices;
+	for (const auto& meshlet : Meshlets::build(indices, grid.vertices, settings)) {
+		ASSERT_TRUE(meshlet.bounds.has_cone());
+		EXPECT_NEAR(meshlet.bounds.cone_cutoff, 0.0F, 1e-3F);
+		EXPECT_NEAR(meshlet.bounds.cone_axis.z, 1.0F, 1e-5F);
+	}
+}
+
+TEST(Meshlets, BoundsContainEveryVertex)
+{
+	const auto submesh = load_submesh("Assets/Models/viking.obj");
+	auto indices = submesh.indices;
+	const auto meshlets = Meshlets::build(indices, submesh.vertices, settings);
+	expect_valid_meshlets(submesh, indices, meshlets);
+
+	for (const auto& meshlet : meshlets) {
+		const auto& bounds = meshlet.bounds;
+		const auto tolerance = 1e-5F * std::max(1.0F, bounds.radius);
+		for (const auto index : std::span { indices }.subspan(meshlet.first_index, meshlet.index_count)) {
+			const auto& position = submesh.vertices[index].pos;
+			ASSERT_LE(glm::length(position - bounds.centre), bounds.radius + tolerance);
+			for (glm::length_t axis = 0; axis < 3; axis++) {
+				ASSERT_GE(position[axis], bounds.minimum[axis]);
+				ASSERT_LE(position[axis], bounds.maximum[axis]);
+			}
+		}
+		if (!bounds.has_cone()) {
+			continue;
+		}
+		const auto spread = std::sqrt(1.0F - bounds.cone_cutoff * bounds.cone_cutoff);
+		for (std::size_t triangle = meshlet.first_index; triangle < meshlet.first_index + meshlet.index_count; triangle += 3) {
+			const auto normal = face_normal(submesh, std::span { indices }.subspan(triangle, 3));
+			if (glm::length(normal) > 0.0F) {
+				ASSERT_GE(glm::dot(glm::normalize(normal), bounds.cone_axis), spread - 1e-4F);
+			}
+		}
+	}
+}
+
+TEST(Meshlets, ImportedModelsFillTheirMeshlets)
+{
+	// Both run out of vertices long before triangles: viking has more vertices than triangles from its uv seams, and every triangle of
+	// the flat shaded sphere has its own three.
+	for (const auto* path : { "Assets/Models/viking.obj", "Assets/Models/sphere.obj" }) {
+		const auto submesh = load_submesh(path);
+		auto indices = submesh.indices;
+		const auto meshlets = Meshlets::build(indices, submesh.vertices, settings);
+		expect_valid_meshlets(submesh, indices, meshlets);
+		EXPECT_GT(Meshlets::statistics(meshlets, settings).vertex_fill, 0.8F) << path;
+	}
+}
+
+TEST(Meshlets, CurvedSurfacesGetTightCones)
+{
+	const auto submesh = load_submesh("Assets/Models/sphere.obj");
+	auto indices = submesh.indices;
+	const auto meshlets = Meshlets::build(indices, submesh.vertices, settings);
+
+	// Two dozen meshlets over a sphere cover caps of about 25 degrees each, so every normal is well within 45 degrees of its axis.
+	const auto statistics = Meshlets::statistics(meshlets, settings);
+	EXPECT_EQ(statistics.meshlets_with_cones, meshlets.size());
+	EXPECT_LT(statistics.mean_cone_cutoff, std::sin(pi / 4.0F));
+}
+
+TEST(Meshlets, CullingNeverDropsAVisibleTriangle)
+{
+	const auto submesh = load_submesh("Assets/Models/sphere.obj");
+	auto indices = submesh.indices;
+	const auto meshlets = Meshlets::build(indices, submesh.vertices, settings);
+
+	std::size_t cone_culled = 0;
+	std::size_t frustum_culled = 0;
+	std::vector<IndexRange> ranges {};
+	for (std::size_t step = 0; step < 24; step++) {
+		// Every other camera is close enough that the sphere overflows the frustum.
+		const auto angle = 2.0F * pi * static_cast<float>(step) / 24.0F;
+		const auto distance = step % 2 == 0 ? 4.0F : 1.3F;
+		const glm::vec3 position { distance * std::cos(angle), 0.3F * distance * std::sin(3.0F * angle), distance * std::sin(angle) };
+		const auto [view, projection] = camera_at(position, glm::vec3 { 0.3F * std::sin(angle), 0.0F, 0.0F });
+		const auto culling = Meshlets::culling_view(view, projection, glm::mat4 { 1.0F });
+		ASSERT_NEAR(glm::length(culling.camera_position - position), 0.0F, 1e-4F);
+
+		const auto statistics = Meshlets::cull(meshlets, culling, ranges);
+		cone_culled += statistics.cone_culled;
+		frustum_culled += statistics.frustum_culled;
+		ASSERT_EQ(statistics.visible + statistics.frustum_culled + statistics.cone_culled, meshlets.size());
+
+		std::vector<bool> drawn(indices.size() / 3, false);
+		for (const auto& range : ranges) {
+			for (auto index = range.first_index; index < range.first_index + range.index_count; index += 3) {
+				drawn[index / 3] = true;
+			}
+		}
+		for (std::size_t triangle = 0; triangle < drawn.size(); triangle++) {
+			if (drawn[triangle]) {
+				continue;
+			}
+			const auto corners = std::span { indices }.subspan(triangle * 3, 3);
+			const auto back_facing = glm::dot(face_normal(submesh, corners), submesh.vertices[corners[0]].pos - position) >= -1e-6F;
+			ASSERT_TRUE(back_facing || outside_frustum(projection * view, submesh, corners)) << "a visible triangle was culled";
+		}
+	}
+	EXPECT_GT(cone_culled, 0);
+	EXPECT_GT(frustum_culled, 0);
+}
+
+TEST(Meshlets, CullingRejectsMeshesOutsideTheFrustumAndMergesRanges)
+{
+	const auto grid = make_grid(32);
+	auto indices = grid.indices;
+	const auto meshlets = Meshlets::build(indices, grid.vertices, settings);
+	ASSERT_GT(meshlets.size(), 1);
+
+	std::vector<IndexRange> ranges {};
+	const auto [view, projection] = camera_at({ 16.0F, 16.0F, 40.0F }, { 16.0F, 16.0F, 0.0F });
+	const auto front = Meshlets::cull(meshlets, Meshlets::culling_view(view, projection, glm::mat4 { 1.0F }), ranges);
+	EXPECT_EQ(front.visible, meshlets.size());
+	ASSERT_EQ(ranges.size(), 1);
+	EXPECT_EQ(ranges.front(), (IndexRange { 0, static_cast<std::uint32_t>(indices.size()) }));
+
+	// Seen from below the grid faces away.
+	const auto [below_view, below_projection] = camera_at({ 16.0F, 16.0F, -40.0F }, { 16.0F, 16.0F, 0.0F });
+	const auto back = Meshlets::cull(meshlets, Meshlets::culling_view(below_view, below_projection, glm::mat4 { 1.0F }), ranges);
+	EXPECT_EQ(back.cone_culled, meshlets.size());
+	EXPECT_TRUE(ranges.empty());
+
+	// The transform moves the grid behind the camera.
+	glm::mat4 transform { 1.0F };
+	transform[3] = glm::vec4 { 0.0F, 0.0F, 80.0F, 1.0F };
+	const auto moved = Meshlets::cull(meshlets, Meshlets::culling_view(view, projection, transform), ranges);
+	EXPECT_EQ(moved.frustum_culled, meshlets.size());
+	EXPECT_TRUE(ranges.empty());
+}
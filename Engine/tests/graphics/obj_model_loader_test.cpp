@@ -0,0 +1,53 @@
+#include <gtest/gtest.h>
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <filesystem>
+#include <string>
+
+#include "graphics/ModelLoader.hpp"
+#include "graphics/model_loaders/ObjModelLoader.hpp"
+#include "graphics/model_loaders/TinyObjModelLoader.hpp"
+
+using namespace Disarray;
+
+namespace {
+
+class ObjModelLoaderTest : public ::testing::TestWithParam<std::string> {
+protected:
+	void SetUp() override
+	{
+		const auto path = std::filesystem::path { "Assets/Models" } / GetParam();
+		tiny = TinyObjModelLoader { glm::mat4 { 1.0F } }.import_model(path, default_import_flags);
+		chunked = ObjModelLoader {}.import_model(path, default_import_flags);
+	}
+
+	ImportedMesh tiny {};
+	ImportedMesh chunked {};
+};
+
+} // namespace
+
+TEST_P(ObjModelLoaderTest, ProducesTheSameSubmeshesAsTinyObj)
+{
+	ASSERT_EQ(chunked.size(), tiny.size());
+	for (const auto& [identifier, expected] : tiny) {
+		const auto found = chunked.find(identifier);
+		ASSERT_NE(found, chunked.end()) << identifier;
+		const auto& actual = found->second;
+
+		// Welding numbers vertices by first use, so the same vertices in the same order also mean the same indices.
+		EXPECT_EQ(actual.indices, expected.indices) << identifier;
+		ASSERT_EQ(actual.vertices.size(), expected.vertices.size()) << identifier;
+		std::size_t mismatches = 0;
+		for (std::size_t vertex = 0; vertex < expected.vertices.size(); vertex++) {
+			if (!(actual.vertices[vertex] == expected.vertices[vertex])) {
+				mismatches++;
+			}
+		}
+		EXPECT_EQ(mismatches, 0) << identifier;
+	}
+}
+
+INSTANTIATE_TEST_SUITE_P(BundledModels, ObjModelLoaderTest, ::testing::Values("cube.obj", "sphere.obj", "arrow.obj", "viking.obj"));
@@ -0,0 +1,172 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "core/Collections.hpp"
+#include "graphics/ShaderDependencyGraph.hpp"
+
+using namespace Disarray;
+
+namespace {
+
+// A filesystem in memory, paths are compared as written.
+class FakeFilesystem {
+public:
+	void write(const std::filesystem::path& path, std::string source) { files.insert_or_assign(path.generic_string(), std::move(source)); }
+	void remove(const std::filesystem::path& path) { files.erase(path.generic_string()); }
+
+	[[nodiscard]] auto reader() -> ShaderSourceReader
+	{
+		return [this](const std::filesystem::path& path) -> std::optional<std::string> {
+			reads++;
+			const auto found = files.find(path.generic_string());
+			if (found == files.end()) {
+				return std::nullopt;
+			}
+			return found->second;
+		};
+	}
+
+	std::size_t reads { 0 };
+
+private:
+	Collections::StringMap<std::string> files {};
+};
+
+// Static and Water share a vertex shader and, through their fragment shaders, the lighting include. Unlit shares nothing.
+class ShaderDependencyGraphTest : public ::testing::Test {
+protected:
+	void SetUp() override
+	{
+		filesystem.write("Shaders/Include/constants.glsl", "const float pi = 3.14;\n");
+		filesystem.write("Shaders/Include/lighting.glsl", "#include \"constants.glsl\"\nvec3 light() { return vec3(pi); }\n");
+		filesystem.write("Shaders/Include/shadows.glsl", "#include \"lighting.glsl\"\nfloat shadow() { return 1.0; }\n");
+		filesystem.write("Shaders/main.vert", "#version 460\nvoid main() {}\n");
+		filesystem.write("Shaders/main.frag", "#version 460\n#include \"shadows.glsl\"\nvoid main() {}\n");
+		filesystem.write("Shaders/water.frag", "#version 460\n#include \"lighting.glsl\"\nvoid main() {}\n");
+		filesystem.write("Shaders/unlit.vert", "#version 460\nvoid main() {}\n");
+		filesystem.write("Shaders/unlit.frag", "#version 460\nvoid main() {}\n");
+
+		for (const auto* shader : { "main.vert", "main.frag", "water.frag", "unlit.vert", "unlit.frag" }) {
+			graph.add_shader(std::filesystem::path { "Shaders" } / shader);
+		}
+		graph.add_pipeline("Static", "main.vert", "main.frag");
+		graph.add_pipeline("Water", "main.vert", "water.frag");
+		graph.add_pipeline("Unlit", "unlit.vert", "unlit.frag");
+	}
+
+	FakeFilesystem filesystem {};
+	ShaderDependencyGraph graph { "Shaders/Include", filesystem.reader() };
+};
+
+auto paths(std::initializer_list<const char*> names) -> std::vector<std::filesystem::path>
+{
+	std::vector<std::filesystem::path> result {};
+	for (const auto* name : names) {
+		result.emplace_back(std::filesystem::path { "Shaders" } / name);
+	}
+	return result;
+}
+
+} // namespace
+
+TEST(ShaderDependencyGraph, ParsesIncludeDirectives)
+{
+	static constexpr std::string_view source = "#include \"a.glsl\"\nint x;\n#include \"b.glsl\"\n#include <c.glsl>\n#include \"broken\n";
+	const auto names = ShaderDependencyGraph::parse_includes(source);
+	ASSERT_EQ(names.size(), 2);
+	EXPECT_EQ(names[0], "a.glsl");
+	EXPECT_EQ(names[1], "b.glsl");
+}
+
+TEST_F(ShaderDependencyGraphTest, RecordsTransitiveIncludes)
+{
+	EXPECT_EQ(graph.includes_of("main.frag"), (std::vector<std::string> { "constants.glsl", "lighting.glsl", "shadows.glsl" }));
+	EXPECT_EQ(graph.includes_of("water.frag"), (std::vector<std::string> { "constants.glsl", "lighting.glsl" }));
+	EXPECT_TRUE(graph.includes_of("unlit.vert").empty());
+}
+
+TEST_F(ShaderDependencyGraphTest, ChangingAShaderOnlyTouchesItsPipelines)
+{
+	const auto plan = graph.on_changed("Shaders/water.frag");
+	EXPECT_EQ(plan.shaders, paths({ "water.frag" }));
+	EXPECT_EQ(plan.pipelines, (std::vector<std::string> { "Water" }));
+}
+
+TEST_F(ShaderDependencyGraphTest, ChangingASharedShaderTouchesEveryPipelineUsingIt)
+{
+	const auto plan = graph.on_changed("Shaders/main.vert");
+	EXPECT_EQ(plan.shaders, paths({ "main.vert" }));
+	EXPECT_EQ(plan.pipelines, (std::vector<std::string> { "Static", "Water" }));
+}
+
+TEST_F(ShaderDependencyGraphTest, ChangingAnIncludeFollowsIncludesOfIncludes)
+{
+	const auto plan = graph.on_changed("Shaders/Include/constants.glsl");
+	EXPECT_EQ(plan.shaders, paths({ "main.frag", "water.frag" }));
+	EXPECT_EQ(plan.pipelines, (std::vector<std::string> { "Static", "Water" }));
+
+	const auto shadows = graph.on_changed("Shaders/Include/shadows.glsl");
+	EXPECT_EQ(shadows.shaders, paths({ "main.frag" }));
+	EXPECT_EQ(shadows.pipelines, (std::vector<std::string> { "Static" }));
+}
+
+TEST_F(ShaderDependencyGraphTest, UnrelatedFilesTouchNothing)
+{
+	EXPECT_TRUE(graph.on_changed("Shaders/Include/unused.glsl").empty());
+	EXPECT_TRUE(graph.on_changed("Shaders/notes.frag").empty());
+}
+
+TEST_F(ShaderDependencyGraphTest, ChangedIncludesAreReread)
+{
+	filesystem.write("Shaders/unlit.frag", "#version 460\n#include \"constants.glsl\"\nvoid main() {}\n");
+	const auto plan = graph.on_changed("Shaders/unlit.frag");
+	EXPECT_EQ(plan.pipelines, (std::vector<std::string> { "Unlit" }));
+	EXPECT_EQ(graph.includes_of("unlit.frag"), (std::vector<std::string> { "constants.glsl" }));
+
+	const auto constants = graph.on_changed("Shaders/Include/constants.glsl");
+	EXPECT_EQ(constants.pipelines, (std::vector<std::string> { "Static", "Unlit", "Water" }));
+
+	filesystem.write("Shaders/Include/shadows.glsl", "float shadow() { return 1.0; }\n");
+	graph.on_changed("Shaders/Include/shadows.glsl");
+	EXPECT_EQ(graph.includes_of("main.frag"), (std::vector<std::string> { "shadows.glsl" }));
+	EXPECT_EQ(graph.on_changed("Shaders/Include/lighting.glsl").pipelines, (std::vector<std::string> { "Water" }));
+}
+
+TEST_F(ShaderDependencyGraphTest, IncludesThatAppearLaterAreTracked)
+{
+	filesystem.write("Shaders/main.vert", "#version 460\n#include \"skinning.glsl\"\nvoid main() {}\n");
+	EXPECT_EQ(graph.on_changed("Shaders/main.vert").pipelines, (std::vector<std::string> { "Static", "Water" }));
+
+	filesystem.write("Shaders/Include/skinning.glsl", "#include \"constants.glsl\"\n");
+	const auto plan = graph.on_changed("Shaders/Include/skinning.glsl");
+	EXPECT_EQ(plan.shaders, paths({ "main.vert" }));
+	EXPECT_EQ(graph.includes_of("main.vert"), (std::vector<std::string> { "constants.glsl", "skinning.glsl" }));
+}
+
+TEST_F(ShaderDependencyGraphTest, DeletedIncludesStillMapToTheirShaders)
+{
+	filesystem.remove("Shaders/Include/lighting.glsl");
+	const auto plan = graph.on_changed("Shaders/Include/lighting.glsl");
+	EXPECT_EQ(plan.shaders, paths({ "main.frag", "water.frag" }));
+	EXPECT_EQ(graph.includes_of("water.frag"), (std::vector<std::string> { "lighting.glsl" }));
+}
+
+TEST(ShaderDependencyGraph, IncludeCyclesEnd)
+{
+	FakeFilesystem filesystem {};
+	filesystem.write("Include/a.glsl", "#include \"b.glsl\"\n");
+	filesystem.write("Include/b.glsl", "#include \"a.glsl\"\n");
+	filesystem.write("cycle.frag", "#include \"a.glsl\"\n");
+	ShaderDependencyGraph graph { "Include", filesystem.reader() };
+	graph.add_shader("cycle.frag");
+	graph.add_pipeline("Cycle", "missing.vert", "cycle.frag");
+
+	EXPECT_EQ(graph.includes_of("cycle.frag"), (std::vector<std::string> { "a.glsl", "b.glsl" }));
+	EXPECT_EQ(graph.on_changed("Include/b.glsl").pipelines, (std::vector<std::string> { "Cycle" }));
+	EXPECT_EQ(filesystem.reads, 4);
+}
@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "core/Collections.hpp"
+#include "core/exceptions/GeneralExceptions.hpp"
+#include "graphics/ShaderKeywords.hpp"
+
+using namespace Disarray;
+
+namespace {
+
+constexpr std::string_view lit_fragment = R"(#version 460
+#pragma keywords SHADOWS NORMAL_MAPPING
+  #  pragma   keywords	ALPHA_TEST SHADOWS
+#pragma keywordsX IGNORED
+#pragma once
+#pragma keywords 2D not-an-identifier
+void main() {}
+)";
+
+auto strings(std::initializer_list<const char*> values) -> std::vector<std::string> { return { values.begin(), values.end() }; }
+
+} // namespace
+
+TEST(ShaderKeywords, ParsesDeclarationsInOrderWithoutRepeats)
+{
+	const auto keywords = ShaderKeywords::parse(lit_fragment);
+	EXPECT_EQ(keywords.get_keywords(), strings({ "SHADOWS", "NORMAL_MAPPING", "ALPHA_TEST" }));
+	EXPECT_TRUE(ShaderKeywords::parse("#version 460\nvoid main() {}\n").empty());
+}
+
+TEST(ShaderKeywords, PacksOneBitPerKeywordInDeclarationOrder)
+{
+	const auto keywords = ShaderKeywords::parse(lit_fragment);
+	EXPECT_EQ(keywords.mask_of({}), 0);
+	EXPECT_EQ(keywords.mask_of(strings({ "SHADOWS" })), 0b001);
+	EXPECT_EQ(keywords.mask_of(strings({ "ALPHA_TEST" })), 0b100);
+	EXPECT_EQ(keywords.mask_of(strings({ "ALPHA_TEST", "NORMAL_MAPPING", "SHADOWS" })), 0b111);
+}
+
+TEST(ShaderKeywords, UndeclaredRepeatedAndReorderedKeywordsPackTheSame)
+{
+	const auto keywords = ShaderKeywords::parse(lit_fragment);
+	const auto mask = keywords.mask_of(strings({ "SHADOWS", "ALPHA_TEST" }));
+	EXPECT_EQ(keywords.mask_of(strings({ "ALPHA_TEST", "SHADOWS" })), mask);
+	EXPECT_EQ(keywords.mask_of(strings({ "SHADOWS", "ALPHA_TEST", "SHADOWS", "FOG" })), mask);
+	EXPECT_EQ(keywords.mask_of(strings({ "shadows", "FOG" })), 0);
+}
+
+TEST(ShaderKeywords, MasksUnpackToDefines)
+{
+	const auto keywords = ShaderKeywords::parse(lit_fragment);
+	const auto mask = keywords.mask_of(strings({ "ALPHA_TEST", "SHADOWS" }));
+	EXPECT_EQ(keywords.enabled_in(mask), (std::vector<std::string_view> { "SHADOWS", "ALPHA_TEST" }));
+	EXPECT_EQ(keywords.defines_for(mask), "#define SHADOWS\n#define ALPHA_TEST\n");
+	EXPECT_EQ(keywords.defines_for(0), "");
+}
+
+TEST(ShaderKeywords, SupportsSixtyFourKeywords)
+{
+	std::vector<std::string> declared {};
+	std::string source {};
+	for (std::size_t index = 0; index < ShaderKeywords::max_keywords; index++) {
+		declared.push_back("K" + std::to_string(index));
+		source += "#pragma keywords " + declared.back() + "\n";
+	}
+	const auto keywords = ShaderKeywords::parse(source);
+	EXPECT_EQ(keywords.mask_of(strings({ "K63" })), KeywordMask { 1 } << 63);
+	EXPECT_EQ(keywords.mask_of(declared), ~KeywordMask { 0 });
+
+	source += "#pragma keywords ONE_TOO_MANY\n";
+	EXPECT_THROW((void)ShaderKeywords::parse(source), CouldNotCompileShaderException);
+}
+
+TEST(ShaderKeywords, VariantKeysAreTheShaderKeyWithoutKeywords)
+{
+	EXPECT_EQ((ShaderVariant { .shader = "static_mesh.frag", .mask = 0 }.key()), "static_mesh.frag");
+	EXPECT_EQ((ShaderVariant { .shader = "static_mesh.frag", .mask = 0b101 }.key()), "static_mesh.frag#5");
+	const ShaderVariant fragment { .shader = "static_mesh.frag", .mask = 0b101 };
+	const ShaderVariant vertex { .shader = "static_mesh.vert", .mask = 0b101 };
+	EXPECT_NE(fragment.key(), vertex.key());
+}
+
+TEST(ShaderKeywords, ResolvingDropsIdenticalPermutations)
+{
+	Collections::StringMap<ShaderKeywords> shaders {};
+	shaders.try_emplace("lit.frag", ShaderKeywords::parse(lit_fragment));
+	shaders.try_emplace("lit.vert", ShaderKeywords::parse("#pragma keywords SKINNING\n"));
+	const auto keywords_of = [&shaders](std::string_view shader) -> const ShaderKeywords& { return shaders.find(shader)->second; };
+
+	const std::vector<ShaderVariantRequest> requests {
+		{ .shader = "lit.frag", .keywords = strings({ "SHADOWS", "ALPHA_TEST" }) },
+		{ .shader = "lit.frag", .keywords = strings({ "ALPHA_TEST", "SHADOWS", "SKINNING" }) },
+		{ .shader = "lit.frag", .keywords = strings({ "FOG" }) },
+		{ .shader = "lit.frag", .keywords = {} },
+		{ .shader = "lit.vert", .keywords = strings({ "SHADOWS", "ALPHA_TEST" }) },
+		{ .shader = "lit.vert", .keywords = strings({ "SKINNING" }) },
+		{ .shader = "lit.vert", .keywords = strings({ "SKINNING", "SKINNING" }) },
+	};
+	const auto variants = resolve_variants(requests, keywords_of);
+	const std::vector<ShaderVariant> expected {
+		{ .shader = "lit.frag", .mask = 0 },
+		{ .shader = "lit.frag", .mask = 0b101 },
+		{ .shader = "lit.vert", .mask = 0 },
+		{ .shader = "lit.vert", .mask = 0b1 },
+	};
+	EXPECT_EQ(variants, expected);
+}
@@ -3,7 +3,6 @@
 #include <glslang/Public/ShaderLang.h>
 
 #include <filesystem>
-#include <map>
 #include <string>
 
 namespace Disarray {
@@ -34,13 +33,9 @@ private:
 	static inline const std::string empty;
 	static inline IncludeResult fail_result = { empty, "Header does not exist!", 0, nullptr };
 
-	struct Deleter {
-		auto operator()(IncludeResult*) -> void;
-	};
-	using IncludeResultPtr = std::unique_ptr<IncludeResult, Deleter>;
+	// Every result holds on to its file in the IncludeCache through its user data, so the includer keeps no state and any number of
+	// compilations can use it at once.
 	std::filesystem::path directory {};
-	std::map<std::string, IncludeResultPtr> includes;
-	std::map<std::string, std::string> sources;
 };
 
 } // namespace Disarray
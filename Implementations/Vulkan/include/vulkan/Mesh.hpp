@@ -23,6 +23,7 @@ public:
 	auto get_indices() const -> Disarray::IndexBuffer& override;
 	auto get_vertices() const -> Disarray::VertexBuffer& override;
 	auto get_aabb() const -> const AABB& override;
+	auto get_lod_errors() const -> std::span<const float> override;
 
 	[[nodiscard]] auto invalid() const -> bool override;
 
@@ -42,6 +43,7 @@ private:
 	std::vector<Ref<Disarray::Texture>> mesh_textures;
 	Collections::ScopedStringMap<Disarray::MeshSubstructure> submeshes {};
 	AABB aabb {};
+	std::vector<float> lod_errors {};
 	std::string mesh_name {};
 };
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "graphics/Shader.hpp"
+#include "graphics/SpirvCache.hpp"
 #include "vulkan/PropertySupplier.hpp"
 
 namespace Disarray::Vulkan {
@@ -13,10 +14,6 @@ namespace Reflection {
 
 } // namespace Reflection
 
-struct ReflectionData {
-	std::uint32_t attachment_count { 0 };
-};
-
 class Shader : public Disarray::Shader, public PropertySupplier<VkPipelineShaderStageCreateInfo> {
 	DISARRAY_MAKE_NONCOPYABLE(Shader)
 public:
@@ -34,7 +31,7 @@ private:
 
 	bool was_destroyed_explicitly { false };
 
-	ReflectionData reflection_data {};
+	ShaderReflection reflection_data {};
 
 	const Disarray::Device& device;
 	VkPipelineShaderStageCreateInfo stage {};
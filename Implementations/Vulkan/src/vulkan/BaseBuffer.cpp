@@ -3,6 +3,7 @@
 #include <magic_enum.hpp>
 
 #include "core/Ensure.hpp"
+#include "core/Metrics.hpp"
 #include "graphics/BufferProperties.hpp"
 #include "vulkan/Allocator.hpp"
 #include "vulkan/CommandExecutor.hpp"
@@ -130,6 +131,7 @@ void BaseBuffer::create_with_empty_data()
 
 void BaseBuffer::set_data(const void* data, std::uint32_t size, std::size_t offset)
 {
+	Metrics::add(Metrics::Counter::BytesUploaded, size);
 	if (props.always_mapped) {
 		std::memcpy(vma_allocation_info.pMappedData, data, size);
 		return;
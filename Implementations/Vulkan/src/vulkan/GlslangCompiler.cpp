@@ -7,18 +7,26 @@
 #include <glslang/Public/ResourceLimits.h>
 #include <glslang/Public/ShaderLang.h>
 
+#include <spirv_reflect.hpp>
+
+#include <array>
+#include <cstddef>
 #include <exception>
 #include <filesystem>
+#include <span>
 #include <unordered_set>
 
 #include "core/Collections.hpp"
 #include "core/Ensure.hpp"
 #include "core/Formatters.hpp"
+#include "core/Hashes.hpp"
 #include "core/Log.hpp"
 #include "core/Types.hpp"
 #include "core/filesystem/FileIO.hpp"
+#include "core/filesystem/MappedFile.hpp"
 #include "graphics/Shader.hpp"
 #include "graphics/ShaderCompiler.hpp"
+#include "graphics/SpirvCache.hpp"
 #include "vulkan/IncludeDirectoryIncluder.hpp"
 
 namespace Disarray::Runtime {
@@ -166,44 +174,138 @@ static constexpr auto DEFAULT_RESOURCES = []() {
 
 auto ShaderCompiler::Deleter::operator()(Detail::CompilerIntrinsics* ptr) -> void { delete ptr; }
 
+namespace {
+	constexpr int default_version = 460;
+	constexpr EProfile default_profile = ECoreProfile;
+	constexpr bool forward_compatible = false;
+	constexpr glslang::EShTargetClientVersion target_api_version = glslang::EShTargetVulkan_1_3;
+	constexpr glslang::EShTargetLanguageVersion target_spirv_version = glslang::EShTargetSpv_1_6;
+	constexpr bool validate_spirv = true;
+	constexpr bool generate_debug_info = true;
+
+	auto compiler_resources() -> TBuiltInResource
+	{
+		auto resources = DEFAULT_RESOURCES();
+		resources.maxCombinedTextureImageUnits = 2000;
+		resources.maxTextureImageUnits = 2000;
+		return resources;
+	}
+
+	// Everything besides the source that changes the SPIR-V glslang produces, so a change to any of it misses the SpirvCache.
+	auto compiler_seed(ShaderType type) -> std::uint64_t
+	{
+		const auto resources = compiler_resources();
+		// The limits are ints up to the trailing struct of bools, which is hashed field by field to leave out its padding.
+		auto seed = hash_bytes(std::span { reinterpret_cast<const std::byte*>(&resources), offsetof(TBuiltInResource, limits) });
+		const auto& limits = resources.limits;
+		const std::array<std::uint8_t, 9> limit_flags { limits.nonInductiveForLoops, limits.whileLoops, limits.doWhileLoops,
+			limits.generalUniformIndexing, limits.generalAttributeMatrixVectorIndexing, limits.generalVaryingIndexing, limits.generalSamplerIndexing,
+			limits.generalVariableIndexing, limits.generalConstantMatrixVectorIndexing };
+		seed = hash_bytes(std::as_bytes(std::span { limit_flags }), seed);
+
+		const auto glslang_version = glslang::GetVersion();
+		const std::array<std::int32_t, 11> options { static_cast<std::int32_t>(type), default_version, default_profile, forward_compatible,
+			target_api_version, target_spirv_version, validate_spirv, generate_debug_info, glslang_version.major, glslang_version.minor,
+			glslang_version.patch };
+		return hash_bytes(std::as_bytes(std::span { options }), seed);
+	}
+} // namespace
+
 auto ShaderCompiler::compile(const std::filesystem::path& path_to_shader, ShaderType type) -> std::vector<std::uint32_t>
 {
-	Log::info("ShaderCompiler", "Compiling {}", path_to_shader);
-	ensure(was_initialised(), "Compiler was not initialised");
+	// The source is handed to glslang as pieces of the mapped file and the includes, so that it is never copied.
+	const FS::MappedFile file { path_to_shader };
+	std::vector<std::string_view> pieces;
+	std::vector<IncludeHandle> includes;
+	expand_source(file, path_to_shader, type, {}, pieces, includes);
+	return compile_pieces(path_to_shader, pieces, type);
+}
 
-	auto resources = DEFAULT_RESOURCES();
-	auto& custom = resources;
-	custom.maxCombinedTextureImageUnits = 2000;
-	custom.maxTextureImageUnits = 2000;
+auto ShaderCompiler::compile_cached(const std::filesystem::path& path_to_shader, ShaderType type, std::string_view defines) -> CompiledShader
+{
+	const FS::MappedFile file { path_to_shader };
+	std::vector<std::string_view> pieces;
+	std::vector<IncludeHandle> includes;
+	expand_source(file, path_to_shader, type, defines, pieces, includes);
+
+	const auto key = SpirvCache::key_for(pieces, compiler_seed(type));
+	if (auto cached = SpirvCache::load(key)) {
+		Log::debug("ShaderCompiler", "Loaded {} from the SPIR-V cache", path_to_shader);
+		return std::move(*cached);
+	}
 
-	auto glslang_type = Detail::CompilerIntrinsics::to_glslang_type(type);
-	Scope<glslang::TShader> shader = make_scope<glslang::TShader>(glslang_type);
+	CompiledShader compiled { .code = compile_pieces(path_to_shader, pieces, type) };
+	if (compiled.code.empty()) {
+		return compiled;
+	}
+	compiled.reflection = reflect(compiled.code);
+	SpirvCache::store(key, compiled);
+	return compiled;
+}
 
-	std::string output;
-	if (!FS::read_from_file(path_to_shader.string(), output)) {
+auto ShaderCompiler::reflect(std::span<const std::uint32_t> code) -> ShaderReflection
+{
+	ShaderReflection output {};
+	spirv_cross::CompilerReflection reflection_compiler { code.data(), code.size() };
+	spirv_cross::ShaderResources shader_resources = reflection_compiler.get_shader_resources();
+	// Count the number of output attachments
+
+	const auto& model = reflection_compiler.get_execution_model();
+
+	for (const auto& resource : shader_resources.stage_outputs) {
+		// Check if the resource is an output attachment
+		if (reflection_compiler.get_decoration(resource.id, spv::Decoration::DecorationLocation) >= 0) {
+			output.attachment_count++;
+		}
+	}
+
+	// Technically, we only care about how many fragment outputs there are.
+	// FIXME: Will need to generalise if / when we care about vertex outputs.
+	if (model != spv::ExecutionModelFragment) {
+		output.attachment_count = 0;
+	}
+	Log::info("SPIRV Reflection", "Attachment count: {}", output.attachment_count);
+	return output;
+}
+
+void ShaderCompiler::expand_source(const FS::MappedFile& file, const std::filesystem::path& path_to_shader, ShaderType type,
+	std::string_view defines, std::vector<std::string_view>& pieces, std::vector<IncludeHandle>& includes)
+{
+	if (!file) {
 		throw CouldNotOpenStreamException { fmt::format("Could not read shader: {}", path_to_shader) };
 	}
-	add_include_extension(output);
-	output.erase(std::remove(output.begin(), output.end(), '\0'), output.end());
 
+	add_include_extension(file.view(), defines, pieces, includes);
 	if (type == ShaderType::Include) {
-		output += "void main() \n{}\n";
+		pieces.emplace_back("void main() \n{}\n");
 	}
+}
+
+auto ShaderCompiler::compile_pieces(const std::filesystem::path& path_to_shader, std::span<const std::string_view> pieces, ShaderType type) -> Code
+{
+	Log::debug("ShaderCompiler", "Compiling {}", path_to_shader);
+	ensure(was_initialised(), "Compiler was not initialised");
+
+	auto custom = compiler_resources();
+
+	auto glslang_type = Detail::CompilerIntrinsics::to_glslang_type(type);
+	Scope<glslang::TShader> shader = make_scope<glslang::TShader>(glslang_type);
 
-	std::array sources = { output.c_str() };
-	shader->setStrings(sources.data(), 1);
+	std::vector<const char*> strings;
+	std::vector<int> lengths;
+	strings.reserve(pieces.size());
+	lengths.reserve(pieces.size());
+	for (const auto& piece : pieces) {
+		strings.push_back(piece.data());
+		lengths.push_back(static_cast<int>(piece.size()));
+	}
+	shader->setStringsWithLengths(strings.data(), lengths.data(), static_cast<int>(strings.size()));
 
 	// Use appropriate Vulkan version
-	glslang::EShTargetClientVersion target_api_version = glslang::EShTargetVulkan_1_3;
 	shader->setEnvClient(glslang::EShClientVulkan, target_api_version);
-
-	glslang::EShTargetLanguageVersion target_spirv_version = glslang::EShTargetSpv_1_6;
 	shader->setEnvTarget(glslang::EshTargetSpv, target_spirv_version);
 
 	shader->setEntryPoint("main");
-	const int default_version = 460;
-	const bool forward_compatible = false;
-	EProfile default_profile = ECoreProfile;
 
 	std::string preprocessed_str;
 	if (glslang::TShader::ForbidIncluder forbid_includer {}; !shader->preprocess(
@@ -212,8 +314,8 @@ auto ShaderCompiler::compile(const std::filesystem::path& path_to_shader, Shader
 		return {};
 	}
 
-	std::array strings { preprocessed_str.c_str() };
-	shader->setStrings(strings.data(), 1);
+	std::array preprocessed_strings { preprocessed_str.c_str() };
+	shader->setStrings(preprocessed_strings.data(), 1);
 
 	if (!shader->parse(&custom, default_version, default_profile, false, forward_compatible, EShMsgDefault)) {
 		Log::error("ShaderCompiler", "Could not parse shader: {}, because: {}", path_to_shader.string(), shader->getInfoLog());
@@ -230,8 +332,8 @@ auto ShaderCompiler::compile(const std::filesystem::path& path_to_shader, Shader
 	const auto& intermediate_ref = *(program.getIntermediate(shader->getStage()));
 	std::vector<uint32_t> spirv;
 	glslang::SpvOptions options {};
-	options.validate = true;
-	options.generateDebugInfo = true;
+	options.validate = validate_spirv;
+	options.generateDebugInfo = generate_debug_info;
 	spv::SpvBuildLogger logger;
 	glslang::GlslangToSpv(intermediate_ref, spirv, &logger, &options);
 
@@ -269,59 +371,105 @@ void ShaderCompiler::destroy()
 	}
 }
 
-static auto replace(std::string& output, const std::string_view from, const std::string& replacement) -> bool
+BasicIncluder::BasicIncluder(std::filesystem::path directory)
+	: include_directory(std::move(directory))
 {
-	size_t start_pos = output.find(from);
-	if (start_pos == std::string::npos) {
-		return false;
+	// Only the names are listed here, the sources are read through the IncludeCache when a shader first includes them.
+	if (!std::filesystem::exists(include_directory)) {
+		return;
 	}
-	output.replace(start_pos, from.length(), replacement.c_str());
-	return true;
+	FS::for_each_in_directory(
+		include_directory,
+		[&paths = include_paths](const std::filesystem::directory_entry& entry) {
+			const auto& path = entry.path();
+			paths.try_emplace(path.filename().string(), path);
+		},
+		[](const std::filesystem::directory_entry& entry) { return extensions.contains(entry.path().extension().string()); });
 }
 
-auto BasicIncluder::check_and_replace(std::string& io_string, std::string_view to_find)
+void BasicIncluder::expand_includes(std::string_view source, std::vector<std::string_view>& pieces, std::vector<IncludeHandle>& includes) const
 {
-	const auto include = fmt::format("#include \"{}\"\n", to_find);
-	if (io_string.find(include) == std::string::npos) {
-		return;
-	}
-
-	ensure(include_include_source_map.contains(to_find), fmt::format("Could not find key {}", to_find));
-	const auto& include_string = include_include_source_map.at(std::string { to_find });
-
-	replace(io_string, include, fmt::format("\n{}\n", include_string));
+	Collections::StringSet expanded {};
+	expand_includes(source, pieces, includes, expanded);
 }
 
-BasicIncluder::BasicIncluder(std::filesystem::path directory)
+auto BasicIncluder::path_of(std::string_view name) const -> std::filesystem::path
 {
-	FS::for_each_in_directory(
-		std::move(directory),
-		[&inc = include_include_source_map](const std::filesystem::directory_entry& entry) {
-			const auto& path = entry.path();
-			inc[path.filename().string()] = {};
-			if (!FS::read_from_file(path.string(), inc[path.filename().string()])) {
-				Log::error("BasicIncluder", "Could not read file {}", path.string());
-			}
-		},
-		[](const std::filesystem::directory_entry& entry) { return extensions.contains(entry.path().extension().string()); });
+	// Files added to the directory after it was listed are found by name.
+	if (const auto found = include_paths.find(name); found != include_paths.end()) {
+		return found->second;
+	}
+	return include_directory / name;
 }
 
-void BasicIncluder::replace_all_includes(std::string& io_string)
+void BasicIncluder::expand_includes(std::string_view source, std::vector<std::string_view>& pieces, std::vector<IncludeHandle>& includes,
+	Collections::StringSet& expanded) const
 {
-	Collections::for_each(include_include_source_map, [&str = io_string, this](const auto& pair) {
-		auto&& [view, string] = pair;
-		check_and_replace(str, view);
-	});
+	static constexpr std::string_view directive = "#include \"";
+	static constexpr std::string_view newline = "\n";
+
+	// Null characters are left out, glslang stops at them.
+	const auto add_text = [&pieces](std::string_view text) {
+		for (auto null = text.find('\0'); null != std::string_view::npos; null = text.find('\0')) {
+			if (null > 0) {
+				pieces.push_back(text.substr(0, null));
+			}
+			text.remove_prefix(null + 1);
+		}
+		if (!text.empty()) {
+			pieces.push_back(text);
+		}
+	};
+
+	std::size_t position = 0;
+	while (true) {
+		const auto start = source.find(directive, position);
+		if (start == std::string_view::npos) {
+			break;
+		}
+
+		const auto name_start = start + directive.size();
+		const auto name_end = source.find('"', name_start);
+		if (name_end == std::string_view::npos || name_end + 1 >= source.size() || source[name_end + 1] != '\n') {
+			add_text(source.substr(position, name_start - position));
+			position = name_start;
+			continue;
+		}
+
+		const auto name = source.substr(name_start, name_end - name_start);
+		IncludeHandle include { nullptr };
+		if (!expanded.contains(name) && extensions.contains(std::filesystem::path { name }.extension().string())) {
+			include = IncludeCache::get(path_of(name));
+		}
+		if (!include) {
+			add_text(source.substr(position, name_end + 2 - position));
+			position = name_end + 2;
+			continue;
+		}
+
+		expanded.emplace(name);
+		add_text(source.substr(position, start - position));
+		pieces.push_back(newline);
+		const auto include_source = include->view();
+		includes.push_back(std::move(include));
+		expand_includes(include_source, pieces, includes, expanded);
+		pieces.push_back(newline);
+		position = name_end + 2;
+	}
+	add_text(source.substr(position));
 }
 
-void ShaderCompiler::add_include_extension(std::string& glsl_code)
+void ShaderCompiler::add_include_extension(
+	std::string_view glsl_code, std::string_view defines, std::vector<std::string_view>& pieces, std::vector<IncludeHandle>& includes)
 {
-	ensure(glsl_code.find("#version") == std::string::npos, "Shader already has a #version directive");
+	ensure(glsl_code.find("#version") == std::string_view::npos, "Shader already has a #version directive");
 	static constexpr std::string_view extension = "#version 460\n#extension GL_EXT_control_flow_attributes : require\n";
-	glsl_code.insert(0, extension);
+	pieces.push_back(extension);
+	if (!defines.empty()) {
+		pieces.push_back(defines);
+	}
 
-	using namespace std::string_view_literals;
-	includer.replace_all_includes(glsl_code);
+	includer.expand_includes(glsl_code, pieces, includes);
 }
 
 ShaderCompiler::ShaderCompiler()
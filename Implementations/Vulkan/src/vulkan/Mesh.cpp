@@ -1,5 +1,7 @@
 #include "DisarrayPCH.hpp"
 
+#include <magic_enum.hpp>
+
 #include <algorithm>
 #include <cstdint>
 #include <exception>
@@ -7,6 +9,7 @@
 #include <iostream>
 #include <mutex>
 #include <numeric>
+#include <span>
 #include <string>
 #include <utility>
 #include <vector>
@@ -16,8 +19,10 @@
 #include "core/Types.hpp"
 #include "core/exceptions/GeneralExceptions.hpp"
 #include "graphics/BufferProperties.hpp"
+#include "graphics/CompactVertex.hpp"
 #include "graphics/IndexBuffer.hpp"
 #include "graphics/Mesh.hpp"
+#include "graphics/MeshCache.hpp"
 #include "graphics/ModelLoader.hpp"
 #include "graphics/ModelVertex.hpp"
 #include "graphics/VertexBuffer.hpp"
@@ -49,28 +54,95 @@ void Mesh::load_and_initialise_model()
 	};
 
 	mesh_name = props.path.filename().replace_extension().string();
+
+	// A cache hit skips Assimp entirely, and the buffers are filled straight from the mapped cache file.
+	const auto cached = MeshCache::load(props.path, props.flags, props.initial_rotation, props.optimisation, props.lods, props.meshlets);
 	ModelLoader loader;
-	try {
-		loader = ModelLoader(make_scope<AssimpModelLoader>(props.initial_rotation), props.path, props.flags);
-	} catch (const CouldNotLoadModelException& exc) {
-		Log::error("Mesh", "Model could not be loaded: {}", exc.what());
-		return;
+	if (cached) {
+		loader = ModelLoader(props.path, cached->to_texture_tables());
+	} else {
+		try {
+			loader = ModelLoader(make_scope<AssimpModelLoader>(props.initial_rotation), props.path, props.flags);
+		} catch (const CouldNotLoadModelException& exc) {
+			Log::error("Mesh", "Model could not be loaded: {}", exc.what());
+			return;
+		}
 	}
 
 	mesh_textures = loader.construct_textures(device);
-	aabb = loader.get_aabb();
+	if (cached) {
+		aabb = cached->get_aabb();
+	} else {
+		loader.optimise(props.optimisation);
+		loader.generate_lods(props.lods);
+		loader.build_meshlets(props.meshlets);
+		aabb = loader.get_aabb();
+		MeshCache::store(
+			props.path, props.flags, props.initial_rotation, loader.get_mesh_data(), aabb, props.optimisation, props.lods, props.meshlets);
+	}
+
+	MeshFootprint footprint {};
+	lod_errors.assign(1, 0.0F);
 	for (const auto& mesh_data = loader.get_mesh_data(); const auto& [key, submesh] : mesh_data) {
-		auto vertex_buffer = VertexBuffer::construct_scoped(device,
-			{
-				.data = submesh.data<ModelVertex>(),
-				.size = submesh.size<ModelVertex>(),
-				.count = submesh.count<ModelVertex>(),
-			});
+		std::span<const ModelVertex> vertices = submesh.vertices;
+		std::span<const std::uint32_t> indices = submesh.indices;
+		std::vector<CachedLod> lods {};
+		std::span<const Meshlet> meshlets = submesh.meshlets;
+		if (cached) {
+			const auto* cached_submesh = cached->find(key);
+			if (cached_submesh == nullptr) {
+				continue;
+			}
+			vertices = cached_submesh->vertices;
+			indices = cached_submesh->indices;
+			lods = cached_submesh->lods;
+			meshlets = cached_submesh->meshlets;
+		} else {
+			for (const auto& lod : submesh.lods) {
+				lods.push_back({ .indices = lod.indices, .error = lod.error });
+			}
+		}
+
+		footprint += CompactVertices::footprint(vertices.size(), indices.size(), props.vertex_format);
+
+		PositionDequantisation dequantisation {};
+		Scope<Disarray::VertexBuffer> vertex_buffer {};
+		switch (props.vertex_format) {
+		case VertexFormat::Compact: {
+			const auto compact = CompactVertices::encode(vertices);
+			vertex_buffer = VertexBuffer::construct_scoped(device,
+				{
+					.data = compact.data(),
+					.size = compact.size() * sizeof(CompactVertex),
+					.count = compact.size(),
+				});
+			break;
+		}
+		case VertexFormat::CompactQuantised: {
+			dequantisation = CompactVertices::dequantisation_for(vertices);
+			const auto quantised = CompactVertices::encode_quantised(vertices, dequantisation);
+			vertex_buffer = VertexBuffer::construct_scoped(device,
+				{
+					.data = quantised.data(),
+					.size = quantised.size() * sizeof(QuantisedCompactVertex),
+					.count = quantised.size(),
+				});
+			break;
+		}
+		default:
+			vertex_buffer = VertexBuffer::construct_scoped(device,
+				{
+					.data = vertices.data(),
+					.size = vertices.size_bytes(),
+					.count = vertices.size(),
+				});
+			break;
+		}
 		auto index_buffer = IndexBuffer::construct_scoped(device,
 			{
-				.data = submesh.data<std::uint32_t>(),
-				.size = submesh.size<std::uint32_t>(),
-				.count = submesh.count<std::uint32_t>(),
+				.data = indices.data(),
+				.size = indices.size_bytes(),
+				.count = indices.size(),
 			});
 
 		std::unordered_set<std::int32_t> image_indices {};
@@ -80,9 +152,37 @@ void Mesh::load_and_initialise_model()
 			}
 		}
 
-		auto substructure = make_scope<MeshSubstructure>(std::move(vertex_buffer), std::move(index_buffer), std::move(image_indices));
+		// A submesh with fewer levels draws its coarsest one for the rest, so its error counts towards those too.
+		std::vector<MeshLod> lod_buffers {};
+		for (std::size_t level = 0; level < lods.size(); level++) {
+			const auto& lod = lods[level];
+			lod_buffers.push_back({
+				.indices = IndexBuffer::construct_scoped(device,
+					{
+						.data = lod.indices.data(),
+						.size = lod.indices.size_bytes(),
+						.count = lod.indices.size(),
+					}),
+				.error = lod.error,
+			});
+			if (lod_errors.size() < level + 2) {
+				lod_errors.resize(level + 2, lod_errors.back());
+			}
+			for (auto coarser = level + 1; coarser < lod_errors.size(); coarser++) {
+				lod_errors[coarser] = std::max(lod_errors[coarser], lod.error);
+			}
+		}
+
+		const auto submesh_aabb = AABB::from_vertices(vertices);
+		auto substructure = make_scope<MeshSubstructure>(std::move(vertex_buffer), std::move(index_buffer), std::move(image_indices), dequantisation,
+			std::move(lod_buffers), std::vector<Meshlet> { meshlets.begin(), meshlets.end() }, submesh_aabb,
+			BoundingSphere::from_vertices(vertices, submesh_aabb.middle_point()));
 		submeshes.try_emplace(key, std::move(substructure));
 	}
+
+	static constexpr auto to_kibibytes = [](std::size_t bytes) { return static_cast<double>(bytes) / 1024.0; };
+	Log::debug("Mesh", "{} takes {:.1f}KiB as {} vertices, saving {:.1f}KiB over ModelVertex.", props.path.filename().string(),
+		to_kibibytes(footprint.total_bytes()), magic_enum::enum_name(props.vertex_format), to_kibibytes(footprint.saved_bytes()));
 }
 
 auto Mesh::get_indices() const -> Disarray::IndexBuffer&
@@ -120,6 +220,8 @@ auto Mesh::construct_deferred(const Disarray::Device& device, MeshProperties pro
 
 auto Mesh::get_aabb() const -> const AABB& { return aabb; }
 
+auto Mesh::get_lod_errors() const -> std::span<const float> { return lod_errors; }
+
 auto Mesh::invalid() const -> bool
 {
 #ifdef IS_RELEASE
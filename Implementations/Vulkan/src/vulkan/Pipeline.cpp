@@ -49,6 +49,16 @@ namespace Detail {
 			return VK_FORMAT_R16G16B16_UINT;
 		case ElementType::Uint4:
 			return VK_FORMAT_R16G16B16A16_UINT;
+		case ElementType::Half2:
+			return VK_FORMAT_R16G16_SFLOAT;
+		case ElementType::Snorm16x2:
+			return VK_FORMAT_R16G16_SNORM;
+		case ElementType::Snorm16x4:
+			return VK_FORMAT_R16G16B16A16_SNORM;
+		case ElementType::Unorm16x4:
+			return VK_FORMAT_R16G16B16A16_UNORM;
+		case ElementType::Unorm8x4:
+			return VK_FORMAT_R8G8B8A8_UNORM;
 		default:
 			unreachable();
 		}
@@ -6,6 +6,7 @@
 #include "core/Clock.hpp"
 #include "core/Formatters.hpp"
 #include "core/Log.hpp"
+#include "core/Metrics.hpp"
 #include "core/Types.hpp"
 #include "graphics/Maths.hpp"
 #include "graphics/RenderBatch.hpp"
@@ -113,6 +114,7 @@ void QuadVertexBatch::submit_impl(Renderer& renderer, CommandExecutor& command_e
 
 	const auto count = index_count;
 	vkCmdDrawIndexed(command_buffer, count, 1, 0, 0, 0);
+	Metrics::add(Metrics::Counter::DrawCalls);
 }
 
 void QuadVertexBatch::flush_impl(Renderer& renderer, CommandExecutor& executor)
@@ -212,6 +214,7 @@ void LineVertexBatch::submit_impl(Disarray::Renderer& renderer, Disarray::Comman
 	vkCmdSetLineWidth(command_buffer, vk_pipeline.get_properties().line_width);
 
 	vkCmdDrawIndexed(command_buffer, index_count, 1, 0, 0, 0);
+	Metrics::add(Metrics::Counter::DrawCalls);
 }
 
 void LineVertexBatch::flush_impl(Disarray::Renderer& renderer, Disarray::CommandExecutor& executor)
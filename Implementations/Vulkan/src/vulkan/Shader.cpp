@@ -2,8 +2,6 @@
 
 #include "graphics/Shader.hpp"
 
-#include <spirv_reflect.hpp>
-
 #include <fstream>
 
 #include "core/Ensure.hpp"
@@ -51,29 +49,6 @@ namespace {
 		verify(vkCreateShaderModule(*device, &create_info, nullptr, &shader));
 	}
 
-	auto reflect_code(const std::vector<std::uint32_t>& spirv, ReflectionData& output)
-	{
-		spirv_cross::CompilerReflection reflection_compiler { spirv };
-		spirv_cross::ShaderResources shader_resources = reflection_compiler.get_shader_resources();
-		// Count the number of output attachments
-
-		const auto& model = reflection_compiler.get_execution_model();
-
-		for (const auto& resource : shader_resources.stage_outputs) {
-			// Check if the resource is an output attachment
-			if (reflection_compiler.get_decoration(resource.id, spv::Decoration::DecorationLocation) >= 0) {
-				output.attachment_count++;
-			}
-		}
-
-		// Technically, we only care about how many fragment outputs there are.
-		// FIXME: Will need to generalise if / when we care about vertex outputs.
-		if (model != spv::ExecutionModelFragment) {
-			output.attachment_count = 0;
-		}
-		Log::info("SPIRV Reflection", "Attachment count: {}", output.attachment_count);
-	}
-
 } // namespace
 
 Shader::Shader(const Disarray::Device& dev, ShaderProperties properties)
@@ -84,7 +59,7 @@ Shader::Shader(const Disarray::Device& dev, ShaderProperties properties)
 
 	if (props.code) {
 		ensure(!props.identifier.empty(), "Must supply an identifier");
-		reflect_code(*props.code, reflection_data);
+		reflection_data = props.reflection ? *props.reflection : Runtime::ShaderCompiler::reflect(*props.code);
 		create_module(cast_to<Vulkan::Device>(device), *props.code, shader_module);
 	} else {
 		ensure(props.path.has_value(), "No code, but no path provided.");
@@ -108,13 +83,13 @@ Shader::Shader(const Disarray::Device& dev, const std::filesystem::path& path)
 	props.path = path;
 	auto type = to_stage(props.type);
 	props.identifier = path;
-	props.code = compiler.compile(path, props.type);
-	if (props.code.has_value() && props.code->empty()) {
+	auto compiled = compiler.compile_cached(path, props.type);
+	if (compiled.code.empty()) {
 		Log::info("Shader", "Could not compile {}", path);
 		throw CouldNotCompileShaderException { fmt::format("Path: {}", path) };
 	}
-
-	reflect_code(*props.code, reflection_data);
+	props.code = std::move(compiled.code);
+	reflection_data = compiled.reflection;
 
 	create_module(cast_to<Vulkan::Device>(device), *props.code, shader_module);
 
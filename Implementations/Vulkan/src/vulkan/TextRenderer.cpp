@@ -12,6 +12,7 @@
 // clang-format on
 
 #include "core/Log.hpp"
+#include "core/Metrics.hpp"
 #include "core/filesystem/FileIO.hpp"
 #include "graphics/PipelineCache.hpp"
 #include "graphics/Renderer.hpp"
@@ -488,6 +489,7 @@ void TextRenderer::draw_screen_space(Disarray::Renderer& renderer, Disarray::Com
 	vkCmdBindVertexBuffers(cmd, 0, 1, vbs.data(), &offsets);
 
 	vkCmdDrawIndexed(cmd, screen_space.text_data_index * 6, 1, 0, 0, 0);
+	Metrics::add(Metrics::Counter::DrawCalls);
 }
 
 void TextRenderer::draw_world_space(Disarray::Renderer& renderer, Disarray::CommandExecutor& executor)
@@ -515,6 +517,7 @@ void TextRenderer::draw_world_space(Disarray::Renderer& renderer, Disarray::Comm
 	vkCmdBindVertexBuffers(cmd, 0, 1, vbs.data(), &offsets);
 
 	vkCmdDrawIndexed(cmd, world_space.text_data_index * 6, 1, 0, 0, 0);
+	Metrics::add(Metrics::Counter::DrawCalls);
 }
 
 void TextRenderer::draw_billboard_space(Disarray::Renderer& renderer, Disarray::CommandExecutor& executor)
@@ -543,6 +546,7 @@ void TextRenderer::draw_billboard_space(Disarray::Renderer& renderer, Disarray::
 	vkCmdBindVertexBuffers(cmd, 0, 1, vbs.data(), &offsets);
 
 	vkCmdDrawIndexed(cmd, billboard_space.text_data_index * 6, 1, 0, 0, 0);
+	Metrics::add(Metrics::Counter::DrawCalls);
 }
 
 void TextRenderer::render(Disarray::Renderer& renderer, Disarray::CommandExecutor& executor)
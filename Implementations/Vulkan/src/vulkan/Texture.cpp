@@ -21,7 +21,9 @@ Texture::Texture(const Disarray::Device& dev, Disarray::TextureProperties proper
 	: Disarray::Texture(std::move(properties))
 	, device(dev)
 {
-	DataBuffer pixels = props.data_buffer.is_valid() ? props.data_buffer : load_pixels();
+	// Decoded pixels are handed to the image instead of staying in props as well, for as long as the texture lives.
+	DataBuffer pixels = props.data_buffer.is_valid() ? std::move(props.data_buffer) : load_pixels();
+	props.data_buffer.reset();
 
 	if (props.generate_mips) {
 		props.mips = static_cast<std::uint32_t>(std::floor(std::log2(std::max(props.extent.width, props.extent.height)))) + 1;
@@ -47,7 +49,8 @@ Texture::Texture(const CommandExecutor* command_executor, const Disarray::Device
 	: Disarray::Texture(std::move(properties))
 	, device(dev)
 {
-	DataBuffer pixels = props.data_buffer.is_valid() ? props.data_buffer : load_pixels();
+	DataBuffer pixels = props.data_buffer.is_valid() ? std::move(props.data_buffer) : load_pixels();
+	props.data_buffer.reset();
 	if (!props.mips) {
 		props.mips = static_cast<std::uint32_t>(std::floor(std::log2(std::max(props.extent.width, props.extent.height)))) + 1;
 	}
@@ -14,6 +14,7 @@
 #include <array>
 
 #include "core/Instrumentation.hpp"
+#include "core/Metrics.hpp"
 #include "core/Types.hpp"
 #include "graphics/Pipeline.hpp"
 #include "util/BitCast.hpp"
@@ -138,6 +139,7 @@ void Renderer::draw_mesh(Disarray::CommandExecutor& executor, const Disarray::Me
 	vkCmdBindIndexBuffer(command_buffer, supply_cast<Vulkan::IndexBuffer>(mesh.get_indices()), 0, VK_INDEX_TYPE_UINT32);
 
 	vkCmdDrawIndexed(command_buffer, static_cast<std::uint32_t>(mesh.get_indices().size()), 1, 0, 0, 0);
+	Metrics::add(Metrics::Counter::DrawCalls);
 }
 
 void Renderer::draw_mesh_instanced(Disarray::CommandExecutor& executor, std::size_t instance_count, const Disarray::VertexBuffer& vertex_buffer,
@@ -163,6 +165,7 @@ void Renderer::draw_mesh_instanced(Disarray::CommandExecutor& executor, std::siz
 	vkCmdBindIndexBuffer(command_buffer, supply_cast<Vulkan::IndexBuffer>(index_buffer), 0, VK_INDEX_TYPE_UINT32);
 
 	vkCmdDrawIndexed(command_buffer, static_cast<std::uint32_t>(index_buffer.size()), static_cast<std::uint32_t>(instance_count), 0, 0, 0);
+	Metrics::add(Metrics::Counter::DrawCalls);
 }
 
 void Renderer::draw_mesh(Disarray::CommandExecutor& executor, const Disarray::Mesh& mesh, const Disarray::Pipeline& mesh_pipeline,
@@ -203,6 +206,7 @@ void Renderer::draw_mesh(Disarray::CommandExecutor& executor, const Disarray::Me
 	const auto& indices = cast_to<Vulkan::IndexBuffer>(mesh.get_indices());
 	vkCmdBindIndexBuffer(command_buffer, indices.supply(), 0, VK_INDEX_TYPE_UINT32);
 	vkCmdDrawIndexed(command_buffer, static_cast<std::uint32_t>(indices.size()), 1, 0, 0, 0);
+	Metrics::add(Metrics::Counter::DrawCalls);
 }
 void Renderer::draw_mesh(Disarray::CommandExecutor& executor, const Disarray::Mesh& mesh, const Disarray::Pipeline& mesh_pipeline,
 	const glm::vec4& colour, const glm::mat4& transform)
@@ -240,6 +244,7 @@ void Renderer::draw_mesh(Disarray::CommandExecutor& executor, const Disarray::Ve
 	const auto& vk_indices = cast_to<Vulkan::IndexBuffer>(indices);
 	vkCmdBindIndexBuffer(command_buffer, vk_indices.supply(), 0, VK_INDEX_TYPE_UINT32);
 	vkCmdDrawIndexed(command_buffer, static_cast<std::uint32_t>(indices.size()), 1, 0, 0, 0);
+	Metrics::add(Metrics::Counter::DrawCalls);
 }
 
 void Renderer::text_rendering_pass(Disarray::CommandExecutor& executor) { text_renderer.render(*this, executor); }
@@ -254,6 +259,7 @@ void Renderer::fullscreen_quad_pass(Disarray::CommandExecutor& executor, const D
 	auto* cmd = supply_cast<Vulkan::CommandExecutor>(executor);
 	bind_pipeline(executor, fullscreen_pipeline);
 	vkCmdDrawIndexed(cmd, 3, 1, 0, 0, 0);
+	Metrics::add(Metrics::Counter::DrawCalls);
 
 	end_pass(executor);
 }
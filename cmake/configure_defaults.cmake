@@ -1,7 +1,13 @@
 function(configure_defaults)
     set(DISARRAY_COMPILE_PROFILE OFF CACHE BOOL "Compile time profilation")
     set(DISARRAY_LOG_ALLOCATIONS OFF CACHE BOOL "Log all allocations")
+    set(DISARRAY_FORCE_SERIAL_EXECUTION OFF CACHE BOOL "Run parallel algorithms on the calling thread")
+    set(DISARRAY_COUNT_ALLOCATIONS OFF CACHE BOOL "Count heap allocations per frame, replaces the global operator new and delete")
+    set(DISARRAY_MINIMUM_LOG_LEVEL "" CACHE STRING "Log levels below this are compiled out (0 trace, 1 debug, 2 info, 3 error). Empty uses 2 in release and 0 otherwise")
+    set(DISARRAY_PROFILE OFF CACHE BOOL "Record profiler zones and write a Chrome trace on exit")
     set(DISARRAY_USE_VULKAN ON CACHE BOOL "Use vulkan over some other API")
+    set(DISARRAY_ENABLE_AVX OFF CACHE BOOL "Compile for CPUs with AVX, which the vectorised bounds computation uses over SSE2")
+    set(DISARRAY_NO_SIMD OFF CACHE BOOL "Use the scalar fallbacks of vectorised code")
     set(DISARRAY_BUILD_BENCHMARKS OFF CACHE BOOL "Build some benchmarks!")
     set(DISARRAY_BUILD_TESTS ON CACHE BOOL "Build tests")
 
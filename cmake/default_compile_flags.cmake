@@ -45,7 +45,20 @@ function(default_compile_flags)
 		target_compile_definitions(${PROJECT_NAME} PRIVATE DEBUG_ALLOCATIONS)
 	endif()
 
-	if()
+	if(DISARRAY_COUNT_ALLOCATIONS)
+		target_compile_definitions(${PROJECT_NAME} PRIVATE DISARRAY_COUNT_ALLOCATIONS)
+	endif()
+
+	if(NOT "${DISARRAY_MINIMUM_LOG_LEVEL}" STREQUAL "")
+		target_compile_definitions(${PROJECT_NAME} PRIVATE DISARRAY_MINIMUM_LOG_LEVEL=${DISARRAY_MINIMUM_LOG_LEVEL})
+	endif()
+
+	if(DISARRAY_PROFILE)
+		target_compile_definitions(${PROJECT_NAME} PRIVATE DISARRAY_PROFILE)
+	endif()
+
+	if(DISARRAY_FORCE_SERIAL_EXECUTION)
+		target_compile_definitions(${PROJECT_NAME} PRIVATE DISARRAY_FORCE_SERIAL_EXECUTION)
 	endif()
 
 	if("${CMAKE_BUILD_TYPE}" STREQUAL "Release")
@@ -56,6 +69,18 @@ function(default_compile_flags)
 		target_compile_definitions(${PROJECT_NAME} PRIVATE USE_VALIDATION_LAYERS)
 	endif()
 
+	if(DISARRAY_ENABLE_AVX)
+		if(DISARRAY_COMPILER STREQUAL "MSVC")
+			target_compile_options(${PROJECT_NAME} PRIVATE /arch:AVX)
+		else()
+			target_compile_options(${PROJECT_NAME} PRIVATE -mavx)
+		endif()
+	endif()
+
+	if(DISARRAY_NO_SIMD)
+		target_compile_definitions(${PROJECT_NAME} PRIVATE DISARRAY_NO_SIMD)
+	endif()
+
 	if(DISARRAY_USE_VULKAN)
 		target_compile_definitions(${PROJECT_NAME} PRIVATE DISARRAY_VULKAN)
 	endif()